@@ -63,8 +63,6 @@
 #ifndef _MSC_VER 
 #include <sys/time.h>
 #include <unistd.h>
-#else
-#define unlink _unlink
 #endif
 
 extern bool test_output_enabled;
@@ -89,11 +87,11 @@ void do_delete(Mobile* ch, char* argument)
             return;
         }
         else {
-            sprintf(strsave, "%s%s", cfg_get_player_dir(), capitalize(NAME_STR(ch)));
+            sprintf(strsave, "%s", NAME_STR(ch));
             wiznet("$N turns $Mself into line noise.", ch, NULL, 0, 0, 0);
             stop_fighting(ch, true);
             do_function(ch, &do_quit, "");
-            unlink(strsave);
+            delete_player_file(strsave);
             return;
         }
     }
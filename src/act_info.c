@@ -648,6 +648,12 @@ void do_autolist(Mobile* ch, char* argument)
     else
         send_to_char(COLOR_B_RED "OFF" COLOR_EOL, ch);
 
+    send_to_char("combat brief   ", ch);
+    if (IS_SET(ch->comm_flags, COMM_COMBAT_BRIEF))
+        send_to_char(COLOR_B_GREEN "ON" COLOR_EOL, ch);
+    else
+        send_to_char(COLOR_B_RED "OFF" COLOR_EOL, ch);
+
     if (!IS_SET(ch->act_flags, PLR_CANLOOT))
         send_to_char("Your corpse is safe from thieves.\n\r", ch);
     else
@@ -772,6 +778,21 @@ void do_compact(Mobile* ch, char* argument)
     }
 }
 
+void do_combatbrief(Mobile* ch, char* argument)
+{
+    if (IS_NPC(ch))
+        return;
+
+    if (IS_SET(ch->comm_flags, COMM_COMBAT_BRIEF)) {
+        send_to_char("You will see every blow again.\n\r", ch);
+        REMOVE_BIT(ch->comm_flags, COMM_COMBAT_BRIEF);
+    }
+    else {
+        send_to_char("Combat will be summarized once a round.\n\r", ch);
+        SET_BIT(ch->comm_flags, COMM_COMBAT_BRIEF);
+    }
+}
+
 void do_prompt(Mobile* ch, char* argument)
 {
     char buf[MAX_STRING_LENGTH];
@@ -1700,32 +1721,34 @@ void do_help(Mobile* ch, char* argument)
     }
     const char* argall = sb_string(argall_sb);
 
-    FOR_EACH(pHelp, help_first) {
+    int count;
+    HelpData** helps = find_helps((char*)argall, &count);
+
+    for (int i = 0; i < count; i++) {
+        pHelp = helps[i];
         level = (pHelp->level < 0) ? -1 * pHelp->level - 1 : pHelp->level;
 
         if (level > get_trust(ch)) continue;
 
-        if (is_name((char*)argall, pHelp->keyword)) {
-            /* add seperator if found */
-            if (found)
-                add_buf(output, "\n\r" COLOR_DECOR_2 "========================="
-                    "===================================" COLOR_CLEAR "\n\r\n\r");
-            if (pHelp->level >= 0 && str_cmp(argall, "imotd")) {
-                add_buf(output, pHelp->keyword);
-                add_buf(output, "\n\r");
-            }
-
-            // Strip leading '.' to allow initial blanks.
-            if (pHelp->text[0] == '.')
-                add_buf(output, pHelp->text + 1);
-            else
-                add_buf(output, pHelp->text);
-            found = true;
-            /* small hack :) */
-            if (ch->desc != NULL && ch->desc->connected != CON_PLAYING
-                && ch->desc->connected != CON_GEN_GROUPS)
-                break;
+        /* add seperator if found */
+        if (found)
+            add_buf(output, "\n\r" COLOR_DECOR_2 "========================="
+                "===================================" COLOR_CLEAR "\n\r\n\r");
+        if (pHelp->level >= 0 && str_cmp(argall, "imotd")) {
+            add_buf(output, pHelp->keyword);
+            add_buf(output, "\n\r");
         }
+
+        // Strip leading '.' to allow initial blanks.
+        if (pHelp->text[0] == '.')
+            add_buf(output, pHelp->text + 1);
+        else
+            add_buf(output, pHelp->text);
+        found = true;
+        /* small hack :) */
+        if (ch->desc != NULL && ch->desc->connected != CON_PLAYING
+            && ch->desc->connected != CON_GEN_GROUPS)
+            break;
     }
 
     if (!found)
@@ -35,6 +35,7 @@
 #include "interp.h"
 #include "mob_prog.h"
 #include "note.h"
+#include "pathfind.h"
 #include "skill_ops.h"
 #include "skills.h"
 #include "stringbuffer.h"
@@ -1692,3 +1693,88 @@ void do_train(Mobile* ch, char* argument)
     act("$n's $T increases!", ch, NULL, pOutput, TO_ROOM);
     return;
 }
+
+/*
+ * Takes one step along the shortest way to 'to', opening a door on the way if
+ * it has to. Returns false if it couldn't find a way (within 'limit' steps),
+ * or couldn't take it.
+ */
+bool move_toward(Mobile* ch, Room* to, int limit)
+{
+    Room* was_in = ch->in_room;
+    FLAGS flags = path_flags_for(ch);
+    PathResult path;
+
+    if (was_in == NULL || !find_path(was_in, to, limit, flags, &path)
+        || path.steps == 0 || path.first_dir < 0)
+        return false;
+
+    RoomExit* room_exit = was_in->exit[path.first_dir];
+    if (IS_SET(room_exit->exit_flags, EX_CLOSED)
+        && (!IS_SET(flags, PATH_PASS_DOOR)
+            || IS_SET(room_exit->exit_flags, EX_NOPASS))) {
+        do_function(ch, &do_open, (char*)dir_list[path.first_dir].name);
+        if (IS_SET(room_exit->exit_flags, EX_CLOSED))
+            return false;
+    }
+
+    move_char(ch, path.first_dir, false);
+    return ch->in_room != was_in;
+}
+
+#define TRACK_RANGE     40
+
+void do_track(Mobile* ch, char* argument)
+{
+    char arg[MAX_INPUT_LENGTH];
+    Mobile* victim;
+    PathResult path;
+    FLAGS flags;
+
+    one_argument(argument, arg);
+
+    if (get_skill(ch, gsn_track) == 0) {
+        send_to_char("You don't know how to track.\n\r", ch);
+        return;
+    }
+
+    if (arg[0] == '\0') {
+        send_to_char("Track whom?\n\r", ch);
+        return;
+    }
+
+    if ((victim = get_mob_world(ch, arg)) == NULL) {
+        send_to_char("You can't find a trail of anyone like that.\n\r", ch);
+        return;
+    }
+
+    if (victim->in_room == ch->in_room) {
+        act("$N is right here!", ch, NULL, victim, TO_CHAR);
+        return;
+    }
+
+    WAIT_STATE(ch, skill_table[gsn_track].beats);
+    act("$n kneels and studies the ground.", ch, NULL, NULL, TO_ROOM);
+
+    // Only immortals can follow a trail out of the area.
+    flags = path_flags_for(ch);
+    if (!IS_IMMORTAL(ch))
+        SET_BIT(flags, PATH_SAME_AREA);
+
+    if (!find_path(ch->in_room, victim->in_room, TRACK_RANGE, flags, &path)
+        || path.first_dir < 0) {
+        act("You can't find a trail of $N from here.", ch, NULL, victim,
+            TO_CHAR);
+        return;
+    }
+
+    if (!skill_ops->check_simple(ch, gsn_track)) {
+        send_to_char("You can't make out the trail.\n\r", ch);
+        check_improve(ch, gsn_track, false, 2);
+        return;
+    }
+
+    act("$N is $t from here.", ch, dir_list[path.first_dir].name, victim,
+        TO_CHAR);
+    check_improve(ch, gsn_track, true, 2);
+}
@@ -7,7 +7,9 @@
 #define MUD98__ACT_MOVE_H
 
 #include "entities/mobile.h"
+#include "entities/room.h"
 
 void move_char(Mobile* ch, int door, bool follow);
+bool move_toward(Mobile* ch, Room* to, int limit);
 
 #endif // !MUD98__ACT_MOVE_H
@@ -2360,7 +2360,7 @@ void do_buy(Mobile* ch, char* argument)
         READ_ARG(arg);
         if (arg[0] != '\0') {
             sprintf(buf, "%s %s", NAME_STR(pet), arg);
-            NAME_FIELD(pet) = lox_string(buf);
+            SET_NAME(pet, lox_string(buf));
         }
 
         sprintf(buf, "%sA neck tag says 'I belong to %s'.\n\r",
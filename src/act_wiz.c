@@ -2892,8 +2892,10 @@ void do_peace(Mobile* ch, char* argument)
     FOR_EACH_ROOM_MOB(rch, ch->in_room) {
         if (rch->fighting != NULL)
             stop_fighting(rch, true);
-        if (IS_NPC(rch) && IS_SET(rch->act_flags, ACT_AGGRESSIVE))
+        if (IS_NPC(rch) && IS_SET(rch->act_flags, ACT_AGGRESSIVE)) {
             REMOVE_BIT(rch->act_flags, ACT_AGGRESSIVE);
+            update_room_aggressor(rch);
+        }
     }
 
     send_to_char("Ok.\n\r", ch);
@@ -3454,7 +3456,7 @@ void do_string(Mobile* ch, char* argument)
                 send_to_char("Not on PC's.\n\r", ch);
                 return;
             }
-            NAME_FIELD(victim) = lox_string(arg3);
+            SET_NAME(victim, lox_string(arg3));
             return;
         }
 
@@ -3511,7 +3513,7 @@ void do_string(Mobile* ch, char* argument)
         }
 
         if (!str_prefix(arg2, "name")) {
-            NAME_FIELD(obj) = lox_string(arg3);
+            SET_NAME(obj, lox_string(arg3));
             return;
         }
 
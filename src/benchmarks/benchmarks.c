@@ -98,6 +98,10 @@ void stop_timer(Timer* timer)
 static const BenchmarkEntry benchmark_entries[] = {
     { "containers", benchmark_containers },
     { "formatting", benchmark_formatting },
+    { "lox",        benchmark_lox },
+    { "lox_events", benchmark_lox_events },
+    { "lox_patrol", benchmark_lox_patrol },
+    { "pathfinding", benchmark_pathfinding },
 };
 
 const BenchmarkEntry* benchmark_registry(size_t* count)
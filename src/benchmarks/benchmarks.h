@@ -30,6 +30,10 @@ void stop_timer(Timer* timer);
 
 void benchmark_containers();
 void benchmark_formatting();
+void benchmark_lox();
+void benchmark_lox_events();
+void benchmark_lox_patrol();
+void benchmark_pathfinding();
 
 const BenchmarkEntry* benchmark_registry(size_t* count);
 bool run_benchmark_by_name(const char* name);
@@ -6,12 +6,20 @@
 
 #include <olc/string_edit.h>
 
+#include <entities/descriptor.h>
+#include <entities/mob_prototype.h>
+#include <entities/player_data.h>
+#include <entities/room.h>
+
 #include <color.h>
+#include <comm.h>
 #include <db.h>
 #include <format.h>
+#include <handler.h>
 #include <match.h>
 
 char* _OLD_format_string(char* oldstring);
+void set_default_theme(Mobile* ch);
 
 #define ITERATIONS 100000
 
@@ -85,6 +93,116 @@ static void benchmark_new_string_format()
     printf(": %12ldns\n", result); // timer_res.tv_nsec);
 }
 
+#define ACT_ITERATIONS  100000
+#define ACT_PLAYERS     4
+#define ACT_CROWD       12
+
+typedef struct {
+    const char* name;
+    const char* format;
+    char arg;       // What the message is about: 'N' victim, 'p' object, 't' text
+} ActBenchmark;
+
+static const ActBenchmark act_benchmarks[] = {
+    { "social",     "$n smiles happily at $N.",                         'N' },
+    { "damage",     COLOR_FIGHT_OHIT "$n's slash MAULS $N!" COLOR_CLEAR,  'N' },
+    { "channel",    COLOR_SAY "$n says '" COLOR_SAY_TEXT "$t" COLOR_SAY
+                    "'" COLOR_CLEAR,                                    't' },
+    { "object",     "$n gets $p from the ground.",                      'p' },
+    { NULL, NULL, 0 }
+};
+
+static Mobile* bench_mobile(MobPrototype* proto, const char* name, bool player)
+{
+    Mobile* mob = create_mobile(proto);
+    SET_NAME(mob, lox_string(name));
+    mob->short_descr = str_dup(name);
+    mob->position = POS_STANDING;
+
+    if (player) {
+        mob->act_flags = PLR_COLOUR;
+        mob->pcdata = new_player_data();
+        mob->pcdata->ch = mob;
+        mob->desc = new_descriptor();
+        mob->desc->character = mob;
+        mob->desc->outsize = 2000;
+        mob->desc->outbuf = alloc_mem(mob->desc->outsize);
+        set_default_theme(mob);
+    }
+
+    return mob;
+}
+
+// act() in a room with a few linked players and a crowd of NPCs that have
+// nothing to hear.
+static void benchmark_act()
+{
+    Room* room = NULL;
+    RoomData* room_data;
+    FOR_EACH_GLOBAL_ROOM(room_data) {
+        if (room == NULL && room_data->instances.front != NULL)
+            room = AS_ROOM(room_data->instances.front->value);
+    }
+
+    if (room == NULL) {
+        printf("act() Benchmarks: no room to act in.\n");
+        return;
+    }
+
+    MobPrototype* proto = new_mob_prototype();
+    proto->level = 1;
+    proto->hit[0] = proto->hit[1] = proto->hit[2] = 1;
+
+    Mobile* actors[ACT_PLAYERS + ACT_CROWD];
+    for (int i = 0; i < ACT_PLAYERS + ACT_CROWD; i++) {
+        actors[i] = bench_mobile(proto, i < ACT_PLAYERS ? "Bencher" : "sheep",
+            i < ACT_PLAYERS);
+        mob_to_room(actors[i], room);
+    }
+
+    Object* obj = NULL;
+    ObjPrototype* obj_proto;
+    FOR_EACH_OBJ_PROTO(obj_proto) {
+        if (obj == NULL)
+            obj = create_object(obj_proto, 0);
+    }
+
+    Mobile* ch = actors[0];
+    Mobile* vch = actors[1];
+    String* text = lox_string("Has anyone seen my sheep?");
+
+    printf("act() Benchmarks (%d players, %d NPCs):\n", ACT_PLAYERS, ACT_CROWD);
+
+    for (const ActBenchmark* bench = act_benchmarks; bench->name != NULL;
+        bench++) {
+        if (bench->arg == 'p' && obj == NULL)
+            continue;
+
+        Timer timer = { 0 };
+        start_timer(&timer);
+        for (int i = 0; i < ACT_ITERATIONS; i++) {
+            if (bench->arg == 'N')
+                act(bench->format, ch, NULL, vch, TO_NOTVICT);
+            else if (bench->arg == 'p')
+                act(bench->format, ch, obj, NULL, TO_ROOM);
+            else
+                act(bench->format, ch, text, NULL, TO_ROOM);
+
+            for (int j = 0; j < ACT_PLAYERS; j++)
+                actors[j]->desc->outtop = 0;
+        }
+        stop_timer(&timer);
+
+        struct timespec res = elapsed(&timer);
+        long ns = (long)res.tv_sec * 1000000000L + res.tv_nsec;
+        printf("    %-10s: %12ldns (%6.1fns/act)\n", bench->name, ns,
+            (double)ns / ACT_ITERATIONS);
+    }
+
+    for (int i = 0; i < ACT_PLAYERS + ACT_CROWD; i++)
+        mob_from_room(actors[i]);
+}
+
 void benchmark_formatting()
 {
     benchmark_string_allocs();
@@ -100,4 +218,6 @@ void benchmark_formatting()
     printf("        Norm : %12ldns\n", norm_elapsed);
     printf("        Wrap : %12ldns\n", wrap_elapsed);
 #endif
+
+    benchmark_act();
 }
\ No newline at end of file
@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////
+// benchmarks/lox_benchmarks.c
+////////////////////////////////////////////////////////////////////////////////
+
+// Micro-benchmarks for the Lox call sites that go through inline caches
+// (property reads, method invocation, and native calls on entities), and for
+// the event handlers a scripted mob typically runs ("lox_events"), and for
+// long-running behaviours kept alive on the timer wheel ("lox_patrol").
+
+#include "benchmarks.h"
+
+#include <db.h>
+
+#include <entities/entity.h>
+#include <entities/event_timer.h>
+#include <entities/mobile.h>
+
+#include <lox/memory.h>
+#include <lox/native.h>
+#include <lox/vm.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define ITERATIONS 100000
+
+typedef struct {
+    const char* name;
+    const char* source;
+} LoxBenchmark;
+
+// Each script runs its loop body ITERATIONS times. The loop itself is timed
+// separately ("empty loop") so its cost can be subtracted by eye.
+static const LoxBenchmark lox_benchmarks[] = {
+    { "empty loop",
+        "var t = 0;"
+        "for (var i = 0; i < %d; i += 1) t = t + 1;" },
+    { "instance field",
+        "class P { init() { this.x = 1; } }"
+        "var p = P(); var t = 0;"
+        "for (var i = 0; i < %d; i += 1) t = t + p.x;" },
+    { "array count",
+        "var a = [1, 2, 3]; var t = 0;"
+        "for (var i = 0; i < %d; i += 1) t = t + a.count;" },
+    { "entity field",
+        "var m = bench_mob; var t = 0;"
+        "for (var i = 0; i < %d; i += 1) t = t + m.hp;" },
+    { "method invoke",
+        "class P { get() { return 1; } }"
+        "var p = P(); var t = 0;"
+        "for (var i = 0; i < %d; i += 1) t = t + p.get();" },
+    { "polymorphic invoke",
+        "class A { get() { return 1; } }"
+        "class B { get() { return 2; } }"
+        "var o = [A(), B()]; var k = 0; var t = 0;"
+        "for (var i = 0; i < %d; i += 1) { t = t + o[k].get(); k = 1 - k; }" },
+    { "bound method",
+        "class P { get() { return 1; } }"
+        "var p = P(); var f;"
+        "for (var i = 0; i < %d; i += 1) f = p.get;" },
+    { "native method",
+        "var m = bench_mob; var t;"
+        "for (var i = 0; i < %d; i += 1) t = m.is_mob();" },
+    { "array add",
+        "var a = [];"
+        "for (var i = 0; i < %d; i += 1) a.add(i);" },
+    { NULL, NULL }
+};
+
+static long run_lox_benchmark(const char* source)
+{
+    char buf[MAX_STRING_LENGTH];
+    Timer timer = { 0 };
+
+    // Wrap in a block so the loop variables are locals, not globals.
+    snprintf(buf, sizeof(buf), "{ ");
+    size_t len = strlen(buf);
+    snprintf(buf + len, sizeof(buf) - len, source, ITERATIONS);
+    len = strlen(buf);
+    snprintf(buf + len, sizeof(buf) - len, " }");
+
+    start_timer(&timer);
+    InterpretResult result = interpret_code(buf);
+    stop_timer(&timer);
+
+    if (result != INTERPRET_OK)
+        return -1;
+
+    struct timespec res = elapsed(&timer);
+    return (long)res.tv_sec * 1000000000L + res.tv_nsec;
+}
+
+void benchmark_lox()
+{
+    Mobile* mob = new_mobile();
+    mob->hit = 1;
+    add_global("bench_mob", OBJ_VAL(mob));
+
+    printf("Lox call site benchmarks (%d iterations):\n", ITERATIONS);
+
+    for (const LoxBenchmark* bench = lox_benchmarks; bench->name != NULL;
+        bench++) {
+        // First run warms the caches and the allocator.
+        run_lox_benchmark(bench->source);
+        long ns = run_lox_benchmark(bench->source);
+
+        if (ns < 0)
+            printf("    %-20s: failed\n", bench->name);
+        else
+            printf("    %-20s: %12ldns (%6.1fns/op)\n", bench->name, ns,
+                (double)ns / ITERATIONS);
+    }
+
+    add_global("bench_mob", NIL_VAL);
+}
+
+// A small scripted mob, in the shape of the handlers builders write most.
+static const char* event_class_source =
+    "init() { this.greeted = 0; }\n"
+    "on_greet(ch) {\n"
+    "    var msg = \"Welcome, level ${ch.level}!\";\n"
+    "    if (ch.level > this.level) this.greeted = this.greeted + 1;\n"
+    "    return msg;\n"
+    "}\n"
+    "on_fight(victim) {\n"
+    "    var pct = victim.hp * 100 / victim.max_hp;\n"
+    "    if (pct < 30) return \"flee\";\n"
+    "    var n = 0;\n"
+    "    while (n < 3) n = n + 1;\n"
+    "    return n;\n"
+    "}\n"
+    "on_random() {\n"
+    "    if (dice(1, 6) == 6) return true;\n"
+    "    return false;\n"
+    "}\n";
+
+static const char* event_handlers[] = {
+    "on_greet", "on_fight", "on_random", NULL
+};
+
+void benchmark_lox_events()
+{
+    Mobile* mob = new_mobile();
+    mob->level = 10;
+    mob->hit = 50;
+    mob->max_hit = 100;
+    add_global("bench_mob", OBJ_VAL(mob));
+
+    ObjClass* klass = create_entity_class((Entity*)mob, "BenchMob",
+        event_class_source);
+    if (klass == NULL) {
+        printf("Lox event benchmarks: could not compile the mob class.\n");
+        add_global("bench_mob", NIL_VAL);
+        return;
+    }
+    mob->header.klass = klass;
+    init_entity_class((Entity*)mob);
+
+    printf("Lox event handler benchmarks (%d calls each):\n", ITERATIONS);
+
+    for (const char** handler = event_handlers; *handler != NULL; handler++) {
+        Value method;
+        ObjString* name = copy_string(*handler, (int)strlen(*handler));
+        if (!table_get(&klass->methods, name, &method)) {
+            printf("    %-20s: missing\n", *handler);
+            continue;
+        }
+        ObjClosure* closure = AS_CLOSURE(method);
+
+        // Every handler takes at most one argument; the mob stands in for
+        // the other character.
+        int argc = closure->function->arity;
+        Timer timer = { 0 };
+        start_timer(&timer);
+        for (int i = 0; i < ITERATIONS; i++)
+            invoke_method_closure(OBJ_VAL(mob), closure, argc, OBJ_VAL(mob));
+        stop_timer(&timer);
+
+        struct timespec res = elapsed(&timer);
+        long ns = (long)res.tv_sec * 1000000000L + res.tv_nsec;
+        printf("    %-20s: %12ldns (%6.1fns/call)\n", *handler, ns,
+            (double)ns / ITERATIONS);
+    }
+
+    mob->header.klass = NULL;
+    add_global("bench_mob", NIL_VAL);
+}
+
+#define PATROLLERS      5000
+#define PATROL_STEPS    20
+
+// Two ways to write a behaviour that does a step every other pulse: a closure
+// that re-arms itself with delay(), and a spawned coroutine that yields.
+static const LoxBenchmark patrol_benchmarks[] = {
+    { "delay() chain",
+        "var patrol_steps = 0;"
+        "fun patrol(n) {"
+        "    patrol_steps = patrol_steps + 1;"
+        "    if (n > 1) delay(2, () -> { patrol(n - 1); }, nil);"
+        "}"
+        "for (var i = 0; i < %d; i++) delay(1, () -> { patrol(%d); }, nil);" },
+    { "spawned coroutine",
+        "var patrol_steps = 0;"
+        "for (var i = 0; i < %d; i++) spawn(() -> {"
+        "    for (var s = 0; s < %d; s++) {"
+        "        patrol_steps = patrol_steps + 1;"
+        "        yield 2;"
+        "    }"
+        "}, nil);" },
+    { NULL, NULL }
+};
+
+void benchmark_lox_patrol()
+{
+    printf("Lox patrol benchmarks (%d behaviours, %d steps each):\n",
+        PATROLLERS, PATROL_STEPS);
+
+    for (const LoxBenchmark* bench = patrol_benchmarks; bench->name != NULL;
+        bench++) {
+        char buf[MAX_STRING_LENGTH];
+        snprintf(buf, sizeof(buf), bench->source, PATROLLERS, PATROL_STEPS);
+
+        if (interpret_code(buf) != INTERPRET_OK) {
+            printf("    %-20s: failed\n", bench->name);
+            continue;
+        }
+
+        uint64_t allocs = vm.alloc_count;
+        int pulses = 0;
+        Timer timer = { 0 };
+        start_timer(&timer);
+        while (event_timer_stats()->pending > 0) {
+            event_timer_tick();
+            pulses++;
+        }
+        stop_timer(&timer);
+        allocs = vm.alloc_count - allocs;
+
+        Value steps = NIL_VAL;
+        table_get(&vm.globals, copy_string("patrol_steps", 12), &steps);
+        int count = IS_INT(steps) ? AS_INT(steps) : 0;
+
+        struct timespec res = elapsed(&timer);
+        long ns = (long)res.tv_sec * 1000000000L + res.tv_nsec;
+        printf("    %-20s: %12ldns over %d pulses (%6.1fns/step, %.2f "
+            "allocs/step)\n", bench->name, ns, pulses,
+            count > 0 ? (double)ns / count : 0.0,
+            count > 0 ? (double)allocs / count : 0.0);
+
+        collect_garbage();
+    }
+}
@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////
+// benchmarks/pathfind_benchmarks.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "benchmarks.h"
+
+#include <db.h>
+#include <pathfind.h>
+#include <rng.h>
+
+#include <entities/room.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PATH_QUERIES    5000
+
+typedef struct {
+    const char* name;
+    FLAGS flags;
+    int limit;
+} PathBenchmark;
+
+static const PathBenchmark path_benchmarks[] = {
+    { "steps",          PATH_OPEN_DOORS | PATH_FLY | PATH_SWIM,     0   },
+    { "steps (<= 40)",  PATH_OPEN_DOORS | PATH_FLY | PATH_SWIM,     40  },
+    { "steps (walker)", PATH_OPEN_DOORS,                            0   },
+    { "costs",          PATH_OPEN_DOORS | PATH_FLY | PATH_SWIM
+                        | PATH_COSTS,                               0   },
+    { NULL, 0, 0 }
+};
+
+static long timer_ns(Timer* timer)
+{
+    struct timespec res = elapsed(timer);
+    return (long)res.tv_sec * 1000000000L + res.tv_nsec;
+}
+
+void benchmark_pathfinding()
+{
+    Room** rooms = NULL;
+    int count = 0;
+    int capacity = 0;
+
+    RoomData* room_data;
+    Room* room;
+    FOR_EACH_GLOBAL_ROOM(room_data) {
+        FOR_EACH_ROOM_INST(room, room_data) {
+            if (count == capacity) {
+                capacity = capacity < 256 ? 256 : capacity * 2;
+                rooms = realloc(rooms, sizeof(Room*) * (size_t)capacity);
+                if (rooms == NULL) {
+                    printf("Pathfinding benchmarks: out of memory.\n");
+                    return;
+                }
+            }
+            rooms[count++] = room;
+        }
+    }
+
+    if (count < 2) {
+        printf("Pathfinding benchmarks: no world to search.\n");
+        free(rooms);
+        return;
+    }
+
+    printf("Pathfinding benchmarks (%d rooms, %d random pairs):\n", count,
+        PATH_QUERIES);
+
+    // The first search builds the landmark tables.
+    PathResult result;
+    Timer timer = { 0 };
+    path_graph_changed();
+    start_timer(&timer);
+    find_path(rooms[0], rooms[1], 0, PATH_COSTS, &result);
+    stop_timer(&timer);
+    printf("    %-20s: %12ldns\n", "landmark build", timer_ns(&timer));
+
+    for (const PathBenchmark* bench = path_benchmarks; bench->name != NULL;
+        bench++) {
+        RngContext ctx;
+        rng_context_seed(&ctx, 98, 1);
+
+        PathStats before = *path_stats();
+        int found = 0;
+        long steps = 0;
+
+        reset_timer(&timer);
+        start_timer(&timer);
+        for (int i = 0; i < PATH_QUERIES; i++) {
+            Room* from = rooms[rng_range_r(&ctx, 0, count - 1)];
+            Room* to = rooms[rng_range_r(&ctx, 0, count - 1)];
+            if (find_path(from, to, bench->limit, bench->flags, &result)) {
+                found++;
+                steps += result.steps;
+            }
+        }
+        stop_timer(&timer);
+
+        const PathStats* after = path_stats();
+        long ns = timer_ns(&timer);
+        printf("    %-20s: %12ldns (%8.1fns/query, %5d found, %5.1f steps "
+            "avg, %7.1f rooms/query, %d pruned)\n", bench->name, ns,
+            (double)ns / PATH_QUERIES, found,
+            found > 0 ? (double)steps / found : 0.0,
+            (double)(after->rooms_visited - before.rooms_visited)
+                / PATH_QUERIES,
+            (int)(after->pruned - before.pruned));
+    }
+
+    free(rooms);
+}
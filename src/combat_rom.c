@@ -205,6 +205,10 @@ static bool rom_apply_damage(Mobile* ch, Mobile* victim, int dam,
         victim->hit = 1;
     update_pos(victim);
 
+    // Summarized blows come before anyone goes down.
+    if (victim->position <= POS_STUNNED)
+        flush_combat_batch();
+
     switch (victim->position) {
     case POS_MORTAL:
         act("$n is mortally wounded, and will die soon, if not aided.", victim,
@@ -1204,21 +1204,10 @@ bust_a_prompt_cleanup:
 }
 
 // Append onto an output buffer.
-void write_to_buffer(Descriptor* d, const char* txt, size_t length)
+// Makes room for 'length' more bytes at d->outtop. Returns false (having
+// closed the connection) if the buffer can't grow that far.
+static bool reserve_output(Descriptor* d, size_t length)
 {
-    // Don't try to write to descriptors during unit tests; but allow for mock
-    // players to receive output.
-    if (test_socket_output_enabled) {
-        lox_printf("%s", txt);
-        return;
-    }
-    else if (test_output_enabled)
-        return;
-
-    // Find length in case caller didn't.
-    if (length <= 0) 
-        length = strlen(txt);
-
     // Initial \n\r if needed.
     if (d->outtop == 0 && !d->fcommand) {
         d->outbuf[0] = '\n';
@@ -1233,7 +1222,7 @@ void write_to_buffer(Descriptor* d, const char* txt, size_t length)
         if (d->outsize >= 32000) {
             bug("Buffer overflow. Closing.\n\r", 0);
             close_socket(d);
-            return;
+            return false;
         }
         outbuf = alloc_mem(2 * d->outsize);
         strncpy(outbuf, d->outbuf, d->outtop);
@@ -1243,6 +1232,27 @@ void write_to_buffer(Descriptor* d, const char* txt, size_t length)
         d->outsize *= 2;
     }
 
+    return true;
+}
+
+void write_to_buffer(Descriptor* d, const char* txt, size_t length)
+{
+    // Don't try to write to descriptors during unit tests; but allow for mock
+    // players to receive output.
+    if (test_socket_output_enabled) {
+        lox_printf("%s", txt);
+        return;
+    }
+    else if (test_output_enabled)
+        return;
+
+    // Find length in case caller didn't.
+    if (length <= 0) 
+        length = strlen(txt);
+
+    if (!reserve_output(d, length))
+        return;
+
     // Copy.
     strncpy(d->outbuf + d->outtop, txt, length);
     d->outtop += length;
@@ -1313,15 +1323,10 @@ void nanny(Descriptor * d, char* argument)
         }
 
         if (str_cmp(argument, "random") == 0) {
-            file_exists = true;
-            while (file_exists) {
+            do {
                 random_name(arg, MAX_INPUT_LENGTH);
-                file_exists = load_char_obj(d, arg);
-                if (!file_exists) {
-                    strcpy(argument, arg);
-                    ch = d->character;
-                }
-            }
+            } while (player_file_exists(arg));
+            strcpy(argument, arg);
         }
 
         argument[0] = UPPER(argument[0]);
@@ -2408,6 +2413,304 @@ void fix_sex(Mobile * ch)
         ch->sex = IS_NPC(ch) ? 0 : ch->pcdata->true_sex;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// act() templates
+//
+// A format is split once into literal spans and $-codes. The split is cached
+// by the format's address, and checked against a copy of the text, since
+// callers like dam_message() reuse one stack buffer for every message. A
+// template is pinned while its act() runs, as triggers may act() again.
+////////////////////////////////////////////////////////////////////////////////
+
+#define ACT_TEMPLATE_SLOTS  512     // Power of two
+
+typedef struct act_segment_t {
+    int start;          // Literal text: offset into the template's copy...
+    int length;         // ...and its length. Zero for a $-code.
+    char code;
+} ActSegment;
+
+typedef struct act_template_t {
+    const char* format;
+    char* text;
+    size_t text_size;
+    ActSegment* segments;
+    int count;
+    int capacity;
+    int pins;
+} ActTemplate;
+
+static ActTemplate act_templates[ACT_TEMPLATE_SLOTS];
+
+static void add_act_segment(ActTemplate* tmpl, int start, int length,
+    char code)
+{
+    if (tmpl->count == tmpl->capacity) {
+        int capacity = tmpl->capacity < 8 ? 8 : tmpl->capacity * 2;
+        ActSegment* segments = alloc_mem(sizeof(ActSegment) * (size_t)capacity);
+        if (tmpl->count > 0)
+            memcpy(segments, tmpl->segments,
+                sizeof(ActSegment) * (size_t)tmpl->count);
+        if (tmpl->segments != NULL)
+            free_mem(tmpl->segments,
+                sizeof(ActSegment) * (size_t)tmpl->capacity);
+        tmpl->segments = segments;
+        tmpl->capacity = capacity;
+    }
+
+    ActSegment* seg = &tmpl->segments[tmpl->count++];
+    seg->start = start;
+    seg->length = length;
+    seg->code = code;
+}
+
+static void parse_act_template(ActTemplate* tmpl, const char* format)
+{
+    size_t size = strlen(format) + 1;
+    if (tmpl->text_size < size) {
+        if (tmpl->text != NULL)
+            free_mem(tmpl->text, tmpl->text_size);
+        tmpl->text = alloc_mem(size);
+        tmpl->text_size = size;
+    }
+    memcpy(tmpl->text, format, size);
+    tmpl->format = format;
+    tmpl->count = 0;
+
+    const char* text = tmpl->text;
+    const char* str = text;
+    while (*str != '\0') {
+        const char* start = str;
+        while (*str != '\0' && *str != '$')
+            str++;
+
+        if (str > start)
+            add_act_segment(tmpl, (int)(start - text), (int)(str - start), 0);
+
+        if (*str == '\0')
+            break;
+
+        // A '$' at the very end becomes a bad (NUL) code.
+        add_act_segment(tmpl, 0, 0, *++str);
+        if (*str != '\0')
+            str++;
+    }
+}
+
+static void free_act_template(ActTemplate* tmpl)
+{
+    if (tmpl->text != NULL)
+        free_mem(tmpl->text, tmpl->text_size);
+    if (tmpl->segments != NULL)
+        free_mem(tmpl->segments, sizeof(ActSegment) * (size_t)tmpl->capacity);
+}
+
+// Returns the cached template for 'format', or NULL if its slot is pinned by
+// a different one.
+static ActTemplate* get_act_template(const char* format)
+{
+    uintptr_t key = (uintptr_t)format;
+    ActTemplate* tmpl = &act_templates[((key >> 4) ^ (key >> 13))
+        & (ACT_TEMPLATE_SLOTS - 1)];
+
+    if (tmpl->format == format && !strcmp(tmpl->text, format))
+        return tmpl;
+
+    if (tmpl->pins > 0)
+        return NULL;
+
+    parse_act_template(tmpl, format);
+    return tmpl;
+}
+
+// Where one recipient's copy of a message goes: straight into a descriptor's
+// output buffer, or into a StringBuffer (for triggers, and for tests, which
+// capture whole strings).
+typedef struct act_sink_t {
+    Descriptor* d;
+    StringBuffer* sb;
+    Mobile* to;             // Whose colour theme to use
+    bool expand;            // Process colour codes (or leave them be)
+    bool colour;            // ...into escape sequences (or strip them)
+    bool capitalize;        // Nothing written yet
+    bool escape;            // Last character seen was COLOR_ESC_CHAR
+} ActSink;
+
+static void act_sink_put(ActSink* sink, const char* text, size_t length)
+{
+    if (sink->sb != NULL) {
+        sb_append_n(sink->sb, text, length);
+        return;
+    }
+
+    Descriptor* d = sink->d;
+    if (d == NULL)
+        return;
+
+    if (!reserve_output(d, length)) {
+        sink->d = NULL;
+        return;
+    }
+
+    memcpy(d->outbuf + d->outtop, text, length);
+    d->outtop += length;
+}
+
+static void act_sink_expand(ActSink* sink, const char* text, size_t length)
+{
+    if (!sink->expand) {
+        act_sink_put(sink, text, length);
+        return;
+    }
+
+    const char* end = text + length;
+    while (text < end) {
+        if (sink->escape) {
+            sink->escape = false;
+            if (sink->colour) {
+                char code[256];
+                size_t len = colour(*text, sink->to, code, sizeof(code));
+                act_sink_put(sink, code, len);
+            }
+            text++;
+            continue;
+        }
+
+        const char* chunk = text;
+        while (text < end && *text != COLOR_ESC_CHAR)
+            text++;
+
+        if (text > chunk)
+            act_sink_put(sink, chunk, (size_t)(text - chunk));
+
+        if (text < end) {
+            sink->escape = true;
+            text++;
+        }
+    }
+}
+
+static void act_sink_write(ActSink* sink, const char* text, size_t length)
+{
+    if (length == 0)
+        return;
+
+    if (sink->capitalize) {
+        sink->capitalize = false;
+        if (*text >= 'a' && *text <= 'z') {
+            char first = UPPER(*text);
+            act_sink_expand(sink, &first, 1);
+            text++;
+            length--;
+        }
+    }
+
+    act_sink_expand(sink, text, length);
+}
+
+typedef struct act_args_t {
+    Mobile* ch;
+    Mobile* vch;
+    Object* obj1;
+    Object* obj2;
+    char* string1;
+    char* string2;
+    Obj* arg2;
+} ActArgs;
+
+static void render_act(const ActTemplate* tmpl, const ActArgs* args,
+    Mobile* to, ActSink* sink)
+{
+    Mobile* ch = args->ch;
+    Mobile* vch = args->vch;
+    char fname[MAX_INPUT_LENGTH];
+
+    // Display "you" forms to victim.
+    int vch_sex = (vch != NULL && to != vch) ? vch->sex : SEX_YOU;
+
+    for (int n = 0; n < tmpl->count; n++) {
+        const ActSegment* seg = &tmpl->segments[n];
+        if (seg->length > 0) {
+            act_sink_write(sink, tmpl->text + seg->start, (size_t)seg->length);
+            continue;
+        }
+
+        const char* i = " <@@@> ";
+        char code = seg->code;
+        if (!args->arg2 && code >= 'A' && code <= 'Z') {
+            bug("Act: missing arg2 for code %d.", code);
+        }
+        else {
+            switch (code) {
+            default:
+                bug("Act: bad code %d.", code);
+                break;
+                /* Thx alex for 't' idea */
+            case 't':
+                i = args->string1;
+                break;
+            case 'T':
+                i = args->string2;
+                break;
+            case 'n':
+                i = PERS(ch, to);
+                break;
+            case 'N':
+                i = PERS(vch, to);
+                break;
+            case 'e':
+                i = sex_table[ch->sex].subj;
+                break;
+            case 'E':
+                i = sex_table[vch_sex].subj;
+                break;
+            case 'm':
+                i = sex_table[ch->sex].obj;
+                break;
+            case 'M':
+                i = sex_table[vch_sex].obj;
+                break;
+            case 's':
+                i = sex_table[ch->sex].poss;
+                break;
+            case 'S':
+                i = sex_table[vch_sex].poss;
+                break;
+
+            case 'p':
+                i = (args->obj1 != NULL && can_see_obj(to, args->obj1))
+                    ? args->obj1->short_descr : "something";
+                break;
+
+            case 'P':
+                i = can_see_obj(to, args->obj2) ? args->obj2->short_descr
+                    : "something";
+                break;
+
+            case 'd':
+                if (args->string2 == NULL || args->string2[0] == '\0') {
+                    i = "door";
+                }
+                else {
+                    one_argument(args->string2, fname);
+                    i = fname;
+                }
+                break;
+            }
+        }
+
+        act_sink_write(sink, i, strlen(i));
+    }
+
+    act_sink_write(sink, "\n\r", 2);
+}
+
+// How many act_pos_new() calls are walking a listener list; triggers fired
+// by one may act() again.
+static int act_depth = 0;
+
+FLAGS act_skip_comm_flags = 0;
+
 void act_pos_new(const char* format, Obj* target, Obj* arg1, Obj* arg2, 
     ActTarget type, Position min_pos)
 {
@@ -2448,10 +2751,6 @@ void act_pos_new(const char* format, Obj* target, Obj* arg1, Obj* arg2,
             string2 = ((String*)arg2)->chars;
     }
 
-    const char* str;
-    const char* i = NULL;
-    char fname[MAX_INPUT_LENGTH] = "";
-
     // Discard null and zero-length messages.
     if (!format || !*format)
         return;
@@ -2475,10 +2774,43 @@ void act_pos_new(const char* format, Obj* target, Obj* arg1, Obj* arg2,
         to_room = ch->in_room;
     }
 
-    FOR_EACH_ROOM_MOB(to, to_room) {
+    ActArgs args = {
+        .ch = ch,
+        .vch = vch,
+        .obj1 = obj1,
+        .obj2 = obj2,
+        .string1 = string1,
+        .string2 = string2,
+        .arg2 = arg2,
+    };
+
+    // Only players and NPCs with act triggers are worth formatting for.
+    List* listeners = get_room_listeners(to_room, act_depth == 0);
+    act_depth++;
+
+    // The skip is for this message only, not for anything its triggers say.
+    FLAGS skip_comm_flags = act_skip_comm_flags;
+    act_skip_comm_flags = 0;
+
+    ActTemplate local = { 0 };
+    ActTemplate* tmpl = get_act_template(format);
+    if (tmpl == NULL) {
+        tmpl = &local;
+        parse_act_template(tmpl, format);
+    }
+    tmpl->pins++;
+
+    StringBuffer* sb = NULL;
+
+    Node* next;
+    for (Node* node = listeners->front; node != NULL; node = next) {
+        next = node->next;
+        to = AS_MOBILE(node->value);
+
         if ((!IS_NPC(to) && to->desc == NULL)
             || (IS_NPC(to) && !HAS_MPROG_TRIGGER(to, TRIG_ACT) && !HAS_EVENT_TRIGGER(to, TRIG_ACT))
-            || to->position < min_pos)
+            || to->position < min_pos
+            || (!IS_NPC(to) && (to->comm_flags & skip_comm_flags)))
             continue;
 
         if ((type == TO_CHAR) && to != ch) 
@@ -2490,151 +2822,56 @@ void act_pos_new(const char* format, Obj* target, Obj* arg1, Obj* arg2,
         if (type == TO_NOTVICT && (to == ch || to == vch)) 
             continue;
 
-        // Display "you" forms to victim.
-        int vch_sex = (vch != NULL && to != vch) ? vch->sex : SEX_YOU;
+        ActSink sink = { .to = to, .capitalize = true };
 
-        // Use StringBuffer for safe, efficient message building
-        StringBuffer* sb = sb_new();
-        str = format;
-        
-        while (*str != '\0') {
-            // Fast path: find next $ or end of string and append chunk at once
-            const char* chunk_start = str;
-            while (*str != '\0' && *str != '$') {
-                str++;
-            }
-            
-            // Append literal text chunk (vectorizable memcpy inside sb_append_n)
-            if (str > chunk_start) {
-                sb_append_n(sb, chunk_start, (size_t)(str - chunk_start));
-            }
-            
-            // If we hit end of string, we're done
-            if (*str == '\0') {
-                break;
-            }
-            
-            // Handle $ code
-            ++str;
-            i = " <@@@> ";
-            if (!arg2 && *str >= 'A' && *str <= 'Z') {
-                bug("Act: missing arg2 for code %d.", *str);
-                i = " <@@@> ";
-            }
-            else {
-                switch (*str) {
-                default:
-                    bug("Act: bad code %d.", *str);
-                    i = " <@@@> ";
-                    break;
-                    /* Thx alex for 't' idea */
-                case 't':
-                    i = string1;
-                    break;
-                case 'T':
-                    i = string2;
-                    break;
-                case 'n':
-                    i = PERS(ch, to);
-                    break;
-                case 'N':
-                    i = PERS(vch, to);
-                    break;
-                case 'e':
-                    i = sex_table[ch->sex].subj;
-                    break;
-                case 'E':
-                    i = sex_table[vch_sex].subj;
-                    break;
-                case 'm':
-                    i = sex_table[ch->sex].obj;
-                    break;
-                case 'M':
-                    i = sex_table[vch_sex].obj;
-                    break;
-                case 's':
-                    i = sex_table[ch->sex].poss;
-                    break;
-                case 'S':
-                    i = sex_table[vch_sex].poss;
-                    break;
-
-                case 'p':
-                    i = (obj1 != NULL && can_see_obj(to, obj1)) ? obj1->short_descr : "something";
-                    break;
+        if (!test_act_output_enabled && to->desc != NULL
+            && !test_socket_output_enabled && !test_output_enabled) {
+            // The usual case: render straight into the output buffer.
+            sink.d = to->desc;
+            sink.expand = true;
+            sink.colour = IS_SET(to->act_flags, PLR_COLOUR);
+            render_act(tmpl, &args, to, &sink);
+            continue;
+        }
 
-                case 'P':
-                    i = can_see_obj(to, obj2) ? obj2->short_descr : "something";
-                    break;
+        if (!test_act_output_enabled && to->desc == NULL && !events_enabled)
+            continue;
 
-                case 'd':
-                    if (string2 == NULL || string2[0] == '\0') {
-                        i = "door";
-                    }
-                    else {
-                        one_argument(string2, fname);
-                        i = fname;
-                    }
-                    break;
-                }
-            }
+        if (sb == NULL)
+            sb = sb_new();
+        else
+            sb_clear(sb);
+        sink.sb = sb;
 
-            ++str;
-            sb_append(sb, i);
+        if (test_act_output_enabled) {
+            render_act(tmpl, &args, to, &sink);
+            lox_printf("%s", sb_string(sb));
         }
-
-        // Add newline and capitalize first character
-        sb_append(sb, "\n\r");
-        
-        // Get final string and capitalize first char
-        char* message = (char*)sb_string(sb);  // Cast away const for legacy API
-        size_t msg_len = sb_length(sb);
-        
-        if (msg_len > 0 && message[0] >= 'a' && message[0] <= 'z') {
-            // Create capitalized version - need mutable copy
-            char* cap_msg = alloc_mem(msg_len + 1);
-            memcpy(cap_msg, message, msg_len + 1);
-            cap_msg[0] = UPPER(cap_msg[0]);
-            
-            if (test_act_output_enabled) {
-                lox_printf("%s", cap_msg);
-            }
-            else if (to->desc != NULL) {
-                char* colorbuf = alloc_mem(msg_len * 2 + 1);  // Color codes can expand
-                colourconv(colorbuf, cap_msg, to);
-                write_to_buffer(to->desc, colorbuf, 0);
-                free_mem(colorbuf, msg_len * 2 + 1);
-            }
-            else if (events_enabled) {
-                if (HAS_EVENT_TRIGGER(to, TRIG_ACT))
-                    raise_act_event((Entity*)to, TRIG_ACT, (Entity*)ch, cap_msg);
-                if (HAS_MPROG_TRIGGER(to, TRIG_ACT)) 
-                    mp_act_trigger(cap_msg, to, ch, arg1, arg2, TRIG_ACT);
-            }
-            
-            free_mem(cap_msg, msg_len + 1);
+        else if (to->desc != NULL) {
+            sink.expand = true;
+            sink.colour = IS_SET(to->act_flags, PLR_COLOUR);
+            render_act(tmpl, &args, to, &sink);
+            write_to_buffer(to->desc, sb_string(sb), sb_length(sb));
         }
         else {
-            // No capitalization needed or empty message
-            if (test_act_output_enabled) {
-                lox_printf("%s", message);
-            }
-            else if (to->desc != NULL) {
-                char* colorbuf = alloc_mem(msg_len * 2 + 1);
-                colourconv(colorbuf, message, to);
-                write_to_buffer(to->desc, colorbuf, 0);
-                free_mem(colorbuf, msg_len * 2 + 1);
-            }
-            else if (events_enabled) {
-                if (HAS_EVENT_TRIGGER(to, TRIG_ACT))
-                    raise_act_event((Entity*)to, TRIG_ACT, (Entity*)ch, message);
-                if (HAS_MPROG_TRIGGER(to, TRIG_ACT)) 
-                    mp_act_trigger(message, to, ch, arg1, arg2, TRIG_ACT);
-            }
+            render_act(tmpl, &args, to, &sink);
+            char* message = (char*)sb_string(sb);  // Cast away const for legacy API
+            if (HAS_EVENT_TRIGGER(to, TRIG_ACT))
+                raise_act_event((Entity*)to, TRIG_ACT, (Entity*)ch, message);
+            if (HAS_MPROG_TRIGGER(to, TRIG_ACT)) 
+                mp_act_trigger(message, to, ch, arg1, arg2, TRIG_ACT);
         }
-        
-        sb_free(sb);
     }
+
+    if (sb != NULL)
+        sb_free(sb);
+
+    tmpl->pins--;
+    if (tmpl == &local)
+        free_act_template(tmpl);
+
+    act_skip_comm_flags = skip_comm_flags;
+    act_depth--;
 }
 
 size_t colour(char type, Mobile * ch, char* string, size_t string_size)
@@ -2753,10 +2990,9 @@ int colourconv(char* buffer, const char* txt, Mobile * ch)
                 
                 if (*point == COLOR_ESC_CHAR) {
                     point++;
-                    continue;
+                    if (*point != '\0')
+                        point++;
                 }
-                *buffer = *point;
-                *++buffer = '\0';
             }
             *buffer = '\0';
         }
@@ -53,7 +53,7 @@ typedef enum comm_flags_t {
     COMM_TELNET_GA          = BIT(15),
     COMM_SHOW_AFFECTS       = BIT(16),
     COMM_NOGRATS            = BIT(17),
-    // Unused                 BIT(18)
+    COMM_COMBAT_BRIEF       = BIT(18),
 
 // Penalties
     COMM_NOEMOTE            = BIT(19),
@@ -132,6 +132,10 @@ act_pos_new((format), LOX_OBJ_CAST(target), LOX_OBJ_CAST(arg1), LOX_OBJ_CAST(arg
 void act_pos_new(const char* format, Obj* target, Obj* arg1, Obj* arg2,
     ActTarget type, Position min_pos);
 
+// Players with any of these comm flags are left out of act(). Triggers fired by
+// that act() run without it; set it around your own calls and restore it.
+extern FLAGS act_skip_comm_flags;
+
 void printf_to_char(Mobile*, const char*, ...);
 void bugf(char*, ...);
 void printf_log(char*, ...);
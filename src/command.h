@@ -47,6 +47,7 @@ COMMAND(do_clone)
 COMMAND(do_close)
 COMMAND(do_colour)
 COMMAND(do_commands)
+COMMAND(do_combatbrief)
 COMMAND(do_combine)
 COMMAND(do_compact)
 COMMAND(do_compare)
@@ -153,6 +154,7 @@ COMMAND(do_pecho)
 COMMAND(do_penalty)
 COMMAND(do_permban)
 COMMAND(do_pick)
+COMMAND(do_pindex)
 COMMAND(do_play)
 COMMAND(do_pmote)
 COMMAND(do_pose)
@@ -233,6 +235,7 @@ COMMAND(do_tell)
 COMMAND(do_theme)
 COMMAND(do_time)
 COMMAND(do_title)
+COMMAND(do_track)
 COMMAND(do_train)
 COMMAND(do_transfer)
 COMMAND(do_trip)
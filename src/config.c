@@ -170,6 +170,12 @@
 #define DEFAULT_CHANGES_FILE        "change.not"
 #define DEFAULT_SHUTDOWN_FILE       "shutdown.txt"
 #define DEFAULT_BAN_FILE            "ban.txt"
+#define DEFAULT_AREA_CACHE          false
+#define DEFAULT_AREA_CACHE_VERIFY   false
+#define DEFAULT_AREA_CACHE_DIR      "cache/"
+#define DEFAULT_LOX_CACHE           false
+#define DEFAULT_LOX_CACHE_VERIFY    false
+#define DEFAULT_LOX_CACHE_DIR       "cache/"
 
 // Data Files
 #define DEFAULT_DEFAULT_FORMAT      "json"
@@ -186,6 +192,7 @@
 #define DEFAULT_CLASSES_FILE        "classes.olc"
 #define DEFAULT_TUTORIALS_FILE      "tutorials.olc"
 #define DEFAULT_LOOT_FILE           "loot.olc"
+#define DEFAULT_LOX_BUDGET_FILE     "lox_budgets.txt"
 
 // Temp Files
 #define DEFAULT_TEMP_DIR            "temp/"
@@ -196,6 +203,12 @@
 // Other Top-Level Dirs
 #define DEFAULT_PLAYER_DIR          "player/"
 #define DEFAULT_GODS_DIR            "gods/"
+#define DEFAULT_PLAYER_INDEX_FILE   "players.idx"
+
+// Lox VM
+#define DEFAULT_GC_SLICE_USEC       1000
+#define DEFAULT_LOX_BUDGET          10000000
+#define DEFAULT_LOX_PROFILE_TIME    false
 
 // Gameplay Defaults
 #define DEFAULT_CHARGEN_CUSTOM      true
@@ -248,6 +261,7 @@ DEFINE_DIR_CONFIG(base_dir,         DEFAULT_BASE_DIR)
 DEFINE_STR_CONFIG(config_file,      DEFAULT_CONFIG_FILE)
 DEFINE_DIR_CONFIG(player_dir,       DEFAULT_PLAYER_DIR)
 DEFINE_DIR_CONFIG(gods_dir,         DEFAULT_GODS_DIR)
+DEFINE_STR_CONFIG(player_index_file, DEFAULT_PLAYER_INDEX_FILE)
 DEFINE_DIR_CONFIG(area_dir,         DEFAULT_AREA_DIR)
 DEFINE_FILE_CONFIG(area_list,       area_dir,   DEFAULT_AREA_LIST)
 DEFINE_FILE_CONFIG(music_file,      area_dir,   DEFAULT_MUSIC_FILE)
@@ -260,6 +274,12 @@ DEFINE_LOG_CONFIG(news_file,        area_dir,   DEFAULT_NEWS_FILE)
 DEFINE_LOG_CONFIG(changes_file,     area_dir,   DEFAULT_CHANGES_FILE)
 DEFINE_LOG_CONFIG(shutdown_file,    area_dir,   DEFAULT_SHUTDOWN_FILE)
 DEFINE_FILE_CONFIG(ban_file,        area_dir,   DEFAULT_BAN_FILE)
+DEFINE_CONFIG(area_cache,           bool,       DEFAULT_AREA_CACHE)
+DEFINE_CONFIG(area_cache_verify,    bool,       DEFAULT_AREA_CACHE_VERIFY)
+DEFINE_DIR_CONFIG(area_cache_dir,   DEFAULT_AREA_CACHE_DIR)
+DEFINE_CONFIG(lox_cache,            bool,       DEFAULT_LOX_CACHE)
+DEFINE_CONFIG(lox_cache_verify,     bool,       DEFAULT_LOX_CACHE_VERIFY)
+DEFINE_DIR_CONFIG(lox_cache_dir,    DEFAULT_LOX_CACHE_DIR)
 DEFINE_DIR_CONFIG(data_dir,         DEFAULT_DATA_DIR)
 DEFINE_DIR_CONFIG(progs_dir,        DEFAULT_PROGS_DIR)
 DEFINE_DIR_CONFIG(scripts_dir,      DEFAULT_SCRIPTS_DIR)
@@ -273,12 +293,18 @@ DEFINE_FILE_CONFIG(races_file,      data_dir,   DEFAULT_RACES_FILE)
 DEFINE_FILE_CONFIG(classes_file,    data_dir,   DEFAULT_CLASSES_FILE)
 DEFINE_FILE_CONFIG(tutorials_file,  data_dir,   DEFAULT_TUTORIALS_FILE)
 DEFINE_FILE_CONFIG(loot_file,       data_dir,   DEFAULT_LOOT_FILE)
+DEFINE_FILE_CONFIG(lox_budget_file, data_dir,   DEFAULT_LOX_BUDGET_FILE)
 
 DEFINE_DIR_CONFIG(temp_dir,         DEFAULT_TEMP_DIR)
 DEFINE_FILE_CONFIG(mem_dump_file,   temp_dir,   DEFAULT_MEM_DUMP_FILE)
 DEFINE_FILE_CONFIG(mob_dump_file,   temp_dir,   DEFAULT_MOB_DUMP_FILE)
 DEFINE_FILE_CONFIG(obj_dump_file,   temp_dir,   DEFAULT_OBJ_DUMP_FILE)
 
+// Lox VM Configs
+DEFINE_CONFIG(gc_slice_usec,        int,        DEFAULT_GC_SLICE_USEC)
+DEFINE_CONFIG(lox_budget,           int,        DEFAULT_LOX_BUDGET)
+DEFINE_CONFIG(lox_profile_time,     bool,       DEFAULT_LOX_PROFILE_TIME)
+
 // Gameplay Configs
 DEFINE_CONFIG(chargen_custom,       bool,       DEFAULT_CHARGEN_CUSTOM)
 DEFINE_CONFIG(default_recall,       int,        DEFAULT_RECALL)
@@ -366,6 +392,12 @@ const ConfigEntry config_entries[] = {
     { "changes_file",       CFG_STR,    U(cfg_set_changes_file)         },
     { "shutdown_file",      CFG_STR,    U(cfg_set_shutdown_file)        },
     { "ban_file",           CFG_STR,    U(cfg_set_ban_file)             },
+    { "area_cache",         CFG_BOOL,   U(cfg_set_area_cache)           },
+    { "area_cache_verify",  CFG_BOOL,   U(cfg_set_area_cache_verify)    },
+    { "area_cache_dir",     CFG_DIR,    U(cfg_set_area_cache_dir)       },
+    { "lox_cache",          CFG_BOOL,   U(cfg_set_lox_cache)            },
+    { "lox_cache_verify",   CFG_BOOL,   U(cfg_set_lox_cache_verify)     },
+    { "lox_cache_dir",      CFG_DIR,    U(cfg_set_lox_cache_dir)        },
     { "data_dir",           CFG_DIR,    U(cfg_set_data_dir)             },
     { "progs_dir",          CFG_DIR,    U(cfg_set_progs_dir)            },
     { "scripts_dir",        CFG_DIR,    U(cfg_set_scripts_dir)          },
@@ -379,12 +411,19 @@ const ConfigEntry config_entries[] = {
     { "classes_file",       CFG_STR,    U(cfg_set_classes_file)         },
     { "tutorials_file",     CFG_STR,    U(cfg_set_tutorials_file)       },
     { "loot_file",          CFG_STR,    U(cfg_set_loot_file)            },
+    { "lox_budget_file",    CFG_STR,    U(cfg_set_lox_budget_file)      },
     { "temp_dir",           CFG_DIR,    U(cfg_set_temp_dir)             },
     { "mem_dump_file",      CFG_STR,    U(cfg_set_mem_dump_file)        },
     { "mob_dump_file",      CFG_STR,    U(cfg_set_mob_dump_file)        },
     { "obj_dump_file",      CFG_STR,    U(cfg_set_obj_dump_file)        },
     { "player_dir",         CFG_DIR,    U(cfg_set_player_dir)           },
     { "gods_dir",           CFG_DIR,    U(cfg_set_gods_dir)             },
+    { "player_index_file",  CFG_STR,    U(cfg_set_player_index_file)    },
+
+    // Lox VM
+    { "gc_slice_usec",      CFG_INT,    U(cfg_set_gc_slice_usec)        },
+    { "lox_budget",         CFG_INT,    U(cfg_set_lox_budget)           },
+    { "lox_profile_time",   CFG_BOOL,   U(cfg_set_lox_profile_time)     },
 
     // Gameplay
     { "chargen_custom",     CFG_BOOL,   U(cfg_set_chargen_custom)       },
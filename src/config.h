@@ -81,8 +81,15 @@ DECLARE_STR_CONFIG(subgenre)
 DECLARE_STR_CONFIG(default_format)
 DECLARE_STR_CONFIG(base_dir)
 DECLARE_STR_CONFIG(area_dir)
+DECLARE_CONFIG(area_cache, bool)
+DECLARE_CONFIG(area_cache_verify, bool)
+DECLARE_STR_CONFIG(area_cache_dir)
+DECLARE_CONFIG(lox_cache, bool)
+DECLARE_CONFIG(lox_cache_verify, bool)
+DECLARE_STR_CONFIG(lox_cache_dir)
 DECLARE_STR_CONFIG(player_dir)
 DECLARE_STR_CONFIG(gods_dir)
+DECLARE_STR_CONFIG(player_index_file)
 DECLARE_STR_CONFIG(temp_dir)
 DECLARE_STR_CONFIG(data_dir)
 DECLARE_STR_CONFIG(progs_dir)
@@ -97,6 +104,7 @@ DECLARE_FILE_CONFIG(races_file)
 DECLARE_FILE_CONFIG(classes_file)
 DECLARE_FILE_CONFIG(tutorials_file)
 DECLARE_FILE_CONFIG(loot_file)
+DECLARE_FILE_CONFIG(lox_budget_file)
 DECLARE_FILE_CONFIG(area_list)
 DECLARE_FILE_CONFIG(music_file)
 DECLARE_LOG_CONFIG(bug_file)
@@ -112,6 +120,11 @@ DECLARE_FILE_CONFIG(mem_dump_file)
 DECLARE_FILE_CONFIG(mob_dump_file)
 DECLARE_FILE_CONFIG(obj_dump_file)
 
+// Lox VM configs
+DECLARE_CONFIG(gc_slice_usec, int)
+DECLARE_CONFIG(lox_budget, int)
+DECLARE_CONFIG(lox_profile_time, bool)
+
 // Game configs
 DECLARE_CONFIG(chargen_custom, bool)
 DECLARE_CONFIG(default_recall, int)
@@ -74,6 +74,7 @@ EventTrigger get_event_type_info_by_name(const char* name);
 
 extern const EventTypeInfo event_type_info_table[];
 
+// Keep this the highest trigger bit; EVENT_TRIG_SLOTS is checked against it.
 #define LAST_TRIG TRIG_PRDSTOP
 
 #endif // !MUD98__DATA__EVENTS_H
@@ -40,9 +40,11 @@
 #include "handler.h"
 #include "lookup.h"
 #include "magic.h"
+#include "mob_prog.h"
 #include "music.h"
 #include "note.h"
 #include "pcg_basic.h"
+#include "player_index.h"
 #include "recycle.h"
 #include "skills.h"
 #include "special.h"
@@ -50,8 +52,10 @@
 #include "tables.h"
 #include "weather.h"
 
+#include <persist/area/area_cache.h>
 #include <persist/area/area_persist.h>
 #include <persist/command/command_persist.h>
+#include <persist/lox/lox_cache.h>
 #include <persist/persist_io_adapters.h>
 #ifdef ENABLE_ROM_OLC_PERSISTENCE
 #include <persist/rom-olc/loader_guard.h>
@@ -94,6 +98,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -193,6 +198,8 @@ const size_t rgSizeList[MAX_MEM_LIST] = {
 
 int nAllocString;
 size_t sAllocString;
+int nFoldedString;      // Loaded strings that matched one already in string_space
+size_t sFoldedString;
 int nAllocPerm;
 size_t sAllocPerm;
 
@@ -244,10 +251,12 @@ void boot_db()
 
     init_const_natives();
     load_lox_public_scripts();
+    load_class_budgets();
 
     load_class_table();
     load_skill_table();
     load_race_table();
+    invalidate_derived_stats();
     load_command_table();
     load_tutorials();
     load_global_loot_db();
@@ -297,7 +306,7 @@ void boot_db()
                 .create_single_instance = true,
             };
 
-            PersistResult load_result = fmt->load(&params);
+            PersistResult load_result = area_cache_load(fmt, &params);
             close_file(strArea);
             strArea = NULL;
 
@@ -309,6 +318,8 @@ void boot_db()
             gc_protect_clear();
         }
         close_file(fpList);
+        area_cache_log_stats();
+        lox_cache_log_stats();
     }
 
     init_world_natives();
@@ -317,7 +328,7 @@ void boot_db()
      * Fix up exits.
      * Declare db booting over.
      * Reset all areas once.
-     * Load up the songs, notes and ban files.
+     * Load up the songs, notes, ban files and the player index.
      */
     {
         fix_exits();
@@ -329,6 +340,7 @@ void boot_db()
         load_notes();
         load_bans();
         load_songs();
+        load_player_index();
     }
 
     init_mth();
@@ -751,8 +763,10 @@ void fix_mobprogs()
 
     FOR_EACH_MOB_PROTO(p_mob_proto) {
         FOR_EACH(list, p_mob_proto->mprogs) {
-            if ((prog = pedit_prog(list->vnum)) != NULL)
+            if ((prog = pedit_prog(list->vnum)) != NULL) {
                 list->code = prog->code;
+                recompile_mob_prog(list);
+            }
             else {
                 bug("Fix_mobprogs: code vnum %"PRVNUM" not found.", list->vnum);
                 exit(1);
@@ -919,6 +933,18 @@ String* fread_lox_string(FILE* fp)
     return copy_string(str, len);
 }
 
+static char* find_perm_string(const char* text, uint32_t hash)
+{
+    int bucket = (int)(hash % MAX_KEY_HASH);
+
+    for (StringBlock* block = string_hash[bucket]; block != NULL; block = block->next) {
+        if (block->hash == hash && strcmp(string_block_text(block), text) == 0)
+            return string_block_text(block);
+    }
+
+    return NULL;
+}
+
 static char* intern_string(char* plast)
 {
     plast[-1] = '\0';
@@ -929,9 +955,11 @@ static char* intern_string(char* plast)
     uint32_t hash = boot_hash_string(text, len);
     int bucket = (int)(hash % MAX_KEY_HASH);
 
-    for (StringBlock* block = string_hash[bucket]; block != NULL; block = block->next) {
-        if (block->hash == hash && strcmp(string_block_text(block), text) == 0)
-            return string_block_text(block);
+    char* found = find_perm_string(text, hash);
+    if (found != NULL) {
+        nFoldedString += 1;
+        sFoldedString += len + 1;
+        return found;
     }
 
     if (!fBootDb)
@@ -1673,9 +1701,83 @@ void* alloc_perm(size_t sMem)
     return pMem;
 }
 
+/*
+ * Shared strings.
+ * Everything str_dup() hands out is either a perm string from string_space or
+ * a reference-counted entry in this table, so identical text (keywords,
+ * short_descrs, OLC copies of prototype text) is stored once. The header sits
+ * directly in front of the text; its last member is a magic number that lets
+ * free_string() tell a shared string from a plain alloc_mem() block.
+ */
+#define SHARED_STRING_MAGIC     0x51a4ed57
+#define SHARED_HASH_MIN         1024
+
+typedef struct shared_string_t {
+    struct shared_string_t* next;
+    uint32_t hash;
+    uint32_t len;
+    int refs;
+    int magic;
+} SharedString;
+
+static_assert(offsetof(SharedString, magic) + sizeof(int) == sizeof(SharedString),
+    "SharedString.magic must immediately precede the text");
+
+static SharedString** shared_hash = NULL;
+static size_t shared_hash_size = 0;
+
+int nSharedString;      // Distinct shared strings
+size_t sSharedString;   // Bytes of text they hold
+int nSharedRefs;        // Outstanding str_dup() references to them
+size_t sSharedSaved;    // Bytes that separate copies would have needed
+
+static inline char* shared_string_text(SharedString* ss)
+{
+    return (char*)(ss + 1);
+}
+
+static inline SharedString* shared_string_of(const char* str)
+{
+    return (SharedString*)str - 1;
+}
+
+static bool is_shared_string(const char* str)
+{
+    return ((const int*)str)[-1] == SHARED_STRING_MAGIC;
+}
+
+static void grow_shared_hash()
+{
+    size_t new_size = shared_hash_size ? shared_hash_size * 2 : SHARED_HASH_MIN;
+    SharedString** new_hash = calloc(new_size, sizeof(SharedString*));
+    if (new_hash == NULL) {
+        // Keep using the current (overloaded) table.
+        if (shared_hash != NULL)
+            return;
+        bug("Grow_shared_hash: can't alloc %zu buckets.", new_size);
+        exit(1);
+    }
+
+    for (size_t i = 0; i < shared_hash_size; i++) {
+        SharedString* ss = shared_hash[i];
+        while (ss != NULL) {
+            SharedString* next = ss->next;
+            size_t bucket = ss->hash & (new_size - 1);
+            ss->next = new_hash[bucket];
+            new_hash[bucket] = ss;
+            ss = next;
+        }
+    }
+
+    free(shared_hash);
+    shared_hash = new_hash;
+    shared_hash_size = new_size;
+}
+
 /*
  * Duplicate a string into dynamic memory.
- * Fread_strings are read-only and shared.
+ * Fread_strings are read-only and shared, and so is everything returned here:
+ * never write through the result; free_string() it and str_dup() a new one.
  */
 char* str_dup(const char* str)
 {
@@ -1686,15 +1788,65 @@ char* str_dup(const char* str)
         return (char*)str;
 
     size_t len = strlen(str);
-    char* str_new = alloc_mem(len + 1);
-    strcpy(str_new, str);
+    uint32_t hash = boot_hash_string(str, len);
+
+    char* perm = find_perm_string(str, hash);
+    if (perm != NULL)
+        return perm;
+
+    if ((size_t)nSharedString >= shared_hash_size)
+        grow_shared_hash();
+
+    size_t bucket = hash & (shared_hash_size - 1);
+    for (SharedString* ss = shared_hash[bucket]; ss != NULL; ss = ss->next) {
+        if (ss->hash == hash && ss->len == len
+            && memcmp(shared_string_text(ss), str, len) == 0) {
+            ss->refs++;
+            nSharedRefs++;
+            sSharedSaved += len + 1;
+            return shared_string_text(ss);
+        }
+    }
+
+    SharedString* ss = alloc_mem(sizeof(SharedString) + len + 1);
+    ss->hash = hash;
+    ss->len = (uint32_t)len;
+    ss->refs = 1;
+    ss->magic = SHARED_STRING_MAGIC;
+    ss->next = shared_hash[bucket];
+    shared_hash[bucket] = ss;
+    memcpy(shared_string_text(ss), str, len + 1);
+
+    nSharedString++;
+    sSharedString += len + 1;
+    nSharedRefs++;
 
 #ifdef COUNT_BOOT_STRINGS
     if (fBootDb)
-        record_boot_string_stat(str_new, len);
+        record_boot_string_stat(shared_string_text(ss), len);
 #endif
 
-    return str_new;
+    return shared_string_text(ss);
+}
+
+static void release_shared_string(SharedString* ss)
+{
+    nSharedRefs--;
+
+    if (--ss->refs > 0) {
+        sSharedSaved -= ss->len + 1;
+        return;
+    }
+
+    SharedString** link = &shared_hash[ss->hash & (shared_hash_size - 1)];
+    while (*link != ss)
+        link = &(*link)->next;
+    *link = ss->next;
+
+    nSharedString--;
+    sSharedString -= ss->len + 1;
+    ss->magic = 0;
+    free_mem(ss, sizeof(SharedString) + ss->len + 1);
 }
 
 char* str_append(char* str1, const char* str2)
@@ -1720,6 +1872,11 @@ void free_string(const char* pstr)
         || (pstr >= string_space && pstr < top_string))
         return;
 
+    if (is_shared_string(pstr)) {
+        release_shared_string(shared_string_of(pstr));
+        return;
+    }
+
     free_mem((void*)pstr, strlen(pstr) + 1);
     return;
 }
@@ -1773,10 +1930,27 @@ static void memory_to_buffer(Buffer* buf)
     addf_buf(buf, "Socials      %7d                 %7d\n\r", social_count, social_count * sizeof(Social));
     addf_buf(buf, "Quests       %7d     %7d     %7d\n\r", quest_perm_count, quest_count, quest_perm_count * sizeof(Quest));
     addf_buf(buf, "Events       %7d     %7d     %7d\n\r", event_perm_count, event_count, event_perm_count * sizeof(Event));
+    addf_buf(buf, "Timers       %7d     %7d     %7d\n\r", event_timer_perm_count, event_timer_count, event_timer_perm_count * sizeof(EventTimer));
+    const EventTimerStats* timers = event_timer_stats();
+    addf_buf(buf, "- Pulse  %5d pending (peak %d), %d fired, %d cancelled; %" PRIu64
+        " fired in all.\n\r", timers->pending, timers->peak_pending, timers->fired,
+        timers->cancelled, timers->total_fired);
     addf_buf(buf, "Lox VM                             %9d\n\r", vm.bytes_allocated);
+    addf_buf(buf, "- GC     %5" PRIu64 " cycles (%" PRIu64 " full), max pause %" PRIu64
+        " us, avg %" PRIu64 " us.\n\r", gc_stats.cycles, gc_stats.full_collections,
+        gc_stats.max_pause_usec,
+        gc_stats.steps ? gc_stats.total_pause_usec / gc_stats.steps : 0);
+    addf_buf(buf, "- Last   %5d slices, %" PRIu64 " us (max %" PRIu64 " us), freed %zu "
+        "objects (%zu bytes).\n\r", gc_stats.last_steps, gc_stats.last_pause_usec,
+        gc_stats.last_max_pause_usec, gc_stats.last_freed_objects,
+        gc_stats.last_freed_bytes);
 
     addf_buf(buf, "Strings %5d strings of %zu bytes (max %d).\n\r", nAllocString,
         sAllocString, MAX_STRING);
+    addf_buf(buf, "- Folded %5d duplicate loads     (%zu bytes saved).\n\r",
+        nFoldedString, sFoldedString);
+    addf_buf(buf, "- Shared %5d strings of %zu bytes, %d refs (%zu bytes saved).\n\r",
+        nSharedString, sSharedString, nSharedRefs, sSharedSaved);
 
     addf_buf(buf, "Perms   %5d blocks  of %zu bytes.\n\r", nAllocPerm,
         sAllocPerm);
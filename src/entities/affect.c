@@ -14,10 +14,49 @@
 #include <db.h>
 #include <handler.h>
 
+#include <string.h>
+
 Affect* affect_free;
 int affect_count;
 int affect_perm_count;
 
+static inline bool has_skill_bit(Mobile* ch, SKNUM sn)
+{
+    return (ch->affect_skills[sn / 64] & (1ULL << (sn % 64))) != 0;
+}
+
+static inline void set_skill_bit(Mobile* ch, SKNUM sn)
+{
+    if (sn >= 0 && sn < AFFECT_SKILL_BITS)
+        ch->affect_skills[sn / 64] |= 1ULL << (sn % 64);
+}
+
+// Clears sn's bit unless another affect of that type is still on ch.
+static void unset_skill_bit(Mobile* ch, SKNUM sn)
+{
+    Affect* affect;
+
+    if (sn < 0 || sn >= AFFECT_SKILL_BITS || !has_skill_bit(ch, sn))
+        return;
+
+    FOR_EACH(affect, ch->affected)
+        if (affect->type == sn)
+            return;
+
+    ch->affect_skills[sn / 64] &= ~(1ULL << (sn % 64));
+}
+
+// For loaders that link affects straight into ch->affected.
+void rebuild_affect_index(Mobile* ch)
+{
+    Affect* affect;
+
+    memset(ch->affect_skills, 0, sizeof(ch->affect_skills));
+
+    FOR_EACH(affect, ch->affected)
+        set_skill_bit(ch, affect->type);
+}
+
 Affect* new_affect()
 {
     LIST_ALLOC_PERM(affect, Affect);
@@ -199,6 +238,11 @@ void affect_join(Mobile* ch, Affect* affect)
 {
     Affect* paf_old;
 
+    if (!is_affected(ch, affect->type)) {
+        affect_to_mob(ch, affect);
+        return;
+    }
+
     FOR_EACH(paf_old, ch->affected) {
         if (paf_old->type == affect->type) {
             //affect->level = (affect->level += paf_old->level) / 2;
@@ -468,6 +512,7 @@ void affect_remove(Mobile* ch, Affect* affect)
         }
     }
 
+    unset_skill_bit(ch, affect->type);
     free_affect(affect);
 
     affect_check(ch, where, vector);
@@ -534,6 +579,9 @@ void affect_strip(Mobile* ch, SKNUM sn)
     Affect* affect;
     Affect* paf_next = NULL;
 
+    if (!is_affected(ch, sn))
+        return;
+
     for (affect = ch->affected; affect != NULL; affect = paf_next) {
         paf_next = affect->next;
         if (affect->type == sn) 
@@ -552,6 +600,7 @@ void affect_to_mob(Mobile* ch, Affect* affect)
 
     paf_new->next = ch->affected;
     ch->affected = paf_new;
+    set_skill_bit(ch, paf_new->type);
 
     affect_modify(ch, paf_new, true);
     return;
@@ -580,6 +629,9 @@ bool is_affected(Mobile* ch, SKNUM sn)
 {
     Affect* affect;
 
+    if (sn >= 0 && sn < AFFECT_SKILL_BITS)
+        return has_skill_bit(ch, sn);
+
     FOR_EACH(affect, ch->affected) {
         if (affect->type == sn) 
             return true;
@@ -116,6 +116,7 @@ void affect_to_obj(Object* obj, Affect* affect);
 void free_affect(Affect* af);
 bool is_affected(Mobile* ch, SKNUM sn);
 Affect* new_affect();
+void rebuild_affect_index(Mobile* ch);
 
 #define ADD_AFFECT(t, aff)                                                   \
     if (!t->affected) {                                                        \
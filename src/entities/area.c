@@ -35,7 +35,6 @@ Area* new_area(AreaData* area_data)
     init_header(&area->header, OBJ_AREA);
 
     init_table(&area->rooms);
-    SET_LOX_FIELD(&area->header, &area->rooms, rooms);
 
     SET_NAME(area, NAME_FIELD(area_data));
     VNUM_FIELD(area) = VNUM_FIELD(area_data);
@@ -75,7 +74,6 @@ AreaData* new_area_data()
     init_header(&area_data->header, OBJ_AREA_DATA);
 
     init_list(&area_data->instances);
-    SET_LOX_FIELD(&area_data->header, &area_data->instances, instances);
 
     VNUM_FIELD(area_data) = global_areas.count;
     const char* def_fmt = cfg_get_default_format();
@@ -185,7 +183,7 @@ Area* get_area_for_player(Mobile* ch, AreaData* area_data)
 #define KEYLS(literal, entity, field, value)                                   \
     if (!str_cmp(word, literal)) {                                             \
         (entity)->header.field = (value);                                      \
-        SET_LOX_FIELD(&((entity)->header), (entity)->header.field, field);     \
+        GC_BARRIER_OBJ((entity)->header.field);                                \
         break;                                                                 \
     }
 
@@ -4,11 +4,217 @@
 
 #include "entity.h"
 
+#include "area.h"
+#include "faction.h"
+#include "mobile.h"
+#include "object.h"
+#include "room.h"
+
 #include <db.h>
+#include <handler.h>
 
 #include <lox/list.h>
 #include <lox/vm.h>
 
+#include <persist/lox/lox_cache.h>
+
+#include <string.h>
+
+#define FIELD(name, type, T, member)    { name, type, offsetof(T, member), NULL }
+#define END_FIELDS                      { NULL, 0, 0, NULL }
+
+// Every entity has these.
+static EntityField header_fields[] = {
+    FIELD("name",           FIELD_NAME,     Entity,     name),
+    FIELD("vnum",           FIELD_I32,      Entity,     vnum),
+    END_FIELDS
+};
+
+static EntityField area_fields[] = {
+    FIELD("rooms",          FIELD_EMBEDDED, Area,       rooms),
+    END_FIELDS
+};
+
+static EntityField area_data_fields[] = {
+    FIELD("instances",      FIELD_EMBEDDED, AreaData,   instances),
+    END_FIELDS
+};
+
+static EntityField room_fields[] = {
+    FIELD("mobiles",        FIELD_EMBEDDED, Room,       mobiles),
+    FIELD("objects",        FIELD_EMBEDDED, Room,       objects),
+    FIELD("area",           FIELD_ENTITY,   Room,       area),
+    END_FIELDS
+};
+
+static EntityField room_data_fields[] = {
+    FIELD("instances",      FIELD_EMBEDDED, RoomData,   instances),
+    END_FIELDS
+};
+
+static EntityField obj_fields[] = {
+    FIELD("short_desc",     FIELD_STR,      Object,     short_descr),
+    FIELD("in_room",        FIELD_ENTITY,   Object,     in_room),
+    END_FIELDS
+};
+
+static EntityField mob_fields[] = {
+    FIELD("short_desc",     FIELD_STR,      Mobile,     short_descr),
+    FIELD("hp",             FIELD_I16,      Mobile,     hit),
+    FIELD("max_hp",         FIELD_I16,      Mobile,     max_hit),
+    FIELD("race",           FIELD_I16,      Mobile,     race),
+    FIELD("level",          FIELD_I16,      Mobile,     level),
+    FIELD("faction",        FIELD_I32,      Mobile,     faction_vnum),
+    FIELD("in_room",        FIELD_ENTITY,   Mobile,     in_room),
+    FIELD("was_in_room",    FIELD_ENTITY,   Mobile,     was_in_room),
+    END_FIELDS
+};
+
+static EntityField faction_fields[] = {
+    FIELD("area",           FIELD_ENTITY,   Faction,    area),
+    FIELD("allies",         FIELD_EMBEDDED, Faction,    allies),
+    FIELD("enemies",        FIELD_EMBEDDED, Faction,    enemies),
+    END_FIELDS
+};
+
+#define SHAPE_COUNT     (OBJ_QUEST - OBJ_AREA + 1)
+
+// Type-specific fields, indexed by ObjType - OBJ_AREA. Types without any
+// only have the header fields.
+static EntityField* shapes[SHAPE_COUNT] = {
+    [OBJ_AREA - OBJ_AREA]       = area_fields,
+    [OBJ_AREA_DATA - OBJ_AREA]  = area_data_fields,
+    [OBJ_ROOM - OBJ_AREA]       = room_fields,
+    [OBJ_ROOM_DATA - OBJ_AREA]  = room_data_fields,
+    [OBJ_OBJ - OBJ_AREA]        = obj_fields,
+    [OBJ_MOB - OBJ_AREA]        = mob_fields,
+    [OBJ_FACTION - OBJ_AREA]    = faction_fields,
+};
+
+static void intern_fields(EntityField* fields)
+{
+    for (EntityField* field = fields; field->name != NULL; field++) {
+        if (field->key == NULL)
+            field->key = copy_string(field->name, (int)strlen(field->name));
+    }
+}
+
+void init_entity_shapes()
+{
+    intern_fields(header_fields);
+    for (int i = 0; i < SHAPE_COUNT; i++) {
+        if (shapes[i] != NULL)
+            intern_fields(shapes[i]);
+    }
+}
+
+static void mark_fields(EntityField* fields)
+{
+    for (EntityField* field = fields; field->name != NULL; field++)
+        mark_object((Obj*)field->key);
+}
+
+void mark_entity_shapes()
+{
+    mark_fields(header_fields);
+    for (int i = 0; i < SHAPE_COUNT; i++) {
+        if (shapes[i] != NULL)
+            mark_fields(shapes[i]);
+    }
+}
+
+static const EntityField* find_in_fields(const EntityField* fields, 
+    ObjString* name)
+{
+    // Keys are interned, so a pointer compare is enough.
+    for (const EntityField* field = fields; field->name != NULL; field++) {
+        if (field->key == name)
+            return field;
+    }
+    return NULL;
+}
+
+const EntityField* find_entity_field(Entity* entity, ObjString* name)
+{
+    int type = (int)entity->obj.type - OBJ_AREA;
+    const EntityField* field;
+
+    if (type >= 0 && type < SHAPE_COUNT && shapes[type] != NULL
+        && (field = find_in_fields(shapes[type], name)) != NULL)
+        return field;
+
+    return find_in_fields(header_fields, name);
+}
+
+Value get_entity_field(Entity* entity, const EntityField* field)
+{
+    char* addr = (char*)entity + field->offset;
+
+    switch (field->type) {
+    case FIELD_I16:
+        return INT_VAL((int32_t)*(int16_t*)addr);
+    case FIELD_I32:
+        return INT_VAL(*(int32_t*)addr);
+    case FIELD_STR: {
+            char* str = *(char**)addr;
+            return OBJ_VAL(copy_string(str, (int)strlen(str)));
+        }
+    case FIELD_NAME:
+    case FIELD_ENTITY: {
+            Obj* obj = *(Obj**)addr;
+            return obj != NULL ? OBJ_VAL(obj) : NIL_VAL;
+        }
+    case FIELD_EMBEDDED:
+        return OBJ_VAL((Obj*)addr);
+    }
+
+    return NIL_VAL;
+}
+
+bool set_entity_field(Entity* entity, const EntityField* field, Value value)
+{
+    char* addr = (char*)entity + field->offset;
+
+    switch (field->type) {
+    case FIELD_I16:
+    case FIELD_I32:
+        if (!IS_INT(value)) {
+            runtime_error("Field '%s' must be an integer.", field->name);
+            return false;
+        }
+        if (field->type == FIELD_I16)
+            *(int16_t*)addr = (int16_t)AS_INT(value);
+        else
+            *(int32_t*)addr = (int32_t)AS_INT(value);
+        if (entity->obj.type == OBJ_MOB)
+            update_room_aggressor((Mobile*)entity);
+        return true;
+    case FIELD_STR: {
+            if (!IS_STRING(value)) {
+                runtime_error("Field '%s' must be a string.", field->name);
+                return false;
+            }
+            char** str = (char**)addr;
+            free_string(*str);
+            *str = str_dup(AS_CSTRING(value));
+            return true;
+        }
+    case FIELD_NAME:
+        if (!IS_STRING(value)) {
+            runtime_error("Field '%s' must be a string.", field->name);
+            return false;
+        }
+        set_name(entity, AS_STRING(value));
+        return true;
+    case FIELD_ENTITY:
+    case FIELD_EMBEDDED:
+        break;
+    }
+
+    runtime_error("Field '%s' is read-only.", field->name);
+    return false;
+}
+
 void init_header(Entity* header, ObjType type)
 {
     header->obj.type = type;
@@ -18,12 +224,10 @@ void init_header(Entity* header, ObjType type)
     header->name = lox_empty_string;
 
     header->event_triggers = 0;
+    header->event_index = NULL;
+    header->timers = NULL;
     header->klass = NULL;
     header->script = 0;
-
-    SET_LOX_FIELD(header, header->name, name);
-
-    SET_NATIVE_FIELD(header, header->vnum, vnum, I32);
 }
 
 ObjClass* create_entity_class(Entity* entity, const char* name, const char* bare_class_source)
@@ -36,7 +240,7 @@ ObjClass* create_entity_class(Entity* entity, const char* name, const char* bare
 
     compile_context.this_ = entity;
 
-    int result = interpret_code(buf->string);
+    int result = lox_cache_interpret(buf->string);
 
     compile_context.this_ = NULL;
 
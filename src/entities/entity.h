@@ -16,6 +16,9 @@
 #define MUD98__ENTITIES__ENTITY_H
 
 #include <lox/lox.h>
+#include <lox/memory.h>
+
+#include <stddef.h>
 
 typedef struct entity_t {
     Obj obj;
@@ -26,8 +29,38 @@ typedef struct entity_t {
     int32_t vnum;
     List events;
     FLAGS event_triggers;
+    struct event_index_t* event_index;  // Built on first dispatch
+    struct event_timer_t* timers;   // Delayed callbacks it owns
 } Entity;
 
+// Native fields (hp, level, short_desc, ...) aren't stored per-entity. Each
+// entity type has a static shape: a list of field descriptors giving the name,
+// type, and offset of the C member backing it. Property access resolves
+// through the shape first; 'fields' only holds what scripts add themselves,
+// so it stays empty (and unallocated) for most entities.
+
+typedef enum {
+    FIELD_I16,          // int16_t
+    FIELD_I32,          // int32_t
+    FIELD_STR,          // char*, copied in and out of Lox
+    FIELD_NAME,         // Entity::name
+    FIELD_ENTITY,       // Pointer to another entity; read-only, NULL is nil
+    FIELD_EMBEDDED,     // Embedded List, Table, or ValueArray; read-only
+} FieldType;
+
+typedef struct entity_field_t {
+    const char* name;
+    FieldType type;
+    size_t offset;
+    ObjString* key;     // Interned by init_entity_shapes()
+} EntityField;
+
+void init_entity_shapes();
+void mark_entity_shapes();
+const EntityField* find_entity_field(Entity* entity, ObjString* name);
+Value get_entity_field(Entity* entity, const EntityField* field);
+bool set_entity_field(Entity* entity, const EntityField* field, Value value);
+
 void init_header(Entity* header, ObjType type);
 ObjClass* create_entity_class(Entity* entity, const char* name, const char* bare_class_source);
 Value is_obj_lox(Value receiver, int arg_count, Value* args);
@@ -39,41 +72,28 @@ Value is_room_data_lox(Value receiver, int arg_count, Value* args);
 Value is_area_lox(Value receiver, int arg_count, Value* args);
 Value is_area_data_lox(Value receiver, int arg_count, Value* args);
 
-// I don't need to use gc_protect on these because the creation and assignment 
-// is atomic. We won't see a vm run in the middle of it.
-
-#define SET_NATIVE_FIELD(inst, src, tgt, TYPE)                                 \
-{                                                                              \
-    Value tgt##_value = WRAP_##TYPE(src);                                      \
-    push(tgt##_value);                                                         \
-    char* tgt##_str = #tgt;                                                    \
-    ObjString* tgt##_fld = copy_string(tgt##_str, (int)strlen(tgt##_str));     \
-    push(OBJ_VAL(tgt##_fld));                                                  \
-    table_set(&(inst)->fields, tgt##_fld, tgt##_value);                        \
-    pop();                                                                     \
-    pop();                                                                     \
-}
-
-#define SET_LOX_FIELD(inst, value, field)                                      \
-{                                                                              \
-    Value tgt##_value = OBJ_VAL(value);                                        \
-    push(tgt##_value);                                                         \
-    char* field##_str = #field;                                                \
-    ObjString* key = copy_string(field##_str, (int)strlen(field##_str));       \
-    push(OBJ_VAL(key));                                                        \
-    table_set(&(inst)->fields, key, tgt##_value);                              \
-    pop();                                                                     \
-    pop();                                                                     \
-}
-
 static inline void set_name(Entity* header, ObjString* new_name)
 {
     header->name = new_name;
-    SET_LOX_FIELD(header, header->name, name);
+    GC_BARRIER_OBJ(new_name);
 }
 
 #define SET_NAME(obj, name)     set_name(&((obj)->header), name)
 
+// Classes and scripts are stored from C, so they need the barrier too; an
+// entity already traced this cycle wouldn't be looked at again.
+static inline void set_entity_class(Entity* header, ObjClass* klass)
+{
+    header->klass = klass;
+    GC_BARRIER_OBJ(klass);
+}
+
+static inline void set_entity_script(Entity* header, ObjString* script)
+{
+    header->script = script;
+    GC_BARRIER_OBJ(script);
+}
+
 #define C_STR(string)       (string->chars)
 
 #define NAME_STR(obj)       (obj->header.name->chars)
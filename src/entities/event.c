@@ -8,6 +8,7 @@
 
 #include <comm.h>
 #include <db.h>
+#include <handler.h>
 #include <lookup.h>
 
 #include <data/events.h>
@@ -19,69 +20,12 @@
 #include <lox/value.h>
 #include <lox/vm.h>
 
+#include <string.h>
+
 int event_count = 0;
 int event_perm_count = 0;
 Event* event_free = NULL;
 
-int event_timer_count;
-int event_timer_perm_count;
-EventTimer* event_timer_free;
-EventTimer* event_timers = NULL;
-
-EventTimer* new_event_timer(ObjClosure* closure, int ticks)
-{
-    LIST_ALLOC_PERM(event_timer, EventTimer);
-
-    event_timer->closure = closure;
-    event_timer->ticks = ticks;
-
-    return event_timer;
-}
-
-void free_event_timer(EventTimer* event_timer)
-{
-    LIST_FREE(event_timer);
-}
-
-void add_event_timer(ObjClosure* closure, int ticks)
-{
-    EventTimer* timer = new_event_timer(closure, ticks);
-    timer->next = event_timers;
-    event_timers = timer;
-}
-
-void event_timer_tick()
-{
-    EventTimer* timer = NULL;
-    EventTimer* timer_next = NULL;
-
-    for (timer = event_timers; timer != NULL; timer = timer_next) {
-        timer_next = timer->next;
-        if (--timer->ticks <= 0) {
-            // Time to run the event
-            ObjClosure* closure = timer->closure;
-
-            // Remove from list
-            if (timer == event_timers)
-                event_timers = timer->next;
-            else {
-                EventTimer* t = event_timers;
-                while (t != NULL && t->next != timer)
-                    t = t->next;
-                if (t != NULL)
-                    t->next = timer->next;
-            }
-
-            free_event_timer(timer);
-
-            if (closure != NULL) {
-                // Run the closure
-                invoke_closure(closure, 0);
-            }
-        }
-    }
-}
-
 Event* new_event()
 {
     LIST_ALLOC_PERM(event, Event);
@@ -106,6 +50,7 @@ void add_event(Entity* entity, Event* event)
 {
     list_push(&entity->events, OBJ_VAL(event));
     entity->event_triggers |= event->trigger;
+    invalidate_event_indexes();
 }
 
 void remove_event(Entity* entity, Event* event)
@@ -115,9 +60,10 @@ void remove_event(Entity* entity, Event* event)
     // Recalculate event triggers
     entity->event_triggers = 0;
     for (Node* node = entity->events.front; node != NULL; node = node->next) {
-        Event* ev = (Event*)node->value;
+        Event* ev = AS_EVENT(node->value);
         entity->event_triggers |= ev->trigger;
     }
+    invalidate_event_indexes();
 }
 
 void load_event(FILE* fp, Entity* owner)
@@ -308,28 +254,244 @@ ObjClosure* get_event_closure(Entity* entity, Event* event)
     return AS_CLOSURE(method_val);
 }
 
+// EVENT DISPATCH INDEX ////////////////////////////////////////////////////////
+
+// Bumped whenever any entity's events change; indexes built before then are
+// rebuilt on their next dispatch.
+static uint32_t event_epoch = 1;
+
+void invalidate_event_indexes()
+{
+    event_epoch++;
+    invalidate_room_listeners();
+}
+
+static inline int trigger_slot(FLAGS trigger)
+{
+    int slot = 0;
+    while ((trigger >>= 1) != 0)
+        slot++;
+    return slot;
+}
+
+void free_event_index(Entity* entity)
+{
+    EventIndex* index = entity->event_index;
+    if (index == NULL)
+        return;
+
+    if (index->matchers != NULL)
+        free_mem(index->matchers, sizeof(PhraseMatcher)
+            * (size_t)index->matcher_count);
+    free_mem(index, index->size);
+    entity->event_index = NULL;
+}
+
+static void build_phrase_matchers(EventIndex* index)
+{
+    int count = 0;
+    for (int slot = 0; slot < EVENT_TRIG_SLOTS; slot++) {
+        index->matcher[slot] = -1;
+        for (int i = index->start[slot]; i < index->start[slot + 1]; i++) {
+            if (index->handlers[i].phrase != NULL) {
+                index->matcher[slot] = (int8_t)count++;
+                break;
+            }
+        }
+    }
+
+    index->matcher_count = count;
+    if (count == 0)
+        return;
+
+    index->matchers = alloc_mem(sizeof(PhraseMatcher) * (size_t)count);
+    for (int slot = 0; slot < EVENT_TRIG_SLOTS; slot++) {
+        if (index->matcher[slot] < 0)
+            continue;
+
+        PhraseMatcher* matcher = &index->matchers[index->matcher[slot]];
+        memset(matcher, 0, sizeof(PhraseMatcher));
+        matcher->first = -1;
+        matcher->always = -1;
+
+        for (int i = index->start[slot]; i < index->start[slot + 1]; i++) {
+            EventHandler* handler = &index->handlers[i];
+            if (handler->phrase == NULL)
+                continue;
+            if (matcher->first < 0)
+                matcher->first = i;
+            if (handler->phrase_len == 0) {
+                if (matcher->always < 0)
+                    matcher->always = i;
+                continue;
+            }
+            unsigned char c = (unsigned char)handler->phrase[0];
+            matcher->starts[c >> 5] |= 1u << (c & 31);
+        }
+    }
+}
+
+static EventIndex* build_event_index(Entity* entity)
+{
+    int counts[EVENT_TRIG_SLOTS] = { 0 };
+    int total = 0;
+
+    for (Node* node = entity->events.front; node != NULL; node = node->next) {
+        if (!IS_EVENT(node->value))
+            continue;
+        FLAGS trigger = AS_EVENT(node->value)->trigger;
+        for (int slot = 0; slot < EVENT_TRIG_SLOTS; slot++) {
+            if (trigger & BIT(slot)) {
+                counts[slot]++;
+                total++;
+            }
+        }
+    }
+
+    size_t size = sizeof(EventIndex) + sizeof(EventHandler) * (size_t)total;
+    EventIndex* index = alloc_mem(size);
+    memset(index, 0, size);
+    index->klass = entity->klass;
+    index->epoch = event_epoch;
+    index->size = size;
+
+    int cursor[EVENT_TRIG_SLOTS];
+    for (int slot = 0; slot < EVENT_TRIG_SLOTS; slot++) {
+        cursor[slot] = index->start[slot];
+        index->start[slot + 1] = (int16_t)(index->start[slot] + counts[slot]);
+    }
+
+    for (Node* node = entity->events.front; node != NULL; node = node->next) {
+        if (!IS_EVENT(node->value)) {
+            bug("build_event_index: Invalid event node on entity #%"PRVNUM".\n",
+                entity->vnum);
+            continue;
+        }
+
+        Event* event = AS_EVENT(node->value);
+        if ((event->trigger & ((FLAGS)BIT(EVENT_TRIG_SLOTS) - 1)) == 0)
+            continue;
+
+        // Resolve the method once for every trigger the event is on.
+        ObjClosure* closure = get_event_closure(entity, event);
+        const char* phrase = NULL;
+        int phrase_len = 0;
+        if (IS_STRING(event->criteria)) {
+            phrase = AS_STRING(event->criteria)->chars;
+            phrase_len = AS_STRING(event->criteria)->length;
+        }
+
+        for (int slot = 0; slot < EVENT_TRIG_SLOTS; slot++) {
+            if ((event->trigger & BIT(slot)) == 0)
+                continue;
+            EventHandler* handler = &index->handlers[cursor[slot]++];
+            handler->event = event;
+            handler->closure = closure;
+            handler->phrase = phrase;
+            handler->phrase_len = phrase_len;
+        }
+    }
+
+    build_phrase_matchers(index);
+    return index;
+}
+
+static EventIndex* get_event_index(Entity* entity)
+{
+    EventIndex* index = entity->event_index;
+    if (index != NULL && index->epoch == event_epoch
+        && index->klass == entity->klass)
+        return index;
+
+    free_event_index(entity);
+    entity->event_index = build_event_index(entity);
+    return entity->event_index;
+}
+
+// The first event on the trigger
+static EventHandler* find_handler(Entity* entity, FLAGS trigger)
+{
+    if (entity == NULL || !HAS_EVENT_TRIGGER(entity, trigger))
+        return NULL;
+
+    EventIndex* index = get_event_index(entity);
+    int slot = trigger_slot(trigger);
+    if (index->start[slot] == index->start[slot + 1])
+        return NULL;
+
+    return &index->handlers[index->start[slot]];
+}
+
+// The first event on the trigger with the given int criteria
+static EventHandler* find_handler_intval(Entity* entity, FLAGS trigger, int val)
+{
+    if (entity == NULL || !HAS_EVENT_TRIGGER(entity, trigger))
+        return NULL;
+
+    EventIndex* index = get_event_index(entity);
+    int slot = trigger_slot(trigger);
+    for (int i = index->start[slot]; i < index->start[slot + 1]; i++) {
+        Value criteria = index->handlers[i].event->criteria;
+        if (IS_INT(criteria) && AS_INT(criteria) == val)
+            return &index->handlers[i];
+    }
+
+    return NULL;
+}
+
+// The first event on the trigger whose string criteria appears in 'str'. Like
+// the list it replaces, an earlier event wins over an earlier match.
+static EventHandler* find_handler_strval(Entity* entity, FLAGS trigger,
+    const char* str)
+{
+    if (entity == NULL || !HAS_EVENT_TRIGGER(entity, trigger))
+        return NULL;
+
+    EventIndex* index = get_event_index(entity);
+    int slot = trigger_slot(trigger);
+    if (index->matcher[slot] < 0)
+        return NULL;
+
+    const PhraseMatcher* matcher = &index->matchers[index->matcher[slot]];
+    int end = index->start[slot + 1];
+    int best = matcher->always >= 0 ? matcher->always : end;
+
+    for (const unsigned char* p = (const unsigned char*)str;
+        *p != '\0' && best > matcher->first; p++) {
+        if ((matcher->starts[*p >> 5] & (1u << (*p & 31))) == 0)
+            continue;
+
+        for (int i = matcher->first; i < best; i++) {
+            EventHandler* handler = &index->handlers[i];
+            if (handler->phrase != NULL && handler->phrase_len > 0
+                && (unsigned char)handler->phrase[0] == *p
+                && strncmp((const char*)p, handler->phrase,
+                    (size_t)handler->phrase_len) == 0) {
+                best = i;
+                break;
+            }
+        }
+    }
+
+    return best < end ? &index->handlers[best] : NULL;
+}
+
 // EVENT TRIGGERS //////////////////////////////////////////////////////////////
 
 // TRIG_ACT
 // TRIG_SPEECH
 void raise_act_event(Entity* receiver, EventTrigger trig_type, Entity* actor, char* msg)
 {
-    if (!HAS_EVENT_TRIGGER(receiver, TRIG_ACT))
+    if (!HAS_EVENT_TRIGGER(receiver, trig_type))
         return;
 
-    Event* event = get_event_by_trigger_strval(receiver, trig_type, msg);
-
-    if (event == NULL)
-        return;
-
-    ObjClosure* closure = get_event_closure(receiver, event);
-    
-    if (closure == NULL)
+    EventHandler* handler = find_handler_strval(receiver, trig_type, msg);
+    if (handler == NULL || handler->closure == NULL)
         return;
 
     Value msg_val = OBJ_VAL(lox_string(msg));
 
-    invoke_method_closure(OBJ_VAL(receiver), closure, 2, OBJ_VAL(actor), msg_val);
+    invoke_method_closure(OBJ_VAL(receiver), handler->closure, 2, OBJ_VAL(actor), msg_val);
 }
 
 // TRIG_ATTACKED
@@ -338,19 +500,17 @@ void raise_attacked_event(Mobile* victim, Mobile* attacker, int pct_chance)
     if (!HAS_EVENT_TRIGGER(victim, TRIG_ATTACKED))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)victim, TRIG_ATTACKED);
-
-    if (!IS_INT(event->criteria))
+    EventHandler* handler = find_handler((Entity*)victim, TRIG_ATTACKED);
+    if (handler == NULL || !IS_INT(handler->event->criteria))
         return;
 
-    if (pct_chance > AS_INT(event->criteria))
+    if (pct_chance > AS_INT(handler->event->criteria))
         return;
 
-    ObjClosure* closure = get_event_closure((Entity*)victim, event);
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(victim), closure, 1, OBJ_VAL(attacker));
+    invoke_method_closure(OBJ_VAL(victim), handler->closure, 1, OBJ_VAL(attacker));
 }
 
 // TRIG_BRIBE
@@ -359,32 +519,28 @@ void raise_bribe_event(Mobile* mob, Mobile* ch, int amount)
     if (!HAS_EVENT_TRIGGER(mob, TRIG_BRIBE))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)mob, TRIG_BRIBE);
-
-    if (!IS_INT(event->criteria))
+    EventHandler* handler = find_handler((Entity*)mob, TRIG_BRIBE);
+    if (handler == NULL || !IS_INT(handler->event->criteria))
         return;
 
-    if (amount < AS_INT(event->criteria))
+    if (amount < AS_INT(handler->event->criteria))
         return;
 
-    ObjClosure* closure = get_event_closure((Entity*)mob, event);
-
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(mob), closure, 2, OBJ_VAL(ch), INT_VAL(amount));
+    invoke_method_closure(OBJ_VAL(mob), handler->closure, 2, OBJ_VAL(ch), INT_VAL(amount));
 }
 
 // TRIG_DEATH
 void raise_death_event(Mobile* victim, Mobile* killer)
 {
-    Event* event;
-    ObjClosure* closure;
+    EventHandler* handler;
 
     if (HAS_EVENT_TRIGGER(victim, TRIG_DEATH)
-        && (event = get_event_by_trigger((Entity*)victim, TRIG_DEATH)) != NULL
-        && (closure = get_event_closure((Entity*)victim, event)) != NULL)
-        invoke_method_closure(OBJ_VAL(victim), closure, 1, OBJ_VAL(killer));
+        && (handler = find_handler((Entity*)victim, TRIG_DEATH)) != NULL
+        && handler->closure != NULL)
+        invoke_method_closure(OBJ_VAL(victim), handler->closure, 1, OBJ_VAL(killer));
 }
 
 // TRIG_ENTRY
@@ -393,20 +549,17 @@ void raise_entry_event(Mobile* mob, int pct_chance)
     if (!HAS_EVENT_TRIGGER(mob, TRIG_ENTRY))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)mob, TRIG_ENTRY);
-
-    if (!IS_INT(event->criteria))
+    EventHandler* handler = find_handler((Entity*)mob, TRIG_ENTRY);
+    if (handler == NULL || !IS_INT(handler->event->criteria))
         return;
 
-    if (pct_chance > AS_INT(event->criteria))
+    if (pct_chance > AS_INT(handler->event->criteria))
         return;
 
-    ObjClosure* closure = get_event_closure((Entity*)mob, event);
-
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(mob), closure, 0);
+    invoke_method_closure(OBJ_VAL(mob), handler->closure, 0);
 }
 
 // TRIG_FIGHT
@@ -415,39 +568,35 @@ void raise_fight_event(Mobile* attacker, Mobile* victim, int pct_chance)
     if (!HAS_EVENT_TRIGGER(attacker, TRIG_FIGHT))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)attacker, TRIG_FIGHT);
-
-    if (!IS_INT(event->criteria))
+    EventHandler* handler = find_handler((Entity*)attacker, TRIG_FIGHT);
+    if (handler == NULL || !IS_INT(handler->event->criteria))
         return;
 
-    if (pct_chance > AS_INT(event->criteria))
+    if (pct_chance > AS_INT(handler->event->criteria))
         return;
 
-    ObjClosure* closure = get_event_closure((Entity*)attacker, event);
-
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(attacker), closure, 1, OBJ_VAL(victim));
+    invoke_method_closure(OBJ_VAL(attacker), handler->closure, 1, OBJ_VAL(victim));
 }
 
 // TRIG_GIVE
 void raise_give_event(Mobile* receiver, Mobile* giver, Object* obj)
 {
-    Event* event = NULL;
-    ObjClosure* closure = NULL;
+    EventHandler* handler = NULL;
 
     // Look for TRIG_GIVE events; they can have either ObjString* criteria
     // (for name) or IntVal criteria (for Obj VNUM).
     if (!HAS_EVENT_TRIGGER(receiver, TRIG_GIVE))
         return;
     
-    if ((event = get_event_by_trigger_intval((Entity*)receiver, TRIG_GIVE, VNUM_FIELD(obj))) == NULL
-        && (event = get_event_by_trigger_strval((Entity*)receiver, TRIG_GIVE, NAME_STR(obj))) == NULL)
+    if ((handler = find_handler_intval((Entity*)receiver, TRIG_GIVE, VNUM_FIELD(obj))) == NULL
+        && (handler = find_handler_strval((Entity*)receiver, TRIG_GIVE, NAME_STR(obj))) == NULL)
         return;
 
-    if ((closure = get_event_closure((Entity*)receiver, event)) != NULL)
-        invoke_method_closure(OBJ_VAL(receiver), closure, 2, OBJ_VAL(giver), OBJ_VAL(obj));
+    if (handler->closure != NULL)
+        invoke_method_closure(OBJ_VAL(receiver), handler->closure, 2, OBJ_VAL(giver), OBJ_VAL(obj));
 }
 
 // TRIG_GREET
@@ -455,33 +604,31 @@ void raise_give_event(Mobile* receiver, Mobile* giver, Object* obj)
 void raise_greet_event(Mobile* ch)
 {
     Mobile* mob;
-    Event* event;
-    ObjClosure* closure;
+    EventHandler* handler;
     Room* room = ch->in_room;
 
     // First check the room for event triggers
     if (HAS_EVENT_TRIGGER(room, TRIG_GREET)
-        && (event = get_event_by_trigger((Entity*)room, TRIG_GREET)) != NULL
-        && (closure = get_event_closure((Entity*)room, event)) != NULL)
-        invoke_method_closure(OBJ_VAL(room), closure, 1, OBJ_VAL(ch));
+        && (handler = find_handler((Entity*)room, TRIG_GREET)) != NULL
+        && handler->closure != NULL)
+        invoke_method_closure(OBJ_VAL(room), handler->closure, 1, OBJ_VAL(ch));
 
     // Now check every mob in the room
     FOR_EACH_ROOM_MOB(mob, ch->in_room) {
-        event = NULL;
+        handler = NULL;
 
         if (!IS_NPC(mob) || (!HAS_EVENT_TRIGGER(mob, TRIG_GREET) && !HAS_EVENT_TRIGGER(mob, TRIG_GRALL)))
             continue;
 
         if (HAS_EVENT_TRIGGER(mob, TRIG_GREET))
-            event = get_event_by_trigger((Entity*)mob, TRIG_GREET);
+            handler = find_handler((Entity*)mob, TRIG_GREET);
         else if (HAS_EVENT_TRIGGER(mob, TRIG_GRALL))
-            event = get_event_by_trigger((Entity*)mob, TRIG_GRALL);
+            handler = find_handler((Entity*)mob, TRIG_GRALL);
        
-        if (event == NULL 
-            || (closure = get_event_closure((Entity*)mob, event)) == NULL)
+        if (handler == NULL || handler->closure == NULL)
             continue;
                 
-        invoke_method_closure(OBJ_VAL(mob), closure, 1, OBJ_VAL(ch));
+        invoke_method_closure(OBJ_VAL(mob), handler->closure, 1, OBJ_VAL(ch));
     }
 }
 
@@ -491,20 +638,17 @@ void raise_hpcnt_event(Mobile* victim, Mobile* attacker)
     if (!HAS_EVENT_TRIGGER(victim, TRIG_HPCNT))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)victim, TRIG_HPCNT);
-
-    if (!IS_INT(event->criteria))
+    EventHandler* handler = find_handler((Entity*)victim, TRIG_HPCNT);
+    if (handler == NULL || !IS_INT(handler->event->criteria))
         return;
 
-    if ((victim->hit * 100) / victim->max_hit > AS_INT(event->criteria))
+    if ((victim->hit * 100) / victim->max_hit > AS_INT(handler->event->criteria))
         return;
 
-    ObjClosure* closure = get_event_closure((Entity*)victim, event);
-
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(victim), closure, 1, OBJ_VAL(attacker));
+    invoke_method_closure(OBJ_VAL(victim), handler->closure, 1, OBJ_VAL(attacker));
 }
 
 // TRIG_RANDOM
@@ -513,20 +657,17 @@ bool raise_random_event(Mobile* ch, int pct_chance)
     if (!HAS_EVENT_TRIGGER(ch, TRIG_RANDOM))
         return false;
 
-    Event* event = get_event_by_trigger((Entity*)ch, TRIG_RANDOM);
-
-    if (!IS_INT(event->criteria))
+    EventHandler* handler = find_handler((Entity*)ch, TRIG_RANDOM);
+    if (handler == NULL || !IS_INT(handler->event->criteria))
         return false;
 
-    if (pct_chance > AS_INT(event->criteria))
+    if (pct_chance > AS_INT(handler->event->criteria))
         return false;
 
-    ObjClosure* closure = get_event_closure((Entity*)ch, event);
-
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return false;
 
-    invoke_method_closure(OBJ_VAL(ch), closure, 0);
+    invoke_method_closure(OBJ_VAL(ch), handler->closure, 0);
 
     return true;
 }
@@ -537,8 +678,7 @@ bool raise_random_event(Mobile* ch, int pct_chance)
 bool raise_exit_event(Mobile* ch, Direction dir)
 {
     Mobile* mob;
-    Event* event;
-    ObjClosure* closure;
+    EventHandler* handler;
 
     bool blocked = false;
     Room* room = ch->in_room;
@@ -547,10 +687,10 @@ bool raise_exit_event(Mobile* ch, Direction dir)
         return false;
 
     // First check the room for event triggers
-    if (room && HAS_EVENT_TRIGGER(room, TRIG_EXIT)
-        && (event = get_event_by_trigger_intval((Entity*)room, TRIG_EXIT, dir)) != NULL
-        && (closure = get_event_closure((Entity*)room, event)) != NULL) {
-        invoke_method_closure(OBJ_VAL(room), closure, 1, OBJ_VAL(ch));
+    if (HAS_EVENT_TRIGGER(room, TRIG_EXIT)
+        && (handler = find_handler_intval((Entity*)room, TRIG_EXIT, dir)) != NULL
+        && handler->closure != NULL) {
+        invoke_method_closure(OBJ_VAL(room), handler->closure, 1, OBJ_VAL(ch));
         if (repl_ret_val == TRUE_VAL)
             blocked = true;
     }
@@ -558,18 +698,17 @@ bool raise_exit_event(Mobile* ch, Direction dir)
     FOR_EACH_ROOM_MOB(mob, room) {
         if (IS_NPC(mob) && (HAS_EVENT_TRIGGER(mob, TRIG_EXIT)
             || HAS_EVENT_TRIGGER(mob, TRIG_EXALL))) {
-            event = get_event_by_trigger_intval((Entity*)mob,
+            handler = find_handler_intval((Entity*)mob,
                 HAS_EVENT_TRIGGER(mob, TRIG_EXIT) ? TRIG_EXIT : TRIG_EXALL, dir);
-            if (event == NULL)
+            if (handler == NULL)
                 continue;
 
-            if ((event->trigger == TRIG_EXIT
+            if ((handler->event->trigger == TRIG_EXIT
                 && mob->position == mob->prototype->default_pos
-                && can_see(mob, ch)) || event->trigger == TRIG_EXALL) {
-                closure = get_event_closure((Entity*)mob, event);
-                if (closure == NULL)
+                && can_see(mob, ch)) || handler->event->trigger == TRIG_EXALL) {
+                if (handler->closure == NULL)
                     continue;
-                invoke_method_closure(OBJ_VAL(mob), closure, 1, OBJ_VAL(ch));
+                invoke_method_closure(OBJ_VAL(mob), handler->closure, 1, OBJ_VAL(ch));
                 if (repl_ret_val == TRUE_VAL)
                     blocked = true;
             }
@@ -588,40 +727,33 @@ bool raise_surrender_event(Mobile* ch, Mobile* mob, int pct_chance)
     if (!HAS_EVENT_TRIGGER(mob, TRIG_SURR))
         return false;
 
-    Event* event = get_event_by_trigger((Entity*)mob, TRIG_SURR);
-    if (event == NULL)
+    EventHandler* handler = find_handler((Entity*)mob, TRIG_SURR);
+    if (handler == NULL)
         return false;
 
-    if (!IS_INT(event->criteria))
+    if (!IS_INT(handler->event->criteria))
         return false;
 
-    if (pct_chance > AS_INT(event->criteria))
+    if (pct_chance > AS_INT(handler->event->criteria))
         return false;
 
-    ObjClosure* closure = get_event_closure((Entity*)mob, event);
-    if (closure == NULL)
+    if (handler->closure == NULL)
         return false;
 
-    invoke_method_closure(OBJ_VAL(mob), closure, 1, OBJ_VAL(ch));
+    invoke_method_closure(OBJ_VAL(mob), handler->closure, 1, OBJ_VAL(ch));
     return repl_ret_val == TRUE_VAL;
 }
 
 // TRIG_LOGIN
 void raise_login_event(Mobile* ch)
 {
-    Event* event = get_event_by_trigger((Entity*)ch->in_room, TRIG_LOGIN);
+    EventHandler* handler = find_handler((Entity*)ch->in_room, TRIG_LOGIN);
 
-    if (event == NULL)
-        return;
-
-    // Get the closure for this event from the room
-    ObjClosure* closure = get_event_closure((Entity*)ch->in_room, event);
-
-    if (closure == NULL)
+    if (handler == NULL || handler->closure == NULL)
         return;
 
     // Invoke the closure with the room and character as parameters
-    invoke_method_closure(OBJ_VAL(ch->in_room), closure, 1, OBJ_VAL(ch));
+    invoke_method_closure(OBJ_VAL(ch->in_room), handler->closure, 1, OBJ_VAL(ch));
 }
 
 void raise_object_given_event(Object* obj, Mobile* giver, Mobile* taker)
@@ -632,15 +764,11 @@ void raise_object_given_event(Object* obj, Mobile* giver, Mobile* taker)
     if (!HAS_EVENT_TRIGGER(obj, TRIG_GIVEN))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)obj, TRIG_GIVEN);
-    if (event == NULL)
-        return;
-
-    ObjClosure* closure = get_event_closure((Entity*)obj, event);
-    if (closure == NULL)
+    EventHandler* handler = find_handler((Entity*)obj, TRIG_GIVEN);
+    if (handler == NULL || handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(obj), closure, 2, OBJ_VAL(giver),
+    invoke_method_closure(OBJ_VAL(obj), handler->closure, 2, OBJ_VAL(giver),
         OBJ_VAL(taker));
 }
 
@@ -652,15 +780,11 @@ void raise_object_taken_event(Object* obj, Mobile* taker)
     if (!HAS_EVENT_TRIGGER(obj, TRIG_TAKEN))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)obj, TRIG_TAKEN);
-    if (event == NULL)
-        return;
-
-    ObjClosure* closure = get_event_closure((Entity*)obj, event);
-    if (closure == NULL)
+    EventHandler* handler = find_handler((Entity*)obj, TRIG_TAKEN);
+    if (handler == NULL || handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(obj), closure, 1, OBJ_VAL(taker));
+    invoke_method_closure(OBJ_VAL(obj), handler->closure, 1, OBJ_VAL(taker));
 }
 
 void raise_object_dropped_event(Object* obj, Mobile* dropper)
@@ -671,15 +795,11 @@ void raise_object_dropped_event(Object* obj, Mobile* dropper)
     if (!HAS_EVENT_TRIGGER(obj, TRIG_DROPPED))
         return;
 
-    Event* event = get_event_by_trigger((Entity*)obj, TRIG_DROPPED);
-    if (event == NULL)
-        return;
-
-    ObjClosure* closure = get_event_closure((Entity*)obj, event);
-    if (closure == NULL)
+    EventHandler* handler = find_handler((Entity*)obj, TRIG_DROPPED);
+    if (handler == NULL || handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(obj), closure, 1, OBJ_VAL(dropper));
+    invoke_method_closure(OBJ_VAL(obj), handler->closure, 1, OBJ_VAL(dropper));
 }
 
 // TRIG_PRDSTART
@@ -691,15 +811,11 @@ void raise_prdstart_event(Entity* entity, const char* period_name)
     if (!HAS_EVENT_TRIGGER(entity, TRIG_PRDSTART))
         return;
 
-    Event* event = get_event_by_trigger_strval(entity, TRIG_PRDSTART, period_name);
-    if (event == NULL)
+    EventHandler* handler = find_handler_strval(entity, TRIG_PRDSTART, period_name);
+    if (handler == NULL || handler->closure == NULL)
         return;
 
-    ObjClosure* closure = get_event_closure(entity, event);
-    if (closure == NULL)
-        return;
-
-    invoke_method_closure(OBJ_VAL(entity), closure, 0);
+    invoke_method_closure(OBJ_VAL(entity), handler->closure, 0);
 }
 
 // TRIG_PRDSTOP
@@ -711,13 +827,9 @@ void raise_prdstop_event(Entity* entity, const char* period_name)
     if (!HAS_EVENT_TRIGGER(entity, TRIG_PRDSTOP))
         return;
 
-    Event* event = get_event_by_trigger_strval(entity, TRIG_PRDSTOP, period_name);
-    if (event == NULL)
-        return;
-
-    ObjClosure* closure = get_event_closure(entity, event);
-    if (closure == NULL)
+    EventHandler* handler = find_handler_strval(entity, TRIG_PRDSTOP, period_name);
+    if (handler == NULL || handler->closure == NULL)
         return;
 
-    invoke_method_closure(OBJ_VAL(entity), closure, 0);
+    invoke_method_closure(OBJ_VAL(entity), handler->closure, 0);
 }
@@ -9,12 +9,15 @@
 #include <merc.h>
 
 #include "entity.h"
+#include "event_timer.h"
 
 typedef struct object_t Object;
 typedef struct obj_closure_t ObjClosure;
 
 #include <lox/object.h>
 
+#include <data/events.h>
+
 #include <recycle.h>
 
 typedef struct event_t {
@@ -25,18 +28,45 @@ typedef struct event_t {
     ObjString* method_name;
 } Event;
 
-// Used for delayed events
-typedef struct event_timer_t {
-    struct event_timer_t* next;
-    ObjClosure* closure;
-    int ticks;
-} EventTimer;
+// Bit positions an EventTrigger can occupy (BIT(0) through LAST_TRIG).
+#define EVENT_TRIG_SLOTS    23
+
+static_assert(LAST_TRIG == BIT(EVENT_TRIG_SLOTS - 1),
+    "EVENT_TRIG_SLOTS must cover every trigger bit up to LAST_TRIG");
+
+// An entity's events resolved for dispatch: each event paired with the class
+// method it calls, grouped by trigger bit in list order. Handlers for trigger
+// slot 's' are handlers[start[s]] up to handlers[start[s + 1]].
+typedef struct event_handler_t {
+    Event* event;
+    ObjClosure* closure;    // NULL if the class has no such method
+    const char* phrase;     // String criteria, or NULL
+    int phrase_len;
+} EventHandler;
+
+// String criteria are matched as substrings. For each trigger with any, a
+// matcher notes which bytes can start a phrase, so one pass over the text
+// skips everywhere none can begin.
+typedef struct phrase_matcher_t {
+    uint32_t starts[8];     // Bit set of the phrases' first bytes
+    int first;              // First handler with a phrase
+    int always;             // First handler with an empty phrase, or -1
+} PhraseMatcher;
+
+typedef struct event_index_t {
+    ObjClass* klass;        // Class the closures were resolved against
+    uint32_t epoch;
+    size_t size;
+    int16_t start[EVENT_TRIG_SLOTS + 1];
+    int8_t matcher[EVENT_TRIG_SLOTS];   // Index into 'matchers', or -1
+    PhraseMatcher* matchers;
+    int matcher_count;
+    EventHandler handlers[];
+} EventIndex;
 
 Event* new_event();
 void free_event(Event* event);
 void add_event(Entity* entity, Event* event);
-void add_event_timer(ObjClosure* closure, int ticks);
-void event_timer_tick();
 void remove_event(Entity* entity, Event* event);
 void load_event(FILE* fp, Entity* owner);
 void save_events(FILE* fp, Entity* entity);
@@ -44,6 +74,8 @@ Event* get_event_by_trigger(Entity* entity, FLAGS trigger);
 Event* get_event_by_trigger_strval(Entity* entity, FLAGS trigger, const char* str);
 Event* get_event_by_trigger_intval(Entity* entity, FLAGS trigger, int val);
 ObjClosure* get_event_closure(Entity* entity, Event* event);
+void invalidate_event_indexes();
+void free_event_index(Entity* entity);
 
 #define HAS_EVENT_TRIGGER(entity, trigger)                                     \
     (((Entity*)(entity))->event_triggers & trigger)
@@ -52,8 +84,6 @@ extern int event_count;
 extern int event_perm_count;
 extern Event* event_free;
 
-extern EventTimer* event_timers;
-
 // EVENT TRIGGER ROUTINES //////////////////////////////////////////////////////
 
 /* TRIG_ACT     */  void raise_act_event(Entity* receiver, EventTrigger trig_type, Entity* actor, char* msg);
@@ -0,0 +1,393 @@
+////////////////////////////////////////////////////////////////////////////////
+// entities/event_timer.c
+// Delayed Lox callbacks, scheduled on a hierarchical timing wheel
+//
+// The first level has a slot for each of the next 256 pulses; each level
+// after it has 64 slots, each covering a full turn of the level below. A timer
+// is filed by how far off it is, so scheduling and cancelling are O(1). When a
+// level comes back around to slot 0, the next level's current slot is
+// "cascaded": its timers are filed again, now one level finer. Each pulse only
+// touches the timers that are due (and, now and then, one slot to cascade),
+// no matter how many are pending.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "event_timer.h"
+
+#include "entity.h"
+
+#include <comm.h>
+#include <db.h>
+
+#include <lox/coroutine.h>
+#include <lox/memory.h>
+#include <lox/vm.h>
+
+#include <stdlib.h>
+
+#define WHEEL_ROOT_BITS     8
+#define WHEEL_LEVEL_BITS    6
+#define WHEEL_ROOT_SIZE     (1 << WHEEL_ROOT_BITS)
+#define WHEEL_LEVEL_SIZE    (1 << WHEEL_LEVEL_BITS)
+#define WHEEL_ROOT_MASK     (WHEEL_ROOT_SIZE - 1)
+#define WHEEL_LEVEL_MASK    (WHEEL_LEVEL_SIZE - 1)
+#define WHEEL_LEVELS        3   // Not counting the root
+
+// Furthest a timer can be filed: about 194 days at 4 pulses per second.
+// Anything further is parked in the last slot and refiled as it comes around.
+#define WHEEL_SPAN_BITS     (WHEEL_ROOT_BITS + WHEEL_LEVELS * WHEEL_LEVEL_BITS)
+#define WHEEL_MAX_DELTA     ((UINT64_C(1) << WHEEL_SPAN_BITS) - 1)
+
+#define LEVEL_SHIFT(n)      (WHEEL_ROOT_BITS + (n) * WHEEL_LEVEL_BITS)
+#define LEVEL_INDEX(t, n)   (((t) >> LEVEL_SHIFT(n)) & WHEEL_LEVEL_MASK)
+
+// Handles are a slot in 'handles' and that slot's generation, so a stale
+// handle from a fired or cancelled timer doesn't match whatever uses the slot
+// next. Both fit in a positive Lox int.
+#define HANDLE_INDEX_BITS   20
+#define HANDLE_INDEX_MASK   ((1 << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GEN_MAX      0x7FF
+
+typedef struct timer_handle_t {
+    EventTimer* timer;
+    int next_free;
+    uint16_t gen;
+} TimerHandle;
+
+int event_timer_count;
+int event_timer_perm_count;
+EventTimer* event_timer_free;
+
+static EventTimer* wheel_root[WHEEL_ROOT_SIZE];
+static EventTimer* wheel_levels[WHEEL_LEVELS][WHEEL_LEVEL_SIZE];
+
+// The next pulse to run. Timers due on it are in wheel_root[wheel_pulse].
+static uint64_t wheel_pulse = 0;
+
+static TimerHandle* handles = NULL;
+static int handle_count = 0;
+static int handle_capacity = 0;
+static int handle_free = -1;
+
+static EventTimerStats stats = { 0 };
+
+const EventTimerStats* event_timer_stats()
+{
+    return &stats;
+}
+
+static void link_timer(EventTimer** head, EventTimer* timer)
+{
+    timer->next = *head;
+    if (timer->next != NULL)
+        timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+}
+
+static void unlink_timer(EventTimer* timer)
+{
+    if (timer->pprev == NULL)
+        return;
+    *timer->pprev = timer->next;
+    if (timer->next != NULL)
+        timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+static void link_owner(Entity* owner, EventTimer* timer)
+{
+    timer->owner = owner;
+    timer->owner_next = owner->timers;
+    if (timer->owner_next != NULL)
+        timer->owner_next->owner_pprev = &timer->owner_next;
+    timer->owner_pprev = &owner->timers;
+    owner->timers = timer;
+}
+
+static void unlink_owner(EventTimer* timer)
+{
+    if (timer->owner_pprev == NULL)
+        return;
+    *timer->owner_pprev = timer->owner_next;
+    if (timer->owner_next != NULL)
+        timer->owner_next->owner_pprev = timer->owner_pprev;
+    timer->owner = NULL;
+    timer->owner_next = NULL;
+    timer->owner_pprev = NULL;
+}
+
+static void file_timer(EventTimer* timer)
+{
+    uint64_t expires = timer->expires;
+    uint64_t delta = expires - wheel_pulse;
+
+    // Anything already due goes in the current slot.
+    if (expires < wheel_pulse) {
+        link_timer(&wheel_root[wheel_pulse & WHEEL_ROOT_MASK], timer);
+        return;
+    }
+
+    if (delta < WHEEL_ROOT_SIZE) {
+        link_timer(&wheel_root[expires & WHEEL_ROOT_MASK], timer);
+        return;
+    }
+
+    if (delta > WHEEL_MAX_DELTA)
+        expires = wheel_pulse + WHEEL_MAX_DELTA;
+
+    int level = 0;
+    while (level < WHEEL_LEVELS - 1
+        && (expires - wheel_pulse) >= (UINT64_C(1) << LEVEL_SHIFT(level + 1)))
+        level++;
+
+    link_timer(&wheel_levels[level][LEVEL_INDEX(expires, level)], timer);
+}
+
+// Refiles every timer in a slot of the given level. They all land in finer
+// levels (or back here, if they were parked past the end of the wheel).
+static void cascade(int level, int index)
+{
+    EventTimer* timer = wheel_levels[level][index];
+    wheel_levels[level][index] = NULL;
+
+    while (timer != NULL) {
+        EventTimer* next = timer->next;
+        timer->next = NULL;
+        timer->pprev = NULL;
+        file_timer(timer);
+        timer = next;
+    }
+}
+
+static int32_t acquire_handle(EventTimer* timer)
+{
+    int index;
+
+    if (handle_free >= 0) {
+        index = handle_free;
+        handle_free = handles[index].next_free;
+    }
+    else {
+        if (handle_count == handle_capacity) {
+            if (handle_capacity > HANDLE_INDEX_MASK) {
+                bug("add_event_timer: too many pending timers.");
+                return NO_EVENT_TIMER;
+            }
+            int capacity = handle_capacity < 64 ? 64 : handle_capacity * 2;
+            TimerHandle* grown = realloc(handles, sizeof(TimerHandle)
+                * (size_t)capacity);
+            if (grown == NULL) {
+                bug("add_event_timer: out of memory.");
+                return NO_EVENT_TIMER;
+            }
+            handles = grown;
+            handle_capacity = capacity;
+        }
+        index = handle_count++;
+        handles[index].gen = 0;
+    }
+
+    TimerHandle* handle = &handles[index];
+    handle->gen = (uint16_t)(handle->gen % HANDLE_GEN_MAX + 1);
+    handle->timer = timer;
+    handle->next_free = -1;
+
+    return (int32_t)(((uint32_t)handle->gen << HANDLE_INDEX_BITS)
+        | (uint32_t)index);
+}
+
+static TimerHandle* find_handle(int32_t id)
+{
+    if (id <= 0)
+        return NULL;
+
+    int index = id & HANDLE_INDEX_MASK;
+    uint16_t gen = (uint16_t)((uint32_t)id >> HANDLE_INDEX_BITS);
+    if (index >= handle_count || handles[index].gen != gen
+        || handles[index].timer == NULL)
+        return NULL;
+
+    return &handles[index];
+}
+
+static void release_handle(EventTimer* timer)
+{
+    TimerHandle* handle = find_handle(timer->handle);
+    if (handle != NULL) {
+        handle->timer = NULL;
+        handle->next_free = handle_free;
+        handle_free = (int)(handle - handles);
+    }
+    timer->handle = NO_EVENT_TIMER;
+}
+
+// Takes the timer off the wheel and its owner, and returns it to the pool
+// (unless it belongs to a coroutine).
+static void release_timer(EventTimer* event_timer)
+{
+    bool pooled = event_timer->coroutine == NULL;
+
+    if (event_timer->pprev != NULL) {
+        unlink_timer(event_timer);
+        stats.pending--;
+    }
+    unlink_owner(event_timer);
+    release_handle(event_timer);
+
+    event_timer->closure = NULL;
+    event_timer->coroutine = NULL;
+
+    if (pooled) {
+        LIST_FREE(event_timer);
+    }
+}
+
+int32_t add_event_timer(ObjClosure* closure, int ticks, Entity* owner)
+{
+    if (closure == NULL)
+        return NO_EVENT_TIMER;
+
+    LIST_ALLOC_PERM(event_timer, EventTimer);
+
+    event_timer->handle = acquire_handle(event_timer);
+    if (event_timer->handle == NO_EVENT_TIMER) {
+        LIST_FREE(event_timer);
+        return NO_EVENT_TIMER;
+    }
+
+    // Fire on the 'ticks'-th pulse from now; wheel_pulse is the next one.
+    event_timer->closure = closure;
+    event_timer->expires = wheel_pulse + (uint64_t)(ticks > 1 ? ticks - 1 : 0);
+    file_timer(event_timer);
+
+    if (owner != NULL)
+        link_owner(owner, event_timer);
+
+    if (++stats.pending > stats.peak_pending)
+        stats.peak_pending = stats.pending;
+
+    return event_timer->handle;
+}
+
+int32_t add_coroutine_timer(ObjCoroutine* coroutine, int ticks, Entity* owner)
+{
+    EventTimer* timer = &coroutine->timer;
+
+    if (timer->pprev != NULL) {
+        unlink_timer(timer);
+        stats.pending--;
+    }
+    release_handle(timer);
+
+    timer->coroutine = coroutine;
+    timer->handle = acquire_handle(timer);
+    if (timer->handle == NO_EVENT_TIMER) {
+        release_timer(timer);
+        return NO_EVENT_TIMER;
+    }
+
+    timer->expires = wheel_pulse + (uint64_t)(ticks > 1 ? ticks - 1 : 0);
+    file_timer(timer);
+
+    if (owner != NULL && timer->owner == NULL)
+        link_owner(owner, timer);
+
+    if (++stats.pending > stats.peak_pending)
+        stats.peak_pending = stats.pending;
+
+    return timer->handle;
+}
+
+void cancel_coroutine_timer(ObjCoroutine* coroutine)
+{
+    if (coroutine->timer.coroutine == NULL)
+        return;
+
+    // Only counts if it was waiting; a coroutine that just finished isn't.
+    bool pending = coroutine->timer.pprev != NULL;
+    release_timer(&coroutine->timer);
+    if (pending) {
+        stats.cancelled++;
+        stats.total_cancelled++;
+    }
+}
+
+bool cancel_event_timer(int32_t id)
+{
+    TimerHandle* handle = find_handle(id);
+    if (handle == NULL)
+        return false;
+
+    release_timer(handle->timer);
+    stats.cancelled++;
+    stats.total_cancelled++;
+    return true;
+}
+
+void cancel_entity_timers(Entity* owner)
+{
+    while (owner->timers != NULL) {
+        release_timer(owner->timers);
+        stats.cancelled++;
+        stats.total_cancelled++;
+    }
+}
+
+void event_timer_tick()
+{
+    int index = (int)(wheel_pulse & WHEEL_ROOT_MASK);
+
+    // Root came around; pull the next stretch of timers down from above.
+    if (index == 0) {
+        for (int level = 0; level < WHEEL_LEVELS; level++) {
+            int slot = (int)LEVEL_INDEX(wheel_pulse, level);
+            cascade(level, slot);
+            if (slot != 0)
+                break;
+        }
+    }
+
+    // Detach the due timers first; anything scheduled while they run is for
+    // a later pulse, and cancelling one of these still unlinks it from here.
+    EventTimer* due = wheel_root[index];
+    wheel_root[index] = NULL;
+    if (due != NULL)
+        due->pprev = &due;
+
+    wheel_pulse++;
+
+    stats.fired = 0;
+    stats.cancelled = 0;
+
+    while (due != NULL) {
+        EventTimer* timer = due;
+        ObjClosure* closure = timer->closure;
+        ObjCoroutine* coroutine = timer->coroutine;
+
+        stats.fired++;
+        stats.total_fired++;
+
+        if (coroutine != NULL) {
+            // Keeps its owner; see add_coroutine_timer().
+            unlink_timer(timer);
+            stats.pending--;
+            release_handle(timer);
+            run_spawned_coroutine(coroutine);
+            continue;
+        }
+
+        release_timer(timer);
+        invoke_closure(closure, 0);
+    }
+}
+
+void mark_event_timers()
+{
+    for (int i = 0; i < handle_count; i++) {
+        if (handles[i].timer != NULL) {
+            mark_object((Obj*)handles[i].timer->closure);
+            mark_object((Obj*)handles[i].timer->coroutine);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////
+// entities/event_timer.h
+// Delayed Lox callbacks, scheduled on a hierarchical timing wheel
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__ENTITIES__EVENT_TIMER_H
+#define MUD98__ENTITIES__EVENT_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct entity_t Entity;
+typedef struct obj_closure_t ObjClosure;
+typedef struct obj_coroutine_t ObjCoroutine;
+
+// Timers are linked through 'pprev' (the previous timer's 'next', or the list
+// head) so they can be unlinked in O(1) without knowing which list they're on.
+typedef struct event_timer_t {
+    struct event_timer_t* next;
+    struct event_timer_t** pprev;
+    struct event_timer_t* owner_next;
+    struct event_timer_t** owner_pprev;
+    ObjClosure* closure;
+    ObjCoroutine* coroutine;    // Spawned coroutine this is embedded in
+    Entity* owner;
+    uint64_t expires;       // Pulse it fires on
+    int32_t handle;
+} EventTimer;
+
+typedef struct event_timer_stats_t {
+    int pending;            // Scheduled and not yet fired
+    int peak_pending;
+    int fired;              // Fired on the last pulse
+    int cancelled;          // Cancelled since the last pulse
+    uint64_t total_fired;
+    uint64_t total_cancelled;
+} EventTimerStats;
+
+#define NO_EVENT_TIMER  0
+
+// Runs 'closure' after 'ticks' pulses (at least one). If 'owner' is given,
+// the timer is cancelled when the owner is freed. Returns a handle for
+// cancel_event_timer(); handles are never 0 and are not reused for a long
+// while after their timer is gone.
+int32_t add_event_timer(ObjClosure* closure, int ticks, Entity* owner);
+bool cancel_event_timer(int32_t handle);
+// Files the timer embedded in a spawned coroutine to resume it. Unlike
+// closure timers, it stays linked to its owner while the coroutine runs, and
+// is only unlinked by cancel_coroutine_timer() or the owner being freed.
+int32_t add_coroutine_timer(ObjCoroutine* coroutine, int ticks, Entity* owner);
+void cancel_coroutine_timer(ObjCoroutine* coroutine);
+void cancel_entity_timers(Entity* owner);
+void event_timer_tick();
+void mark_event_timers();
+const EventTimerStats* event_timer_stats();
+
+extern int event_timer_count;
+extern int event_timer_perm_count;
+extern EventTimer* event_timer_free;
+
+#endif // !MUD98__ENTITIES__EVENT_TIMER_H
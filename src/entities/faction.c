@@ -99,10 +99,6 @@ static Faction* new_faction()
     init_value_array(&faction->enemies);
     faction->default_standing = 0;
 
-    SET_LOX_FIELD(&faction->header, faction->area, area);
-    SET_LOX_FIELD(&faction->header, &faction->allies, allies);
-    SET_LOX_FIELD(&faction->header, &faction->enemies, enemies);
-
     return faction;
 }
 
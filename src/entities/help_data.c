@@ -6,7 +6,10 @@
 #include "help_data.h"
 
 #include <db.h>
+#include <handler.h>
+#include <interp.h>
 
+#include <stdlib.h>
 #include <string.h>
 
 HelpData* help_free = NULL;
@@ -22,6 +25,25 @@ int help_perm_count;
 int help_area_count;
 int help_area_perm_count;
 
+// Keyword index. Every keyword of every help, lowercased and sorted, so a
+// lookup only has to check the helps that share a prefix with the first word
+// of the query. Rebuilt on the next lookup after any help is added, removed,
+// or rekeyed.
+typedef struct help_index_entry_t {
+    char* keyword;
+    HelpData* help;
+    int order;              // Position in help_first; results keep that order
+} HelpIndexEntry;
+
+static HelpIndexEntry* help_index = NULL;
+static int help_index_count = 0;
+static int help_index_capacity = 0;
+static bool help_index_dirty = true;
+
+static HelpIndexEntry* help_candidates = NULL;
+static HelpData** help_matches = NULL;
+static int help_matches_capacity = 0;
+
 HelpArea* new_help_area()
 {
     LIST_ALLOC_PERM(help_area, HelpArea);
@@ -38,6 +60,7 @@ HelpData* new_help_data()
 {
     LIST_ALLOC_PERM(help, HelpData);
 
+    help_index_dirty = true;
     return help;
 }
 
@@ -47,4 +70,119 @@ void free_help_data(HelpData* help)
     free_string(help->text);
 
     LIST_FREE(help);
+    help_index_dirty = true;
+}
+
+void invalidate_help_index()
+{
+    help_index_dirty = true;
+}
+
+static int compare_help_keywords(const void* a, const void* b)
+{
+    return strcmp(((const HelpIndexEntry*)a)->keyword,
+        ((const HelpIndexEntry*)b)->keyword);
+}
+
+static int compare_help_order(const void* a, const void* b)
+{
+    return ((const HelpIndexEntry*)a)->order - ((const HelpIndexEntry*)b)->order;
+}
+
+static void add_help_keyword(const char* keyword, HelpData* help, int order)
+{
+    if (help_index_count >= help_index_capacity) {
+        int new_capacity = help_index_capacity ? help_index_capacity * 2 : 1024;
+        HelpIndexEntry* entries = realloc(help_index,
+            (size_t)new_capacity * sizeof(HelpIndexEntry));
+        if (entries == NULL) {
+            bug("add_help_keyword: can't grow help index to %d.", new_capacity);
+            return;
+        }
+        help_index = entries;
+        help_index_capacity = new_capacity;
+    }
+
+    HelpIndexEntry* entry = &help_index[help_index_count++];
+    entry->keyword = strdup(keyword);
+    entry->help = help;
+    entry->order = order;
+}
+
+static void build_help_index()
+{
+    for (int i = 0; i < help_index_count; i++)
+        free(help_index[i].keyword);
+    help_index_count = 0;
+
+    HelpData* help;
+    char name[MAX_INPUT_LENGTH];
+    int order = 0;
+
+    FOR_EACH(help, help_first) {
+        char* list = help->keyword;
+        while (list != NULL && list[0] != '\0') {
+            list = one_argument(list, name);
+            if (name[0] != '\0')
+                add_help_keyword(name, help, order);
+        }
+        order++;
+    }
+
+    qsort(help_index, (size_t)help_index_count, sizeof(HelpIndexEntry),
+        compare_help_keywords);
+
+    if (help_index_count > help_matches_capacity) {
+        free(help_candidates);
+        free(help_matches);
+        help_candidates = malloc((size_t)help_index_count * sizeof(HelpIndexEntry));
+        help_matches = malloc((size_t)help_index_count * sizeof(HelpData*));
+        help_matches_capacity = (help_candidates && help_matches) ? help_index_count : 0;
+    }
+
+    help_index_dirty = false;
+}
+
+HelpData** find_helps(char* argall, int* count)
+{
+    char part[MAX_INPUT_LENGTH];
+
+    *count = 0;
+
+    if (help_index_dirty)
+        build_help_index();
+
+    one_argument(argall, part);
+    if (part[0] == '\0' || help_matches_capacity == 0)
+        return help_matches;
+
+    // is_name() needs the first word of the query to prefix one of a help's
+    // keywords, so the helps worth checking form one run of the index.
+    size_t len = strlen(part);
+    int lo = 0;
+    int hi = help_index_count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strcmp(help_index[mid].keyword, part) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    int candidates = 0;
+    for (int i = lo; i < help_index_count
+        && !strncmp(help_index[i].keyword, part, len); i++)
+        help_candidates[candidates++] = help_index[i];
+
+    qsort(help_candidates, (size_t)candidates, sizeof(HelpIndexEntry),
+        compare_help_order);
+
+    for (int i = 0; i < candidates; i++) {
+        if (i > 0 && help_candidates[i].help == help_candidates[i - 1].help)
+            continue;
+        if (is_name(argall, help_candidates[i].help->keyword))
+            help_matches[(*count)++] = help_candidates[i].help;
+    }
+
+    return help_matches;
 }
@@ -35,6 +35,11 @@ void free_help_data(HelpData* help);
 HelpArea* new_help_area();
 void free_help_area(HelpArea* help_area);
 
+// Returns the helps whose keywords match 'argall' (as is_name() does), in
+// help_first order. The array is reused by the next call.
+HelpData** find_helps(char* argall, int* count);
+void invalidate_help_index();
+
 extern HelpArea* help_area_list;
 extern HelpData* help_first;
 extern HelpData* help_last;
@@ -25,6 +25,7 @@
 #include <lox/memory.h>
 #include <lox/ordered_table.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -257,6 +258,20 @@ MobPrototype* get_mob_prototype(VNUM vnum)
 }
 
 // Snarf a mob section.  new style
+// Loaded strings are shared, so capitalizing one means interning a new copy
+// rather than writing into the text in place.
+static char* capitalize_shared(char* str)
+{
+    if (str[0] == UPPER(str[0]))
+        return str;
+
+    char buf[MAX_STRING_LENGTH];
+    snprintf(buf, sizeof(buf), "%s", str);
+    buf[0] = UPPER(buf[0]);
+    free_string(str);
+    return boot_intern_string(buf);
+}
+
 void load_mobiles(FILE* fp)
 {
     MobPrototype* p_mob_proto;
@@ -297,8 +312,8 @@ void load_mobiles(FILE* fp)
         p_mob_proto->description = fread_string(fp);
         p_mob_proto->race = (int16_t)race_lookup(fread_string(fp));
 
-        p_mob_proto->long_descr[0] = UPPER(p_mob_proto->long_descr[0]);
-        p_mob_proto->description[0] = UPPER(p_mob_proto->description[0]);
+        p_mob_proto->long_descr = capitalize_shared(p_mob_proto->long_descr);
+        p_mob_proto->description = capitalize_shared(p_mob_proto->description);
 
         p_mob_proto->act_flags
             = fread_flag(fp) | ACT_IS_NPC | race_table[p_mob_proto->race].act_flags;
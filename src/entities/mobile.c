@@ -8,9 +8,11 @@
 #include <comm.h>
 #include <config.h>
 #include <db.h>
+#include <fight.h>
 #include <handler.h>
 #include <recycle.h>
 
+#include <entities/event.h>
 #include <entities/object.h>
 
 #include <data/mobile_data.h>
@@ -34,16 +36,6 @@ Mobile* new_mobile()
     init_list(&mob->objects);
 
     mob->short_descr = &str_empty[0];
-    SET_NATIVE_FIELD(&mob->header, mob->short_descr, short_desc, STR);
-
-    SET_NATIVE_FIELD(&mob->header, mob->hit, hp, I16);
-    SET_NATIVE_FIELD(&mob->header, mob->max_hit, max_hp, I16);
-    SET_NATIVE_FIELD(&mob->header, mob->race, race, I16);
-    SET_NATIVE_FIELD(&mob->header, mob->level, level, I16);
-    SET_NATIVE_FIELD(&mob->header, mob->faction_vnum, faction, I32);
-
-    SET_LOX_FIELD(&mob->header, mob->in_room, in_room);
-    SET_LOX_FIELD(&mob->header, mob->was_in_room, was_in_room);
 
     mob->mob_list_node = list_push_back(&mob_list, OBJ_VAL(mob));
 
@@ -88,6 +80,10 @@ void free_mobile(Mobile* mob)
         affect_remove(mob, affect);
     }
 
+    remove_combatant(mob);
+    cancel_entity_timers(&mob->header);
+    free_event_index(&mob->header);
+
     free_string(mob->short_descr);
     free_string(mob->long_descr);
     free_string(mob->description);
@@ -201,7 +197,7 @@ Mobile* create_mobile(MobPrototype* p_mob_proto)
     VNUM_FIELD(mob) = VNUM_FIELD(p_mob_proto);
 
     if (p_mob_proto->header.klass != NULL) {
-        mob->header.klass = p_mob_proto->header.klass;
+        set_entity_class(&mob->header, p_mob_proto->header.klass);
         init_entity_class((Entity*)mob);
     }
 
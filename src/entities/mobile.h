@@ -34,6 +34,31 @@ typedef struct mobile_t Mobile;
 
 #include <stdbool.h>
 
+// What get_curr_stat() works out from the race and class tables. It is
+// rebuilt when the mobile's level, race, class or NPC-ness no longer match
+// the ones it was built for, or when derived_stats_gen has moved on (see
+// invalidate_derived_stats()).
+//
+// Only the caps are kept here. armor[], hitroll and damroll are already kept
+// up to date by affect_modify() as affects and worn gear come and go, so
+// GET_AC() and GET_HITROLL() are a field read plus a cached cap. get_skill()
+// reads learned[] or the NPC rule table, and its daze and drunk penalties
+// change from round to round, so caching its result would save nothing.
+typedef struct mobile_stats_t {
+    uint32_t gen;
+    LEVEL level;
+    int16_t race;
+    int16_t ch_class;
+    bool npc;
+    int16_t max_stat[STAT_COUNT];
+} MobileStats;
+
+// Skills below AFFECT_SKILL_WORDS * 64 get a bit in Mobile.affect_skills while
+// any affect of that type is in Mobile.affected; higher ones are looked up in
+// the list.
+#define AFFECT_SKILL_WORDS  4
+#define AFFECT_SKILL_BITS   (AFFECT_SKILL_WORDS * 64)
+
 typedef struct mobile_t {
     Entity header;
     Mobile* next;
@@ -42,6 +67,8 @@ typedef struct mobile_t {
     Mobile* master;
     Mobile* leader;
     Mobile* fighting;
+    Mobile* combat_next;        // Everyone fighting; see set_fighting()
+    Mobile** combat_pprev;
     Mobile* reply;
     Mobile* pet;
     Mobile* mprog_target;
@@ -50,6 +77,7 @@ typedef struct mobile_t {
     MobPrototype* prototype;
     Descriptor* desc;
     Affect* affected;
+    uint64_t affect_skills[AFFECT_SKILL_WORDS];    // See is_affected()
     NoteData* pnote;
     Object* on;
     Room* in_room;
@@ -107,6 +135,7 @@ typedef struct mobile_t {
     int16_t wimpy;
     int16_t perm_stat[STAT_COUNT];
     int16_t mod_stat[STAT_COUNT];
+    MobileStats derived;
     int16_t invis_level;
     int16_t incog_level;
     int16_t timer;
@@ -120,6 +149,7 @@ typedef struct mobile_t {
     int16_t gold;
     int16_t silver;
     int16_t copper;
+    bool room_aggressor;    // Counted in in_room->aggressors
     bool valid;
 } Mobile;
 
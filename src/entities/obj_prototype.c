@@ -102,8 +102,6 @@ ObjPrototype* new_object_prototype()
 
     init_header(&obj_proto->header, OBJ_OBJ_PROTO);
 
-    SET_NATIVE_FIELD(&obj_proto->header, obj_proto->header.vnum, vnum, I32);
-
     SET_NAME(obj_proto, lox_string("no name"));
     
     obj_proto->short_descr = fBootDb ? boot_intern_string("(no short description)")
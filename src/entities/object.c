@@ -5,6 +5,8 @@
 
 #include "object.h"
 
+#include "event.h"
+
 #include <db.h>
 #include <handler.h>
 #include <lookup.h>
@@ -29,13 +31,8 @@ Object* new_object()
 
     SET_NAME(obj, lox_empty_string);
 
-    SET_NATIVE_FIELD(&obj->header, obj->header.vnum, vnum, I32);
-
     init_list(&obj->objects);
 
-    SET_NATIVE_FIELD(&obj->header, obj->short_descr, short_desc, STR);
-    SET_NATIVE_FIELD(&obj->header, obj->in_room, in_room, OBJ);
-
     obj->obj_list_node = list_push_back(&obj_list, OBJ_VAL(obj));
 
     VALIDATE(obj);
@@ -65,6 +62,9 @@ void free_object(Object* obj)
     }
     obj->extra_desc = NULL;
 
+    cancel_entity_timers(&obj->header);
+    free_event_index(&obj->header);
+
     if (obj->craft_mats != NULL) {
         free(obj->craft_mats);
         obj->craft_mats = NULL;
@@ -223,7 +223,7 @@ Object* create_object(ObjPrototype* obj_proto, LEVEL level)
     VNUM_FIELD(obj) = VNUM_FIELD(obj_proto);
 
     if (obj_proto->header.klass != NULL) {
-        obj->header.klass = obj_proto->header.klass;
+        set_entity_class(&obj->header, obj_proto->header.klass);
         init_entity_class((Entity*)obj);
     }
 
@@ -120,27 +120,22 @@ Room* new_room(RoomData* room_data, Area* area)
     init_header(&room->header, OBJ_ROOM);
 
     init_list(&room->mobiles);
-    SET_LOX_FIELD(&room->header, &room->mobiles, mobiles);
-
+    init_list(&room->listeners);
     init_list(&room->objects);
-    SET_LOX_FIELD(&room->header, &room->objects, objects);
 
     init_list(&room->inbound_exits);
 
     SET_NAME(room, NAME_FIELD(room_data));
 
     VNUM_FIELD(room) = VNUM_FIELD(room_data);
-    SET_NATIVE_FIELD(&room->header, room->header.vnum, vnum, I32);
-
     room->area = area;
-    SET_LOX_FIELD(&room->header, room->area, area);
 
     table_set_vnum(&area->rooms, VNUM_FIELD(room), OBJ_VAL(room));
 
     room->data = room_data;
 
     if (room_data->header.klass != NULL) {
-        room->header.klass = room_data->header.klass;
+        set_entity_class(&room->header, room_data->header.klass);
         init_entity_class((Entity*)room);
     }
 
@@ -156,6 +151,9 @@ void free_room(Room* room)
 {
     Area* area = room->area;
 
+    cancel_entity_timers(&room->header);
+    free_event_index(&room->header);
+
     // Clean up outbound exits
     for (Direction dir = 0; dir < DIR_MAX; dir++) {
         if (room->exit[dir]) {
@@ -188,6 +186,7 @@ void free_room(Room* room)
     }
 
     free_list(&room->inbound_exits);
+    free_list(&room->listeners);
     list_remove_value(&room->data->instances, OBJ_VAL(room));
     table_delete_vnum(&area->rooms, VNUM_FIELD(room));
 
@@ -455,7 +454,6 @@ RoomData* new_room_data()
     init_header(&room_data->header, OBJ_ROOM_DATA);
 
     init_list(&room_data->instances);
-    SET_LOX_FIELD(&room_data->header, &room_data->instances, instances);
 
     SET_NAME(room_data, lox_empty_string);
     room_data->description = &str_empty[0];
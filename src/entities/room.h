@@ -61,16 +61,33 @@ typedef enum room_flags_t {
     ROOM_RECALL         = BIT(20),
 } RoomFlags;
 
+// Per-room scratch space for pathfind.c. A field is only meaningful when its
+// stamp or generation matches the current one, so nothing has to be cleared
+// between searches.
+typedef struct path_node_t {
+    uint32_t stamp;         // Search that last reached this room
+    uint32_t index_gen;     // Graph generation 'index' was assigned in
+    int32_t index;          // Column in the landmark tables
+    int32_t cost;           // Steps (or cost) from the side that reached it
+    int16_t steps;
+    int8_t first_dir;       // First step from the source toward this room
+    uint8_t side;           // Which end of the search reached it
+} PathNode;
+
 typedef struct room_t {
     Entity header;
     Room* next;
     List mobiles;
+    List listeners;      // The mobiles act() talks to; see is_act_listener()
     List objects;
     List inbound_exits;  // RoomExit* pointing TO this room
     RoomData* data;
     Area* area;
     RoomExit* exit[DIR_MAX];
+    PathNode path;
     int16_t light;
+    int16_t aggressors;     // NPCs that aggr_update() has to look at
+    uint32_t listener_epoch;
 } Room;
 
 typedef struct room_data_t {
@@ -6,6 +6,7 @@
 #include "room_exit.h"
 
 #include <db.h>
+#include <pathfind.h>
 
 #include <lox/vm.h>
 
@@ -51,6 +52,7 @@ RoomExit* new_room_exit(RoomExitData* room_exit_data, Room* from)
     // Add to target room's inbound exits list
     if (room_exit->to_room) {
         list_push_back(&room_exit->to_room->inbound_exits, OBJ_VAL(room_exit));
+        path_graph_changed();
     }
 
     gc_protect_clear();
@@ -65,6 +67,7 @@ void free_room_exit(RoomExit* room_exit)
     // Remove from target room's inbound exits list
     if (room_exit->to_room) {
         list_remove_value(&room_exit->to_room->inbound_exits, OBJ_VAL(room_exit));
+        path_graph_changed();
     }
 
     LIST_FREE(room_exit);
@@ -26,5 +26,8 @@ ShopData* new_shop_data()
 
 void free_shop_data(ShopData* shop)
 {
+    if (shop == NULL)
+        return;
+
     LIST_FREE(shop);
 }
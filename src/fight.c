@@ -117,6 +117,48 @@ void set_fighting(Mobile* ch, Mobile* victim);
 void disarm(Mobile* ch, Mobile* victim);
 bool check_counter(Mobile* ch, Mobile* victim, int dam, int dt);
 
+// Everyone with 'fighting' set, newest first, linked through 'combat_next'
+// and 'combat_pprev'. violence_update() walks this rather than every mobile
+// in the world. Anyone who joins a fight mid-round lands ahead of the round's
+// cursor, so their first round is on the next pulse.
+static Mobile* combatants = NULL;
+
+// The next combatant violence_update() will visit. Leaving combat moves it
+// along, so deaths and extractions mid-round don't derail the walk.
+static Mobile* combat_cursor = NULL;
+
+static void add_combatant(Mobile* ch)
+{
+    if (ch->combat_pprev != NULL)
+        return;
+
+    ch->combat_next = combatants;
+    if (ch->combat_next != NULL)
+        ch->combat_next->combat_pprev = &ch->combat_next;
+    ch->combat_pprev = &combatants;
+    combatants = ch;
+}
+
+void remove_combatant(Mobile* ch)
+{
+    if (ch->combat_pprev == NULL)
+        return;
+
+    if (combat_cursor == ch)
+        combat_cursor = ch->combat_next;
+
+    *ch->combat_pprev = ch->combat_next;
+    if (ch->combat_next != NULL)
+        ch->combat_next->combat_pprev = ch->combat_pprev;
+    ch->combat_next = NULL;
+    ch->combat_pprev = NULL;
+}
+
+Mobile* first_combatant()
+{
+    return combatants;
+}
+
 // Crafting material VNUMs for auto-derivation from mob form flags
 #define VNUM_CRAFT_RAW_HIDE   101
 #define VNUM_CRAFT_RAW_MEAT   104
@@ -159,14 +201,20 @@ void violence_update()
     Mobile* ch;
     Mobile* victim;
 
-    FOR_EACH_GLOBAL_MOB(ch) {
+    combat_cursor = combatants;
+    while ((ch = combat_cursor) != NULL) {
+        combat_cursor = ch->combat_next;
+
         if (ch->fighting == NULL || ch->in_room == NULL) 
             continue;
 
         victim = ch->fighting;
 
-        if (IS_AWAKE(ch) && ch->in_room == victim->in_room)
+        if (IS_AWAKE(ch) && ch->in_room == victim->in_room) {
+            begin_combat_batch();
             multi_hit(ch, victim, TYPE_UNDEFINED);
+            end_combat_batch();
+        }
         else
             stop_fighting(ch, false);
 
@@ -978,23 +1026,35 @@ void set_fighting(Mobile* ch, Mobile* victim)
 
     ch->fighting = victim;
     ch->position = POS_FIGHTING;
+    add_combatant(ch);
 
     return;
 }
 
+static void end_fighting(Mobile* ch)
+{
+    remove_combatant(ch);
+    ch->fighting = NULL;
+    ch->position = IS_NPC(ch) ? ch->default_pos : POS_STANDING;
+    update_pos(ch);
+}
+
 // Stop fights.
 void stop_fighting(Mobile* ch, bool fBoth)
 {
     Mobile* fch;
+    Mobile* fch_next;
 
-    FOR_EACH_GLOBAL_MOB(fch) {
-        if (fch == ch || (fBoth && fch->fighting == ch)) {
-            fch->fighting = NULL;
-            fch->position = IS_NPC(fch) ? fch->default_pos : POS_STANDING;
-            update_pos(fch);
+    if (fBoth) {
+        for (fch = combatants; fch != NULL; fch = fch_next) {
+            fch_next = fch->combat_next;
+            if (fch != ch && fch->fighting == ch)
+                end_fighting(fch);
         }
     }
 
+    end_fighting(ch);
+
     return;
 }
 
@@ -1558,6 +1618,157 @@ int xp_compute(Mobile* gch, Mobile* victim, int total_levels)
     return xp;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Combat batches
+//
+// While a batch is open (one attacker's round in violence_update()), players
+// with COMBAT_BRIEF don't get dam_message()'s blow-by-blow. Their blows seen
+// are tallied per attacker and victim instead, and each tally is reported in
+// one line when the batch closes, or before someone goes down.
+////////////////////////////////////////////////////////////////////////////////
+
+#define COMBAT_TALLY_MAX    32
+
+typedef struct combat_tally_t {
+    Mobile* observer;
+    Mobile* attacker;
+    Mobile* victim;
+    int observer_id;
+    int attacker_id;
+    int victim_id;
+    int hits;
+    int misses;
+    int damage;
+} CombatTally;
+
+static CombatTally combat_tallies[COMBAT_TALLY_MAX];
+static int combat_tally_count = 0;
+static int combat_batch_depth = 0;
+
+static void tally_blow(Mobile* observer, Mobile* attacker, Mobile* victim,
+    int dam)
+{
+    CombatTally* tally = NULL;
+
+    for (int i = 0; i < combat_tally_count; i++) {
+        CombatTally* t = &combat_tallies[i];
+        if (t->observer == observer && t->attacker == attacker
+            && t->victim == victim) {
+            tally = t;
+            break;
+        }
+    }
+
+    if (tally == NULL) {
+        if (combat_tally_count == COMBAT_TALLY_MAX)
+            flush_combat_batch();
+
+        tally = &combat_tallies[combat_tally_count++];
+        tally->observer = observer;
+        tally->attacker = attacker;
+        tally->victim = victim;
+        tally->observer_id = observer->id;
+        tally->attacker_id = attacker->id;
+        tally->victim_id = victim->id;
+        tally->hits = 0;
+        tally->misses = 0;
+        tally->damage = 0;
+    }
+
+    if (dam > 0) {
+        tally->hits++;
+        tally->damage += dam;
+    }
+    else
+        tally->misses++;
+}
+
+static const char* times_str(int count, char* buf)
+{
+    if (count == 1)
+        return "once";
+    if (count == 2)
+        return "twice";
+    sprintf(buf, "%d times", count);
+    return buf;
+}
+
+static void report_tally(const CombatTally* t)
+{
+    Mobile* to = t->observer;
+    Mobile* ch = t->attacker;
+    Mobile* victim = t->victim;
+    char subject[MAX_INPUT_LENGTH];
+    char object[MAX_INPUT_LENGTH];
+    char hits[32];
+    char misses[32];
+    char buf[MAX_STRING_LENGTH];
+    const char* color;
+
+    if (to == ch) {
+        color = COLOR_FIGHT_YHIT;
+        strcpy(subject, "You");
+    }
+    else {
+        color = (to == victim) ? COLOR_FIGHT_THIT : COLOR_FIGHT_OHIT;
+        snprintf(subject, sizeof(subject), "%s", PERS(ch, to));
+        subject[0] = UPPER(subject[0]);
+    }
+
+    if (victim == ch)
+        snprintf(object, sizeof(object), "%sself",
+            to == ch ? "your" : sex_table[ch->sex].obj);
+    else if (to == victim)
+        strcpy(object, "you");
+    else
+        snprintf(object, sizeof(object), "%s", PERS(victim, to));
+
+    if (t->hits == 0) {
+        sprintf(buf, "%s%s %s %s %s.%s\n\r", color, subject,
+            to == ch ? "miss" : "misses", object, times_str(t->misses, misses),
+            COLOR_CLEAR);
+    }
+    else {
+        sprintf(buf, "%s%s %s %s %s for %d damage%s%s.%s\n\r", color, subject,
+            to == ch ? "hit" : "hits", object, times_str(t->hits, hits),
+            t->damage, t->misses > 0 ? ", missing " : "",
+            t->misses > 0 ? times_str(t->misses, misses) : "", COLOR_CLEAR);
+    }
+
+    send_to_char(buf, to);
+}
+
+void begin_combat_batch()
+{
+    combat_batch_depth++;
+}
+
+void end_combat_batch()
+{
+    if (--combat_batch_depth == 0)
+        flush_combat_batch();
+}
+
+void flush_combat_batch()
+{
+    for (int i = 0; i < combat_tally_count; i++) {
+        const CombatTally* t = &combat_tallies[i];
+
+        // Skip anyone extracted since.
+        if (!IS_VALID(t->observer) || t->observer->id != t->observer_id
+            || !IS_VALID(t->attacker) || t->attacker->id != t->attacker_id
+            || !IS_VALID(t->victim) || t->victim->id != t->victim_id)
+            continue;
+
+        if (t->observer->desc == NULL || t->observer->position < POS_RESTING)
+            continue;
+
+        report_tally(t);
+    }
+
+    combat_tally_count = 0;
+}
+
 void dam_message(Mobile* ch, Mobile* victim, int dam, int dt, bool immune)
 {
     char buf1[256], buf2[256], buf3[256];
@@ -1702,6 +1913,18 @@ void dam_message(Mobile* ch, Mobile* victim, int dam, int dt, bool immune)
         }
     }
 
+    FLAGS saved_skip = act_skip_comm_flags;
+
+    if (combat_batch_depth > 0 && ch->in_room != NULL) {
+        Mobile* rch;
+        FOR_EACH_ROOM_MOB(rch, ch->in_room) {
+            if (!IS_NPC(rch) && rch->desc != NULL
+                && IS_SET(rch->comm_flags, COMM_COMBAT_BRIEF))
+                tally_blow(rch, ch, victim, dam);
+        }
+        act_skip_comm_flags = COMM_COMBAT_BRIEF;
+    }
+
     if (ch == victim) {
         act(buf1, ch, NULL, NULL, TO_ROOM);
         act(buf2, ch, NULL, NULL, TO_CHAR);
@@ -1712,6 +1935,8 @@ void dam_message(Mobile* ch, Mobile* victim, int dam, int dt, bool immune)
         act(buf3, ch, NULL, victim, TO_VICT);
     }
 
+    act_skip_comm_flags = saved_skip;
+
     return;
 }
 
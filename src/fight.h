@@ -26,6 +26,11 @@ bool check_shield_block(Mobile* ch, Mobile* victim);
 void check_killer(Mobile* ch, Mobile* victim);
 void make_corpse(Mobile* ch);
 void set_fighting(Mobile* ch, Mobile* victim);
+void remove_combatant(Mobile* ch);
+Mobile* first_combatant();
 void raw_kill(Mobile* victim);
+void begin_combat_batch();
+void end_combat_batch();
+void flush_combat_batch();
 
 #endif // !MUD98__FIGHT_H
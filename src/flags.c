@@ -222,6 +222,7 @@ void do_flag(Mobile* ch, char* argument)
             }
         }
         *flag = new;
+        update_room_aggressor(victim);
         return;
     }
 }
@@ -67,6 +67,7 @@ GSN(gsn_recall)
 // GSNs new for Mud98
 GSN(gsn_dual_wield)
 GSN(gsn_counter)
+GSN(gsn_track)
 
 // Gathering skills
 GSN(gsn_skinning)
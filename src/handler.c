@@ -46,6 +46,8 @@
 
 #include <entities/area.h>
 #include <entities/descriptor.h>
+#include <entities/event.h>
+#include <entities/faction.h>
 #include <entities/object.h>
 #include <entities/player_data.h>
 
@@ -61,6 +63,7 @@
 
 #include <ctype.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <time.h>
@@ -312,6 +315,147 @@ bool is_same_clan(Mobile* ch, Mobile* victim)
         return (ch->clan == victim->clan);
 }
 
+uint32_t derived_stats_gen = 1;
+
+void invalidate_derived_stats()
+{
+    // Zero is what a fresh MobileStats has, so it never counts as current.
+    if (++derived_stats_gen == 0)
+        derived_stats_gen = 1;
+}
+
+// How an NPC's skill in each sn is worked out. The first rule that names an sn
+// wins; if its flags don't fit the mobile, it has no skill at all.
+typedef enum npc_skill_rule_t {
+    NPC_SKILL_NONE,
+    NPC_SKILL_SPELL,
+    NPC_SKILL_SNEAK,
+    NPC_SKILL_DODGE,
+    NPC_SKILL_PARRY,
+    NPC_SKILL_SHIELD_BLOCK,
+    NPC_SKILL_SECOND_ATTACK,
+    NPC_SKILL_THIRD_ATTACK,
+    NPC_SKILL_HAND_TO_HAND,
+    NPC_SKILL_TRIP,
+    NPC_SKILL_BASH,
+    NPC_SKILL_DISARM,
+    NPC_SKILL_BERSERK,
+    NPC_SKILL_KICK,
+    NPC_SKILL_BACKSTAB,
+    NPC_SKILL_RESCUE,
+    NPC_SKILL_WEAPON,
+} NpcSkillRule;
+
+static uint8_t* npc_skill_rules = NULL;
+static int npc_skill_rule_count = 0;
+static uint32_t npc_skill_rule_gen = 0;
+
+static NpcSkillRule classify_npc_skill(SKNUM sn)
+{
+    if (HAS_SPELL_FUNC(sn))
+        return NPC_SKILL_SPELL;
+    if (sn == gsn_sneak || sn == gsn_hide)
+        return NPC_SKILL_SNEAK;
+    if (sn == gsn_dodge)
+        return NPC_SKILL_DODGE;
+    if (sn == gsn_parry)
+        return NPC_SKILL_PARRY;
+    if (sn == gsn_shield_block)
+        return NPC_SKILL_SHIELD_BLOCK;
+    if (sn == gsn_second_attack)
+        return NPC_SKILL_SECOND_ATTACK;
+    if (sn == gsn_third_attack)
+        return NPC_SKILL_THIRD_ATTACK;
+    if (sn == gsn_hand_to_hand)
+        return NPC_SKILL_HAND_TO_HAND;
+    if (sn == gsn_trip)
+        return NPC_SKILL_TRIP;
+    if (sn == gsn_bash)
+        return NPC_SKILL_BASH;
+    if (sn == gsn_disarm)
+        return NPC_SKILL_DISARM;
+    if (sn == gsn_berserk)
+        return NPC_SKILL_BERSERK;
+    if (sn == gsn_kick)
+        return NPC_SKILL_KICK;
+    if (sn == gsn_backstab)
+        return NPC_SKILL_BACKSTAB;
+    if (sn == gsn_rescue || sn == gsn_recall)
+        return NPC_SKILL_RESCUE;
+    if (sn == gsn_sword || sn == gsn_dagger || sn == gsn_spear
+        || sn == gsn_mace || sn == gsn_axe || sn == gsn_flail
+        || sn == gsn_whip || sn == gsn_polearm)
+        return NPC_SKILL_WEAPON;
+    return NPC_SKILL_NONE;
+}
+
+static NpcSkillRule npc_skill_rule(SKNUM sn)
+{
+    if (npc_skill_rule_gen != derived_stats_gen
+        || npc_skill_rule_count != skill_count) {
+        free(npc_skill_rules);
+        npc_skill_rules = malloc((size_t)skill_count + 1);
+        if (npc_skill_rules == NULL) {
+            npc_skill_rule_count = 0;
+            return classify_npc_skill(sn);
+        }
+        for (SKNUM i = 0; i < skill_count; i++)
+            npc_skill_rules[i] = (uint8_t)classify_npc_skill(i);
+        npc_skill_rule_count = skill_count;
+        npc_skill_rule_gen = derived_stats_gen;
+    }
+
+    if (sn >= npc_skill_rule_count)
+        return classify_npc_skill(sn);
+
+    return (NpcSkillRule)npc_skill_rules[sn];
+}
+
+static int get_npc_skill(Mobile* ch, SKNUM sn)
+{
+    int level = ch->level;
+
+    switch (npc_skill_rule(sn)) {
+    case NPC_SKILL_SPELL:
+    case NPC_SKILL_HAND_TO_HAND:
+        return 40 + 2 * level;
+    case NPC_SKILL_SNEAK:
+        return level * 2 + 20;
+    case NPC_SKILL_DODGE:
+        return IS_SET(ch->atk_flags, ATK_DODGE) ? level * 2 : 0;
+    case NPC_SKILL_PARRY:
+        return IS_SET(ch->atk_flags, ATK_PARRY) ? level * 2 : 0;
+    case NPC_SKILL_SHIELD_BLOCK:
+        return 10 + 2 * level;
+    case NPC_SKILL_SECOND_ATTACK:
+        return (IS_SET(ch->act_flags, ACT_WARRIOR)
+                || IS_SET(ch->act_flags, ACT_THIEF)) ? 10 + 3 * level : 0;
+    case NPC_SKILL_THIRD_ATTACK:
+        return IS_SET(ch->act_flags, ACT_WARRIOR) ? 4 * level - 40 : 0;
+    case NPC_SKILL_TRIP:
+        return IS_SET(ch->atk_flags, ATK_TRIP) ? 10 + 3 * level : 0;
+    case NPC_SKILL_BASH:
+        return IS_SET(ch->atk_flags, ATK_BASH) ? 10 + 3 * level : 0;
+    case NPC_SKILL_DISARM:
+        return (IS_SET(ch->atk_flags, ATK_DISARM)
+                || IS_SET(ch->act_flags, ACT_WARRIOR)
+                || IS_SET(ch->act_flags, ACT_THIEF)) ? 20 + 3 * level : 0;
+    case NPC_SKILL_BERSERK:
+        return IS_SET(ch->atk_flags, ATK_BERSERK) ? 3 * level : 0;
+    case NPC_SKILL_KICK:
+        return 10 + 3 * level;
+    case NPC_SKILL_BACKSTAB:
+        return IS_SET(ch->act_flags, ACT_THIEF) ? 20 + 2 * level : 0;
+    case NPC_SKILL_RESCUE:
+        return 40 + level;
+    case NPC_SKILL_WEAPON:
+        return 40 + 5 * level / 2;
+    case NPC_SKILL_NONE:
+    default:
+        return 0;
+    }
+}
+
 /* for returning skill information */
 int get_skill(Mobile* ch, SKNUM sn)
 {
@@ -333,64 +477,7 @@ int get_skill(Mobile* ch, SKNUM sn)
     }
     else {
         // Mobiles
-        if (HAS_SPELL_FUNC(sn))
-            skill = 40 + 2 * ch->level;
-
-        else if (sn == gsn_sneak || sn == gsn_hide)
-            skill = ch->level * 2 + 20;
-
-        else if ((sn == gsn_dodge && IS_SET(ch->atk_flags, ATK_DODGE))
-                 || (sn == gsn_parry && IS_SET(ch->atk_flags, ATK_PARRY)))
-            skill = ch->level * 2;
-
-        else if (sn == gsn_shield_block)
-            skill = 10 + 2 * ch->level;
-
-        else if (sn == gsn_second_attack
-                 && (IS_SET(ch->act_flags, ACT_WARRIOR)
-                     || IS_SET(ch->act_flags, ACT_THIEF)))
-            skill = 10 + 3 * ch->level;
-
-        else if (sn == gsn_third_attack && IS_SET(ch->act_flags, ACT_WARRIOR))
-            skill = 4 * ch->level - 40;
-
-        else if (sn == gsn_hand_to_hand)
-            skill = 40 + 2 * ch->level;
-
-        else if (sn == gsn_trip && IS_SET(ch->atk_flags, ATK_TRIP))
-            skill = 10 + 3 * ch->level;
-
-        else if (sn == gsn_bash && IS_SET(ch->atk_flags, ATK_BASH))
-            skill = 10 + 3 * ch->level;
-
-        else if (sn == gsn_disarm
-                 && (IS_SET(ch->atk_flags, ATK_DISARM)
-                     || IS_SET(ch->act_flags, ACT_WARRIOR)
-                     || IS_SET(ch->act_flags, ACT_THIEF)))
-            skill = 20 + 3 * ch->level;
-
-        else if (sn == gsn_berserk && IS_SET(ch->atk_flags, ATK_BERSERK))
-            skill = 3 * ch->level;
-
-        else if (sn == gsn_kick)
-            skill = 10 + 3 * ch->level;
-
-        else if (sn == gsn_backstab && IS_SET(ch->act_flags, ACT_THIEF))
-            skill = 20 + 2 * ch->level;
-
-        else if (sn == gsn_rescue)
-            skill = 40 + ch->level;
-
-        else if (sn == gsn_recall)
-            skill = 40 + ch->level;
-
-        else if (sn == gsn_sword || sn == gsn_dagger || sn == gsn_spear
-                 || sn == gsn_mace || sn == gsn_axe || sn == gsn_flail
-                 || sn == gsn_whip || sn == gsn_polearm)
-            skill = 40 + 5 * ch->level / 2;
-
-        else
-            skill = 0;
+        skill = get_npc_skill(ch, sn);
     }
 
     if (ch->daze > 0) {
@@ -755,33 +842,56 @@ int get_age(Mobile* ch)
     return 17 + (int)(ch->played + (current_time - ch->logon)) / 72000;
 }
 
-/* command for retrieving stats */
-int get_curr_stat(Mobile* ch, Stat stat)
+static const MobileStats* get_derived_stats(Mobile* ch)
 {
-    int max_score;
-    int i = (int)stat;
-    
-    if (i < 0)
-        i = 0;
-    if (i >= STAT_COUNT)
-        i = STAT_COUNT - 1;
+    MobileStats* stats = &ch->derived;
+    bool npc = IS_NPC(ch);
 
-    if (IS_NPC(ch) || ch->level > LEVEL_IMMORTAL)
-        max_score = STAT_MAX;
+    if (stats->gen == derived_stats_gen && stats->level == ch->level
+        && stats->race == ch->race && stats->ch_class == ch->ch_class
+        && stats->npc == npc)
+        return stats;
 
-    else {
-        max_score = race_table[ch->race].max_stats[i] + 4;
+    stats->gen = derived_stats_gen;
+    stats->level = ch->level;
+    stats->race = ch->race;
+    stats->ch_class = ch->ch_class;
+    stats->npc = npc;
+
+    if (npc || ch->level > LEVEL_IMMORTAL) {
+        for (int i = 0; i < STAT_COUNT; i++)
+            stats->max_stat[i] = STAT_MAX;
+        return stats;
+    }
+
+    bool human = ch->race == race_lookup("human");
+    for (int i = 0; i < STAT_COUNT; i++) {
+        int max_score = race_table[ch->race].max_stats[i] + 4;
 
-        if (class_table[ch->ch_class].prime_stat == stat)
+        if ((int)class_table[ch->ch_class].prime_stat == i)
             max_score += 2;
 
-        if (ch->race == race_lookup("human")) 
+        if (human)
             max_score += 1;
 
-        max_score = UMIN(max_score, STAT_MAX);
+        stats->max_stat[i] = (int16_t)UMIN(max_score, STAT_MAX);
     }
 
-    return URANGE(3, ch->perm_stat[i] + ch->mod_stat[i], max_score);
+    return stats;
+}
+
+/* command for retrieving stats */
+int get_curr_stat(Mobile* ch, Stat stat)
+{
+    int i = (int)stat;
+    
+    if (i < 0)
+        i = 0;
+    if (i >= STAT_COUNT)
+        i = STAT_COUNT - 1;
+
+    return URANGE(3, ch->perm_stat[i] + ch->mod_stat[i],
+        get_derived_stats(ch)->max_stat[i]);
 }
 
 /* command for returning max training score */
@@ -887,6 +997,46 @@ bool is_exact_name(char* str, char* namelist)
     }
 }
 
+// Bumped when any act trigger comes or goes; rooms built before then sort
+// their listeners again.
+static uint32_t listener_epoch = 1;
+
+// Could act() ever have anything for this mobile? Players always (whether
+// they're linked is checked per message); NPCs only with an act trigger.
+static bool is_act_listener(Mobile* ch)
+{
+    return !IS_NPC(ch) || HAS_MPROG_TRIGGER(ch, TRIG_ACT)
+        || HAS_EVENT_TRIGGER(ch, TRIG_ACT);
+}
+
+void invalidate_room_listeners()
+{
+    listener_epoch++;
+}
+
+// The mobiles in 'room' that act() should look at, in room order. If
+// triggers changed since the list was made it's rebuilt, unless the caller
+// can't allow that (someone may be walking it); then it gets everyone.
+List* get_room_listeners(Room* room, bool can_rebuild)
+{
+    if (room->listener_epoch == listener_epoch)
+        return &room->listeners;
+
+    if (!can_rebuild)
+        return &room->mobiles;
+
+    free_list(&room->listeners);
+
+    Mobile* ch;
+    FOR_EACH_ROOM_MOB(ch, room) {
+        if (is_act_listener(ch))
+            list_push_back(&room->listeners, OBJ_VAL(ch));
+    }
+
+    room->listener_epoch = listener_epoch;
+    return &room->listeners;
+}
+
 // Move a char out of a room.
 void mob_from_room(Mobile* ch)
 {
@@ -901,6 +1051,14 @@ void mob_from_room(Mobile* ch)
     if (!IS_NPC(ch)) 
         --ch->in_room->area->nplayer;
 
+    if (ch->room_aggressor) {
+        --ch->in_room->aggressors;
+        ch->room_aggressor = false;
+    }
+
+    if (is_act_listener(ch))
+        list_remove_value(&ch->in_room->listeners, OBJ_VAL(ch));
+
     if ((obj = get_eq_char(ch, WEAR_LIGHT)) != NULL
         && obj->item_type == ITEM_LIGHT && obj->light.hours != 0
         && ch->in_room->light > 0)
@@ -950,6 +1108,32 @@ static void update_mdsp_room(Mobile* ch)
         MSDP_TABLE_CLOSE);
 }
 
+// Could this NPC ever start a fight in aggr_update()? Either it's aggressive,
+// or it has a faction that may hate whoever walks in.
+static bool is_potential_aggressor(Mobile* ch)
+{
+    return IS_NPC(ch) && (IS_SET(ch->act_flags, ACT_AGGRESSIVE)
+        || get_mob_faction_vnum(ch) != 0);
+}
+
+// Call when an NPC's act flags or faction change in place, so its room's
+// aggressor count stays right.
+void update_room_aggressor(Mobile* ch)
+{
+    if (ch->in_room == NULL)
+        return;
+
+    bool aggressor = is_potential_aggressor(ch);
+    if (aggressor == ch->room_aggressor)
+        return;
+
+    if (aggressor)
+        ++ch->in_room->aggressors;
+    else
+        --ch->in_room->aggressors;
+    ch->room_aggressor = aggressor;
+}
+
 void transfer_mob(Mobile* ch, Room* room)
 {
     mob_from_room(ch);
@@ -976,6 +1160,9 @@ void mob_to_room(Mobile* ch, Room* room)
 
     ch->in_room = room;
     list_push_back(&room->mobiles, OBJ_VAL(ch));
+    if (is_act_listener(ch))
+        list_push_back(&room->listeners, OBJ_VAL(ch));
+    update_room_aggressor(ch);
 
     if (!test_output_enabled && ch->desc != NULL && ch->desc->mth != NULL) {
         if (!IS_NPC(ch) && ch->desc->mth->msdp_data && cfg_get_msdp_enabled())
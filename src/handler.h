@@ -45,6 +45,11 @@ void reset_char(Mobile* ch);
 LEVEL get_trust(Mobile* ch);
 int get_curr_stat(Mobile* ch, Stat stat);
 int get_max_train(Mobile* ch, Stat stat);
+
+// Bumped whenever the race, class or skill tables change, so cached stat caps
+// and NPC skill rules are rebuilt on their next use.
+extern uint32_t derived_stats_gen;
+void invalidate_derived_stats();
 int can_carry_n(Mobile* ch);
 int can_carry_w(Mobile* ch);
 bool is_name(char* str, char* namelist);
@@ -52,6 +57,9 @@ bool is_exact_name(char* str, char* namelist);
 void transfer_mob(Mobile* ch, Room* room);
 void mob_from_room(Mobile* ch);
 void mob_to_room(Mobile* ch, Room* pRoomIndex);
+void update_room_aggressor(Mobile* ch);
+void invalidate_room_listeners();
+List* get_room_listeners(Room* room, bool can_rebuild);
 void obj_to_char(Object* obj, Mobile* ch);
 void obj_from_char(Object* obj);
 int apply_ac(Object* obj, int iWear, int type);
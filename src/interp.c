@@ -317,16 +317,14 @@ void interpret(Mobile* ch, char* argument)
 /* function to keep argument safe in all commands -- no static strings */
 void do_function(Mobile* ch, DoFunc* do_fun, char* argument)
 {
-    char* command_string;
+    char command_string[MAX_STRING_LENGTH];
 
-    /* copy the string */
-    command_string = str_dup(argument);
+    /* copy the string; str_dup() may share it, so it goes on the stack */
+    strncpy(command_string, argument, sizeof(command_string) - 1);
+    command_string[sizeof(command_string) - 1] = '\0';
 
     /* dispatch the command */
     (*do_fun)(ch, command_string);
-
-    /* free the string */
-    free_string(command_string);
 }
 
 bool check_social(Mobile* ch, char* command, char* argument)
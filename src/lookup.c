@@ -153,7 +153,6 @@ int liquid_lookup(const char* name)
 
 HelpData* help_lookup(char* keyword)
 {
-    HelpData* pHelp;
     char temp[MIL];
     char argall[MIL] = "";
 
@@ -166,11 +165,10 @@ HelpData* help_lookup(char* keyword)
         strcat(argall, temp);
     }
 
-    FOR_EACH(pHelp, help_first)
-        if (is_name(argall, pHelp->keyword))
-            return pHelp;
+    int count;
+    HelpData** helps = find_helps(argall, &count);
 
-    return NULL;
+    return count > 0 ? helps[0] : NULL;
 }
 
 HelpArea* had_lookup(char* arg)
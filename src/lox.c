@@ -11,11 +11,14 @@
 #include <entities/mobile.h>
 
 #include <lox/lox.h>
+#include <lox/memory.h>
 #include <lox/vm.h>
 
+#include <persist/lox/lox_cache.h>
 #include <persist/lox/lox_persist.h>
 
 #include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -95,15 +98,15 @@ bool load_lox_class(FILE* fp, const char* entity_type_name, Entity* entity)
         return false;
     }
     else {
-        entity->klass = klass;
-        entity->script = script;
+        set_entity_class(entity, klass);
+        set_entity_script(entity, script);
         return true;
     }
 }
 
 static void compile_lox_script(const char* source)
 {
-    InterpretResult result = interpret_code(source);
+    InterpretResult result = lox_cache_interpret(source);
 
     switch (result) {
     case INTERPRET_OK:
@@ -344,10 +347,232 @@ static void lox_eval(Mobile* ch, char* argument, bool is_repl)
     compile_context = old_compile_context;
 }
 
+#define LOX_PROFILE_ROWS    20
+
+typedef struct profile_rows_t {
+    ObjFunction** functions;    // NULL while only counting
+    ObjString** classes;
+    int count;
+} ProfileRows;
+
+static void reset_profile(Obj* obj, void* data)
+{
+    (void)data;
+    if (obj->type == OBJ_FUNCTION)
+        memset(&((ObjFunction*)obj)->profile, 0, sizeof(ScriptProfile));
+}
+
+static void collect_profiled(Obj* obj, void* data)
+{
+    ProfileRows* rows = data;
+    if (obj->type != OBJ_FUNCTION || ((ObjFunction*)obj)->profile.calls == 0)
+        return;
+    if (rows->functions != NULL)
+        rows->functions[rows->count] = (ObjFunction*)obj;
+    rows->count++;
+}
+
+// Names the class each reported function is a method of, if any. Only the
+// rows being printed are looked for, so this is one pass over the heap.
+static void name_method_classes(Obj* obj, void* data)
+{
+    ProfileRows* rows = data;
+    if (obj->type != OBJ_CLASS)
+        return;
+
+    Table* methods = &((ObjClass*)obj)->methods;
+    for (int i = 0; i < methods->capacity; i++) {
+        Entry* entry = &methods->entries[i];
+        if (!IS_STRING(entry->key) || !IS_CLOSURE(entry->value))
+            continue;
+        ObjFunction* function = AS_CLOSURE(entry->value)->function;
+        for (int j = 0; j < rows->count; j++)
+            if (rows->functions[j] == function && rows->classes[j] == NULL)
+                rows->classes[j] = ((ObjClass*)obj)->name;
+    }
+}
+
+static int compare_profiles(const void* a, const void* b)
+{
+    const ObjFunction* fa = *(const ObjFunction* const*)a;
+    const ObjFunction* fb = *(const ObjFunction* const*)b;
+
+    if (fa->profile.instructions != fb->profile.instructions)
+        return fa->profile.instructions < fb->profile.instructions ? 1 : -1;
+    if (fa->profile.calls != fb->profile.calls)
+        return fa->profile.calls < fb->profile.calls ? 1 : -1;
+    return 0;
+}
+
+static void lox_profile(Mobile* ch, char* argument)
+{
+    char arg[MAX_INPUT_LENGTH];
+    READ_ARG(arg);
+
+    if (!str_cmp(arg, "reset")) {
+        for_each_object(reset_profile, NULL);
+        send_to_char(COLOR_INFO "Script profile counters cleared." COLOR_EOL, ch);
+        return;
+    }
+
+    if (!str_cmp(arg, "time")) {
+        if (!str_cmp(argument, "on"))
+            cfg_set_lox_profile_time(true);
+        else if (!str_cmp(argument, "off"))
+            cfg_set_lox_profile_time(false);
+        printf_to_char(ch, COLOR_INFO "Script timing is %s." COLOR_EOL,
+            cfg_get_lox_profile_time() ? "on" : "off");
+        return;
+    }
+
+    if (arg[0] != '\0') {
+        send_to_char(COLOR_INFO "USAGE: " COLOR_ALT_TEXT_1 "LOX PROFILE "
+            "[RESET | TIME <ON|OFF>]" COLOR_EOL, ch);
+        return;
+    }
+
+    ProfileRows rows = { 0 };
+    for_each_object(collect_profiled, &rows);
+    int count = rows.count;
+
+    if (count == 0) {
+        send_to_char(COLOR_INFO "No scripts have run since the counters were "
+            "cleared." COLOR_EOL, ch);
+        return;
+    }
+
+    ObjFunction** functions = malloc(sizeof(ObjFunction*) * (size_t)count);
+    if (functions == NULL) {
+        bug("lox_profile: out of memory", 0);
+        return;
+    }
+
+    rows.functions = functions;
+    rows.count = 0;
+    for_each_object(collect_profiled, &rows);
+    int n = rows.count;
+
+    qsort(functions, (size_t)n, sizeof(ObjFunction*), compare_profiles);
+
+    ObjString* classes[LOX_PROFILE_ROWS] = { 0 };
+    rows.classes = classes;
+    rows.count = UMIN(n, LOX_PROFILE_ROWS);
+    for_each_object(name_method_classes, &rows);
+
+    INIT_BUF(buf, MSL);
+    addf_buf(buf, COLOR_TITLE "%10s %12s %9s %10s %10s %5s  %s" COLOR_EOL,
+        "Calls", "Instrs", "Per Call", "Allocs", "usec", "Stops", "Function");
+
+    for (int i = 0; i < n && i < LOX_PROFILE_ROWS; i++) {
+        ObjFunction* function = functions[i];
+        const ScriptProfile* profile = &function->profile;
+        ObjString* klass = classes[i];
+
+        addf_buf(buf, "%10" PRIu64 " %12" PRIu64 " %9" PRIu64 " %10" PRIu64
+            " %10" PRIu64 " %5u  %s%s%s\n\r", profile->calls,
+            profile->instructions, profile->instructions / profile->calls,
+            profile->allocations, profile->usec, profile->aborts,
+            klass ? klass->chars : "", klass ? "." : "",
+            function->name ? function->name->chars : "<script>");
+    }
+
+    if (n > LOX_PROFILE_ROWS)
+        addf_buf(buf, COLOR_INFO "(%d more not shown.)" COLOR_EOL,
+            n - LOX_PROFILE_ROWS);
+    if (!cfg_get_lox_profile_time())
+        addf_buf(buf, COLOR_INFO "Script timing is off; see 'LOX PROFILE "
+            "TIME'." COLOR_EOL);
+
+    page_to_char(buf->string, ch);
+    free_buf(buf);
+    free(functions);
+}
+
+// Class budgets are kept in lox_budget_file, one "<class> <instructions>" line
+// each, ending with '$'. 'lox budget' rewrites the file on every change.
+void load_class_budgets()
+{
+    FILE* fp;
+
+    if (!lox_budget_file_exists())
+        return;
+
+    OPEN_OR_RETURN(fp = open_read_lox_budget_file());
+
+    for (;;) {
+        char* word = fread_word(fp);
+        if (word[0] == '$')
+            break;
+        ObjString* name = lox_string(word);
+        set_class_budget(name, fread_number(fp));
+    }
+
+    close_file(fp);
+}
+
+void save_class_budgets()
+{
+    FILE* fp;
+
+    OPEN_OR_RETURN(fp = open_write_lox_budget_file());
+
+    for (int i = 0; i < vm.class_budgets.capacity; i++) {
+        Entry* entry = &vm.class_budgets.entries[i];
+        if (IS_STRING(entry->key))
+            fprintf(fp, "%s %d\n", AS_STRING(entry->key)->chars, AS_INT(entry->value));
+    }
+    fprintf(fp, "$\n");
+
+    close_file(fp);
+}
+
+static void lox_budget(Mobile* ch, char* argument)
+{
+    char class_name[MAX_INPUT_LENGTH];
+    READ_ARG(class_name);
+
+    if (class_name[0] == '\0') {
+        printf_to_char(ch, COLOR_INFO "Default script budget: " COLOR_ALT_TEXT_1
+            "%d" COLOR_INFO " instructions (0 is unlimited)." COLOR_EOL,
+            cfg_get_lox_budget());
+        for (int i = 0; i < vm.class_budgets.capacity; i++) {
+            Entry* entry = &vm.class_budgets.entries[i];
+            if (IS_STRING(entry->key))
+                printf_to_char(ch, "    %-20s %d\n\r",
+                    AS_STRING(entry->key)->chars, AS_INT(entry->value));
+        }
+        send_to_char(COLOR_INFO "USAGE: " COLOR_ALT_TEXT_1 "LOX BUDGET <class> "
+            "<instructions | default>" COLOR_EOL, ch);
+        return;
+    }
+
+    ObjString* name = lox_string(class_name);
+    if (!str_cmp(argument, "default")) {
+        set_class_budget(name, -1);
+        save_class_budgets();
+        printf_to_char(ch, COLOR_INFO "Class '%s' now uses the default "
+            "budget." COLOR_EOL, name->chars);
+        return;
+    }
+
+    if (!is_number(argument) || atoi(argument) < 0) {
+        send_to_char(COLOR_INFO "The budget must be a number of instructions, "
+            "0 for unlimited, or 'default'." COLOR_EOL, ch);
+        return;
+    }
+
+    set_class_budget(name, atoi(argument));
+    save_class_budgets();
+    printf_to_char(ch, COLOR_INFO "Class '%s' now has a budget of %d "
+        "instructions." COLOR_EOL, name->chars, atoi(argument));
+}
+
 void do_lox(Mobile* ch, char* argument)
 {
     static const char* help =
         COLOR_INFO "USAGE: " COLOR_ALT_TEXT_1 "LOX [EVAL] <expression>\n\r"
+        COLOR_INFO "       " COLOR_ALT_TEXT_1 "LOX PROFILE [RESET | TIME <ON|OFF>]\n\r"
+        COLOR_INFO "       " COLOR_ALT_TEXT_1 "LOX BUDGET [<class> <instructions | default>]\n\r"
         COLOR_INFO "\n\r"
         "Type '" COLOR_ALT_TEXT_1 "LOX EVAL returns a value." COLOR_EOL;
 
@@ -357,6 +582,17 @@ void do_lox(Mobile* ch, char* argument)
     if (!ch->pcdata)
         return;
 
+    char* rest = one_argument(argument, arg);
+    if (!str_cmp(arg, "profile")) {
+        lox_profile(ch, rest);
+        return;
+    }
+    if (!str_cmp(arg, "budget")) {
+        lox_budget(ch, rest);
+        return;
+    }
+    arg[0] = '\0';
+
     if (!str_prefix(argument, "eval")) {
         READ_ARG(arg);
     }
@@ -33,6 +33,7 @@ void write_value_array(ValueArray* array, Value value)
             array->capacity);
     }
 
+    GC_BARRIER(value);
     array->values[array->count] = value;
     array->count++;
 }
@@ -0,0 +1,628 @@
+////////////////////////////////////////////////////////////////////////////////
+// lox/bytecode.c
+//
+// Image layout (all integers little-endian):
+//
+//   "LOXC" u32 version  u64 build_id  u64 source_hash  u64 payload_hash
+//   payload:
+//     u32 count { string name, u32 size, value }   Global consts read
+//     u32 count { string name }                    Names that weren't consts
+//     function                                     The script itself
+//     u32 count { string name, value }             Global consts defined
+//
+// A function is its arity, upvalue count, name, code, line numbers (as runs),
+// constants, and the number of inline caches its call sites use. Values are a
+// tag byte followed by the value; functions nest as constants.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "bytecode.h"
+
+#include "enum.h"
+#include "memory.h"
+#include "native.h"
+#include "vm.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+extern Table global_const_table;
+
+#define FNV64_BASIS     0xcbf29ce484222325ULL
+#define FNV64_PRIME     0x100000001b3ULL
+
+#define HEADER_SIZE     32
+
+typedef enum {
+    TAG_NIL,
+    TAG_FALSE,
+    TAG_TRUE,
+    TAG_INT,
+    TAG_DOUBLE,
+    TAG_STRING,
+    TAG_FUNCTION,
+    TAG_ENUM,
+} ValueTag;
+
+typedef struct {
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    bool ok;
+} Reader;
+
+static uint64_t hash_bytes(uint64_t hash, const void* data, size_t len)
+{
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+// The build ID covers everything besides the source that the compiled code
+// depends on: the bytecode format version, the opcode count, and the entity
+// native methods that entity class compiles resolve by name. It does not
+// change just because the server was rebuilt.
+uint64_t bytecode_build_id()
+{
+    static uint64_t build_id = 0;
+
+    if (build_id != 0)
+        return build_id;
+
+    uint64_t hash = FNV64_BASIS;
+    const uint32_t layout[] = {
+        LOX_BYTECODE_VERSION, OP_LESS_JUMP, (uint32_t)sizeof(Value),
+    };
+    hash = hash_bytes(hash, layout, sizeof(layout));
+
+    for (int i = 0; i < native_methods.capacity; i++) {
+        Entry* entry = &native_methods.entries[i];
+        if (IS_STRING(entry->key)) {
+            ObjString* name = AS_STRING(entry->key);
+            hash = hash_bytes(hash, name->chars, (size_t)name->length + 1);
+        }
+    }
+
+    build_id = hash;
+    return build_id;
+}
+
+uint64_t bytecode_source_hash(const char* source, uint32_t flags)
+{
+    uint64_t hash = hash_bytes(FNV64_BASIS, &flags, sizeof(flags));
+    return hash_bytes(hash, source, strlen(source));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writing
+////////////////////////////////////////////////////////////////////////////////
+
+static void put_bytes(BytecodeBuffer* buf, const void* data, size_t len)
+{
+    if (buf->len + len > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 1024;
+        while (cap < buf->len + len)
+            cap *= 2;
+        uint8_t* data_ = realloc(buf->data, cap);
+        if (data_ == NULL) {
+            bug("put_bytes: could not grow bytecode buffer to %zu bytes.", cap);
+            exit(1);
+        }
+        buf->data = data_;
+        buf->cap = cap;
+    }
+
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static void put_u8(BytecodeBuffer* buf, uint8_t value)
+{
+    put_bytes(buf, &value, 1);
+}
+
+static void put_u32(BytecodeBuffer* buf, uint32_t value)
+{
+    uint8_t bytes[4];
+    for (int i = 0; i < 4; i++)
+        bytes[i] = (uint8_t)(value >> (8 * i));
+    put_bytes(buf, bytes, sizeof(bytes));
+}
+
+static void put_u64(BytecodeBuffer* buf, uint64_t value)
+{
+    put_u32(buf, (uint32_t)value);
+    put_u32(buf, (uint32_t)(value >> 32));
+}
+
+static void set_u32(BytecodeBuffer* buf, size_t at, uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+        buf->data[at + i] = (uint8_t)(value >> (8 * i));
+}
+
+static void put_string(BytecodeBuffer* buf, ObjString* string)
+{
+    put_u32(buf, (uint32_t)string->length);
+    put_bytes(buf, string->chars, (size_t)string->length);
+}
+
+typedef struct {
+    ObjString* name;
+    int32_t value;
+} EnumMember;
+
+static int compare_members(const void* a, const void* b)
+{
+    const EnumMember* left = a;
+    const EnumMember* right = b;
+    if (left->value != right->value)
+        return left->value < right->value ? -1 : 1;
+    return strcmp(left->name->chars, right->name->chars);
+}
+
+// Members are written in value order so an enum serializes the same way
+// however its table happens to be laid out.
+static bool put_enum(BytecodeBuffer* buf, ObjEnum* enum_obj)
+{
+    Table* values = &enum_obj->values;
+    EnumMember* members = calloc((size_t)values->count + 1, sizeof(EnumMember));
+    if (members == NULL)
+        return false;
+
+    int count = 0;
+    for (int i = 0; i < values->capacity; i++) {
+        Entry* entry = &values->entries[i];
+        if (!IS_STRING(entry->key))
+            continue;
+        if (!IS_INT(entry->value)) {
+            free(members);
+            return false;
+        }
+        members[count].name = AS_STRING(entry->key);
+        members[count].value = AS_INT(entry->value);
+        count++;
+    }
+    qsort(members, (size_t)count, sizeof(EnumMember), compare_members);
+
+    put_u8(buf, TAG_ENUM);
+    put_string(buf, enum_obj->name);
+    put_u32(buf, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        put_string(buf, members[i].name);
+        put_u32(buf, (uint32_t)members[i].value);
+    }
+
+    free(members);
+    return true;
+}
+
+static bool put_function(BytecodeBuffer* buf, ObjFunction* function);
+
+static bool put_value(BytecodeBuffer* buf, Value value)
+{
+    if (IS_NIL(value)) {
+        put_u8(buf, TAG_NIL);
+    }
+    else if (IS_BOOL(value)) {
+        put_u8(buf, AS_BOOL(value) ? TAG_TRUE : TAG_FALSE);
+    }
+    else if (IS_INT(value)) {
+        put_u8(buf, TAG_INT);
+        put_u32(buf, (uint32_t)AS_INT(value));
+    }
+    else if (IS_DOUBLE(value)) {
+        double d = AS_DOUBLE(value);
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        put_u8(buf, TAG_DOUBLE);
+        put_u64(buf, bits);
+    }
+    else if (IS_STRING(value)) {
+        put_u8(buf, TAG_STRING);
+        put_string(buf, AS_STRING(value));
+    }
+    else if (IS_FUNCTION(value)) {
+        put_u8(buf, TAG_FUNCTION);
+        return put_function(buf, AS_FUNCTION(value));
+    }
+    else if (IS_ENUM(value)) {
+        return put_enum(buf, AS_ENUM(value));
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+static bool put_function(BytecodeBuffer* buf, ObjFunction* function)
+{
+    Chunk* chunk = &function->chunk;
+
+    put_u32(buf, (uint32_t)function->arity);
+    put_u32(buf, (uint32_t)function->upvalue_count);
+    put_u8(buf, function->name != NULL);
+    if (function->name != NULL)
+        put_string(buf, function->name);
+
+    put_u32(buf, (uint32_t)chunk->count);
+    put_bytes(buf, chunk->code, (size_t)chunk->count);
+
+    // Line numbers as (line, length) runs; most instructions share a line
+    // with their neighbors.
+    size_t runs_at = buf->len;
+    uint32_t runs = 0;
+    put_u32(buf, 0);
+    for (int i = 0; i < chunk->count; ) {
+        int start = i;
+        while (i < chunk->count && chunk->lines[i] == chunk->lines[start])
+            i++;
+        put_u32(buf, (uint32_t)chunk->lines[start]);
+        put_u32(buf, (uint32_t)(i - start));
+        runs++;
+    }
+    set_u32(buf, runs_at, runs);
+
+    put_u32(buf, (uint32_t)chunk->constants.count);
+    for (int i = 0; i < chunk->constants.count; i++)
+        if (!put_value(buf, chunk->constants.values[i]))
+            return false;
+
+    put_u32(buf, (uint32_t)chunk->cache_count);
+    return true;
+}
+
+static bool put_const_table(BytecodeBuffer* buf, Table* table, bool with_size)
+{
+    size_t count_at = buf->len;
+    uint32_t count = 0;
+    put_u32(buf, 0);
+
+    for (int i = 0; i < table->capacity; i++) {
+        Entry* entry = &table->entries[i];
+        if (!IS_STRING(entry->key))
+            continue;
+
+        put_string(buf, AS_STRING(entry->key));
+        if (with_size) {
+            // Sized, so a load can compare the stored value's bytes with
+            // the current value's without parsing it.
+            size_t size_at = buf->len;
+            put_u32(buf, 0);
+            if (!put_value(buf, entry->value))
+                return false;
+            set_u32(buf, size_at, (uint32_t)(buf->len - size_at - 4));
+        }
+        else if (!put_value(buf, entry->value)) {
+            return false;
+        }
+        count++;
+    }
+
+    set_u32(buf, count_at, count);
+    return true;
+}
+
+bool write_bytecode_image(BytecodeBuffer* out, const BytecodeKey* key,
+    ObjFunction* function, CompileDeps* deps)
+{
+    out->len = 0;
+
+    put_bytes(out, "LOXC", 4);
+    put_u32(out, LOX_BYTECODE_VERSION);
+    put_u64(out, key->build_id);
+    put_u64(out, key->source_hash);
+    put_u64(out, 0);
+
+    if (!put_const_table(out, &deps->const_reads, true))
+        return false;
+
+    size_t count_at = out->len;
+    uint32_t count = 0;
+    put_u32(out, 0);
+    for (int i = 0; i < deps->const_misses.capacity; i++) {
+        Entry* entry = &deps->const_misses.entries[i];
+        if (IS_STRING(entry->key)) {
+            put_string(out, AS_STRING(entry->key));
+            count++;
+        }
+    }
+    set_u32(out, count_at, count);
+
+    if (!put_function(out, function))
+        return false;
+
+    if (!put_const_table(out, &deps->const_defines, false))
+        return false;
+
+    uint64_t payload_hash = hash_bytes(FNV64_BASIS, out->data + HEADER_SIZE,
+        out->len - HEADER_SIZE);
+    for (int i = 0; i < 8; i++)
+        out->data[24 + i] = (uint8_t)(payload_hash >> (8 * i));
+
+    return true;
+}
+
+void free_bytecode_buffer(BytecodeBuffer* buf)
+{
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reading
+////////////////////////////////////////////////////////////////////////////////
+
+static const uint8_t* get_bytes(Reader* r, size_t len)
+{
+    if (!r->ok || r->len - r->pos < len) {
+        r->ok = false;
+        return NULL;
+    }
+
+    const uint8_t* bytes = r->data + r->pos;
+    r->pos += len;
+    return bytes;
+}
+
+static uint8_t get_u8(Reader* r)
+{
+    const uint8_t* bytes = get_bytes(r, 1);
+    return bytes ? bytes[0] : 0;
+}
+
+static uint32_t get_u32(Reader* r)
+{
+    const uint8_t* bytes = get_bytes(r, 4);
+    if (bytes == NULL)
+        return 0;
+
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (uint32_t)bytes[i] << (8 * i);
+    return value;
+}
+
+static uint64_t get_u64(Reader* r)
+{
+    uint64_t low = get_u32(r);
+    return low | ((uint64_t)get_u32(r) << 32);
+}
+
+static ObjString* get_string(Reader* r)
+{
+    uint32_t length = get_u32(r);
+    if (length > INT32_MAX) {
+        r->ok = false;
+        return NULL;
+    }
+
+    const uint8_t* chars = get_bytes(r, length);
+    if (chars == NULL)
+        return NULL;
+
+    return copy_string((const char*)chars, (int)length);
+}
+
+static ObjFunction* get_function(Reader* r);
+
+static Value get_enum(Reader* r)
+{
+    ObjString* name = get_string(r);
+    if (name == NULL)
+        return NIL_VAL;
+
+    push(OBJ_VAL(name));
+    ObjEnum* enum_obj = new_enum(name);
+    pop();
+    push(OBJ_VAL(enum_obj));
+
+    uint32_t count = get_u32(r);
+    for (uint32_t i = 0; i < count && r->ok; i++) {
+        ObjString* member = get_string(r);
+        int32_t value = (int32_t)get_u32(r);
+        if (member != NULL && r->ok) {
+            GC_BARRIER_OBJ(member);
+            table_set(&enum_obj->values, member, INT_VAL(value));
+        }
+    }
+
+    pop();
+    return OBJ_VAL(enum_obj);
+}
+
+static Value get_value(Reader* r)
+{
+    switch (get_u8(r)) {
+    case TAG_NIL:       return NIL_VAL;
+    case TAG_FALSE:     return FALSE_VAL;
+    case TAG_TRUE:      return TRUE_VAL;
+    case TAG_INT:       return INT_VAL((int32_t)get_u32(r));
+    case TAG_DOUBLE: {
+            uint64_t bits = get_u64(r);
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            return DOUBLE_VAL(d);
+        }
+    case TAG_STRING: {
+            ObjString* string = get_string(r);
+            return string ? OBJ_VAL(string) : NIL_VAL;
+        }
+    case TAG_FUNCTION: {
+            ObjFunction* function = get_function(r);
+            return function ? OBJ_VAL(function) : NIL_VAL;
+        }
+    case TAG_ENUM:
+        return get_enum(r);
+    default:
+        r->ok = false;
+        return NIL_VAL;
+    }
+}
+
+static ObjFunction* get_function(Reader* r)
+{
+    ObjFunction* function = new_function();
+    push(OBJ_VAL(function));
+    Chunk* chunk = &function->chunk;
+
+    function->arity = (int)get_u32(r);
+    function->upvalue_count = (int)get_u32(r);
+    if (get_u8(r)) {
+        function->name = get_string(r);
+        GC_BARRIER_OBJ(function->name);
+    }
+
+    uint32_t count = get_u32(r);
+    const uint8_t* code = get_bytes(r, count);
+
+    uint32_t runs = get_u32(r);
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < runs && r->ok; i++) {
+        int line = (int)get_u32(r);
+        uint32_t length = get_u32(r);
+        if (!r->ok || length > count - written) {
+            r->ok = false;
+            break;
+        }
+        for (uint32_t j = 0; j < length; j++)
+            write_chunk(chunk, code[written++], line);
+    }
+    if (written != count)
+        r->ok = false;
+
+    uint32_t constants = get_u32(r);
+    for (uint32_t i = 0; i < constants && r->ok; i++) {
+        Value value = get_value(r);
+        if (!r->ok)
+            break;
+        GC_BARRIER(value);
+        add_constant(chunk, value);
+    }
+
+    uint32_t caches = get_u32(r);
+    if (caches > MAX_INLINE_CACHES)
+        r->ok = false;
+    for (uint32_t i = 0; i < caches && r->ok; i++)
+        add_inline_cache(chunk);
+
+    pop();
+    return r->ok ? function : NULL;
+}
+
+bool read_bytecode_key(const uint8_t* data, size_t len, BytecodeKey* key)
+{
+    Reader r = { data, len, 0, true };
+
+    const uint8_t* magic = get_bytes(&r, 4);
+    if (magic == NULL || memcmp(magic, "LOXC", 4) != 0
+        || get_u32(&r) != LOX_BYTECODE_VERSION)
+        return false;
+
+    key->build_id = get_u64(&r);
+    key->source_hash = get_u64(&r);
+    return r.ok;
+}
+
+// True if every global const the image was compiled against still has the
+// value it had then, and none of the names it found unbound have since become
+// consts.
+static bool check_const_deps(Reader* r)
+{
+    BytecodeBuffer current = { 0 };
+    bool ok = true;
+
+    uint32_t reads = get_u32(r);
+    for (uint32_t i = 0; i < reads && r->ok && ok; i++) {
+        ObjString* name = get_string(r);
+        uint32_t size = get_u32(r);
+        const uint8_t* stored = get_bytes(r, size);
+        Value value;
+
+        if (!r->ok)
+            break;
+
+        current.len = 0;
+        ok = table_get(&global_const_table, name, &value)
+            && put_value(&current, value)
+            && current.len == size
+            && memcmp(current.data, stored, size) == 0;
+    }
+
+    uint32_t misses = get_u32(r);
+    for (uint32_t i = 0; i < misses && r->ok && ok; i++) {
+        ObjString* name = get_string(r);
+        Value value;
+        if (name != NULL && table_get(&global_const_table, name, &value))
+            ok = false;
+    }
+
+    free_bytecode_buffer(&current);
+    return ok;
+}
+
+ObjFunction* load_bytecode_image(const uint8_t* data, size_t len, bool* stale)
+{
+    BytecodeKey key;
+
+    *stale = false;
+    if (len < HEADER_SIZE || !read_bytecode_key(data, len, &key))
+        return NULL;
+
+    Reader r = { data, len, HEADER_SIZE - 8, true };
+    uint64_t payload_hash = get_u64(&r);
+    if (hash_bytes(FNV64_BASIS, data + HEADER_SIZE, len - HEADER_SIZE)
+        != payload_hash)
+        return NULL;
+
+    if (!check_const_deps(&r)) {
+        *stale = r.ok;
+        return NULL;
+    }
+
+    ObjFunction* function = get_function(&r);
+    if (function == NULL)
+        return NULL;
+    push(OBJ_VAL(function));
+
+    // Read every definition before making any, so a damaged image defines
+    // nothing.
+    ValueArray* defines = new_obj_array();
+    push(OBJ_VAL(defines));
+    uint32_t count = get_u32(&r);
+    for (uint32_t i = 0; i < count && r.ok; i++) {
+        // Growing the array can run a collection, so each value stays on the
+        // stack until it's stored.
+        ObjString* name = get_string(&r);
+        if (name == NULL)
+            break;
+        push(OBJ_VAL(name));
+        GC_BARRIER_OBJ(name);
+        write_value_array(defines, OBJ_VAL(name));
+        pop();
+        Value value = get_value(&r);
+        push(value);
+        GC_BARRIER(value);
+        write_value_array(defines, value);
+        pop();
+    }
+
+    if (r.ok && r.pos == r.len) {
+        for (int i = 0; i + 1 < defines->count; i += 2) {
+            table_set(&global_const_table, AS_STRING(defines->values[i]),
+                defines->values[i + 1]);
+        }
+    }
+    else {
+        function = NULL;
+    }
+
+    pop();
+    pop();
+    return function;
+}
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+// lox/bytecode.h
+// Serialized compiled scripts (.loxc images) for the bytecode cache.
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__LOX__BYTECODE_H
+#define MUD98__LOX__BYTECODE_H
+
+#include "compiler.h"
+#include "function.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LOX_BYTECODE_EXT        "loxc"
+
+// Bump whenever the image layout changes, an opcode is added, removed or
+// renumbered, an opcode's operand encoding changes, or the compiler starts
+// emitting different code for the same source. Cached images from another
+// version are recompiled.
+#define LOX_BYTECODE_VERSION    2
+
+// Compile settings that change the code generated for the same source, and so
+// are part of the source hash.
+#define BYTECODE_ENTITY_CLASS   (1u << 0)   // Compiled against an entity
+#define BYTECODE_REPL           (1u << 1)   // Expression statements print
+
+typedef struct bytecode_buffer_t {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+} BytecodeBuffer;
+
+typedef struct bytecode_key_t {
+    uint64_t build_id;      // bytecode_build_id() of the server that wrote it
+    uint64_t source_hash;   // bytecode_source_hash() of what it was built from
+} BytecodeKey;
+
+uint64_t bytecode_build_id();
+uint64_t bytecode_source_hash(const char* source, uint32_t flags);
+
+// Serializes 'function' and the global consts its compile read and defined.
+// Returns false if it holds a constant the format can't represent.
+bool write_bytecode_image(BytecodeBuffer* out, const BytecodeKey* key,
+    ObjFunction* function, CompileDeps* deps);
+bool read_bytecode_key(const uint8_t* data, size_t len, BytecodeKey* key);
+
+// Rebuilds the script function from an image. The image is only used if the
+// global consts it was compiled against still hold; then the consts it
+// defined are defined again, as the compile would have. Returns NULL (having
+// defined nothing) if the image is damaged or, setting '*stale', if it no
+// longer matches the global consts.
+ObjFunction* load_bytecode_image(const uint8_t* data, size_t len, bool* stale);
+
+void free_bytecode_buffer(BytecodeBuffer* buf);
+
+#endif // !MUD98__LOX__BYTECODE_H
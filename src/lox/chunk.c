@@ -5,9 +5,12 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "lox/chunk.h"
+#include "lox/function.h"
 #include "lox/memory.h"
 #include "lox/vm.h"
 
+#include <string.h>
+
 void init_chunk(Chunk* chunk)
 {
     chunk->count = 0;
@@ -15,6 +18,9 @@ void init_chunk(Chunk* chunk)
     chunk->code = NULL;
     chunk->lines = NULL;
     init_value_array(&chunk->constants);
+    chunk->caches = NULL;
+    chunk->cache_count = 0;
+    chunk->cache_capacity = 0;
 }
 
 void free_chunk(Chunk* chunk)
@@ -22,6 +28,7 @@ void free_chunk(Chunk* chunk)
     FREE_ARRAY(uint8_t, chunk->code, chunk->capacity);
     FREE_ARRAY(int, chunk->lines, chunk->capacity);
     free_value_array(&chunk->constants);
+    FREE_ARRAY(InlineCache, chunk->caches, chunk->cache_capacity);
     init_chunk(chunk);
 }
 
@@ -48,3 +55,72 @@ int add_constant(Chunk* chunk, Value value)
     pop();
     return chunk->constants.count - 1;
 }
+
+int add_inline_cache(Chunk* chunk)
+{
+    if (chunk->cache_capacity < chunk->cache_count + 1) {
+        int old_capacity = chunk->cache_capacity;
+        chunk->cache_capacity = GROW_CAPACITY(old_capacity);
+        chunk->caches = GROW_ARRAY(InlineCache, chunk->caches, old_capacity,
+            chunk->cache_capacity);
+    }
+
+    memset(&chunk->caches[chunk->cache_count], 0, sizeof(InlineCache));
+    return chunk->cache_count++;
+}
+
+static int constant_index_length(Chunk* chunk, int offset)
+{
+    return (chunk->code[offset] & 0x80) ? 2 : 1;
+}
+
+int instruction_length(Chunk* chunk, int offset)
+{
+    switch (chunk->code[offset]) {
+    case OP_CONSTANT:
+    case OP_ADD_CONSTANT:
+    case OP_GET_GLOBAL:
+    case OP_DEFINE_GLOBAL:
+    case OP_SET_GLOBAL:
+    case OP_SET_PROPERTY:
+    case OP_GET_SUPER:
+    case OP_CLASS:
+    case OP_METHOD:
+        return 1 + constant_index_length(chunk, offset + 1);
+    case OP_GET_PROPERTY: {
+            int len = 1 + constant_index_length(chunk, offset + 1);
+            return len + constant_index_length(chunk, offset + len);
+        }
+    case OP_INVOKE: {
+            int len = 2 + constant_index_length(chunk, offset + 1);
+            return len + constant_index_length(chunk, offset + len);
+        }
+    case OP_SUPER_INVOKE:
+    case OP_CALL_GLOBAL:
+        return 2 + constant_index_length(chunk, offset + 1);
+    case OP_GET_LOCAL:
+    case OP_GET_LOCAL_PROPERTY:
+    case OP_SET_LOCAL:
+    case OP_GET_UPVALUE:
+    case OP_SET_UPVALUE:
+    case OP_CALL:
+    case OP_ARRAY:
+    case OP_INTERP:
+        return 2;
+    case OP_JUMP:
+    case OP_JUMP_IF_FALSE:
+    case OP_LOOP:
+    case OP_EACH_OR_END:
+        return 3;
+    case OP_CLOSURE: {
+            int len = 1 + constant_index_length(chunk, offset + 1);
+            int constant = chunk->code[offset + 1];
+            if (constant & 0x80)
+                constant = (constant & 0x7f) << 8 | chunk->code[offset + 2];
+            ObjFunction* function = AS_FUNCTION(chunk->constants.values[constant]);
+            return len + function->upvalue_count * 2;
+        }
+    default:
+        return 1;
+    }
+}
@@ -60,21 +60,75 @@ typedef enum {
     OP_EACH_OR_END,
     OP_EACH_ADVANCE,
     OP_INTERP,
+    OP_CALL_GLOBAL,
+    OP_YIELD,
     // Game entities
     OP_SELF,
+    // Superinstructions. The compiler rewrites the first opcode of a common
+    // pair and leaves the second instruction in place; the fused handler does
+    // both and steps over the second opcode byte.
+    OP_GET_LOCAL_PROPERTY,  // OP_GET_LOCAL + OP_GET_PROPERTY
+    OP_ADD_CONSTANT,        // OP_CONSTANT + OP_ADD
+    OP_EQUAL_JUMP,          // OP_EQUAL + OP_JUMP_IF_FALSE
+    OP_GREATER_JUMP,        // OP_GREATER + OP_JUMP_IF_FALSE
+    OP_LESS_JUMP,           // OP_LESS + OP_JUMP_IF_FALSE
 } OpCode;
 
+// Inline caches for OP_GET_PROPERTY and OP_INVOKE. Each call site gets an
+// InlineCache (its index follows the instruction's operands) remembering what
+// the name resolved to for the last couple of receiver kinds it saw. An entry
+// is keyed on the receiver's ObjType and, for class methods, its class, and is
+// only trusted while its epoch matches vm.ic_epoch; redefining methods,
+// reloading scripts, or freeing a class bumps the epoch.
+
+typedef enum {
+    IC_NONE,
+    IC_COUNT,               // .count on an array, table, list, or enum
+    IC_FIELD,               // Entity shape field
+    IC_METHOD,              // Class method ('target' is the closure)
+    IC_NATIVE_METHOD,       // Entity native method
+    IC_NATIVE_CMD,          // Mobile in-game command
+    IC_NATIVE_MOB_CMD,      // ...that only NPCs may use
+    IC_ARRAY_ADD,
+    IC_ARRAY_CONTAINS,
+} InlineCacheKind;
+
+#define IC_WAYS     2
+
+typedef struct inline_cache_entry_t {
+    uint32_t epoch;
+    ObjType type;
+    InlineCacheKind kind;
+    struct obj_class_t* klass;  // Receiver class for IC_METHOD; otherwise NULL
+    union {
+        Obj* target;
+        const struct entity_field_t* field;
+    };
+} InlineCacheEntry;
+
+typedef struct {
+    InlineCacheEntry entries[IC_WAYS];
+} InlineCache;
+
+// Cache indexes share the variable-length encoding of constant indexes.
+#define MAX_INLINE_CACHES   0x8000
+
 typedef struct {
     int count;
     int capacity;
     uint8_t* code;
     int* lines;
     ValueArray constants;
+    InlineCache* caches;
+    int cache_count;
+    int cache_capacity;
 } Chunk;
 
 void init_chunk(Chunk* chunk);
 void free_chunk(Chunk* chunk);
 void write_chunk(Chunk* chunk, uint8_t byte, int line);
 int add_constant(Chunk* chunk, Value value);
+int add_inline_cache(Chunk* chunk);
+int instruction_length(Chunk* chunk, int offset);
 
 #endif
@@ -23,6 +23,12 @@
 //#define DEBUG_LOG_GC
 #define DEBUG_INTEGRATION
 
+// Dispatch the interpreter loop with computed goto where the compiler supports
+// it. Define LOX_SWITCH_DISPATCH to force the portable switch.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(LOX_SWITCH_DISPATCH)
+#define LOX_THREADED_DISPATCH
+#endif
+
 #define UINT8_COUNT (UINT8_MAX + 1)
 
 // Externals
@@ -32,6 +32,8 @@ void send_to_char(const char* txt, Mobile* ch);
 CompileContext compile_context = { 0 };
 ExecContext exec_context = { 0 };
 
+static CompileDeps* compile_deps = NULL;
+
 typedef struct {
     Token current;
     Token previous;
@@ -277,11 +279,58 @@ static int make_constant(Value value)
     return constant;
 }
 
+// Peephole pass over a finished chunk. Since the second instruction of a
+// fused pair stays where it was, code offsets and jumps are unaffected, and a
+// jump that lands on the second instruction still runs it by itself.
+static void fuse_superinstructions(Chunk* chunk)
+{
+    int offset = 0;
+
+    while (offset < chunk->count) {
+        int next = offset + instruction_length(chunk, offset);
+        if (next >= chunk->count)
+            break;
+
+        uint8_t* op = &chunk->code[offset];
+        uint8_t following = chunk->code[next];
+
+        switch (*op) {
+        case OP_GET_LOCAL:
+            if (following == OP_GET_PROPERTY)
+                *op = OP_GET_LOCAL_PROPERTY;
+            break;
+        case OP_CONSTANT:
+            if (following == OP_ADD)
+                *op = OP_ADD_CONSTANT;
+            break;
+        case OP_EQUAL:
+            if (following == OP_JUMP_IF_FALSE)
+                *op = OP_EQUAL_JUMP;
+            break;
+        case OP_GREATER:
+            if (following == OP_JUMP_IF_FALSE)
+                *op = OP_GREATER_JUMP;
+            break;
+        case OP_LESS:
+            if (following == OP_JUMP_IF_FALSE)
+                *op = OP_LESS_JUMP;
+            break;
+        default:
+            break;
+        }
+
+        offset = next;
+    }
+}
+
 static ObjFunction* end_compiler()
 {
     emit_return();
     ObjFunction* function = current->function;
 
+    if (!parser.had_error)
+        fuse_superinstructions(current_chunk());
+
 #ifdef DEBUG_PRINT_CODE
     if (!parser.had_error) {
         disassemble_chunk(current_chunk(), function->name != NULL
@@ -433,9 +482,20 @@ static bool get_global_const(Token* name, Value* out_value)
 {
     ObjString* name_str = copy_string(name->start, name->length);
     if (table_get(&global_const_table, name_str, out_value)) {
+        // Consts this compile defined itself aren't a dependency.
+        Value defined;
+        if (compile_deps != NULL
+            && !table_get(&compile_deps->const_defines, name_str, &defined)) {
+            GC_BARRIER_OBJ(name_str);
+            table_set(&compile_deps->const_reads, name_str, *out_value);
+        }
         return true;
     }
 
+    if (compile_deps != NULL) {
+        GC_BARRIER_OBJ(name_str);
+        table_set(&compile_deps->const_misses, name_str, NIL_VAL);
+    }
     return false;
 }
 
@@ -493,6 +553,11 @@ static void add_global_const(Token* name, Value value)
 
     push(value);
     table_set(&global_const_table, name_str, value);
+    if (compile_deps != NULL) {
+        table_delete(&compile_deps->const_misses, name_str);
+        GC_BARRIER_OBJ(name_str);
+        table_set(&compile_deps->const_defines, name_str, value);
+    }
     pop();
 }
 
@@ -708,6 +773,16 @@ static void each(bool assign)
     current->current_loop = current->current_loop->enclosing;
 }
 
+static void emit_inline_cache()
+{
+    int cache = add_inline_cache(current_chunk());
+    if (cache >= MAX_INLINE_CACHES) {
+        error("Too many property accesses in one chunk.");
+        return;
+    }
+    emit_constant_index(cache);
+}
+
 static void resolve_property(Token* token, bool can_assign)
 {
     int name = identifier_constant(token);
@@ -722,10 +797,12 @@ static void resolve_property(Token* token, bool can_assign)
         emit_byte(OP_INVOKE);
         emit_constant_index(name);
         emit_byte(arg_count);
+        emit_inline_cache();
     }
     else {
         emit_byte(OP_GET_PROPERTY);
         emit_constant_index(name);
+        emit_inline_cache();
     }
 }
 
@@ -1183,6 +1260,16 @@ static void named_variable(Token name, bool can_assign)
         }
     }
 
+    if (get_op == OP_GET_GLOBAL && match(TOKEN_LEFT_PAREN)) {
+        // Calls to globals (mostly natives) look the callee up when the
+        // call is made instead of pushing it first.
+        uint8_t arg_count = argument_list();
+        emit_byte(OP_CALL_GLOBAL);
+        emit_constant_index(arg);
+        emit_byte(arg_count);
+        return;
+    }
+
     if (can_assign) {
         if (match(TOKEN_EQUAL)) {
             expression();
@@ -1387,6 +1474,23 @@ static void unary(bool can_assign)
     }
 }
 
+static void yield_(bool can_assign)
+{
+    if (current->type == TYPE_SCRIPT)
+        error("Can't yield from top-level code.");
+    else if (current->type == TYPE_INITIALIZER)
+        error("Can't yield from an initializer.");
+
+    // A bare 'yield' yields nil.
+    if (check(TOKEN_SEMICOLON) || check(TOKEN_RIGHT_PAREN)
+        || check(TOKEN_RIGHT_BRACK) || check(TOKEN_COMMA))
+        emit_byte(OP_NIL);
+    else
+        parse_precedence(PREC_ASSIGNMENT);
+
+    emit_byte(OP_YIELD);
+}
+
 ParseRule rules[] = {
     [TOKEN_LEFT_PAREN]      = { grouping,       call,       PREC_CALL       },
     [TOKEN_RIGHT_PAREN]     = { NULL,           NULL,       PREC_NONE       },
@@ -1441,6 +1545,7 @@ ParseRule rules[] = {
     [TOKEN_EACH]            = { NULL,           NULL,       PREC_NONE       },
     [TOKEN_BREAK]           = { NULL,           NULL,       PREC_NONE       }, /* not used yet */
     [TOKEN_CONTINUE]        = { NULL,           NULL,       PREC_NONE       }, /* not used yet */
+    [TOKEN_YIELD]           = { yield_,         NULL,       PREC_NONE       },
     [TOKEN_SELF]            = { literal,        NULL,       PREC_NONE       },
     [TOKEN_ERROR]           = { NULL,           NULL,       PREC_NONE       },
     [TOKEN_EOF]             = { NULL,           NULL,       PREC_NONE       },
@@ -2015,8 +2120,48 @@ ObjFunction* compile(const char* source)
     return parser.had_error ? NULL : function;
 }
 
+void init_compile_deps(CompileDeps* deps)
+{
+    init_table(&deps->const_reads);
+    init_table(&deps->const_misses);
+    init_table(&deps->const_defines);
+}
+
+void free_compile_deps(CompileDeps* deps)
+{
+    if (compile_deps == deps)
+        compile_deps = NULL;
+    free_table(&deps->const_reads);
+    free_table(&deps->const_misses);
+    free_table(&deps->const_defines);
+}
+
+void record_compile_deps(CompileDeps* deps)
+{
+    compile_deps = deps;
+}
+
+// The tables live in the caller's CompileDeps, not the heap, so only their
+// contents go on the gray stack.
+static void mark_deps_table(Table* table)
+{
+    for (int i = 0; i < table->capacity; i++) {
+        Entry* entry = &table->entries[i];
+        if (IS_STRING(entry->key)) {
+            mark_object(AS_OBJ(entry->key));
+            mark_value(entry->value);
+        }
+    }
+}
+
 void mark_compiler_roots()
 {
+    if (compile_deps != NULL) {
+        mark_deps_table(&compile_deps->const_reads);
+        mark_deps_table(&compile_deps->const_misses);
+        mark_deps_table(&compile_deps->const_defines);
+    }
+
     Compiler* compiler = current;
     while (compiler != NULL) {
         mark_object((Obj*)compiler->function);
@@ -13,8 +13,23 @@
 #include "object.h"
 #include "vm.h"
 
+// What a compile took from, and added to, the global constant table. Global
+// consts are folded into the code, so compiled bytecode is only reusable while
+// the ones it read still hold the same values; the bytecode cache stores these
+// with each image (see lox/bytecode.h).
+typedef struct compile_deps_t {
+    Table const_reads;      // Global consts the source referred to
+    Table const_misses;     // Names it looked up that weren't global consts
+    Table const_defines;    // Global consts it defined
+} CompileDeps;
+
 ObjFunction* compile(const char* source);
 void compile_errorf(const char* fmt, ...);
 void mark_compiler_roots();
 
+void init_compile_deps(CompileDeps* deps);
+void free_compile_deps(CompileDeps* deps);
+// Records into 'deps' during the following compiles; NULL stops recording.
+void record_compile_deps(CompileDeps* deps);
+
 #endif
@@ -0,0 +1,78 @@
+////////////////////////////////////////////////////////////////////////////////
+// lox/coroutine.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "coroutine.h"
+
+#include "memory.h"
+
+#include <string.h>
+
+ObjCoroutine* new_coroutine(ObjClosure* closure)
+{
+    ObjCoroutine* coroutine = ALLOCATE_OBJ(ObjCoroutine, OBJ_COROUTINE);
+    coroutine->closure = closure;
+    coroutine->state = CO_NEW;
+    coroutine->transfer = NIL_VAL;
+    coroutine->frames = NULL;
+    coroutine->frame_count = 0;
+    coroutine->frame_capacity = 0;
+    coroutine->stack = NULL;
+    coroutine->stack_count = 0;
+    coroutine->stack_capacity = 0;
+    coroutine->open_upvalues = NULL;
+    coroutine->caller = NULL;
+    coroutine->frame_base = 0;
+    coroutine->stack_base = 0;
+    coroutine->spawned = false;
+    memset(&coroutine->timer, 0, sizeof(EventTimer));
+    return coroutine;
+}
+
+void mark_coroutine(ObjCoroutine* coroutine)
+{
+    mark_object((Obj*)coroutine->closure);
+    mark_value(coroutine->transfer);
+    for (int i = 0; i < coroutine->frame_count; i++)
+        mark_object((Obj*)coroutine->frames[i].closure);
+    for (int i = 0; i < coroutine->stack_count; i++)
+        mark_value(coroutine->stack[i]);
+    for (ObjUpvalue* upvalue = coroutine->open_upvalues; upvalue != NULL;
+            upvalue = upvalue->next)
+        mark_object((Obj*)upvalue);
+    mark_object((Obj*)coroutine->caller);
+}
+
+void free_coroutine(ObjCoroutine* coroutine)
+{
+    cancel_coroutine_timer(coroutine);
+    FREE_ARRAY(CallFrame, coroutine->frames, coroutine->frame_capacity);
+    FREE_ARRAY(Value, coroutine->stack, coroutine->stack_capacity);
+    FREE(ObjCoroutine, coroutine);
+}
+
+bool spawn_coroutine(ObjCoroutine* coroutine, Entity* owner)
+{
+    if (coroutine->state != CO_NEW || coroutine->spawned)
+        return false;
+
+    coroutine->spawned = true;
+    return add_coroutine_timer(coroutine, 1, owner) != NO_EVENT_TIMER;
+}
+
+void run_spawned_coroutine(ObjCoroutine* coroutine)
+{
+    InterpretResult result = resume_coroutine(coroutine, NIL_VAL);
+
+    // Cancelled while it ran (say, it got its owner killed).
+    if (coroutine->timer.coroutine == NULL)
+        return;
+
+    if (result != INTERPRET_OK || coroutine->state != CO_SUSPENDED) {
+        cancel_coroutine_timer(coroutine);
+        return;
+    }
+
+    int ticks = IS_INT(coroutine->transfer) ? AS_INT(coroutine->transfer) : 1;
+    add_coroutine_timer(coroutine, ticks, NULL);
+}
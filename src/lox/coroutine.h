@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////
+// lox/coroutine.h
+// Coroutines: closures that can suspend themselves with 'yield' and be resumed
+// later where they left off.
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__LOX__COROUTINE_H
+#define MUD98__LOX__COROUTINE_H
+
+#include "vm.h"
+
+#include <entities/event_timer.h>
+
+typedef enum {
+    CO_NEW,
+    CO_SUSPENDED,
+    CO_RUNNING,
+    CO_DONE,
+} CoroutineState;
+
+// A running coroutine's frames and stack live on the VM like any other call's.
+// When it yields, they are moved out into 'frames' and 'stack' (with any open
+// upvalues still pointing into them), and copied back when it is resumed. A
+// suspended coroutine costs its saved stack segment and nothing else.
+typedef struct obj_coroutine_t {
+    Obj obj;
+    ObjClosure* closure;
+    CoroutineState state;
+    Value transfer;             // Last value yielded or returned
+    // Saved while suspended
+    CallFrame* frames;          // 'slots' point into 'stack'
+    int frame_count;
+    int frame_capacity;
+    Value* stack;
+    int stack_count;
+    int stack_capacity;
+    ObjUpvalue* open_upvalues;
+    // Set while running
+    struct obj_coroutine_t* caller;
+    int frame_base;             // vm.frame_count when it was resumed
+    int stack_base;             // Offset of its first slot on vm.stack
+    // Spawned coroutines are resumed by their own timer (see spawn()). It
+    // stays linked to its owner while the coroutine lives, so freeing the
+    // owner stops it.
+    bool spawned;
+    EventTimer timer;
+} ObjCoroutine;
+
+#define IS_COROUTINE(value)     is_obj_type(value, OBJ_COROUTINE)
+#define AS_COROUTINE(value)     ((ObjCoroutine*)AS_OBJ(value))
+
+ObjCoroutine* new_coroutine(ObjClosure* closure);
+void mark_coroutine(ObjCoroutine* coroutine);
+void free_coroutine(ObjCoroutine* coroutine);
+
+// Resumes 'coroutine' from outside the VM, passing 'value' as the result of
+// its 'yield' (or as its argument, the first time). Like invoke_closure(), it
+// expects nothing else to be running.
+InterpretResult resume_coroutine(ObjCoroutine* coroutine, Value value);
+
+// Starts 'coroutine' on the next pulse and keeps it going: each time it yields
+// an int, it is resumed that many pulses later (anything else waits one
+// pulse). It stops when it returns, hits an error, or its owner is freed.
+bool spawn_coroutine(ObjCoroutine* coroutine, Entity* owner);
+
+// Called by the timer wheel when a spawned coroutine is due.
+void run_spawned_coroutine(ObjCoroutine* coroutine);
+
+#endif // !MUD98__LOX__COROUTINE_H
@@ -52,6 +52,31 @@ static int invoke_instruction(const char* name, Chunk* chunk, int offset)
     return arg_offset + 1;
 }
 
+static int cached_property_instruction(const char* name, Chunk* chunk, 
+    int offset)
+{
+    int new_offset = offset + 1;
+    int constant = read_constant_index(chunk, &new_offset);
+    int cache = read_constant_index(chunk, &new_offset);
+    lox_printf("%-16s %4d ", name, constant);
+    print_value(chunk->constants.values[constant]);
+    lox_printf(" [ic %d]\n", cache);
+    return new_offset;
+}
+
+static int cached_invoke_instruction(const char* name, Chunk* chunk, 
+    int offset)
+{
+    int arg_offset = offset + 1;
+    int constant = read_constant_index(chunk, &arg_offset);
+    uint8_t arg_count = chunk->code[arg_offset++];
+    int cache = read_constant_index(chunk, &arg_offset);
+    lox_printf("%-16s (%d args) %4d ", name, arg_count, constant);
+    print_value(chunk->constants.values[constant]);
+    lox_printf(" [ic %d]\n", cache);
+    return arg_offset;
+}
+
 static int simple_instruction(const char* name, int offset)
 {
     lox_printf("%s\n", name);
@@ -111,7 +136,7 @@ int disassemble_instruction(Chunk* chunk, int offset)
     case OP_SET_UPVALUE:
         return byte_instruction("OP_SET_UPVALUE", chunk, offset);
     case OP_GET_PROPERTY:
-        return constant_instruction("OP_GET_PROPERTY", chunk, offset);
+        return cached_property_instruction("OP_GET_PROPERTY", chunk, offset);
     case OP_SET_PROPERTY:
         return constant_instruction("OP_SET_PROPERTY", chunk, offset);
     case OP_GET_AT_INDEX:
@@ -151,7 +176,7 @@ int disassemble_instruction(Chunk* chunk, int offset)
     case OP_ARRAY:
         return byte_instruction("OP_ARRAY", chunk, offset);
     case OP_INVOKE:
-        return invoke_instruction("OP_INVOKE", chunk, offset);
+        return cached_invoke_instruction("OP_INVOKE", chunk, offset);
     case OP_SUPER_INVOKE:
         return invoke_instruction("OP_SUPER_INVOKE", chunk, offset);
     case OP_CLOSURE: {
@@ -189,8 +214,23 @@ int disassemble_instruction(Chunk* chunk, int offset)
         return simple_instruction("OP_EACH_ADVANCE", offset);
     case OP_INTERP:
         return byte_instruction("OP_INTERP", chunk, offset);
+    case OP_CALL_GLOBAL:
+        return invoke_instruction("OP_CALL_GLOBAL", chunk, offset);
+    case OP_YIELD:
+        return simple_instruction("OP_YIELD", offset);
     case OP_SELF:
         return simple_instruction("OP_SELF", offset);
+    // Fused opcodes print their first half; the second follows as written.
+    case OP_GET_LOCAL_PROPERTY:
+        return byte_instruction("OP_GET_LOCAL_PROPERTY", chunk, offset);
+    case OP_ADD_CONSTANT:
+        return constant_instruction("OP_ADD_CONSTANT", chunk, offset);
+    case OP_EQUAL_JUMP:
+        return simple_instruction("OP_EQUAL_JUMP", offset);
+    case OP_GREATER_JUMP:
+        return simple_instruction("OP_GREATER_JUMP", offset);
+    case OP_LESS_JUMP:
+        return simple_instruction("OP_LESS_JUMP", offset);
     default:
         lox_printf("Unknown opcode %d\n", instruction);
         return offset + 1;
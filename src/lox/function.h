@@ -14,12 +14,24 @@
 
 #include <merc.h>
 
+// What a function has cost so far. Instructions, allocations, and time are
+// "self" costs: each is charged to whichever frame was on top when it was
+// spent. Time is only kept while lox_profile_time is on.
+typedef struct script_profile_t {
+    uint64_t calls;
+    uint64_t instructions;
+    uint64_t allocations;
+    uint64_t usec;
+    uint32_t aborts;        // Runs stopped for going over budget in here
+} ScriptProfile;
+
 typedef struct obj_function_t {
     Obj obj;
     int arity;
     int upvalue_count;
     Chunk chunk;
     ObjString* name;
+    ScriptProfile profile;
 } ObjFunction;
 
 typedef Value(*NativeFn)(int arg_count, Value* args);
@@ -37,7 +49,7 @@ typedef struct obj_closure_t {
     int upvalue_count;
 } ObjClosure;
 
-typedef struct {
+typedef struct obj_class_t {
     Obj obj;
     ObjString* name;
     Table methods;
@@ -57,6 +57,7 @@ static Node* new_node()
 
 Node* list_push(List* list, Value value)
 {
+    GC_BARRIER(value);
     Node* node = new_node();
     node->value = value;
     node->next = list->front;
@@ -75,6 +76,7 @@ Node* list_push(List* list, Value value)
 
 Node* list_push_back(List* list, Value value)
 {
+    GC_BARRIER(value);
     Node* node = new_node();
     node->value = value;
     node->prev = list->back;
@@ -162,6 +164,7 @@ void list_remove_value(List* list, Value value)
 
 Node* list_insert_after(List* list, Node* node, Value value)
 {
+    GC_BARRIER(value);
     Node* new_ = new_node();
     new_->value = value;
 
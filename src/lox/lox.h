@@ -51,6 +51,7 @@ void init_const_natives();
 void init_world_natives();
 void init_vm();
 InterpretResult interpret_code(const char* source);
+InterpretResult interpret_function(ObjFunction* function);
 Value pop();
 void push(Value value);
 void runtime_error(const char* format, ...);
@@ -84,6 +85,8 @@ void load_lox_public_scripts(void);
 void run_post_lox_public_scripts(void);
 void save_lox_public_scripts(bool force_catalog);
 void save_lox_public_scripts_if_dirty(void);
+void load_class_budgets(void);
+void save_class_budgets(void);
 void lox_script_registry_clear(void);
 
 size_t lox_script_entry_count(void);
@@ -5,8 +5,10 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <merc.h>
+#include <config.h>
 
 #include "compiler.h"
+#include "coroutine.h"
 #include "enum.h"
 #include "memory.h"
 #include "native.h"
@@ -30,6 +32,12 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
 
 #ifdef COUNT_GCS
 uint64_t gc_count = 0;
@@ -164,6 +172,10 @@ static void mark_entity(Entity* entity)
     mark_list(&entity->events);
     if (entity->klass)
         mark_object((Obj*)entity->klass);
+    // A stale index is only ever compared against, but its class must stay
+    // allocated so a new class can't reuse the address and pass for it.
+    if (entity->event_index)
+        mark_object((Obj*)entity->event_index->klass);
     if (entity->script)
         mark_object((Obj*)entity->script);
 }
@@ -241,6 +253,9 @@ static void blacken_object(Obj* object)
         mark_table(&enum_obj->values);
         break;
     }
+    case OBJ_COROUTINE:
+        mark_coroutine((ObjCoroutine*)object);
+        break;
     case OBJ_NATIVE:
     case OBJ_RAW_PTR:
     case OBJ_STRING:
@@ -270,6 +285,7 @@ static void blacken_object(Obj* object)
         Room* room = (Room*)object;
         mark_entity(&room->header);
         mark_list(&room->mobiles);
+        mark_list(&room->listeners);
         mark_list(&room->objects);
         mark_value(OBJ_VAL(room->data));  // Keep RoomData alive
         mark_value(OBJ_VAL(room->area));  // Keep Area alive
@@ -392,6 +408,8 @@ static void free_obj_value(Obj* object)
             ObjClass* klass = (ObjClass*)object;
             free_table(&klass->methods);
             FREE(ObjClass, object);
+            // A new class could reuse this address.
+            invalidate_inline_caches();
             break;
         }
     case OBJ_CLOSURE: {
@@ -447,6 +465,9 @@ static void free_obj_value(Obj* object)
         free_table(&enum_obj->values);
         FREE(ObjEnum, object);
         break;
+    case OBJ_COROUTINE:
+        free_coroutine((ObjCoroutine*)object);
+        break;
     //
     case OBJ_EVENT:
         free_event((Event*)object);
@@ -481,6 +502,7 @@ static void mark_natives()
     mark_table(&native_methods);
     mark_table(&native_cmds);
     mark_table(&native_mob_cmds);
+    mark_entity_shapes();
 }
 
 static void mark_roots()
@@ -498,7 +520,10 @@ static void mark_roots()
         mark_object((Obj*)upvalue);
     }
 
+    mark_object((Obj*)vm.current_coroutine);
+
     mark_table(&vm.globals);
+    mark_table(&vm.class_budgets);
     mark_table(&global_const_table);
     mark_compiler_roots();
     mark_object((Obj*)vm.init_string);
@@ -525,10 +550,16 @@ static void mark_roots()
     mark_list(&obj_free);
     mark_list(&obj_free);
 
-    EventTimer* timer = event_timers;
-    while (timer != NULL) {
-        mark_object((Obj*)timer->closure);
-        timer = timer->next;
+    mark_event_timers();
+}
+
+// Roots are marked at the start of a cycle and again when marking finishes, so
+// they don't need write barriers. Everything else is traced a slice at a time.
+static void trace_some(int budget)
+{
+    while (vm.gray_count > 0 && budget-- > 0) {
+        Obj* object = vm.gray_stack[--vm.gray_count];
+        blacken_object(object);
     }
 }
 
@@ -540,28 +571,203 @@ static void trace_references()
     }
 }
 
-static void sweep()
+typedef enum {
+    GC_IDLE,
+    GC_MARK,
+    GC_SWEEP,
+} GcPhase;
+
+bool gc_marking = false;
+GcStats gc_stats = { 0 };
+
+static GcPhase gc_phase = GC_IDLE;
+static size_t cycle_start_bytes = 0;
+static Obj* mark_boundary = NULL;       // Head of vm.objects when marking began
+static Obj* sweep_list = NULL;          // Objects the sweep has yet to visit
+static Obj* survivors = NULL;
+static Obj* survivors_tail = NULL;
+static int cycle_steps = 0;
+static uint64_t cycle_pause_usec = 0;
+static uint64_t cycle_max_pause_usec = 0;
+static size_t cycle_freed_objects = 0;
+static size_t cycle_freed_bytes = 0;
+
+// Objects are traced or swept in batches of this many between clock checks.
+#define GC_WORK_BATCH       256
+// While a cycle is running, allocating this much more runs another slice.
+#define GC_STEP_BYTES       (64 * 1024)
+
+uint64_t lox_clock_usec()
 {
-    Obj* previous = NULL;
-    Obj* object = vm.objects;
-    while (object != NULL) {
+#ifdef _MSC_VER
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+    if (!freq.QuadPart)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart * 1000000 / freq.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#endif
+}
+
+static void begin_cycle()
+{
+    vm.current_gc_mark++;
+    cycle_start_bytes = vm.bytes_allocated;
+    mark_boundary = vm.objects;
+    cycle_steps = 0;
+    cycle_pause_usec = 0;
+    cycle_max_pause_usec = 0;
+    cycle_freed_objects = 0;
+    cycle_freed_bytes = 0;
+
+    gc_phase = GC_MARK;
+    gc_marking = true;
+    mark_roots();
+}
+
+// Finishes marking in one go. The roots are marked again to pick up anything
+// the mutator moved into them, and objects allocated since marking began were
+// born black without being traced, so their fields are traced now.
+static void finish_mark()
+{
+    mark_roots();
+    for (Obj* object = vm.objects; object != mark_boundary; object = object->next)
+        blacken_object(object);
+    trace_references();
+
+    gc_marking = false;
+    table_remove_white(&vm.strings);
+
+    // New objects are allocated onto vm.objects while the sweep runs. They
+    // are live by definition, so the sweep works through a detached list.
+    sweep_list = vm.objects;
+    vm.objects = NULL;
+    survivors = NULL;
+    survivors_tail = NULL;
+    gc_phase = GC_SWEEP;
+}
+
+static void sweep_some(int budget)
+{
+    size_t before = vm.bytes_allocated;
+
+    while (sweep_list != NULL && budget-- > 0) {
+        Obj* object = sweep_list;
+        sweep_list = object->next;
+
         if (object->mark_id == vm.current_gc_mark) {
-            previous = object;
-            object = object->next;
+            object->next = survivors;
+            survivors = object;
+            if (survivors_tail == NULL)
+                survivors_tail = object;
         }
         else {
-            Obj* unreached = object;
-            object = object->next;
-            if (previous != NULL) {
-                previous->next = object;
-            }
-            else {
-                vm.objects = object;
-            }
+            free_obj_value(object);
+            cycle_freed_objects++;
+        }
+    }
 
-            free_obj_value(unreached);
+    cycle_freed_bytes += before - vm.bytes_allocated;
+}
+
+static void finish_cycle()
+{
+    if (survivors_tail != NULL) {
+        survivors_tail->next = vm.objects;
+        vm.objects = survivors;
+    }
+    survivors = NULL;
+    survivors_tail = NULL;
+    gc_phase = GC_IDLE;
+
+    gc_stats.cycles++;
+    gc_stats.last_steps = cycle_steps;
+    gc_stats.last_pause_usec = cycle_pause_usec;
+    gc_stats.last_max_pause_usec = cycle_max_pause_usec;
+    gc_stats.last_freed_objects = cycle_freed_objects;
+    gc_stats.last_freed_bytes = cycle_freed_bytes;
+}
+
+// Advances the current cycle until it completes or 'budget_usec' runs out
+// (0 means no limit). Returns true if the cycle completed.
+static bool run_cycle(uint64_t budget_usec)
+{
+    uint64_t start = lox_clock_usec();
+
+    while (gc_phase != GC_IDLE) {
+        if (gc_phase == GC_MARK) {
+            trace_some(GC_WORK_BATCH);
+            if (vm.gray_count == 0)
+                finish_mark();
         }
+        else {
+            sweep_some(GC_WORK_BATCH);
+            if (sweep_list == NULL)
+                break;
+        }
+
+        if (budget_usec > 0 && lox_clock_usec() - start >= budget_usec)
+            break;
+    }
+
+    uint64_t pause = lox_clock_usec() - start;
+    cycle_steps++;
+    cycle_pause_usec += pause;
+    if (pause > cycle_max_pause_usec)
+        cycle_max_pause_usec = pause;
+    gc_stats.steps++;
+    gc_stats.total_pause_usec += pause;
+    if (pause > gc_stats.max_pause_usec)
+        gc_stats.max_pause_usec = pause;
+
+    if (gc_phase == GC_SWEEP && sweep_list == NULL) {
+        finish_cycle();
+        return true;
+    }
+
+    return gc_phase == GC_IDLE;
+}
+
+// Runs a whole cycle in a single pause, first finishing any cycle already in
+// progress so that everything unreachable right now is freed.
+static void full_collection()
+{
+    if (gc_phase != GC_IDLE)
+        run_cycle(0);
+
+    begin_cycle();
+    run_cycle(0);
+    gc_stats.full_collections++;
+}
+
+// Called when the allocator crosses vm.next_gc. Sets the next threshold
+// itself if the cycle is still running.
+static void allocation_step()
+{
+    int slice = cfg_get_gc_slice_usec();
+
+    if (slice <= 0) {
+        full_collection();
+        return;
     }
+
+    if (gc_phase == GC_IDLE)
+        begin_cycle();
+
+    // If the heap has grown by the whole growth factor since the cycle began,
+    // the mutator is outrunning the slices; finish rather than keep growing.
+    bool done;
+    if (vm.bytes_allocated > cycle_start_bytes * GC_HEAP_GROW_FACTOR)
+        done = run_cycle(0);
+    else
+        done = run_cycle((uint64_t)slice);
+
+    if (!done)
+        vm.next_gc = vm.bytes_allocated + GC_STEP_BYTES;
 }
 
 void collect_garbage()
@@ -584,14 +790,15 @@ void collect_garbage()
     // We don't add game entities to VM globals until after boot. Don't GC
     // anything until we've had a chance to do that.
     if (!fBootDb) {
-        vm.current_gc_mark++;
-        mark_roots();
-        trace_references();
-        table_remove_white(&vm.strings);
-        sweep();
+#ifdef DEBUG_STRESS_GC
+        full_collection();
+#else
+        allocation_step();
+#endif
     }
 
-    vm.next_gc = vm.bytes_allocated * GC_HEAP_GROW_FACTOR;
+    if (gc_phase == GC_IDLE)
+        vm.next_gc = vm.bytes_allocated * GC_HEAP_GROW_FACTOR;
 
 #if defined(DEBUG_LOG_GC) || defined(COUNT_GCS)
     lox_printf("-- gc end\n");
@@ -621,13 +828,8 @@ void collect_garbage_nongrowing()
 
     // We don't add game entities to VM globals until after boot. Don't GC
     // anything until we've had a chance to do that.
-    if (!fBootDb) {
-        vm.current_gc_mark++;
-        mark_roots();
-        trace_references();
-        table_remove_white(&vm.strings);
-        sweep();
-    }
+    if (!fBootDb)
+        full_collection();
 
 #if defined(DEBUG_LOG_GC) || defined(COUNT_GCS)
     lox_printf("-- gc (non-growing) end\n");
@@ -638,15 +840,47 @@ void collect_garbage_nongrowing()
     vm.gc_running = false;
 }
 
+// Called once per pulse. Gives a cycle in progress one slice, so collection
+// keeps moving even when little is being allocated.
+void collect_garbage_step()
+{
+    if (vm.gc_running || gc_phase == GC_IDLE || fBootDb)
+        return;
+    vm.gc_running = true;
+
+    int slice = cfg_get_gc_slice_usec();
+    if (run_cycle(slice > 0 ? (uint64_t)slice : 0))
+        vm.next_gc = vm.bytes_allocated * GC_HEAP_GROW_FACTOR;
 
-void free_objects()
+    vm.gc_running = false;
+}
+
+void for_each_object(void (*visit)(Obj* object, void* data), void* data)
+{
+    Obj* lists[] = { vm.objects, sweep_list, survivors };
+
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++)
+        for (Obj* object = lists[i]; object != NULL; object = object->next)
+            visit(object, data);
+}
+
+static void free_object_list(Obj* object)
 {
-    Obj* object = vm.objects;
     while (object != NULL) {
         Obj* next = object->next;
         free_obj_value(object);
         object = next;
     }
+}
+
+void free_objects()
+{
+    free_object_list(vm.objects);
+    free_object_list(sweep_list);
+    free_object_list(survivors);
+    vm.objects = sweep_list = survivors = survivors_tail = NULL;
+    gc_phase = GC_IDLE;
+    gc_marking = false;
 
     free(vm.gray_stack);
 }
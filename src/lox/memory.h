@@ -34,13 +34,46 @@ extern uint64_t gc_count;
 #define FREE_ARRAY(type, pointer, old_count) \
     reallocate(pointer, sizeof(type) * (old_count), 0)
 
+// The collector runs incrementally: a cycle marks the roots, then traces and
+// sweeps the heap a slice at a time (see gc_slice_usec). While it is marking,
+// any Value stored into a heap object must go through GC_BARRIER so the
+// collector sees it even if the object holding it has already been traced.
+extern bool gc_marking;
+
+#define GC_BARRIER(value) \
+    do { if (gc_marking) mark_value(value); } while (0)
+
+#define GC_BARRIER_OBJ(object) \
+    do { if (gc_marking) mark_object((Obj*)(object)); } while (0)
+
+typedef struct gc_stats_t {
+    uint64_t cycles;            // Completed collection cycles
+    uint64_t full_collections;  // ...of which ran to completion in one pause
+    uint64_t steps;             // Pauses, incremental or full
+    uint64_t total_pause_usec;
+    uint64_t max_pause_usec;
+    // The last completed cycle
+    int last_steps;
+    uint64_t last_pause_usec;   // Sum of its pauses
+    uint64_t last_max_pause_usec;
+    size_t last_freed_objects;
+    size_t last_freed_bytes;
+} GcStats;
+
+extern GcStats gc_stats;
+
 void* reallocate(void* pointer, size_t old_size, size_t new_size);
 void* reallocate_nogc(void* pointer, size_t old_size, size_t new_size);
 void mark_object(Obj* object);
 void mark_value(Value value);
 void collect_garbage();
 void collect_garbage_nongrowing();
+void collect_garbage_step();
 void free_objects();
+// Calls 'visit' on every object on the heap, including those a sweep in
+// progress has taken off vm.objects. 'visit' must not allocate.
+void for_each_object(void (*visit)(Obj* object, void* data), void* data);
+uint64_t lox_clock_usec();
 
 void gc_protect(Value value);
 void gc_protect_clear();
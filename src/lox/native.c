@@ -11,6 +11,7 @@
 
 #include <data/damage.h>
 
+#include <entities/entity.h>
 #include <entities/faction.h>
 
 #include <db.h>
@@ -75,6 +76,7 @@ void init_const_natives()
 
     init_damage_consts();
     init_faction_consts();
+    init_entity_shapes();
 }
 
 void init_world_natives()
@@ -3,19 +3,25 @@
 // Enumerate native functions for Lox and add them to global
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "coroutine.h"
 #include "native.h"
+#include "vm.h"
 
 #include <data/damage.h>
+#include <data/direction.h>
 
 #include <entities/event.h>
+#include <entities/room.h>
 
 #include <db.h>
 #include <fight.h>
 #include <magic.h>
 #include <mob_cmds.h>
+#include <pathfind.h>
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 static Value clock_native(int arg_count, Value* args)
@@ -118,6 +124,75 @@ static Value dice_native(int arg_count, Value* args)
     return INT_VAL(retval);
 }
 
+// Rooms can be given as themselves or by whoever is standing in them.
+static Room* path_room_arg(Value value)
+{
+    if (IS_ROOM(value))
+        return AS_ROOM(value);
+    if (IS_MOBILE(value))
+        return AS_MOBILE(value)->in_room;
+    return NULL;
+}
+
+// Shared by path_step() and path_distance(). A mobile 'from' walks by its own
+// rules (see path_flags_for()); a room just opens doors.
+static bool path_native(const char* name, int arg_count, Value* args,
+    PathResult* result)
+{
+    if (arg_count != 2 && arg_count != 3) {
+        runtime_error("%s() takes 2 or 3 arguments; %d given.", name,
+            arg_count);
+        return false;
+    }
+
+    if (!IS_ROOM(args[0]) && !IS_MOBILE(args[0])) {
+        runtime_error("%s(): Expected Room or Mobile for first argument.",
+            name);
+        return false;
+    }
+
+    if (!IS_ROOM(args[1]) && !IS_MOBILE(args[1])) {
+        runtime_error("%s(): Expected Room or Mobile for second argument.",
+            name);
+        return false;
+    }
+
+    if (arg_count == 3 && !IS_INT(args[2])) {
+        runtime_error("%s(): Expected integer step limit for third argument.",
+            name);
+        return false;
+    }
+
+    FLAGS flags = IS_MOBILE(args[0]) ? path_flags_for(AS_MOBILE(args[0]))
+        : PATH_OPEN_DOORS;
+    int limit = arg_count == 3 ? AS_INT(args[2]) : 0;
+
+    return find_path(path_room_arg(args[0]), path_room_arg(args[1]), limit,
+        flags, result);
+}
+
+static Value path_step_native(int arg_count, Value* args)
+{
+    PathResult result;
+
+    if (!path_native("path_step", arg_count, args, &result)
+        || result.first_dir < 0)
+        return NIL_VAL;
+
+    const char* dir = dir_list[result.first_dir].name;
+    return OBJ_VAL(copy_string(dir, (int)strlen(dir)));
+}
+
+static Value path_distance_native(int arg_count, Value* args)
+{
+    PathResult result;
+
+    if (!path_native("path_distance", arg_count, args, &result))
+        return NIL_VAL;
+
+    return INT_VAL(result.steps);
+}
+
 static Value do_native(int arg_count, Value* args)
 {
     if (arg_count != 1 || !IS_STRING(args[0])) {
@@ -132,13 +207,14 @@ static Value do_native(int arg_count, Value* args)
 
     const char* argument = AS_STRING(args[0])->chars;
 
-    // Make this command safe for scripted string literals
-    char* cmd = str_dup(argument);
+    // Make this command safe for scripted string literals. str_dup() may hand
+    // back shared text, so the copy has to be our own.
+    char cmd[MAX_INPUT_LENGTH];
+    strncpy(cmd, argument, sizeof(cmd) - 1);
+    cmd[sizeof(cmd) - 1] = '\0';
 
     interpret(exec_context.me, cmd);
 
-    free_string(cmd);
-
     return TRUE_VAL;
 }
 
@@ -170,19 +246,131 @@ static Value saves_spell_native(int arg_count, Value* args)
     return BOOL_VAL(retval);
 }
 
+// int delay(int ticks, closure[, Entity owner])
+// The timer is cancelled if its owner is freed. Called from an entity's own
+// method, the entity owns it unless another owner is given.
 static Value delay_native(int arg_count, Value* args)
 {
-    if (arg_count != 2 || !IS_INT(args[0]) || !IS_CLOSURE(args[1])) {
+    if (arg_count < 2 || arg_count > 3 || !IS_INT(args[0])
+        || !IS_CLOSURE(args[1])) {
         runtime_error("delay(): Expected interval and closure as arguments.");
         return FALSE_VAL;
     }
 
     int32_t interval = AS_INT(args[0]);
     ObjClosure* closure = AS_CLOSURE(args[1]);
+    Entity* owner = NULL;
+
+    if (arg_count == 3) {
+        if (!IS_NIL(args[2]) && !IS_ENTITY(args[2])) {
+            runtime_error("delay(): Expected an entity or nil as the owner.");
+            return FALSE_VAL;
+        }
+        if (IS_ENTITY(args[2]))
+            owner = AS_ENTITY(args[2]);
+    }
+    else if (vm.frame_count > 0) {
+        Value receiver = vm.frames[vm.frame_count - 1].slots[0];
+        if (IS_ENTITY(receiver))
+            owner = AS_ENTITY(receiver);
+    }
+
+    int32_t handle = add_event_timer(closure, interval, owner);
+    if (handle == NO_EVENT_TIMER)
+        return FALSE_VAL;
 
-    add_event_timer(closure, interval);
+    return INT_VAL(handle);
+}
 
-    return TRUE_VAL;
+// bool cancel_delay(int handle | coroutine)
+// Given a spawned coroutine, stops it.
+static Value cancel_delay_native(int arg_count, Value* args)
+{
+    if (arg_count == 1 && IS_COROUTINE(args[0])) {
+        ObjCoroutine* coroutine = AS_COROUTINE(args[0]);
+        if (!coroutine->spawned || coroutine->timer.coroutine == NULL)
+            return FALSE_VAL;
+        cancel_coroutine_timer(coroutine);
+        return TRUE_VAL;
+    }
+
+    if (arg_count != 1 || !IS_INT(args[0])) {
+        runtime_error("cancel_delay(): Expected a handle from delay().");
+        return FALSE_VAL;
+    }
+
+    return BOOL_VAL(cancel_event_timer(AS_INT(args[0])));
+}
+
+static ObjClosure* coroutine_closure(const char* name, Value arg)
+{
+    if (!IS_CLOSURE(arg)) {
+        runtime_error("%s(): Expected a closure.", name);
+        return NULL;
+    }
+
+    ObjClosure* closure = AS_CLOSURE(arg);
+    if (closure->function->arity > 1) {
+        runtime_error("%s(): A coroutine's closure takes at most one "
+            "argument.", name);
+        return NULL;
+    }
+
+    return closure;
+}
+
+// coroutine(closure)
+// Calling the coroutine runs the closure until it yields or returns; the
+// call's value is what it yielded or returned. Calling it again resumes it,
+// and the argument (if any) becomes the value of its 'yield'.
+static Value coroutine_native(int arg_count, Value* args)
+{
+    if (arg_count != 1) {
+        runtime_error("coroutine() takes 1 argument; %d given.", arg_count);
+        return NIL_VAL;
+    }
+
+    ObjClosure* closure = coroutine_closure("coroutine", args[0]);
+    if (closure == NULL)
+        return NIL_VAL;
+
+    return OBJ_VAL(new_coroutine(closure));
+}
+
+// coroutine spawn(closure[, Entity owner])
+// Runs the closure as a coroutine from the next pulse on. Each 'yield n'
+// waits n pulses. Owned like delay() timers.
+static Value spawn_native(int arg_count, Value* args)
+{
+    if (arg_count < 1 || arg_count > 2) {
+        runtime_error("spawn(): Expected a closure and an optional owner.");
+        return NIL_VAL;
+    }
+
+    ObjClosure* closure = coroutine_closure("spawn", args[0]);
+    if (closure == NULL)
+        return NIL_VAL;
+
+    Entity* owner = NULL;
+    if (arg_count == 2) {
+        if (!IS_NIL(args[1]) && !IS_ENTITY(args[1])) {
+            runtime_error("spawn(): Expected an entity or nil as the owner.");
+            return NIL_VAL;
+        }
+        if (IS_ENTITY(args[1]))
+            owner = AS_ENTITY(args[1]);
+    }
+    else if (vm.frame_count > 0) {
+        Value receiver = vm.frames[vm.frame_count - 1].slots[0];
+        if (IS_ENTITY(receiver))
+            owner = AS_ENTITY(receiver);
+    }
+
+    ObjCoroutine* coroutine = new_coroutine(closure);
+    if (!spawn_coroutine(coroutine, owner))
+        return NIL_VAL;
+
+    return OBJ_VAL(coroutine);
 }
 
 const NativeFuncEntry native_func_entries[] = {
@@ -195,5 +383,10 @@ const NativeFuncEntry native_func_entries[] = {
     { "string",         string_native               },
     { "floor",          floor_native                },
     { "delay",          delay_native                },
+    { "cancel_delay",   cancel_delay_native         },
+    { "coroutine",      coroutine_native            },
+    { "spawn",          spawn_native                },
+    { "path_step",      path_step_native            },
+    { "path_distance",  path_distance_native        },
     { NULL,             NULL                        },
 };
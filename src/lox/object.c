@@ -4,6 +4,7 @@
 // Shared under the MIT License
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "coroutine.h"
 #include "enum.h"
 #include "memory.h"
 #include "object.h"
@@ -27,10 +28,13 @@ Obj* allocate_object(size_t size, ObjType type)
 {
     Obj* object = (Obj*)reallocate(NULL, 0, size);
     object->type = type;
-    object->mark_id = 0;
+    // New objects are born black: they survive the cycle in progress, if
+    // any, and are white again once the next one starts.
+    object->mark_id = vm.current_gc_mark;
 
     object->next = vm.objects;
     vm.objects = object;
+    vm.alloc_count++;
 
 #ifdef DEBUG_LOG_GC
     lox_printf("%p allocate %zu for %d\n", (void*)object, size, type);
@@ -89,6 +93,7 @@ ObjFunction* new_function()
     function->arity = 0;
     function->upvalue_count = 0;
     function->name = NULL;
+    memset(&function->profile, 0, sizeof(ScriptProfile));
     init_chunk(&function->chunk);
     return function;
 }
@@ -313,6 +318,14 @@ void print_object(Value value)
             }
             break;
         }
+    case OBJ_COROUTINE: {
+            ObjFunction* function = AS_COROUTINE(value)->closure->function;
+            if (function->name != NULL)
+                lox_printf("<coroutine %s>", function->name->chars);
+            else
+                lox_printf("<coroutine>");
+            break;
+        }
     //
     case OBJ_EVENT:
         lox_printf("<event %s>", AS_EVENT(value)->method_name->chars);
@@ -43,6 +43,7 @@ typedef enum {
     OBJ_TABLE,
     OBJ_LIST,
     OBJ_ENUM,
+    OBJ_COROUTINE,
     // Mud98 Objects
     OBJ_EVENT,
     // Mud98 In-Game Entities
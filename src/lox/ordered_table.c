@@ -93,6 +93,7 @@ bool ordered_table_set_vnum(OrderedTable* ordered, VNUM key, Value value)
 
     bool inserted = table_set_vnum(&ordered->table, key, value);
 
+    // table_set_vnum() has already run the write barrier on 'value'.
     if (found) {
         ordered->ordered[index].value = value;
     }
@@ -188,6 +188,7 @@ static LoxTokenType identifier_type()
         break;
     case 'v': return check_keyword(1, 2, "ar", TOKEN_VAR);
     case 'w': return check_keyword(1, 4, "hile", TOKEN_WHILE);
+    case 'y': return check_keyword(1, 4, "ield", TOKEN_YIELD);
     }
 
     return TOKEN_IDENTIFIER;
@@ -34,6 +34,7 @@ typedef enum {
     TOKEN_TRUE, TOKEN_VAR, TOKEN_WHILE,
     TOKEN_EACH,
     TOKEN_BREAK, TOKEN_CONTINUE, 
+    TOKEN_YIELD,
     // Game entities
     TOKEN_SELF,
 
@@ -223,6 +223,8 @@ bool table_set(Table* table, ObjString* key, Value value)
     if (is_new_key && IS_NIL(entry->value))
         table->count++;
 
+    GC_BARRIER_OBJ(key);
+    GC_BARRIER(value);
     entry->key = OBJ_VAL(key);
     entry->value = value;
     return is_new_key;
@@ -247,6 +249,7 @@ bool table_set_vnum(Table* table, int32_t key, Value value)
     if (is_new_key && IS_NIL(entry->value))
         table->count++;
 
+    GC_BARRIER(value);
     entry->key = INT_VAL(key);
     entry->value = value;
     return is_new_key;
@@ -316,7 +319,9 @@ ObjString* table_find_string(Table* table, const char* chars, int length,
             if (key_str->length == length &&
                 key_str->hash == hash &&
                 memcmp(key_str->chars, chars, length) == 0) {
-                // We found it.
+                // We found it. If it hasn't been marked yet, it's about to be
+                // handed out again, so it can't be collected this cycle.
+                GC_BARRIER_OBJ(key_str);
                 return key_str;
             }
         }
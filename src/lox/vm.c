@@ -6,6 +6,7 @@
 
 #include "common.h"
 #include "compiler.h"
+#include "coroutine.h"
 #include "debug.h"
 #include "enum.h"
 #include "object.h"
@@ -16,6 +17,8 @@
 #include <comm.h>
 #include <config.h>
 
+#include <entities/entity.h>
+
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -89,6 +92,14 @@ void reset_stack()
     vm.stack_top = vm.stack;
     vm.frame_count = 0;
     vm.open_upvalues = NULL;
+
+    // Whatever was running is gone, so its coroutines can't be resumed.
+    while (vm.current_coroutine != NULL) {
+        ObjCoroutine* coroutine = vm.current_coroutine;
+        vm.current_coroutine = coroutine->caller;
+        coroutine->state = CO_DONE;
+        coroutine->caller = NULL;
+    }
 }
 
 void print_stack()
@@ -158,8 +169,15 @@ void init_vm()
     vm.gray_stack = NULL;
     vm.current_gc_mark = 0;
     vm.gc_running = false;
+    vm.ic_epoch = 1;
+
+    vm.exec_count = 0;
+    vm.exec_limit = UINT64_MAX;
+    vm.alloc_count = 0;
+    vm.profile_time = false;
 
     init_table(&vm.globals);
+    init_table(&vm.class_budgets);
     init_table(&vm.strings);
     init_table(&global_const_table);
 
@@ -177,6 +195,7 @@ void init_vm()
 void free_vm()
 {
     free_table(&vm.globals);
+    free_table(&vm.class_budgets);
     free_table(&vm.strings);
     vm.init_string = NULL;
     free_objects();
@@ -199,6 +218,70 @@ Value peek(int distance)
     return vm.stack_top[-1 - distance];
 }
 
+// SCRIPT BUDGET ///////////////////////////////////////////////////////////////
+
+// Charges what has run since the last charge to 'function'.
+static void charge_function(ObjFunction* function)
+{
+    function->profile.instructions += vm.exec_count - vm.charge_exec;
+    function->profile.allocations += vm.alloc_count - vm.charge_alloc;
+    vm.charge_exec = vm.exec_count;
+    vm.charge_alloc = vm.alloc_count;
+
+    if (vm.profile_time) {
+        uint64_t now = lox_clock_usec();
+        function->profile.usec += now - vm.charge_usec;
+        vm.charge_usec = now;
+    }
+}
+
+// A negative budget removes the class's own, leaving it on lox_budget.
+void set_class_budget(ObjString* class_name, int budget)
+{
+    if (budget < 0)
+        table_delete(&vm.class_budgets, class_name);
+    else
+        table_set(&vm.class_budgets, class_name, INT_VAL(budget));
+}
+
+// Returns -1 if the class has no budget of its own.
+int get_class_budget(ObjString* class_name)
+{
+    Value budget;
+    if (vm.class_budgets.count == 0
+        || !table_get(&vm.class_budgets, class_name, &budget))
+        return -1;
+    return AS_INT(budget);
+}
+
+// Each script the game calls into (an event, a timer, a command) gets a fresh
+// budget: its entity class's own, or lox_budget. Whatever it calls runs on
+// the same one.
+static void begin_script(Value receiver)
+{
+    int budget = cfg_get_lox_budget();
+    if (IS_ENTITY(receiver) && AS_ENTITY(receiver)->klass != NULL) {
+        int class_budget = get_class_budget(AS_ENTITY(receiver)->klass->name);
+        if (class_budget >= 0)
+            budget = class_budget;
+    }
+
+    vm.exec_limit = budget > 0 ? vm.exec_count + (uint64_t)budget : UINT64_MAX;
+    vm.charge_exec = vm.exec_count;
+    vm.charge_alloc = vm.alloc_count;
+    vm.profile_time = cfg_get_lox_profile_time();
+    if (vm.profile_time)
+        vm.charge_usec = lox_clock_usec();
+}
+
+static void stop_over_budget()
+{
+    ObjFunction* function = vm.frames[vm.frame_count - 1].closure->function;
+    charge_function(function);
+    function->profile.aborts++;
+    runtime_error("Script stopped: it ran past its budget of instructions.");
+}
+
 bool call_closure(ObjClosure* closure, int arg_count)
 {
     if (arg_count != closure->function->arity) {
@@ -212,6 +295,19 @@ bool call_closure(ObjClosure* closure, int arg_count)
         return false;
     }
 
+    if (vm.frame_count > 0) {
+        charge_function(vm.frames[vm.frame_count - 1].closure->function);
+        // Catches runaway recursion that never loops.
+        if (vm.exec_count > vm.exec_limit) {
+            stop_over_budget();
+            return false;
+        }
+    }
+    else
+        begin_script(vm.stack_top[-arg_count - 1]);
+
+    closure->function->profile.calls++;
+
     CallFrame* frame = &vm.frames[INCREMENT_FRAME_COUNT()];
     frame->closure = closure;
     frame->ip = closure->function->chunk.code;
@@ -219,6 +315,184 @@ bool call_closure(ObjClosure* closure, int arg_count)
     return true;
 }
 
+// COROUTINES //////////////////////////////////////////////////////////////////
+
+// Resumes 'coroutine' in place of the call: the coroutine and its argument are
+// replaced by its saved stack segment, its saved frames go on top of the
+// caller's, and the 'yield' it stopped at gets the argument. The first time,
+// it's just a call to its closure.
+static bool call_coroutine(ObjCoroutine* coroutine, int arg_count)
+{
+    if (arg_count > 1) {
+        runtime_error("Expected at most 1 argument to resume a coroutine but "
+            "got %d.", arg_count);
+        return false;
+    }
+
+    switch (coroutine->state) {
+    case CO_RUNNING:
+        runtime_error("Can't resume a running coroutine.");
+        return false;
+    case CO_DONE:
+        runtime_error("Can't resume a finished coroutine.");
+        return false;
+    default:
+        break;
+    }
+
+    if (coroutine->spawned && vm.current_coroutine != NULL) {
+        runtime_error("Spawned coroutines are only resumed by their timer.");
+        return false;
+    }
+
+    Value value = arg_count == 1 ? pop() : NIL_VAL;
+    pop();  // The coroutine; its result goes here.
+
+    if (coroutine->state == CO_NEW) {
+        ObjClosure* closure = coroutine->closure;
+        push(OBJ_VAL(closure));
+        if (closure->function->arity == 1)
+            push(value);
+        if (!call_closure(closure, closure->function->arity))
+            return false;
+        coroutine->frame_base = vm.frame_count - 1;
+    }
+    else {
+        if (vm.frame_count + coroutine->frame_count > FRAMES_MAX
+            || vm.stack_top + coroutine->stack_count + 1 > vm.stack + STACK_MAX) {
+            runtime_error("Stack overflow.");
+            return false;
+        }
+
+        if (vm.frame_count > 0) {
+            charge_function(vm.frames[vm.frame_count - 1].closure->function);
+            if (vm.exec_count > vm.exec_limit) {
+                stop_over_budget();
+                return false;
+            }
+        }
+        else
+            begin_script(coroutine->stack[0]);
+
+        Value* base = vm.stack_top;
+        memcpy(base, coroutine->stack, sizeof(Value)
+            * (size_t)coroutine->stack_count);
+        for (int i = 0; i < coroutine->frame_count; i++) {
+            CallFrame* frame = &vm.frames[vm.frame_count + i];
+            *frame = coroutine->frames[i];
+            frame->slots = base + (frame->slots - coroutine->stack);
+        }
+
+        // Its upvalues are all above anything still open on the VM, so they
+        // go back at the head of the list, in the same order.
+        if (coroutine->open_upvalues != NULL) {
+            ObjUpvalue* last = coroutine->open_upvalues;
+            for (ObjUpvalue* upvalue = last; upvalue != NULL;
+                    upvalue = upvalue->next) {
+                upvalue->location = base
+                    + (upvalue->location - coroutine->stack);
+                last = upvalue;
+            }
+            last->next = vm.open_upvalues;
+            vm.open_upvalues = coroutine->open_upvalues;
+            coroutine->open_upvalues = NULL;
+        }
+
+        coroutine->frame_base = vm.frame_count;
+        vm.frame_count += coroutine->frame_count;
+        vm.stack_top = base + coroutine->stack_count;
+        coroutine->frame_count = 0;
+        coroutine->stack_count = 0;
+        push(value);
+    }
+
+    coroutine->stack_base = (int)(vm.frames[coroutine->frame_base].slots
+        - vm.stack);
+    coroutine->state = CO_RUNNING;
+    coroutine->caller = vm.current_coroutine;
+    vm.current_coroutine = coroutine;
+    return true;
+}
+
+// Moves the running coroutine's frames and stack segment off the VM and hands
+// 'yield's operand back to whoever resumed it.
+static bool yield_coroutine()
+{
+    ObjCoroutine* coroutine = vm.current_coroutine;
+    if (coroutine == NULL) {
+        runtime_error("Can't yield outside a coroutine.");
+        return false;
+    }
+
+    Value* base = vm.stack + coroutine->stack_base;
+    int frame_count = vm.frame_count - coroutine->frame_base;
+    int stack_count = (int)(vm.stack_top - base) - 1;
+
+    // Grow first: it may collect, and everything is still rooted on the VM.
+    if (coroutine->frame_capacity < frame_count) {
+        int capacity = GROW_CAPACITY(frame_count);
+        coroutine->frames = GROW_ARRAY(CallFrame, coroutine->frames,
+            coroutine->frame_capacity, capacity);
+        coroutine->frame_capacity = capacity;
+    }
+    if (coroutine->stack_capacity < stack_count) {
+        int capacity = GROW_CAPACITY(stack_count);
+        coroutine->stack = GROW_ARRAY(Value, coroutine->stack,
+            coroutine->stack_capacity, capacity);
+        coroutine->stack_capacity = capacity;
+    }
+
+    Value value = pop();
+    charge_function(vm.frames[vm.frame_count - 1].closure->function);
+
+    memcpy(coroutine->stack, base, sizeof(Value) * (size_t)stack_count);
+    for (int i = 0; i < frame_count; i++) {
+        CallFrame* frame = &coroutine->frames[i];
+        *frame = vm.frames[coroutine->frame_base + i];
+        frame->slots = coroutine->stack + (frame->slots - base);
+    }
+
+    // Upvalues still open over its locals follow them, so closures that
+    // share them keep doing so.
+    ObjUpvalue** tail = &coroutine->open_upvalues;
+    while (vm.open_upvalues != NULL && vm.open_upvalues->location >= base) {
+        ObjUpvalue* upvalue = vm.open_upvalues;
+        vm.open_upvalues = upvalue->next;
+        upvalue->location = coroutine->stack + (upvalue->location - base);
+        upvalue->next = NULL;
+        *tail = upvalue;
+        tail = &upvalue->next;
+    }
+
+    coroutine->frame_count = frame_count;
+    coroutine->stack_count = stack_count;
+    coroutine->transfer = value;
+
+    // It may already have been traced with an empty stack.
+    if (gc_marking)
+        mark_coroutine(coroutine);
+
+    vm.frame_count = coroutine->frame_base;
+    vm.stack_top = base;
+    vm.current_coroutine = coroutine->caller;
+    coroutine->caller = NULL;
+    coroutine->state = CO_SUSPENDED;
+
+    push(value);
+    return true;
+}
+
+// Called on return from the coroutine's first frame.
+static void finish_coroutine(Value result)
+{
+    ObjCoroutine* coroutine = vm.current_coroutine;
+    GC_BARRIER(result);
+    coroutine->transfer = result;
+    coroutine->state = CO_DONE;
+    vm.current_coroutine = coroutine->caller;
+    coroutine->caller = NULL;
+}
+
 bool call_value(Value callee, int arg_count)
 {
     if (IS_OBJ(callee)) {
@@ -243,6 +517,8 @@ bool call_value(Value callee, int arg_count)
             }
         case OBJ_CLOSURE:
             return call_closure(AS_CLOSURE(callee), arg_count);
+        case OBJ_COROUTINE:
+            return call_coroutine(AS_COROUTINE(callee), arg_count);
         case OBJ_NATIVE: {
                 NativeFn native = AS_NATIVE(callee);
                 Value result = native(arg_count, vm.stack_top - arg_count);
@@ -261,10 +537,12 @@ bool call_value(Value callee, int arg_count)
                     runtime_error("No valid execution context.");
                     return false;
                 }
+                // Commands write into their argument; give them a scratch copy.
                 ObjString* str_arg = AS_STRING(peek(0));
-                char* arg = str_dup(str_arg->chars);
+                char arg[MAX_INPUT_LENGTH];
+                strncpy(arg, str_arg->chars, sizeof(arg) - 1);
+                arg[sizeof(arg) - 1] = '\0';
                 (*native)(self, arg);
-                free_string(arg);
                 vm.stack_top -= (ptrdiff_t)arg_count + 1;
                 push(NIL_VAL);
                 return true;
@@ -296,20 +574,190 @@ static bool invoke_from_class(ObjClass* klass, ObjString* name, int arg_count)
     return call_closure(AS_CLOSURE(method), arg_count);
 }
 
-bool invoke(ObjString* name, int arg_count)
+////////////////////////////////////////////////////////////////////////////////
+// Inline caches
+////////////////////////////////////////////////////////////////////////////////
+
+void invalidate_inline_caches()
+{
+    // Zero marks a never-filled entry.
+    if (++vm.ic_epoch == 0)
+        vm.ic_epoch = 1;
+}
+
+static inline ObjClass* receiver_class(Value receiver)
+{
+    if (IS_INSTANCE(receiver))
+        return AS_INSTANCE(receiver)->klass;
+    if (IS_ENTITY(receiver))
+        return AS_ENTITY(receiver)->klass;
+    return NULL;
+}
+
+// Fields and methods set on the receiver itself shadow its class's methods.
+static inline Table* receiver_fields(Value receiver)
+{
+    if (IS_INSTANCE(receiver))
+        return &AS_INSTANCE(receiver)->fields;
+    return &AS_ENTITY(receiver)->fields;
+}
+
+static InlineCacheEntry* find_cache_entry(InlineCache* cache, Value receiver)
+{
+    if (cache == NULL || !IS_OBJ(receiver))
+        return NULL;
+
+    ObjType type = OBJ_TYPE(receiver);
+    for (int i = 0; i < IC_WAYS; i++) {
+        InlineCacheEntry* entry = &cache->entries[i];
+        if (entry->epoch == vm.ic_epoch && entry->type == type
+            && (entry->klass == NULL 
+                || entry->klass == receiver_class(receiver)))
+            return entry;
+    }
+
+    return NULL;
+}
+
+static InlineCacheEntry* fill_cache(InlineCache* cache, Value receiver,
+    InlineCacheKind kind, ObjClass* klass)
+{
+    if (cache == NULL)
+        return NULL;
+
+    // Take a free (or stale) way if there is one; otherwise the most recent
+    // entry is kept and the older one is evicted.
+    InlineCacheEntry* entry = NULL;
+    for (int i = 0; i < IC_WAYS; i++) {
+        if (cache->entries[i].epoch != vm.ic_epoch) {
+            entry = &cache->entries[i];
+            break;
+        }
+    }
+
+    if (entry == NULL) {
+        for (int i = IC_WAYS - 1; i > 0; i--)
+            cache->entries[i] = cache->entries[i - 1];
+        entry = &cache->entries[0];
+    }
+
+    entry->epoch = vm.ic_epoch;
+    entry->type = OBJ_TYPE(receiver);
+    entry->kind = kind;
+    entry->klass = klass;
+    entry->target = NULL;
+    return entry;
+}
+
+static int builtin_count(Value receiver)
+{
+    switch (OBJ_TYPE(receiver)) {
+    case OBJ_ARRAY:     return AS_ARRAY(receiver)->count;
+    case OBJ_TABLE:     return AS_TABLE(receiver)->count;
+    case OBJ_LIST:      return AS_LIST(receiver)->count;
+    case OBJ_ENUM:      return AS_ENUM(receiver)->values.count;
+    default:            return 0;
+    }
+}
+
+static void array_add(int arg_count)
+{
+    ValueArray* array = AS_ARRAY(peek(arg_count));
+    for (int i = 0; i < arg_count; i++) {
+        Value value = peek(arg_count - i - 1);
+        write_value_array(array, value);
+    }
+    vm.stack_top -= (ptrdiff_t)arg_count + 1;
+    push(NIL_VAL);
+}
+
+static bool array_contains(int arg_count)
+{
+    if (arg_count != 1) {
+        runtime_error("'contains()' takes only one argument.");
+        return false;
+    }
+    ValueArray* array = AS_ARRAY(peek(1));
+    Value ret = value_array_contains(array, peek(0)) ? TRUE_VAL : FALSE_VAL;
+    vm.stack_top -= (ptrdiff_t)arg_count + 1;
+    push(ret);
+    return true;
+}
+
+static void call_native_method(Value method, int arg_count)
 {
     Value receiver = peek(arg_count);
+    NativeMethod native = AS_NATIVE_METHOD(method)->native;
+    Value result = native(receiver, arg_count, vm.stack_top - arg_count);
+    vm.stack_top -= (ptrdiff_t)arg_count + 1;
+    push(result);
+}
+
+static void call_native_cmd(Mobile* mob, Value cmd)
+{
+    // Mobs have special native functions and methods for in-game commands.
+    // They take exactly one string argument.
+    DoFunc* native = AS_NATIVE_CMD(cmd)->native;
+    // Commands write into their argument; give them a scratch copy.
+    ObjString* str_arg = AS_STRING(peek(0));
+    char arg[MAX_INPUT_LENGTH];
+    strncpy(arg, str_arg->chars, sizeof(arg) - 1);
+    arg[sizeof(arg) - 1] = '\0';
+    (*native)(mob, arg);
+    vm.stack_top -= 2;
+    push(NIL_VAL);
+}
+
+static inline bool is_cmd_call(int arg_count)
+{
+    return arg_count == 1 && IS_STRING(peek(0));
+}
+
+static bool invoke_cached(ObjString* name, int arg_count, InlineCache* cache)
+{
+    Value receiver = peek(arg_count);
+    Value value;
+
+    InlineCacheEntry* entry = find_cache_entry(cache, receiver);
+    if (entry != NULL) {
+        switch (entry->kind) {
+        case IC_NATIVE_METHOD:
+            call_native_method(OBJ_VAL(entry->target), arg_count);
+            return true;
+        case IC_NATIVE_CMD:
+        case IC_NATIVE_MOB_CMD: {
+                Mobile* mob = AS_MOBILE(receiver);
+                if (is_cmd_call(arg_count)
+                    && (entry->kind == IC_NATIVE_CMD || mob->pcdata == NULL)
+                    && !table_get(&mob->header.fields, name, &value)) {
+                    call_native_cmd(mob, OBJ_VAL(entry->target));
+                    return true;
+                }
+                break;
+            }
+        case IC_METHOD:
+            if (!table_get(receiver_fields(receiver), name, &value))
+                return call_closure((ObjClosure*)entry->target, arg_count);
+            break;
+        case IC_ARRAY_ADD:
+            array_add(arg_count);
+            return true;
+        case IC_ARRAY_CONTAINS:
+            return array_contains(arg_count);
+        default:
+            break;
+        }
+    }
 
     if (IS_ENTITY(receiver)) {
         // Check to see if the name is in the native methods table.
         Value method;
         if (table_get(&native_methods, name, &method)) {
             // Found it. Insert the entity as the receiver and call it.
-            vm.stack_top[-arg_count - 1] = receiver;
-            NativeMethod native = AS_NATIVE_METHOD(method)->native;
-            Value result = native(receiver, arg_count, vm.stack_top - arg_count);
-            vm.stack_top -= (ptrdiff_t)arg_count + 1;
-            push(result);
+            entry = fill_cache(cache, receiver, IC_NATIVE_METHOD, NULL);
+            if (entry != NULL)
+                entry->target = AS_OBJ(method);
+            call_native_method(method, arg_count);
             return true;
         }
 
@@ -319,60 +767,47 @@ bool invoke(ObjString* name, int arg_count)
             return call_value(method, arg_count);
         }
 
-        if (IS_MOBILE(receiver) && arg_count == 1 && IS_STRING(peek(0))) {
+        if (IS_MOBILE(receiver) && is_cmd_call(arg_count)) {
             Mobile* mob = AS_MOBILE(receiver);
-            if (table_get(&native_cmds, name, &method) || 
-                (mob->pcdata == NULL &&
-                    table_get(&native_mob_cmds, name, &method))) {
-                // Mobs have special native functions and methods for in-game
-                // commands.
-                vm.stack_top[-arg_count - 1] = receiver;
-                DoFunc* native = AS_NATIVE_CMD(method)->native;
-                ObjString* str_arg = AS_STRING(peek(0));
-                char* arg = str_dup(str_arg->chars);
-                (*native)(mob, arg);
-                free_string(arg);
-                vm.stack_top -= (ptrdiff_t)arg_count + 1;
-                push(NIL_VAL);
+            InlineCacheKind kind = IC_NONE;
+            if (table_get(&native_cmds, name, &method))
+                kind = IC_NATIVE_CMD;
+            else if (mob->pcdata == NULL
+                && table_get(&native_mob_cmds, name, &method))
+                kind = IC_NATIVE_MOB_CMD;
+
+            if (kind != IC_NONE) {
+                entry = fill_cache(cache, receiver, kind, NULL);
+                if (entry != NULL)
+                    entry->target = AS_OBJ(method);
+                call_native_cmd(mob, method);
                 return true;
             }
         }
 
-        Value value;
-        if (table_get(&entity->fields, name, &value)) {
-            vm.stack_top[-arg_count - 1] = value;
-            return call_value(value, arg_count);
-        }
-
         if (entity->klass == NULL) {
             runtime_error("Entity has no class.");
             return false;
         }
 
+        if (table_get(&entity->klass->methods, name, &method)) {
+            entry = fill_cache(cache, receiver, IC_METHOD, entity->klass);
+            if (entry != NULL)
+                entry->target = AS_OBJ(method);
+        }
+
         return invoke_from_class(entity->klass, name, arg_count);
     }
 
     if (IS_ARRAY(receiver)) {
         if (!strcmp(name->chars, "add")) {
-            ValueArray* array = AS_ARRAY(receiver);
-            for (int i = 0; i < arg_count; i++) {
-                Value value = peek(arg_count - i - 1);
-                write_value_array(array, value);
-            }
-            vm.stack_top -= (ptrdiff_t)arg_count + 1;
-            push(NIL_VAL);
+            fill_cache(cache, receiver, IC_ARRAY_ADD, NULL);
+            array_add(arg_count);
             return true;
         }
         else if (!strcmp(name->chars, "contains")) {
-            if (arg_count != 1) {
-                runtime_error("'contains()' takes only one argument.");
-                return false;
-            }
-            ValueArray* array = AS_ARRAY(receiver);
-            Value ret = value_array_contains(array, peek(0)) ? TRUE_VAL : FALSE_VAL;            
-            vm.stack_top -= (ptrdiff_t)arg_count + 1;
-            push(ret);
-            return true;
+            fill_cache(cache, receiver, IC_ARRAY_CONTAINS, NULL);
+            return array_contains(arg_count);
         }
     }
 
@@ -386,16 +821,26 @@ bool invoke(ObjString* name, int arg_count)
 
     ObjInstance* instance = AS_INSTANCE(receiver);
 
-    Value value;
     if (table_get(&instance->fields, name, &value)) {
         vm.stack_top[-arg_count - 1] = value;
         return call_value(value, arg_count);
     }
 
+    if (table_get(&instance->klass->methods, name, &value)) {
+        entry = fill_cache(cache, receiver, IC_METHOD, instance->klass);
+        if (entry != NULL)
+            entry->target = AS_OBJ(value);
+    }
+
     return invoke_from_class(instance->klass, name, arg_count);
 }
 
-static bool bind_method(ObjClass* klass, ObjString* name)
+bool invoke(ObjString* name, int arg_count)
+{
+    return invoke_cached(name, arg_count, NULL);
+}
+
+static bool bind_method(ObjClass* klass, ObjString* name, InlineCache* cache)
 {
     Value method;
     if (!table_get(&klass->methods, name, &method)) {
@@ -403,12 +848,142 @@ static bool bind_method(ObjClass* klass, ObjString* name)
         return false;
     }
 
+    InlineCacheEntry* entry = fill_cache(cache, peek(0), IC_METHOD, klass);
+    if (entry != NULL)
+        entry->target = AS_OBJ(method);
+
     ObjBoundMethod* bound = new_bound_method(peek(0), AS_CLOSURE(method));
     pop();
     push(OBJ_VAL(bound));
     return true;
 }
 
+static bool get_property(ObjString* name, InlineCache* cache)
+{
+    Value comp = peek(0);
+    Value value;
+
+    InlineCacheEntry* entry = find_cache_entry(cache, comp);
+    if (entry != NULL) {
+        switch (entry->kind) {
+        case IC_COUNT:
+            value = INT_VAL(builtin_count(comp));
+            pop();
+            push(value);
+            return true;
+        case IC_FIELD:
+            value = get_entity_field(AS_ENTITY(comp), entry->field);
+            pop();
+            push(value);
+            return true;
+        case IC_METHOD:
+            if (!table_get(receiver_fields(comp), name, &value)) {
+                ObjBoundMethod* bound = new_bound_method(comp,
+                    (ObjClosure*)entry->target);
+                pop();
+                push(OBJ_VAL(bound));
+                return true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (IS_ARRAY(comp) || IS_TABLE(comp) || IS_LIST(comp)) {
+        if (!strcmp(name->chars, "count")) {
+            fill_cache(cache, comp, IC_COUNT, NULL);
+            value = INT_VAL(builtin_count(comp));
+            pop();
+            push(value);
+            return true;
+        }
+
+        const char* kind = IS_ARRAY(comp) ? "array"
+            : IS_TABLE(comp) ? "table" : "list";
+        runtime_error("Bad %s accessor '.%s'.", kind, name->chars);
+        return false;
+    }
+
+    if (IS_ENUM(comp)) {
+        ObjEnum* enum_obj = AS_ENUM(comp);
+        if (!strcmp(name->chars, "count")) {
+            fill_cache(cache, comp, IC_COUNT, NULL);
+            value = INT_VAL(enum_obj->values.count);
+            pop();
+            push(value);
+            return true;
+        }
+
+        if (table_get(&enum_obj->values, name, &value)) {
+            pop();
+            push(value);
+            return true;
+        }
+
+        const char* enum_name = enum_obj->name != NULL
+            ? enum_obj->name->chars : "<enum>";
+        runtime_error("Enum '%s' has no member '%s'.",
+            enum_name, name->chars);
+        return false;
+    }
+
+    if (IS_COROUTINE(comp)) {
+        if (!strcmp(name->chars, "done")) {
+            value = BOOL_VAL(AS_COROUTINE(comp)->state == CO_DONE);
+            pop();
+            push(value);
+            return true;
+        }
+
+        runtime_error("Bad coroutine accessor '.%s'.", name->chars);
+        return false;
+    }
+
+    if (!IS_INSTANCE(comp) && !IS_ENTITY(comp)) {
+        runtime_error("Only instances and entities have properties.");
+        return false;
+    }
+
+    if (IS_INSTANCE(comp)) {
+        ObjInstance* instance = AS_INSTANCE(comp);
+        if (table_get(&instance->fields, name, &value)) {
+            pop(); // Instance.
+            push(value);
+            return true;
+        }
+
+        return bind_method(instance->klass, name, cache);
+    }
+
+    Entity* entity = AS_ENTITY(comp);
+
+    const EntityField* native = find_entity_field(entity, name);
+    if (native != NULL) {
+        entry = fill_cache(cache, comp, IC_FIELD, NULL);
+        if (entry != NULL)
+            entry->field = native;
+        value = get_entity_field(entity, native);
+        pop(); // Entity.
+        push(value);
+        return true;
+    }
+
+    if (table_get(&entity->fields, name, &value)) {
+        pop(); // Entity.
+
+        if (IS_RAW_PTR(value)) {
+            push(marshal_raw_ptr(AS_RAW_PTR(value)));
+            return true;
+        }
+
+        push(value);
+        return true;
+    }
+
+    return bind_method(entity->klass, name, cache);
+}
+
 static ObjUpvalue* capture_upvalue(Value* local)
 {
     ObjUpvalue* prev_upvalue = NULL;
@@ -439,6 +1014,7 @@ static void close_upvalues(Value* last)
 {
     while (vm.open_upvalues != NULL && vm.open_upvalues->location >= last) {
         ObjUpvalue* upvalue = vm.open_upvalues;
+        GC_BARRIER(*upvalue->location);
         upvalue->closed = *upvalue->location;
         upvalue->location = &upvalue->closed;
         vm.open_upvalues = upvalue->next;
@@ -451,6 +1027,7 @@ static void define_method(ObjString* name)
     if (IS_CLASS(peek(1))) {
         ObjClass* klass = AS_CLASS(peek(1));
         table_set(&klass->methods, name, method);
+        invalidate_inline_caches();
     }
     else if (IS_ENTITY(peek(1))) {
         Entity* entity = AS_ENTITY(peek(1));
@@ -678,6 +1255,48 @@ static bool each_advance()
     }
 }
 
+static inline void push_local(Value value)
+{
+    if (IS_RAW_PTR(value))
+        push(marshal_raw_ptr(AS_RAW_PTR(value)));
+    else
+        push(value);
+}
+
+static bool get_global(ObjString* name, Value* value)
+{
+    // Check for an in-game (player-driven) execution context and look up
+    // in-game commands. Treat them like native functions.
+    if (exec_context.me != NULL) {
+        if (table_get(&native_cmds, name, value))
+            return true;
+
+        if (exec_context.me->pcdata == NULL
+            && table_get(&native_mob_cmds, name, value))
+            return true;
+    }
+
+    if (!table_get(&vm.globals, name, value)) {
+        runtime_error("Undefined global variable '%s'.", name->chars);
+        return false;
+    }
+
+    return true;
+}
+
+static void trace_instruction(CallFrame* frame)
+{
+    print_stack();
+    disassemble_instruction(&frame->closure->function->chunk,
+        (int)(frame->ip - frame->closure->function->chunk.code));
+}
+
+// Labels-as-values and computed goto are GNU extensions.
+#ifdef LOX_THREADED_DISPATCH
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
 InterpretResult run()
 {
     char err_buf[256] = { 0 };
@@ -690,6 +1309,10 @@ InterpretResult run()
         *frame->ip & 0x80 ? READ_SHORT() & 0x7fff : READ_BYTE() \
         ])
 #define READ_STRING() AS_STRING(READ_CONSTANT())
+#define READ_CACHE() \
+    (&frame->closure->function->chunk.caches[ \
+        *frame->ip & 0x80 ? READ_SHORT() & 0x7fff : READ_BYTE() \
+        ])
 #define BINARY_OP(op) \
     do { \
       if ((!IS_INT(peek(0)) && !IS_DOUBLE(peek(0))) \
@@ -730,39 +1353,110 @@ InterpretResult run()
       } \
     } while (false)
 
-    for (;;) {
-#ifndef DEBUG_TRACE_EXECUTION
-        if (test_trace_exec) {
+#ifdef DEBUG_TRACE_EXECUTION
+#define TRACE_INSTRUCTION() trace_instruction(frame)
+#else
+#define TRACE_INSTRUCTION() \
+    do { \
+        if (test_trace_exec) \
+            trace_instruction(frame); \
+    } while (false)
 #endif
-            print_stack();
-            disassemble_instruction(&frame->closure->function->chunk,
-                (int)(frame->ip - frame->closure->function->chunk.code));
-#ifndef DEBUG_TRACE_EXECUTION
-        }
+
+#ifdef LOX_THREADED_DISPATCH
+    // Each handler jumps straight to the next one instead of going back
+    // through the switch, which gives the branch predictor one indirect jump
+    // per opcode to learn instead of a single shared one.
+    static void* dispatch_table[] = {
+        [OP_CONSTANT] = &&OP_CONSTANT_label,
+        [OP_NIL] = &&OP_NIL_label,
+        [OP_TRUE] = &&OP_TRUE_label,
+        [OP_FALSE] = &&OP_FALSE_label,
+        [OP_GET_SUPER] = &&OP_GET_SUPER_label,
+        [OP_EQUAL] = &&OP_EQUAL_label,
+        [OP_POP] = &&OP_POP_label,
+        [OP_GET_LOCAL] = &&OP_GET_LOCAL_label,
+        [OP_SET_LOCAL] = &&OP_SET_LOCAL_label,
+        [OP_GET_GLOBAL] = &&OP_GET_GLOBAL_label,
+        [OP_DEFINE_GLOBAL] = &&OP_DEFINE_GLOBAL_label,
+        [OP_SET_GLOBAL] = &&OP_SET_GLOBAL_label,
+        [OP_GET_UPVALUE] = &&OP_GET_UPVALUE_label,
+        [OP_SET_UPVALUE] = &&OP_SET_UPVALUE_label,
+        [OP_GET_PROPERTY] = &&OP_GET_PROPERTY_label,
+        [OP_SET_PROPERTY] = &&OP_SET_PROPERTY_label,
+        [OP_GET_AT_INDEX] = &&OP_GET_AT_INDEX_label,
+        [OP_SET_AT_INDEX] = &&OP_SET_AT_INDEX_label,
+        [OP_BOX_PTR] = &&OP_BOX_PTR_label,
+        [OP_UNBOX_VAL] = &&OP_UNBOX_VAL_label,
+        [OP_GREATER] = &&OP_GREATER_label,
+        [OP_LESS] = &&OP_LESS_label,
+        [OP_ADD] = &&OP_ADD_label,
+        [OP_SUBTRACT] = &&OP_SUBTRACT_label,
+        [OP_MULTIPLY] = &&OP_MULTIPLY_label,
+        [OP_DIVIDE] = &&OP_DIVIDE_label,
+        [OP_NOT] = &&OP_NOT_label,
+        [OP_NEGATE] = &&OP_NEGATE_label,
+        [OP_PRINT] = &&OP_PRINT_label,
+        [OP_JUMP] = &&OP_JUMP_label,
+        [OP_JUMP_IF_FALSE] = &&OP_JUMP_IF_FALSE_label,
+        [OP_LOOP] = &&OP_LOOP_label,
+        [OP_CALL] = &&OP_CALL_label,
+        [OP_ARRAY] = &&OP_ARRAY_label,
+        [OP_INVOKE] = &&OP_INVOKE_label,
+        [OP_SUPER_INVOKE] = &&OP_SUPER_INVOKE_label,
+        [OP_CLOSURE] = &&OP_CLOSURE_label,
+        [OP_CLOSE_UPVALUE] = &&OP_CLOSE_UPVALUE_label,
+        [OP_RETURN] = &&OP_RETURN_label,
+        [OP_CLASS] = &&OP_CLASS_label,
+        [OP_INHERIT] = &&OP_INHERIT_label,
+        [OP_METHOD] = &&OP_METHOD_label,
+        [OP_EACH_PRIME] = &&OP_EACH_PRIME_label,
+        [OP_EACH_OR_END] = &&OP_EACH_OR_END_label,
+        [OP_EACH_ADVANCE] = &&OP_EACH_ADVANCE_label,
+        [OP_INTERP] = &&OP_INTERP_label,
+        [OP_CALL_GLOBAL] = &&OP_CALL_GLOBAL_label,
+        [OP_YIELD] = &&OP_YIELD_label,
+        [OP_SELF] = &&OP_SELF_label,
+        [OP_GET_LOCAL_PROPERTY] = &&OP_GET_LOCAL_PROPERTY_label,
+        [OP_ADD_CONSTANT] = &&OP_ADD_CONSTANT_label,
+        [OP_EQUAL_JUMP] = &&OP_EQUAL_JUMP_label,
+        [OP_GREATER_JUMP] = &&OP_GREATER_JUMP_label,
+        [OP_LESS_JUMP] = &&OP_LESS_JUMP_label,
+    };
+#define CASE(op) case op: op##_label
+#define DISPATCH() \
+    do { \
+        TRACE_INSTRUCTION(); \
+        vm.exec_count++; \
+        goto *dispatch_table[READ_BYTE()]; \
+    } while (false)
+#else
+#define CASE(op) case op
+#define DISPATCH() break
 #endif
+
+    // The first instruction (and every one, without threaded dispatch) goes
+    // through the switch.
+    for (;;) {
+        TRACE_INSTRUCTION();
+        vm.exec_count++;
         uint8_t instruction = READ_BYTE();
         switch (instruction/* = READ_BYTE()*/) {
-        case OP_CONSTANT: {
+        CASE(OP_CONSTANT): {
                 Value constant = READ_CONSTANT();
                 push(constant);
-                break;
+                DISPATCH();
             }
-        case OP_NIL:        push(NIL_VAL); break;
-        case OP_TRUE:       push(BOOL_VAL(true)); break;
-        case OP_FALSE:      push(BOOL_VAL(false)); break;
-        case OP_POP:        pop(); break;
-        case OP_GET_LOCAL: {
+        CASE(OP_NIL):        push(NIL_VAL); DISPATCH();
+        CASE(OP_TRUE):       push(BOOL_VAL(true)); DISPATCH();
+        CASE(OP_FALSE):      push(BOOL_VAL(false)); DISPATCH();
+        CASE(OP_POP):        pop(); DISPATCH();
+        CASE(OP_GET_LOCAL): {
                 uint8_t slot = READ_BYTE();
-
-                if (IS_RAW_PTR(frame->slots[slot])) {
-                    push(marshal_raw_ptr(AS_RAW_PTR(frame->slots[slot])));
-                    break;
-                }
-
-                push(frame->slots[slot]);
-                break;
+                push_local(frame->slots[slot]);
+                DISPATCH();
             }
-        case OP_SET_LOCAL: {
+        CASE(OP_SET_LOCAL): {
                 uint8_t slot = READ_BYTE();
 
                 if (IS_RAW_PTR(frame->slots[slot])) {
@@ -772,170 +1466,50 @@ InterpretResult run()
                 else {
                     frame->slots[slot] = peek(0);
                 }
-                break;
+                DISPATCH();
             }
-        case OP_GET_GLOBAL: {
+        CASE(OP_GET_GLOBAL): {
                 ObjString* name = READ_STRING();
                 Value value;
-
-                // Check for an in-game (player-driven) execution context and 
-                // look up in-game commands. Treat them like native functions.
-                if (exec_context.me != NULL) {
-                    if (table_get(&native_cmds, name, &value)) {
-                        push(value);
-                        break;
-                    }
-
-                    if (exec_context.me->pcdata == NULL) {
-                        if (table_get(&native_mob_cmds, name, &value)) {
-                            push(value);
-                            break;
-                        }
-                    }
-                }
-
-                if (!table_get(&vm.globals, name, &value)) {
-                    runtime_error("Undefined global variable '%s'.", name->chars);
+                if (!get_global(name, &value))
                     return INTERPRET_RUNTIME_ERROR;
-                }
                 push(value);
-                break;
+                DISPATCH();
             }
-        case OP_DEFINE_GLOBAL: {
+        CASE(OP_DEFINE_GLOBAL): {
                 ObjString* name = READ_STRING();
                 table_set(&vm.globals, name, peek(0));
                 pop();
-                break;
+                DISPATCH();
             }
-        case OP_SET_GLOBAL: {
+        CASE(OP_SET_GLOBAL): {
                 ObjString* name = READ_STRING();
                 if (table_set(&vm.globals, name, peek(0))) {
                     table_delete(&vm.globals, name);
                     runtime_error("Undefined global variable '%s'.", name->chars);
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                DISPATCH();
             }
-        case OP_GET_UPVALUE: {
+        CASE(OP_GET_UPVALUE): {
                 uint8_t slot = READ_BYTE();
                 push(*frame->closure->upvalues[slot]->location);
-                break;
+                DISPATCH();
             }
-        case OP_SET_UPVALUE: {
+        CASE(OP_SET_UPVALUE): {
                 uint8_t slot = READ_BYTE();
+                GC_BARRIER(peek(0));
                 *frame->closure->upvalues[slot]->location = peek(0);
-                break;
+                DISPATCH();
             }
-        case OP_GET_PROPERTY: {
+        CASE(OP_GET_PROPERTY): {
                 ObjString* name = READ_STRING();
-                Value comp = peek(0);
-
-                if (IS_ARRAY(comp)) {
-                    ValueArray* array_ = AS_ARRAY(comp);
-                    if (!strcmp(name->chars, "count")) {
-                        Value count = INT_VAL(array_->count);
-                        pop(); // Array
-                        push(count);
-                        break;
-                    }
-                    else {
-                        runtime_error("Bad array accessor '.%s'.", name->chars);
-                        return INTERPRET_RUNTIME_ERROR;
-                    }
-                }
-
-                if (IS_TABLE(comp)) {
-                    Table* table = AS_TABLE(comp);
-                    if (!strcmp(name->chars, "count")) {
-                        Value count = INT_VAL(table->count);
-                        pop(); // Array
-                        push(count);
-                        break;
-                    }
-                    else {
-                        runtime_error("Bad table accessor '.%s'.", name->chars);
-                        return INTERPRET_RUNTIME_ERROR;
-                    }
-                }
-
-                if (IS_LIST(comp)) {
-                    List* list = AS_LIST(comp);
-                    if (!strcmp(name->chars, "count")) {
-                        Value count = INT_VAL(list->count);
-                        pop(); // Array
-                        push(count);
-                        break;
-                    }
-                    else {
-                        runtime_error("Bad list accessor '.%s'.", name->chars);
-                        return INTERPRET_RUNTIME_ERROR;
-                    }
-                }
-
-                if (IS_ENUM(comp)) {
-                    ObjEnum* enum_obj = AS_ENUM(comp);
-                    if (!strcmp(name->chars, "count")) {
-                        Value count = INT_VAL(enum_obj->values.count);
-                        pop();
-                        push(count);
-                        break;
-                    }
-
-                    Value value;
-                    if (table_get(&enum_obj->values, name, &value)) {
-                        pop();
-                        push(value);
-                        break;
-                    }
-
-                    const char* enum_name = enum_obj->name != NULL
-                        ? enum_obj->name->chars : "<enum>";
-                    runtime_error("Enum '%s' has no member '%s'.",
-                        enum_name, name->chars);
-                    return INTERPRET_RUNTIME_ERROR;
-                }
-
-                if (!IS_INSTANCE(comp) && !IS_ENTITY(comp)) {
-                    runtime_error("Only instances and entities have properties.");
+                InlineCache* cache = READ_CACHE();
+                if (!get_property(name, cache))
                     return INTERPRET_RUNTIME_ERROR;
-                }
-
-                if (IS_INSTANCE(comp)) {
-                    ObjInstance* instance = AS_INSTANCE(comp);
-                    Value value;
-                    if (table_get(&instance->fields, name, &value)) {
-                        pop(); // Instance.
-                        push(value);
-                        break;
-                    }
-
-                    if (!bind_method(instance->klass, name)) {
-                        return INTERPRET_RUNTIME_ERROR;
-                    }
-                }
-                else {
-                    Entity* entity = AS_ENTITY(comp);
-                    Value value;
-
-                    if (table_get(&entity->fields, name, &value)) {
-                        pop(); // Entity.
-
-                        if (IS_RAW_PTR(value)) {
-                            push(marshal_raw_ptr(AS_RAW_PTR(value)));
-                            break;
-                        }
-
-                        push(value);
-                        break;
-                    }
-
-                    if (!bind_method(entity->klass, name)) {
-                        return INTERPRET_RUNTIME_ERROR;
-                    }
-                }
-                break;
+                DISPATCH();
             }
-        case OP_SET_PROPERTY: {
+        CASE(OP_SET_PROPERTY): {
                 Value comp = peek(1);
                 ObjString* field = READ_STRING();
 
@@ -961,7 +1535,12 @@ InterpretResult run()
                 else {
                     Entity* entity = AS_ENTITY(comp);
                     Value current_value;
-                    if (table_get(&entity->fields, field, &current_value) && IS_RAW_PTR(current_value)) {
+                    const EntityField* native = find_entity_field(entity, field);
+                    if (native != NULL) {
+                        if (!set_entity_field(entity, native, peek(0)))
+                            return INTERPRET_RUNTIME_ERROR;
+                    }
+                    else if (table_get(&entity->fields, field, &current_value) && IS_RAW_PTR(current_value)) {
                         ObjRawPtr* raw = AS_RAW_PTR(current_value);
                         unmarshal_raw_val(raw, peek(0));
                     }
@@ -972,9 +1551,9 @@ InterpretResult run()
                 Value value = pop();
                 pop();
                 push(value);
-                break;
+                DISPATCH();
             }
-        case OP_GET_AT_INDEX: {
+        CASE(OP_GET_AT_INDEX): {
                 if (!IS_INT(peek(0))) {
                     runtime_error("Array indexes must be integers.");
                     return INTERPRET_RUNTIME_ERROR;
@@ -993,9 +1572,9 @@ InterpretResult run()
                 }
                 pop();
                 push(val_array->values[index]);
-                break;
+                DISPATCH();
             }
-        case OP_SET_AT_INDEX: {
+        CASE(OP_SET_AT_INDEX): {
                 if (!IS_INT(peek(1))) {
                     runtime_error("Array indexes must be integers.");
                     return INTERPRET_RUNTIME_ERROR;
@@ -1012,44 +1591,45 @@ InterpretResult run()
                     sprintf(err_buf, "Index %d is out of bounds.", index);
                     runtime_error(err_buf);
                 }
+                GC_BARRIER(peek(0));
                 val_array->values[index] = peek(0);
                 pop();
                 pop();
-                break;
+                DISPATCH();
             }
-        case OP_GET_SUPER: {
+        CASE(OP_GET_SUPER): {
                 ObjString* name = READ_STRING();
                 ObjClass* superclass = AS_CLASS(pop());
 
-                if (!bind_method(superclass, name)) {
+                if (!bind_method(superclass, name, NULL)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
-                break;
+                DISPATCH();
             }
-        case OP_EQUAL:{
+        CASE(OP_EQUAL): {
                 Value b = pop();
                 Value a = pop();
                 push(BOOL_VAL(values_equal(a, b)));
-                break;
+                DISPATCH();
             }
-        case OP_GREATER:    BOOL_OP(>); break;
-        case OP_LESS:       BOOL_OP(<); break;
-        case OP_ADD: {
+        CASE(OP_GREATER):    BOOL_OP(>); DISPATCH();
+        CASE(OP_LESS):       BOOL_OP(<); DISPATCH();
+        CASE(OP_ADD): {
                 if (IS_STRING(peek(0)) || IS_STRING(peek(1))) {
                     concatenate();
                 }
                 else {
                     BINARY_OP(+);
                 }
-                break;
+                DISPATCH();
             }
-        case OP_SUBTRACT:   BINARY_OP(-); break;
-        case OP_MULTIPLY:   BINARY_OP(*); break;
-        case OP_DIVIDE:     BINARY_OP(/); break;
-        case OP_NOT:
+        CASE(OP_SUBTRACT):   BINARY_OP(-); DISPATCH();
+        CASE(OP_MULTIPLY):   BINARY_OP(*); DISPATCH();
+        CASE(OP_DIVIDE):     BINARY_OP(/); DISPATCH();
+        CASE(OP_NOT):
             push(BOOL_VAL(is_falsey(pop())));
-            break;
-        case OP_NEGATE:
+            DISPATCH();
+        CASE(OP_NEGATE):
             if (IS_DOUBLE(peek(0)))
                 push(DOUBLE_VAL(-AS_DOUBLE(pop())));
             else if (IS_INT(peek(0)))
@@ -1058,37 +1638,68 @@ InterpretResult run()
                 runtime_error("Operand must be a number.");
                 return INTERPRET_RUNTIME_ERROR;
             }
-            break;
-        case OP_PRINT: {
+            DISPATCH();
+        CASE(OP_PRINT): {
                 print_value(pop());
                 lox_printf("\n");
-                break;
+                DISPATCH();
             }
-        case OP_JUMP: {
+        CASE(OP_JUMP): {
                 uint16_t offset = READ_SHORT();
                 frame->ip += offset;
-                break;
+                DISPATCH();
             }
-        case OP_JUMP_IF_FALSE: {
+        CASE(OP_JUMP_IF_FALSE): {
                 uint16_t offset = READ_SHORT();
                 if (is_falsey(peek(0)))
                     frame->ip += offset;
-                break;
+                DISPATCH();
             }
-        case OP_LOOP: {
+        CASE(OP_LOOP): {
                 uint16_t offset = READ_SHORT();
                 frame->ip -= offset;
-                break;
+                if (vm.exec_count > vm.exec_limit) {
+                    stop_over_budget();
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                DISPATCH();
             }
-        case OP_CALL: {
+        CASE(OP_CALL): {
                 int arg_count = READ_BYTE();
                 if (!call_value(peek(arg_count), arg_count)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 frame = &vm.frames[vm.frame_count - 1];
-                break;
+                DISPATCH();
             }
-        case OP_ARRAY: {
+        CASE(OP_CALL_GLOBAL): {
+                ObjString* name = READ_STRING();
+                int arg_count = READ_BYTE();
+                Value callee;
+                if (!get_global(name, &callee))
+                    return INTERPRET_RUNTIME_ERROR;
+
+                if (IS_NATIVE(callee)) {
+                    // The common case; nothing to put under the arguments.
+                    NativeFn native = AS_NATIVE(callee);
+                    Value result = native(arg_count, vm.stack_top - arg_count);
+                    vm.stack_top -= arg_count;
+                    push(result);
+                    DISPATCH();
+                }
+
+                // Slide the arguments up to make room for the callee.
+                Value* args = vm.stack_top - arg_count;
+                memmove(args + 1, args, sizeof(Value) * (size_t)arg_count);
+                *args = callee;
+                vm.stack_top++;
+                if (!call_value(callee, arg_count)) {
+                    return INTERPRET_RUNTIME_ERROR;
+                }
+                frame = &vm.frames[vm.frame_count - 1];
+                DISPATCH();
+            }
+        CASE(OP_ARRAY): {
                 ValueArray* array_ = new_obj_array();
                 int elem_count = READ_BYTE();
                 for (int i = 0; i < elem_count; ++i) {
@@ -1096,18 +1707,19 @@ InterpretResult run()
                 }
                 vm.stack_top -= elem_count;
                 push(OBJ_VAL(array_));
-                break;
+                DISPATCH();
             }
-        case OP_INVOKE: {
+        CASE(OP_INVOKE): {
                 ObjString* method = READ_STRING();
                 int arg_count = READ_BYTE();
-                if (!invoke(method, arg_count)) {
+                InlineCache* cache = READ_CACHE();
+                if (!invoke_cached(method, arg_count, cache)) {
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 frame = &vm.frames[vm.frame_count - 1];
-                break;
+                DISPATCH();
             }
-        case OP_SUPER_INVOKE: {
+        CASE(OP_SUPER_INVOKE): {
                 ObjString* method = READ_STRING();
                 int arg_count = READ_BYTE();
                 ObjClass* superclass = AS_CLASS(pop());
@@ -1115,9 +1727,9 @@ InterpretResult run()
                     return INTERPRET_RUNTIME_ERROR;
                 }
                 frame = &vm.frames[vm.frame_count - 1];
-                break;
+                DISPATCH();
             }
-        case OP_CLOSURE: {
+        CASE(OP_CLOSURE): {
                 ObjFunction* function = AS_FUNCTION(READ_CONSTANT());
                 ObjClosure* closure = new_closure(function);
                 push(OBJ_VAL(closure));
@@ -1132,16 +1744,20 @@ InterpretResult run()
                         closure->upvalues[i] = frame->closure->upvalues[index];
                     }
                 }
-                break;
+                DISPATCH();
             }
-        case OP_CLOSE_UPVALUE:
+        CASE(OP_CLOSE_UPVALUE):
             close_upvalues(vm.stack_top - 1);
             pop();
-            break;
-        case OP_RETURN: {
+            DISPATCH();
+        CASE(OP_RETURN): {
                 Value result = pop();
+                charge_function(frame->closure->function);
                 close_upvalues(frame->slots);
                 DECREMENT_FRAME_COUNT();
+                if (vm.current_coroutine != NULL
+                    && vm.frame_count == vm.current_coroutine->frame_base)
+                    finish_coroutine(result);
                 if (vm.frame_count == 0) {
                     repl_ret_val = result;
                     pop();
@@ -1152,12 +1768,21 @@ InterpretResult run()
                 push(result);
                 frame = &vm.frames[vm.frame_count - 1];
 
-                break;
+                DISPATCH();
             }
-        case OP_CLASS:
+        CASE(OP_YIELD): {
+                if (!yield_coroutine())
+                    return INTERPRET_RUNTIME_ERROR;
+                // Back to whoever resumed it; if that was the game, return.
+                if (vm.frame_count == 0)
+                    return INTERPRET_OK;
+                frame = &vm.frames[vm.frame_count - 1];
+                DISPATCH();
+            }
+        CASE(OP_CLASS):
             push(OBJ_VAL(new_class(READ_STRING())));
-            break;
-        case OP_INHERIT: {
+            DISPATCH();
+        CASE(OP_INHERIT): {
                 Value superclass = peek(1);
                 if (!IS_CLASS(superclass)) {
                     runtime_error("Superclass must be a class.");
@@ -1165,45 +1790,99 @@ InterpretResult run()
                 }
                 ObjClass* subclass = AS_CLASS(peek(0));
                 table_add_all(&AS_CLASS(superclass)->methods, &subclass->methods);
+                invalidate_inline_caches();
                 pop(); // Subclass.
-                break;
+                DISPATCH();
             }
-        case OP_METHOD:
+        CASE(OP_METHOD):
             define_method(READ_STRING());
-            break;
-        case OP_EACH_PRIME: {
+            DISPATCH();
+        CASE(OP_EACH_PRIME): {
             if (!each_prime(peek(0), peek(1))) {
                 return INTERPRET_RUNTIME_ERROR;
             }
             frame = &vm.frames[vm.frame_count - 1];
-            break;
+            DISPATCH();
         }
-        case OP_EACH_OR_END: {
+        CASE(OP_EACH_OR_END): {
             uint16_t offset = READ_SHORT();
             if (!each_or_end())
                 frame->ip += offset;
             else
                 frame = &vm.frames[vm.frame_count - 1];
-            break;
+            DISPATCH();
         }
-        case OP_EACH_ADVANCE: {
+        CASE(OP_EACH_ADVANCE): {
             if (!each_advance()) {
                 return INTERPRET_RUNTIME_ERROR;
             }
-            break;
+            DISPATCH();
         }
-        case OP_INTERP: {
+        CASE(OP_INTERP): {
             int count = READ_BYTE();
             interpolate_string(count);
-            break;
+            DISPATCH();
         }
         // In-game entities
-        case OP_SELF:
+        CASE(OP_SELF):
             if (exec_context.me != NULL)
                 push(OBJ_VAL(exec_context.me));
             else
                 push(NIL_VAL);
-            break;
+            DISPATCH();
+        // Superinstructions (see chunk.h)
+        CASE(OP_GET_LOCAL_PROPERTY): {
+                uint8_t slot = READ_BYTE();
+                push_local(frame->slots[slot]);
+                frame->ip++;    // OP_GET_PROPERTY
+                ObjString* name = READ_STRING();
+                InlineCache* cache = READ_CACHE();
+                if (!get_property(name, cache))
+                    return INTERPRET_RUNTIME_ERROR;
+                DISPATCH();
+            }
+        CASE(OP_ADD_CONSTANT): {
+                Value constant = READ_CONSTANT();
+                if (IS_INT(peek(0)) && IS_INT(constant)) {
+                    vm.stack_top[-1] = INT_VAL(AS_INT(peek(0)) + AS_INT(constant));
+                    frame->ip++;    // OP_ADD
+                }
+                else {
+                    // Strings and doubles; let OP_ADD sort them out.
+                    push(constant);
+                }
+                DISPATCH();
+            }
+        CASE(OP_EQUAL_JUMP): {
+                Value b = pop();
+                Value a = pop();
+                push(BOOL_VAL(values_equal(a, b)));
+                frame->ip++;    // OP_JUMP_IF_FALSE
+                uint16_t offset = READ_SHORT();
+                if (is_falsey(peek(0)))
+                    frame->ip += offset;
+                DISPATCH();
+            }
+        CASE(OP_GREATER_JUMP): {
+                BOOL_OP(>);
+                frame->ip++;    // OP_JUMP_IF_FALSE
+                uint16_t offset = READ_SHORT();
+                if (is_falsey(peek(0)))
+                    frame->ip += offset;
+                DISPATCH();
+            }
+        CASE(OP_LESS_JUMP): {
+                BOOL_OP(<);
+                frame->ip++;    // OP_JUMP_IF_FALSE
+                uint16_t offset = READ_SHORT();
+                if (is_falsey(peek(0)))
+                    frame->ip += offset;
+                DISPATCH();
+            }
+        // Never emitted by the compiler.
+        CASE(OP_BOX_PTR):
+        CASE(OP_UNBOX_VAL):
+            DISPATCH();
         } // end switch
     }
 
@@ -1211,16 +1890,32 @@ InterpretResult run()
 #undef READ_SHORT
 #undef READ_CONSTANT
 #undef READ_STRING
+#undef READ_CACHE
 #undef BINARY_OP
+#undef BOOL_OP
+#undef TRACE_INSTRUCTION
+#undef CASE
+#undef DISPATCH
 }
 
+#ifdef LOX_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
 InterpretResult interpret_code(const char* source)
 {
-    repl_ret_val = NIL_VAL;
-
     ObjFunction* function = compile(source);
-    if (function == NULL) 
+    if (function == NULL) {
+        repl_ret_val = NIL_VAL;
         return INTERPRET_COMPILE_ERROR;
+    }
+
+    return interpret_function(function);
+}
+
+InterpretResult interpret_function(ObjFunction* function)
+{
+    repl_ret_val = NIL_VAL;
 
     push(OBJ_VAL(function));
     ObjClosure* closure = new_closure(function);
@@ -1317,6 +2012,25 @@ InterpretResult invoke_closure(ObjClosure* closure, int count, ...)
     return rc;
 }
 
+InterpretResult resume_coroutine(ObjCoroutine* coroutine, Value value)
+{
+    Value* saved_stack_top = vm.stack_top;
+
+    push(OBJ_VAL(coroutine));
+    push(value);
+
+    if (!call_coroutine(coroutine, 1)) {
+        vm.stack_top = saved_stack_top;
+        return INTERPRET_RUNTIME_ERROR;
+    }
+
+    InterpretResult rc = run();
+
+    vm.stack_top = saved_stack_top;
+
+    return rc;
+}
+
 void invoke_method_closure(Value receiver, ObjClosure* closure, int count, ...)
 {
     reset_stack();
@@ -18,6 +18,7 @@
 #include <stdarg.h>
 
 typedef struct entity_t Entity;
+typedef struct obj_coroutine_t ObjCoroutine;
 
 #define FRAMES_MAX 128
 #define STACK_MAX (FRAMES_MAX * UINT8_COUNT)
@@ -38,6 +39,7 @@ typedef struct {
     Table strings;
     ObjString* init_string;
     ObjUpvalue* open_upvalues;
+    ObjCoroutine* current_coroutine;    // Innermost running coroutine
 
     size_t bytes_allocated;
     size_t next_gc;
@@ -47,6 +49,18 @@ typedef struct {
     Obj** gray_stack;
     uint32_t current_gc_mark;
     bool gc_running;
+    uint32_t ic_epoch;          // Inline cache entries from older epochs are stale
+
+    // Script budget and profiling. The counters only ever go up; the charge
+    // marks are where the running frame's costs were last charged to it.
+    uint64_t exec_count;        // Instructions run
+    uint64_t exec_limit;        // The running script is stopped past this
+    uint64_t alloc_count;       // Objects allocated
+    uint64_t charge_exec;
+    uint64_t charge_alloc;
+    uint64_t charge_usec;
+    bool profile_time;
+    Table class_budgets;        // Class name -> instruction budget
 } VM;
 
 extern VM vm;
@@ -63,6 +77,9 @@ void runtime_error(const char* format, ...);
 InterpretResult call_function(const char* fn_name, int count, ...);
 void init_entity_class(Entity* entity);
 void invoke_method_closure(Value receiver, ObjClosure* closure, int count, ...);
+void invalidate_inline_caches();
+void set_class_budget(ObjString* class_name, int budget);
+int get_class_budget(ObjString* class_name);
 
 void gc_protect(Value value);
 void gc_protect_clear();
@@ -1343,7 +1343,7 @@ void spell_create_water(SKNUM sn, LEVEL level, Mobile* ch, void* vo, SpellTarget
 
             sprintf(buf, "%s water", NAME_STR(obj));
             int len = (int)strlen(buf);
-            NAME_FIELD(obj) = copy_string(buf, len);
+            SET_NAME(obj, copy_string(buf, len));
         }
         act("$p is filled.", ch, obj, NULL, TO_CHAR);
     }
@@ -54,6 +54,8 @@
 
 #include <entities/descriptor.h>
 
+#include <olc/area_save_queue.h>
+
 #ifdef _MSC_VER
 #include <stdint.h>
 #include <io.h>
@@ -228,6 +230,9 @@ int main(int argc, char** argv)
     game_loop(telnet_server);
 #endif
 
+    // Don't exit with area snapshots still in the save queue.
+    flush_area_saves();
+
     if (telnet_server)
         close_server(telnet_server);
 
@@ -81,6 +81,7 @@ const MobCmdInfo mob_cmd_table[] = {
     { "gforce",     do_mpgforce     },
     { "goto",       do_mpgoto       },
     { "gtransfer",  do_mpgtransfer  },
+    { "hunt",       do_mphunt       },
     { "junk",       do_mpjunk       },
     { "kill",       do_mpkill       },
     { "mload",      do_mpmload      },
@@ -1137,7 +1138,36 @@ void do_mpcall(Mobile* ch, char* argument)
     READ_ARG(arg);
     if (arg[0] != '\0')
         obj2 = get_obj_here(ch, arg);
-    program_flow(prg->vnum, prg->code, ch, vch, (void*)obj1, (void*)obj2);
+    run_mob_prog_code(prg, ch, vch, (void*)obj1, (void*)obj2);
+}
+
+/*
+ * Takes one step toward the victim, wherever it is in the world, opening
+ * doors on the way. Call it from a delay or random trigger to keep the hunt
+ * going.
+ *
+ * Syntax: mob hunt [victim]
+ */
+void do_mphunt(Mobile* ch, char* argument)
+{
+    char arg[MAX_INPUT_LENGTH];
+    Mobile* victim;
+
+    one_argument(argument, arg);
+    if (arg[0] == '\0') {
+        bug("MpHunt - No argument from vnum %"PRVNUM".",
+            IS_NPC(ch) ? VNUM_FIELD(ch->prototype) : 0);
+        return;
+    }
+
+    if (ch->fighting != NULL || ch->position < POS_STANDING)
+        return;
+
+    if ((victim = get_mob_world(ch, arg)) == NULL
+        || victim->in_room == NULL || victim->in_room == ch->in_room)
+        return;
+
+    move_toward(ch, victim->in_room, 0);
 }
 
 /*
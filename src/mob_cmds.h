@@ -82,6 +82,7 @@ DECLARE_DO_FUN(do_mpdelay);
 DECLARE_DO_FUN(do_mpcancel);
 DECLARE_DO_FUN(do_mpcall);
 DECLARE_DO_FUN(do_mpflee);
+DECLARE_DO_FUN(do_mphunt);
 DECLARE_DO_FUN(do_mpotransfer);
 DECLARE_DO_FUN(do_mpremove);
 DECLARE_DO_FUN(do_mpquest);
@@ -156,6 +156,8 @@ void free_mob_prog(MobProg* mob_prog)
         return;
 
     free_string(mob_prog->code);
+    free_mob_program(mob_prog->program);
+    mob_prog->program = NULL;
 
     INVALIDATE(mob_prog);
 
@@ -174,6 +176,8 @@ MobProgCode* new_mob_prog_code()
 void free_mob_prog_code(MobProgCode* mob_prog_code)
 {
     free_string(mob_prog_code->code);
+    free_mob_program(mob_prog_code->program);
+    mob_prog_code->program = NULL;
 
     LIST_FREE(mob_prog_code);
 }
@@ -924,7 +928,19 @@ void expand_arg(char* buf,
 #define END_BLOCK        -2 /* Flag: End of if-else-endif block */
 #define MAX_CALL_LEVEL    5 /* Maximum nested calls */
 
-void program_flow(
+static int call_level; /* Keep track of nested "mpcall"s */
+
+static bool enter_mob_prog(Mobile* mob)
+{
+    if (++call_level > MAX_CALL_LEVEL) {
+        bug("MOBprogs: MAX_CALL_LEVEL exceeded, vnum %"PRVNUM"", VNUM_FIELD(mob->prototype));
+        call_level--;
+        return false;
+    }
+    return true;
+}
+
+static void run_program_source(
     VNUM pvnum,  /* For diagnostic purposes */
     char* source,  /* the actual MOBprog code */
     Mobile* mob, Mobile* ch, const void* arg1, const void* arg2)
@@ -935,19 +951,12 @@ void program_flow(
     char control[MAX_INPUT_LENGTH] = "";
     char data[MAX_STRING_LENGTH] = "";
 
-    static int call_level; /* Keep track of nested "mpcall"s */
-
     int level, eval, check;
     int state[MAX_NESTED_LEVEL] = { 0 }; /* Block state (BEGIN,IN,END) */
     int cond[MAX_NESTED_LEVEL] = { 0 };  /* Boolean value based on the last if-check */
 
     VNUM mvnum = VNUM_FIELD(mob->prototype);
 
-    if (++call_level > MAX_CALL_LEVEL) {
-        bug("MOBprogs: MAX_CALL_LEVEL exceeded, vnum %"PRVNUM"", VNUM_FIELD(mob->prototype));
-        return;
-    }
-
     // Reset "stack"
     for (level = 0; level < MAX_NESTED_LEVEL; level++) {
         state[level] = IN_BLOCK;
@@ -1078,7 +1087,6 @@ void program_flow(
         }
         else if (cond[level] == true
             && (!str_cmp(control, "break") || !str_cmp(control, "end"))) {
-            call_level--;
             return;
         }
         else if ((!level || cond[level] == true) && buf[0] != '\0') {
@@ -1095,9 +1103,699 @@ void program_flow(
             }
         }
     }
+}
+
+void program_flow(VNUM pvnum, char* source, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2)
+{
+    if (!enter_mob_prog(mob))
+        return;
+    run_program_source(pvnum, source, mob, ch, arg1, arg2);
+    call_level--;
+}
+
+/*
+ * ------------------------------------------------------------------------
+ *  COMPILED MOBPROGS
+ *  program_flow() re-reads the source on every run. A MobProgram is the
+ *  same code split into lines once, with the control words, if-check
+ *  keywords, operators, vnums and table lookups already resolved. It is run
+ *  with the same block state machine, so both behave alike; the only
+ *  difference is that syntax errors in if-checks are reported once, when
+ *  the code is compiled, rather than every time the check is made.
+ *-------------------------------------------------------------------------
+ */
+
+typedef enum mp_op_t {
+    MP_COMMAND,
+    MP_MOB_COMMAND,
+    MP_IF,
+    MP_OR,
+    MP_AND,
+    MP_ENDIF,
+    MP_ELSE,
+    MP_BREAK,
+} MpOp;
+
+// How far cmd_eval() would get parsing an if-check
+typedef enum mp_check_kind_t {
+    CHECK_NONE,         // Nothing to check; always false
+    CHECK_INVALID,      // Syntax error; false, once the target is set
+    CHECK_VALUE,        // Case 1
+    CHECK_COUNT,        // Case 2
+    CHECK_ACTOR,        // Case 3, 4 and 5
+} MpCheckKind;
+
+typedef struct mp_check_t {
+    MpCheckKind kind;
+    int check;          // CHK_*, or -1 if the keyword is unknown
+    int oper;           // EVAL_*, or -1 if case 5 had a bad operator
+    bool negate;
+    bool is_vnum;       // 'word' was a number; it's in 'value'
+    char actor;         // $-code
+    int value;
+    FLAGS flag;
+    char* word;
+} MpCheck;
+
+typedef struct mp_line_t {
+    MpOp op;
+    bool expand;        // 'text' has $-codes
+    char* text;         // Whole line, for commands
+    MpCheck check;
+} MpLine;
+
+struct mob_program_t {
+    VNUM vnum;
+    const char* source;
+    MpLine* lines;
+    int line_count;
+    char* strings;      // Line text and words; never more than twice 'source'
+    size_t strings_used;
+};
+
+static char* save_mp_string(MobProgram* program, const char* str)
+{
+    char* saved = program->strings + program->strings_used;
+    size_t length = strlen(str);
+    memcpy(saved, str, length + 1);
+    program->strings_used += length + 1;
+    return saved;
+}
+
+static void compile_check(MobProgram* program, MpCheck* chk, int check,
+    char* line)
+{
+    char buf[MAX_INPUT_LENGTH];
+    char* original = line;
+
+    chk->check = check;
+    if (check < 0)
+        return;
+
+    line = one_argument(line, buf);
+    while (!str_cmp(buf, "not")) {
+        chk->negate = !chk->negate;
+        original = line;
+        line = one_argument(line, buf);
+    }
+
+    if (buf[0] == '\0') {
+        chk->kind = CHECK_NONE;
+        return;
+    }
+
+    switch (check) {
+    case CHK_RAND:
+        chk->kind = CHECK_VALUE;
+        chk->value = atoi(buf);
+        return;
+    case CHK_MOBHERE:
+    case CHK_OBJHERE:
+    case CHK_MOBEXISTS:
+    case CHK_OBJEXISTS:
+        chk->kind = CHECK_VALUE;
+        chk->is_vnum = is_number(buf);
+        chk->value = chk->is_vnum ? STRTOVNUM(buf) : 0;
+        chk->word = save_mp_string(program, buf);
+        return;
+    case CHK_PEOPLE:
+    case CHK_PLAYERS:
+    case CHK_MOBS:
+    case CHK_CLONES:
+    case CHK_ORDER:
+    case CHK_HOUR:
+        if ((chk->oper = keyword_lookup(fn_evals, buf)) < 0) {
+            bugf("Cmd_eval: prog %"PRVNUM" syntax error(2) '%s'",
+                program->vnum, original);
+            chk->kind = CHECK_INVALID;
+            return;
+        }
+        one_argument(line, buf);
+        chk->kind = CHECK_COUNT;
+        chk->value = atoi(buf);
+        return;
+    default:;
+    }
+
+    if (buf[0] != '$' || buf[1] == '\0') {
+        bugf("Cmd_eval: prog %"PRVNUM" syntax error(3) '%s'", program->vnum,
+            original);
+        chk->kind = CHECK_INVALID;
+        return;
+    }
+    if (strchr("intrpoq", buf[1]) == NULL) {
+        bugf("Cmd_eval: prog %"PRVNUM" syntax error(4) '%s'", program->vnum,
+            original);
+        chk->kind = CHECK_INVALID;
+        return;
+    }
+    chk->kind = CHECK_ACTOR;
+    chk->actor = buf[1];
+
+    // Case 3 needs nothing more.
+    if (check >= CHK_ISPC && check <= CHK_ISTARGET)
+        return;
+
+    // Case 4
+    line = one_argument(line, buf);
+    switch (check) {
+    case CHK_AFFECTED:
+        chk->flag = flag_lookup(buf, affect_flag_table);
+        return;
+    case CHK_ACT:
+        chk->flag = flag_lookup(buf, act_flag_table);
+        return;
+    case CHK_IMM:
+        chk->flag = flag_lookup(buf, imm_flag_table);
+        return;
+    case CHK_OFF:
+        chk->flag = flag_lookup(buf, off_flag_table);
+        return;
+    case CHK_CANQUEST:
+    case CHK_HASQUEST:
+    case CHK_CANFINISHQUEST:
+        chk->value = STRTOVNUM(buf);
+        return;
+    case CHK_CARRIES:
+    case CHK_WEARS:
+        chk->is_vnum = is_number(buf);
+        chk->value = chk->is_vnum ? STRTOVNUM(buf) : 0;
+        chk->word = save_mp_string(program, buf);
+        return;
+    case CHK_HAS:
+    case CHK_USES:
+    case CHK_OBJTYPE:
+        chk->value = item_lookup(buf);
+        return;
+    case CHK_POS:
+        chk->value = position_lookup(buf);
+        return;
+    // Clans, races and classes can be added while the game runs.
+    case CHK_NAME:
+    case CHK_CLAN:
+    case CHK_RACE:
+    case CHK_CLASS:
+        chk->word = save_mp_string(program, buf);
+        return;
+    default:;
+    }
+
+    // Case 5
+    if ((chk->oper = keyword_lookup(fn_evals, buf)) < 0) {
+        bugf("Cmd_eval: prog %"PRVNUM" syntax error(5): '%s'", program->vnum,
+            original);
+        return;
+    }
+    one_argument(line, buf);
+    chk->value = atoi(buf);
+}
+
+MobProgram* compile_mob_prog(VNUM vnum, const char* source)
+{
+    if (source == NULL)
+        return NULL;
+
+    size_t length = strlen(source);
+    int capacity = 1;
+    for (const char* p = source; *p; p++)
+        if (*p == '\n' || *p == '\r')
+            capacity++;
+
+    MobProgram* program = malloc(sizeof(MobProgram));
+    if (program == NULL) {
+        bug("compile_mob_prog: out of memory.");
+        return NULL;
+    }
+    program->vnum = vnum;
+    program->source = source;
+    program->line_count = 0;
+    program->strings_used = 0;
+    program->lines = malloc(sizeof(MpLine) * (size_t)capacity);
+    program->strings = malloc(2 * (length + 1));
+    if (program->lines == NULL || program->strings == NULL) {
+        bug("compile_mob_prog: out of memory.");
+        free_mob_program(program);
+        return NULL;
+    }
+
+    const char* code = source;
+    while (*code) {
+        char buf[MAX_STRING_LENGTH];
+        char control[MAX_INPUT_LENGTH];
+        char data[MAX_STRING_LENGTH];
+        size_t b = 0, c = 0, d = 0;
+        bool first_arg = true;
+
+        // Split the line up the same way program_flow() does.
+        while (ISSPACE(*code) && *code) code++;
+        while (*code && *code != '\n' && *code != '\r') {
+            if (ISSPACE(*code)) {
+                if (first_arg)
+                    first_arg = false;
+                else if (d < sizeof(data) - 1)
+                    data[d++] = *code;
+            }
+            else if (first_arg) {
+                if (c < sizeof(control) - 1)
+                    control[c++] = *code;
+            }
+            else if (d < sizeof(data) - 1)
+                data[d++] = *code;
+            if (b < sizeof(buf) - 1)
+                buf[b++] = *code;
+            code++;
+        }
+        buf[b] = control[c] = data[d] = '\0';
+
+        if (buf[0] == '\0')
+            break;
+        if (buf[0] == '*') /* Comment */
+            continue;
+
+        MpLine* line = &program->lines[program->line_count++];
+        memset(line, 0, sizeof(MpLine));
+
+        if (!str_cmp(control, "if"))
+            line->op = MP_IF;
+        else if (!str_cmp(control, "or"))
+            line->op = MP_OR;
+        else if (!str_cmp(control, "and"))
+            line->op = MP_AND;
+        else if (!str_cmp(control, "endif"))
+            line->op = MP_ENDIF;
+        else if (!str_cmp(control, "else"))
+            line->op = MP_ELSE;
+        else if (!str_cmp(control, "break") || !str_cmp(control, "end"))
+            line->op = MP_BREAK;
+        else {
+            line->op = !str_cmp(control, "mob") ? MP_MOB_COMMAND : MP_COMMAND;
+            line->expand = strchr(buf, '$') != NULL;
+            line->text = save_mp_string(program, buf);
+        }
+
+        if (line->op == MP_IF || line->op == MP_OR || line->op == MP_AND) {
+            char* rest = one_argument(data, control);
+            compile_check(program, &line->check,
+                keyword_lookup(fn_keyword, control), rest);
+        }
+    }
+
+    return program;
+}
+
+void free_mob_program(MobProgram* program)
+{
+    if (program == NULL)
+        return;
+
+    free(program->lines);
+    free(program->strings);
+    free(program);
+}
+
+static bool eval_actor_check(const MpCheck* chk, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2, Mobile* rch)
+{
+    Mobile* lval_char = NULL;
+    Object* lval_obj = NULL;
+    int lval = 0;
+
+    switch (chk->actor) {
+    case 'i':
+        lval_char = mob; break;
+    case 'n':
+        lval_char = ch; break;
+    case 't':
+        lval_char = (Mobile*)arg2; break;
+    case 'r':
+        lval_char = rch == NULL ? get_random_char(mob) : rch; break;
+    case 'o':
+        lval_obj = (Object*)arg1; break;
+    case 'p':
+        lval_obj = (Object*)arg2; break;
+    case 'q':
+        lval_char = mob->mprog_target; break;
+    default:;
+    }
+    if (lval_char == NULL && lval_obj == NULL)
+        return false;
+
+    // Case 3
+    switch (chk->check) {
+    case CHK_ISPC:
+        return(lval_char != NULL && !IS_NPC(lval_char));
+    case CHK_ISNPC:
+        return(lval_char != NULL && IS_NPC(lval_char));
+    case CHK_ISGOOD:
+        return(lval_char != NULL && IS_GOOD(lval_char));
+    case CHK_ISEVIL:
+        return(lval_char != NULL && IS_EVIL(lval_char));
+    case CHK_ISNEUTRAL:
+        return(lval_char != NULL && IS_NEUTRAL(lval_char));
+    case CHK_ISIMMORT:
+        return(lval_char != NULL && IS_IMMORTAL(lval_char));
+    case CHK_ISCHARM:
+        return(lval_char != NULL && IS_AFFECTED(lval_char, AFF_CHARM));
+    case CHK_ISFOLLOW:
+        return(lval_char != NULL && lval_char->master != NULL
+            && lval_char->master->in_room == lval_char->in_room);
+    case CHK_ISACTIVE:
+        return(lval_char != NULL && lval_char->position > POS_SLEEPING);
+    case CHK_ISDELAY:
+        return(lval_char != NULL && lval_char->mprog_delay > 0);
+    case CHK_ISVISIBLE:
+        if (chk->actor == 'o' || chk->actor == 'p')
+            return(lval_obj != NULL && can_see_obj(mob, lval_obj));
+        return(lval_char != NULL && can_see(mob, lval_char));
+    case CHK_HASTARGET:
+        return(lval_char != NULL && lval_char->mprog_target != NULL
+            && lval_char->in_room == lval_char->mprog_target->in_room);
+    case CHK_ISTARGET:
+        return(lval_char != NULL && mob->mprog_target == lval_char);
+    default:;
+    }
+
+    // Case 4
+    switch (chk->check) {
+    case CHK_AFFECTED:
+        return(lval_char != NULL && IS_SET(lval_char->affect_flags, chk->flag));
+    case CHK_ACT:
+        return(lval_char != NULL && IS_SET(lval_char->act_flags, chk->flag));
+    case CHK_IMM:
+        return(lval_char != NULL && IS_SET(lval_char->imm_flags, chk->flag));
+    case CHK_OFF:
+        return(lval_char != NULL && IS_SET(lval_char->atk_flags, chk->flag));
+    case CHK_CANQUEST:
+        return(lval_char != NULL && can_quest(lval_char, chk->value));
+    case CHK_HASQUEST:
+        return(lval_char != NULL && has_quest(lval_char, chk->value));
+    case CHK_CANFINISHQUEST:
+        return(lval_char != NULL && can_finish_quest(lval_char, chk->value));
+    case CHK_CARRIES:
+        if (chk->is_vnum)
+            return(lval_char != NULL && has_item(lval_char, chk->value, -1, false));
+        return(lval_char != NULL && (get_obj_carry(lval_char, chk->word) != NULL));
+    case CHK_WEARS:
+        if (chk->is_vnum)
+            return(lval_char != NULL && has_item(lval_char, chk->value, -1, true));
+        return(lval_char != NULL && (get_obj_wear(lval_char, chk->word) != NULL));
+    case CHK_HAS:
+        return(lval_char != NULL && has_item(lval_char, VNUM_NONE, (int16_t)chk->value, false));
+    case CHK_USES:
+        return(lval_char != NULL && has_item(lval_char, VNUM_NONE, (int16_t)chk->value, true));
+    case CHK_NAME:
+        if (chk->actor == 'o' || chk->actor == 'p')
+            return(lval_obj != NULL && is_name(chk->word, NAME_STR(lval_obj)));
+        return(lval_char != NULL && is_name(chk->word, NAME_STR(lval_char)));
+    case CHK_POS:
+        return(lval_char != NULL && lval_char->position == (Position)chk->value);
+    case CHK_CLAN:
+        return(lval_char != NULL && lval_char->clan == clan_lookup(chk->word));
+    case CHK_RACE:
+        return(lval_char != NULL && lval_char->race == race_lookup(chk->word));
+    case CHK_CLASS:
+        return(lval_char != NULL && lval_char->ch_class == class_lookup(chk->word));
+    case CHK_OBJTYPE:
+        return(lval_obj != NULL && lval_obj->item_type == (ItemType)chk->value);
+    default:;
+    }
+
+    // Case 5
+    if (chk->oper < 0)
+        return false;
+
+    switch (chk->check) {
+    case CHK_VNUM:
+        if (chk->actor == 'o' || chk->actor == 'p') {
+            if (lval_obj != NULL)
+                lval = VNUM_FIELD(lval_obj->prototype);
+        }
+        else if (lval_char != NULL && IS_NPC(lval_char))
+            lval = VNUM_FIELD(lval_char->prototype);
+        break;
+    case CHK_HPCNT:
+        if (lval_char != NULL)
+            lval = (lval_char->hit * 100) / (UMAX(1, lval_char->max_hit));
+        break;
+    case CHK_ROOM:
+        if (lval_char != NULL && lval_char->in_room != NULL)
+            lval = VNUM_FIELD(lval_char->in_room);
+        break;
+    case CHK_SEX:
+        if (lval_char != NULL)
+            lval = lval_char->sex;
+        break;
+    case CHK_LEVEL:
+        if (lval_char != NULL)
+            lval = lval_char->level;
+        break;
+    case CHK_ALIGN:
+        if (lval_char != NULL)
+            lval = lval_char->alignment;
+        break;
+    case CHK_MONEY:
+        if (lval_char != NULL)
+            lval = (int)convert_money_to_copper(lval_char->gold, lval_char->silver, lval_char->copper);
+        break;
+    case CHK_OBJVAL0:
+    case CHK_OBJVAL1:
+    case CHK_OBJVAL2:
+    case CHK_OBJVAL3:
+    case CHK_OBJVAL4:
+        if (lval_obj != NULL)
+            lval = lval_obj->value[chk->check - CHK_OBJVAL0];
+        break;
+    case CHK_GRPSIZE:
+        if (lval_char != NULL)
+            lval = count_people_room(lval_char, 4);
+        break;
+    default:
+        return false;
+    }
+    return(num_eval(lval, chk->oper, chk->value));
+}
+
+// The compiled counterpart of cmd_eval()
+static bool eval_check(const MpCheck* chk, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2, Mobile* rch)
+{
+    bool result = false;
+
+    if (chk->kind != CHECK_NONE) {
+        if (mob->mprog_target == NULL)
+            mob->mprog_target = ch;
+
+        switch (chk->kind) {
+        case CHECK_VALUE:
+            switch (chk->check) {
+            case CHK_RAND:
+                result = chk->value < number_percent();
+                break;
+            case CHK_MOBHERE:
+                result = chk->is_vnum ? get_mob_vnum_room(mob, chk->value)
+                    : get_mob_room(mob, chk->word) != NULL;
+                break;
+            case CHK_OBJHERE:
+                result = chk->is_vnum ? get_obj_vnum_room(mob, chk->value)
+                    : get_obj_here(mob, chk->word) != NULL;
+                break;
+            case CHK_MOBEXISTS:
+                result = get_mob_world(mob, chk->word) != NULL;
+                break;
+            case CHK_OBJEXISTS:
+                result = get_obj_world(mob, chk->word) != NULL;
+                break;
+            default:;
+            }
+            break;
+        case CHECK_COUNT: {
+            int lval = 0;
+            switch (chk->check) {
+            case CHK_PEOPLE:
+                lval = count_people_room(mob, 0); break;
+            case CHK_PLAYERS:
+                lval = count_people_room(mob, 1); break;
+            case CHK_MOBS:
+                lval = count_people_room(mob, 2); break;
+            case CHK_CLONES:
+                lval = count_people_room(mob, 3); break;
+            case CHK_ORDER:
+                lval = get_order(mob); break;
+            case CHK_HOUR:
+                lval = time_info.hour; break;
+            default:;
+            }
+            result = num_eval(lval, chk->oper, chk->value);
+            break;
+        }
+        case CHECK_ACTOR:
+            result = eval_actor_check(chk, mob, ch, arg1, arg2, rch);
+            break;
+        default:;
+        }
+    }
+
+    return chk->negate ? !result : result;
+}
+
+static void run_mob_program(const MobProgram* program, Mobile* mob,
+    Mobile* ch, const void* arg1, const void* arg2)
+{
+    Mobile* rch = NULL;
+    char data[MAX_STRING_LENGTH];
+    char control[MAX_INPUT_LENGTH];
+
+    int level, eval;
+    int state[MAX_NESTED_LEVEL];
+    int cond[MAX_NESTED_LEVEL];
+
+    VNUM mvnum = VNUM_FIELD(mob->prototype);
+    VNUM pvnum = program->vnum;
+
+    for (level = 0; level < MAX_NESTED_LEVEL; level++) {
+        state[level] = IN_BLOCK;
+        cond[level] = true;
+    }
+    level = 0;
+
+    for (int i = 0; i < program->line_count; i++) {
+        const MpLine* line = &program->lines[i];
+
+        switch (line->op) {
+        case MP_IF:
+            if (state[level] == BEGIN_BLOCK) {
+                bugf("Mobprog: misplaced if statement, mob %"PRVNUM" prog %"PRVNUM".",
+                    mvnum, pvnum);
+                return;
+            }
+            state[level] = BEGIN_BLOCK;
+            if (++level >= MAX_NESTED_LEVEL) {
+                bugf("Mobprog: Max nested level exceeded, mob %"PRVNUM" prog %"PRVNUM".",
+                    mvnum, pvnum);
+                return;
+            }
+            if (cond[level - 1] == false) {
+                cond[level] = false;
+                break;
+            }
+            if (line->check.check < 0) {
+                bugf("Mobprog: invalid if_check (if), mob %"PRVNUM" prog %"PRVNUM".",
+                    mvnum, pvnum);
+                return;
+            }
+            cond[level] = eval_check(&line->check, mob, ch, arg1, arg2, rch);
+            state[level] = END_BLOCK;
+            break;
+        case MP_OR:
+        case MP_AND:
+            if (!level || state[level - 1] != BEGIN_BLOCK) {
+                bugf("Mobprog: %s without if, mob %"PRVNUM" prog %"PRVNUM".",
+                    line->op == MP_OR ? "or" : "and", mvnum, pvnum);
+                return;
+            }
+            if (cond[level - 1] == false)
+                break;
+            if (line->check.check < 0) {
+                bugf("Mobprog: invalid if_check (%s), mob %"PRVNUM" prog %"PRVNUM".",
+                    line->op == MP_OR ? "or" : "and", mvnum, pvnum);
+                return;
+            }
+            eval = eval_check(&line->check, mob, ch, arg1, arg2, rch);
+            if (line->op == MP_OR)
+                cond[level] = (eval == true) ? true : cond[level];
+            else
+                cond[level] = (cond[level] == true) && (eval == true);
+            break;
+        case MP_ENDIF:
+            if (!level || state[level - 1] != BEGIN_BLOCK) {
+                bugf("Mobprog: endif without if, mob %"PRVNUM" prog %"PRVNUM".",
+                    mvnum, pvnum);
+                return;
+            }
+            cond[level] = true;
+            state[level] = IN_BLOCK;
+            state[--level] = END_BLOCK;
+            break;
+        case MP_ELSE:
+            if (!level || state[level - 1] != BEGIN_BLOCK) {
+                bugf("Mobprog: else without if, mob %"PRVNUM" prog %"PRVNUM".",
+                    mvnum, pvnum);
+                return;
+            }
+            if (cond[level - 1] == false)
+                break;
+            state[level] = IN_BLOCK;
+            cond[level] = (cond[level] == true) ? false : true;
+            break;
+        case MP_BREAK:
+            if (cond[level] == true)
+                return;
+            break;
+        case MP_COMMAND:
+        case MP_MOB_COMMAND:
+            if (level && cond[level] != true)
+                break;
+            state[level] = IN_BLOCK;
+            if (line->expand)
+                expand_arg(data, line->text, mob, ch, arg1, arg2, rch);
+            else
+                strcpy(data, line->text);
+            if (line->op == MP_MOB_COMMAND)
+                mob_interpret(mob, one_argument(data, control));
+            else
+                interpret(mob, data);
+            break;
+        }
+    }
+}
+
+void execute_mob_program(const MobProgram* program, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2)
+{
+    if (!enter_mob_prog(mob))
+        return;
+    run_mob_program(program, mob, ch, arg1, arg2);
     call_level--;
 }
 
+// Compiles 'code' into 'program' unless it already holds it.
+static MobProgram* get_mob_program(MobProgram** program, VNUM vnum,
+    const char* code)
+{
+    if (*program == NULL || (*program)->source != code) {
+        free_mob_program(*program);
+        *program = compile_mob_prog(vnum, code);
+    }
+    return *program;
+}
+
+void run_mob_prog(MobProg* prg, Mobile* mob, Mobile* ch, const void* arg1,
+    const void* arg2)
+{
+    MobProgram* program = get_mob_program(&prg->program, prg->vnum, prg->code);
+    if (program != NULL)
+        execute_mob_program(program, mob, ch, arg1, arg2);
+    else
+        program_flow(prg->vnum, prg->code, mob, ch, arg1, arg2);
+}
+
+void run_mob_prog_code(MobProgCode* prg, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2)
+{
+    MobProgram* program = get_mob_program(&prg->program, prg->vnum, prg->code);
+    if (program != NULL)
+        execute_mob_program(program, mob, ch, arg1, arg2);
+    else
+        program_flow(prg->vnum, prg->code, mob, ch, arg1, arg2);
+}
+
+void recompile_mob_prog(MobProg* prg)
+{
+    free_mob_program(prg->program);
+    prg->program = compile_mob_prog(prg->vnum, prg->code);
+}
+
 /*
  * ---------------------------------------------------------------------
  * Trigger handlers. These are called from various parts of the code
@@ -1120,7 +1818,7 @@ void mp_act_trigger(
         {
             if (prg->trig_type == trig_type
                 && strstr(argument, prg->trig_phrase) != NULL) {
-                program_flow(prg->vnum, prg->code, mob, ch, arg1, arg2);
+                run_mob_prog(prg, mob, ch, arg1, arg2);
                 break;
             }
         }
@@ -1140,7 +1838,7 @@ bool mp_percent_trigger(
     FOR_EACH(prg, mob->prototype->mprogs) {
         if (prg->trig_type == trig_type
             && number_percent() < atoi(prg->trig_phrase)) {
-            program_flow(prg->vnum, prg->code, mob, ch, arg1, arg2);
+            run_mob_prog(prg, mob, ch, arg1, arg2);
             return (true);
         }
     }
@@ -1159,7 +1857,7 @@ void mp_bribe_trigger(Mobile* mob, Mobile* ch, int amount)
     FOR_EACH(prg, mob->prototype->mprogs) {
         if (prg->trig_type == TRIG_BRIBE
             && amount >= atoi(prg->trig_phrase)) {
-            program_flow(prg->vnum, prg->code, mob, ch, NULL, NULL);
+            run_mob_prog(prg, mob, ch, NULL, NULL);
             break;
         }
     }
@@ -1184,13 +1882,13 @@ bool mp_exit_trigger(Mobile* ch, int dir)
                     && dir == atoi(prg->trig_phrase)
                     && mob->position == mob->prototype->default_pos
                     && can_see(mob, ch)) {
-                    program_flow(prg->vnum, prg->code, mob, ch, NULL, NULL);
+                    run_mob_prog(prg, mob, ch, NULL, NULL);
                     return true;
                 }
                 else
                     if (prg->trig_type == TRIG_EXALL
                         && dir == atoi(prg->trig_phrase)) {
-                        program_flow(prg->vnum, prg->code, mob, ch, NULL, NULL);
+                        run_mob_prog(prg, mob, ch, NULL, NULL);
                         return true;
                     }
             }
@@ -1210,7 +1908,7 @@ void mp_give_trigger(Mobile* mob, Mobile* ch, Object* obj)
             // Vnum argument
             if (is_number(p)) {
                 if (VNUM_FIELD(obj->prototype) == STRTOVNUM(p)) {
-                    program_flow(prg->vnum, prg->code, mob, ch, (void*)obj, NULL);
+                    run_mob_prog(prg, mob, ch, (void*)obj, NULL);
                     return;
                 }
             }
@@ -1221,7 +1919,7 @@ void mp_give_trigger(Mobile* mob, Mobile* ch, Object* obj)
 
                     if (is_name(buf, NAME_STR(obj))
                         || !str_cmp("all", buf)) {
-                        program_flow(prg->vnum, prg->code, mob, ch, (void*)obj, NULL);
+                        run_mob_prog(prg, mob, ch, (void*)obj, NULL);
                         return;
                     }
                 }
@@ -1260,7 +1958,7 @@ void mp_hprct_trigger(Mobile* mob, Mobile* ch)
     FOR_EACH(prg, mob->prototype->mprogs)
         if ((prg->trig_type == TRIG_HPCNT)
             && ((100 * mob->hit / mob->max_hit) < atoi(prg->trig_phrase))) {
-            program_flow(prg->vnum, prg->code, mob, ch, NULL, NULL);
+            run_mob_prog(prg, mob, ch, NULL, NULL);
             break;
         }
 }
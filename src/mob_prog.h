@@ -8,6 +8,7 @@
 
 typedef struct mob_prog_t MobProg;
 typedef struct mob_prog_code_t MobProgCode;
+typedef struct mob_program_t MobProgram;
 
 #include "merc.h"
 
@@ -22,6 +23,7 @@ typedef struct mob_prog_t {
     MobProg* next;
     char* trig_phrase;
     char* code;
+    MobProgram* program;    // 'code', compiled
     EventTrigger trig_type;
     VNUM vnum;
     bool valid;
@@ -32,6 +34,7 @@ typedef struct mob_prog_code_t {
     VNUM vnum;
     bool changed;
     char* code;
+    MobProgram* program;
 } MobProgCode;
 
 MobProg* new_mob_prog();
@@ -40,8 +43,23 @@ void free_mob_prog(MobProg* mob_prog);
 MobProgCode* new_mob_prog_code();
 void free_mob_prog_code(MobProgCode* mob_prog_code);
 
+// Interprets MOBprog source text directly.
 void program_flow(VNUM vnum, char* source, Mobile* mob, Mobile* ch, 
     const void* arg1, const void* arg2);
+
+// MOBprog code compiled ahead of time; runs just as program_flow() would.
+// Returns NULL if it couldn't be allocated.
+MobProgram* compile_mob_prog(VNUM vnum, const char* source);
+void free_mob_program(MobProgram* program);
+void execute_mob_program(const MobProgram* program, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2);
+// Run a prog's compiled code, compiling it first if it is missing or was
+// compiled from some other string.
+void run_mob_prog(MobProg* prg, Mobile* mob, Mobile* ch, const void* arg1,
+    const void* arg2);
+void run_mob_prog_code(MobProgCode* prg, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2);
+void recompile_mob_prog(MobProg* prg);
 void mp_act_trigger(char* argument, Mobile* mob, Mobile* ch, 
     const void* arg1, const void* arg2, EventTrigger trig_type);
 bool mp_percent_trigger(Mobile* mob, Mobile* ch, const void* arg1,
@@ -65,6 +65,134 @@ NoteData* news_list;
 NoteData* changes_list;
 NoteData* note_free;
 
+/*
+ * Note bodies stay on disk. Boards keep the headers (sender, date, recipients
+ * and subject) and the offset of each body in the board's file; bodies are
+ * read on demand and the most recently read NOTE_TEXT_CACHE_SIZE are kept.
+ */
+#define NOTE_TEXT_CACHE_SIZE    64
+#define NOTE_PAGE_SIZE          20
+
+static NoteData* note_lru_head = NULL;
+static NoteData* note_lru_tail = NULL;
+static int note_lru_count = 0;
+
+static const char* note_file_name(int16_t type)
+{
+    switch (type) {
+    default:            return NULL;
+    case NOTE_NOTE:     return cfg_get_note_file();
+    case NOTE_IDEA:     return cfg_get_idea_file();
+    case NOTE_PENALTY:  return cfg_get_penalty_file();
+    case NOTE_NEWS:     return cfg_get_news_file();
+    case NOTE_CHANGES:  return cfg_get_changes_file();
+    }
+}
+
+static bool note_cached(NoteData* pnote)
+{
+    return pnote == note_lru_head || pnote->lru_prev != NULL;
+}
+
+static void note_lru_unlink(NoteData* pnote)
+{
+    if (!note_cached(pnote))
+        return;
+
+    if (pnote->lru_prev)
+        pnote->lru_prev->lru_next = pnote->lru_next;
+    else
+        note_lru_head = pnote->lru_next;
+    if (pnote->lru_next)
+        pnote->lru_next->lru_prev = pnote->lru_prev;
+    else
+        note_lru_tail = pnote->lru_prev;
+
+    pnote->lru_prev = pnote->lru_next = NULL;
+    note_lru_count--;
+}
+
+// Marks the body of 'pnote' as most recently used, dropping the least
+// recently used body if the cache is full.
+static void note_lru_touch(NoteData* pnote)
+{
+    note_lru_unlink(pnote);
+
+    pnote->lru_next = note_lru_head;
+    if (note_lru_head)
+        note_lru_head->lru_prev = pnote;
+    note_lru_head = pnote;
+    if (note_lru_tail == NULL)
+        note_lru_tail = pnote;
+    note_lru_count++;
+
+    while (note_lru_count > NOTE_TEXT_CACHE_SIZE && note_lru_tail != pnote) {
+        NoteData* oldest = note_lru_tail;
+        note_lru_unlink(oldest);
+        free_string(oldest->text);
+        oldest->text = NULL;
+    }
+}
+
+const char* note_text(NoteData* pnote)
+{
+    if (pnote->text != NULL) {
+        if (pnote->text_pos >= 0)
+            note_lru_touch(pnote);
+        return pnote->text;
+    }
+
+    const char* name = note_file_name(pnote->type);
+    if (name == NULL || pnote->text_pos < 0)
+        return "";
+
+    char filename[256];
+    sprintf(filename, "%s%s", cfg_get_area_dir(), name);
+
+    FILE* fp = fopen(filename, "r");
+    if (fp == NULL) {
+        perror(filename);
+        return "";
+    }
+
+    char* text = NULL;
+    if (fseek(fp, pnote->text_pos, SEEK_SET) == 0)
+        text = fread_string(fp);
+    fclose(fp);
+
+    if (text == NULL) {
+        bugf("note_text: could not read note from %s at %ld.", filename,
+            pnote->text_pos);
+        return "";
+    }
+
+    pnote->text = text;
+    note_lru_touch(pnote);
+    return pnote->text;
+}
+
+// Skips a note body the way fread_string() would read it.
+static bool skip_note_text(FILE* fp)
+{
+    int c;
+
+    while ((c = getc(fp)) != EOF)
+        if (c == '~')
+            return true;
+
+    return false;
+}
+
+static void write_note_header(FILE* fp, NoteData* pnote)
+{
+    fprintf(fp, "Sender  %s~\n", pnote->sender);
+    fprintf(fp, "Date    %s~\n", pnote->date);
+    fprintf(fp, "Stamp   "TIME_FMT"\n", pnote->date_stamp);
+    fprintf(fp, "To      %s~\n", pnote->to_list);
+    fprintf(fp, "Subject %s~\n", pnote->subject);
+    fprintf(fp, "Text");
+}
+
 int count_spool(Mobile* ch, NoteData* spool)
 {
     int count = 0;
@@ -144,46 +272,82 @@ void do_changes(Mobile* ch, char* argument)
     parse_note(ch, argument, NOTE_CHANGES);
 }
 
+// Rewrites a board's file after a note is removed. Bodies that aren't cached
+// are copied from the old file, which stays in place until the new one is
+// complete.
 void save_notes(int type)
 {
-    FILE* fp;
-    NoteData* pnote;
+    NoteData* list;
 
     switch (type) {
     default:
         return;
     case NOTE_NOTE:
-        OPEN_OR_RETURN(fp = open_append_note_file());
-        pnote = note_list;
+        list = note_list;
         break;
     case NOTE_IDEA:
-        OPEN_OR_RETURN(fp = open_append_idea_file());
-        pnote = idea_list;
+        list = idea_list;
         break;
     case NOTE_PENALTY:
-        OPEN_OR_RETURN(fp = open_append_penalty_file());
-        pnote = penalty_list;
+        list = penalty_list;
         break;
     case NOTE_NEWS:
-        OPEN_OR_RETURN(fp = open_append_news_file());
-        pnote = news_list;
+        list = news_list;
         break;
     case NOTE_CHANGES:
-        OPEN_OR_RETURN(fp = open_append_changes_file());
-        pnote = changes_list;
+        list = changes_list;
         break;
     }
 
-    for (; pnote != NULL; NEXT_LINK(pnote)) {
-        fprintf(fp, "Sender  %s~\n", pnote->sender);
-        fprintf(fp, "Date    %s~\n", pnote->date);
-        fprintf(fp, "Stamp   "TIME_FMT"\n", pnote->date_stamp);
-        fprintf(fp, "To      %s~\n", pnote->to_list);
-        fprintf(fp, "Subject %s~\n", pnote->subject);
-        fprintf(fp, "Text\n%s~\n", pnote->text);
+    char filename[256];
+    char tmp_filename[256 + 4];
+    sprintf(filename, "%s%s", cfg_get_area_dir(), note_file_name((int16_t)type));
+    sprintf(tmp_filename, "%s.tmp", filename);
+
+    NoteData* pnote;
+    int count = 0;
+    FOR_EACH(pnote, list)
+        count++;
+
+    long* positions = count > 0 ? malloc(sizeof(long) * (size_t)count) : NULL;
+    if (count > 0 && positions == NULL) {
+        bug("Save_notes: can't alloc %d note offsets.", count);
+        return;
+    }
+
+    FILE* fp = fopen(tmp_filename, "w");
+    if (fp == NULL) {
+        perror(tmp_filename);
+        free(positions);
+        return;
     }
-    
-    close_file(fp);
+
+    int i = 0;
+    FOR_EACH(pnote, list) {
+        const char* text = note_text(pnote);
+        write_note_header(fp, pnote);
+        positions[i++] = ftell(fp);
+        fprintf(fp, "\n%s~\n", text);
+    }
+
+    bool ok = !ferror(fp);
+    ok = (fclose(fp) == 0) && ok;
+#ifdef _MSC_VER
+    if (ok)
+        remove(filename);
+#endif
+    if (!ok || rename(tmp_filename, filename) != 0) {
+        bugf("Save_notes: could not replace %s.", filename);
+        remove(tmp_filename);
+        free(positions);
+        return;
+    }
+
+    i = 0;
+    FOR_EACH(pnote, list)
+        pnote->text_pos = positions[i++];
+
+    free(positions);
 }
 
 void load_notes()
@@ -248,7 +412,14 @@ void load_thread(const char* name, NoteData** list, int16_t type, time_t free_ti
 
         if (str_cmp(fread_word(fp), "text")) 
             break;
-        pnote->text = fread_string(fp);
+        pnote->text = NULL;
+        pnote->text_pos = ftell(fp);
+        if (!skip_note_text(fp)) {
+            bug("Load_notes: EOF in note text.", 0);
+            free_note(pnote);
+            close_file(fp);
+            return;
+        }
 
         if (free_time && pnote->date_stamp < current_time - free_time) {
             free_note(pnote);
@@ -309,14 +480,14 @@ void append_note(NoteData* pnote)
         last->next = pnote;
     }
 
-    fprintf(fp, "Sender  %s~\n", pnote->sender);
-    fprintf(fp, "Date    %s~\n", pnote->date);
-    fprintf(fp, "Stamp   "TIME_FMT"\n", pnote->date_stamp);
-    fprintf(fp, "To      %s~\n", pnote->to_list);
-    fprintf(fp, "Subject %s~\n", pnote->subject);
-    fprintf(fp, "Text\n%s~\n", pnote->text);
+    write_note_header(fp, pnote);
+    pnote->text_pos = ftell(fp);
+    fprintf(fp, "\n%s~\n", pnote->text);
 
     close_file(fp);
+
+    // Just posted, so likely to be read soon; it starts out cached.
+    note_lru_touch(pnote);
 }
 
 bool is_note_to(Mobile* ch, NoteData* pnote)
@@ -504,6 +675,7 @@ void parse_note(Mobile* ch, char* argument, int16_t type)
     NoteData* pnote;
     NoteData** list;
     char* list_name;
+    char* cmd_name;
     VNUM vnum;
     int anum;
 
@@ -516,22 +688,27 @@ void parse_note(Mobile* ch, char* argument, int16_t type)
     case NOTE_NOTE:
         list = &note_list;
         list_name = "notes";
+        cmd_name = "note";
         break;
     case NOTE_IDEA:
         list = &idea_list;
         list_name = "ideas";
+        cmd_name = "idea";
         break;
     case NOTE_PENALTY:
         list = &penalty_list;
         list_name = "penalties";
+        cmd_name = "penalty";
         break;
     case NOTE_NEWS:
         list = &news_list;
         list_name = "news";
+        cmd_name = "news";
         break;
     case NOTE_CHANGES:
         list = &changes_list;
         list_name = "changes";
+        cmd_name = "changes";
         break;
     }
 
@@ -554,7 +731,7 @@ void parse_note(Mobile* ch, char* argument, int16_t type)
                             pnote->sender, pnote->subject, pnote->date,
                             pnote->to_list);
                     send_to_char(buf, ch);
-                    page_to_char(pnote->text, ch);
+                    page_to_char(note_text(pnote), ch);
                     update_read(ch, pnote);
                     return;
                 }
@@ -582,7 +759,7 @@ void parse_note(Mobile* ch, char* argument, int16_t type)
                         pnote->sender, pnote->subject, pnote->date,
                         pnote->to_list);
                 send_to_char(buf, ch);
-                page_to_char(pnote->text, ch);
+                page_to_char(note_text(pnote), ch);
                 update_read(ch, pnote);
                 return;
             }
@@ -594,16 +771,40 @@ void parse_note(Mobile* ch, char* argument, int16_t type)
     }
 
     if (!str_prefix(arg, "list")) {
+        int total = 0;
+        FOR_EACH(pnote, *list)
+            if (is_note_to(ch, pnote))
+                total++;
+
+        // Boards list a page at a time, newest page first.
+        int pages = (total + NOTE_PAGE_SIZE - 1) / NOTE_PAGE_SIZE;
+        int page = pages;
+        if (is_number(argument)) {
+            page = atoi(argument);
+            if (page < 1 || page > pages) {
+                printf_to_char(ch, "There %s only %d page%s of %s.\n\r",
+                    pages == 1 ? "is" : "are", pages, pages == 1 ? "" : "s",
+                    list_name);
+                return;
+            }
+        }
+        int first = (page - 1) * NOTE_PAGE_SIZE;
+
         vnum = 0;
         FOR_EACH(pnote, *list) {
             if (is_note_to(ch, pnote)) {
-                sprintf(buf, "[%3d%s] %s: %s\n\r", vnum,
-                        hide_note(ch, pnote) ? " " : "N", pnote->sender,
-                        pnote->subject);
-                send_to_char(buf, ch);
+                if (vnum >= first && vnum < first + NOTE_PAGE_SIZE) {
+                    sprintf(buf, "[%3d%s] %s: %s\n\r", vnum,
+                            hide_note(ch, pnote) ? " " : "N", pnote->sender,
+                            pnote->subject);
+                    send_to_char(buf, ch);
+                }
                 vnum++;
             }
         }
+        if (pages > 1)
+            printf_to_char(ch, "Page %d of %d. Use '%s list <page>' to see "
+                "the others.\n\r", page, pages, cmd_name);
         if (!vnum) {
             switch (type) {
             case NOTE_NOTE:
@@ -862,6 +1063,8 @@ NoteData* new_note()
         note = note_free;
         NEXT_LINK(note_free);
     }
+    note->text_pos = -1;
+    note->lru_prev = note->lru_next = NULL;
     VALIDATE(note);
     return note;
 }
@@ -870,6 +1073,7 @@ void free_note(NoteData* note)
 {
     if (!IS_VALID(note)) return;
 
+    note_lru_unlink(note);
     free_string(note->text);
     free_string(note->subject);
     free_string(note->to_list);
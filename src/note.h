@@ -23,7 +23,10 @@ typedef struct note_data_t {
     char* date;
     char* to_list;
     char* subject;
-    char* text;
+    char* text;             // NULL until read; see note_text()
+    long text_pos;          // Offset of the body in the board's file, or -1
+    NoteData* lru_prev;
+    NoteData* lru_next;
     time_t date_stamp;
     int16_t type;
     bool valid;
@@ -31,6 +34,7 @@ typedef struct note_data_t {
 
 NoteData* new_note();
 void free_note(NoteData* note);
+const char* note_text(NoteData* note);
 
 extern NoteData* note_list;
 
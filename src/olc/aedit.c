@@ -1264,7 +1264,7 @@ AEDIT(aedit_builder)
     }
     strcat(buf, name);
     free_string(area->builders);
-    area->builders = string_proper(str_dup(buf));
+    area->builders = str_dup(string_proper(buf));
 
     send_to_char(COLOR_INFO "Builder added." COLOR_EOL, ch);
     send_to_char(area->builders, ch);
@@ -1399,7 +1399,6 @@ static bool shift_value_array_vnums(ValueArray* array, VNUM lower, VNUM upper, i
 static void set_entity_vnum(Entity* entity, VNUM vnum)
 {
     entity->vnum = vnum;
-    SET_NATIVE_FIELD(entity, entity->vnum, vnum, I32);
 }
 
 static AreaData* loot_owner_area_data(Entity* owner)
@@ -0,0 +1,351 @@
+////////////////////////////////////////////////////////////////////////////////
+// olc/area_save_queue.c
+//
+// Background area saves. The snapshot for an area is the complete output of
+// its persist format, rendered into memory on the game thread; the entity
+// graph (and the Lox strings it points into) is never touched off-thread.
+// A single worker thread writes each snapshot to <file>.tmp and renames it
+// over the area file, in the order the snapshots were taken, and hands the
+// job back to the game thread, which reports finished batches to whoever
+// asked for them.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "area_save_queue.h"
+
+#include <persist/area/area_persist.h>
+#include <persist/persist_io_adapters.h>
+
+#include <entities/descriptor.h>
+#include <entities/mobile.h>
+
+#include <comm.h>
+#include <config.h>
+#include <db.h>
+#include <stringutils.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+typedef SRWLOCK SaveLock;
+typedef CONDITION_VARIABLE SaveCond;
+#define SAVE_LOCK_INIT          SRWLOCK_INIT
+#define SAVE_COND_INIT          CONDITION_VARIABLE_INIT
+#define save_lock(l)            AcquireSRWLockExclusive(l)
+#define save_unlock(l)          ReleaseSRWLockExclusive(l)
+#define save_wait(c, l)         SleepConditionVariableSRW(c, l, INFINITE, 0)
+#define save_signal(c)          WakeConditionVariable(c)
+#define save_broadcast(c)       WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t SaveLock;
+typedef pthread_cond_t SaveCond;
+#define SAVE_LOCK_INIT          PTHREAD_MUTEX_INITIALIZER
+#define SAVE_COND_INIT          PTHREAD_COND_INITIALIZER
+#define save_lock(l)            pthread_mutex_lock(l)
+#define save_unlock(l)          pthread_mutex_unlock(l)
+#define save_wait(c, l)         pthread_cond_wait(c, l)
+#define save_signal(c)          pthread_cond_signal(c)
+#define save_broadcast(c)       pthread_cond_broadcast(c)
+#endif
+
+typedef struct area_save_job_t AreaSaveJob;
+
+struct area_save_job_t {
+    AreaSaveJob* next;
+    AreaSaveBatch* batch;
+    char path[MIL];
+    char tmp_path[MIL + 8];
+    unsigned char* data;
+    size_t len;
+    bool ok;
+    int err;            // errno from the failing write/rename, if any
+};
+
+// Batches are only ever touched on the game thread.
+struct area_save_batch_t {
+    AreaSaveBatch* next;
+    char requester[MIL];
+    int queued;         // Snapshots handed to the worker
+    int finished;       // ...of which the worker has finished
+    int written;        // Areas successfully on disk
+    int failed;         // Snapshot or write failures
+    bool sealed;
+};
+
+static AreaSaveBatch* batch_list = NULL;
+
+// Everything below is shared with the worker and guarded by 'queue_lock'.
+static SaveLock queue_lock = SAVE_LOCK_INIT;
+static SaveCond work_ready = SAVE_COND_INIT;
+static SaveCond work_idle = SAVE_COND_INIT;
+static AreaSaveJob* pending_head = NULL;
+static AreaSaveJob* pending_tail = NULL;
+static AreaSaveJob* done_list = NULL;
+static int in_flight = 0;
+static bool worker_started = false;
+
+static bool write_snapshot(AreaSaveJob* job)
+{
+    FILE* fp = fopen(job->tmp_path, "wb");
+    if (!fp) {
+        job->err = errno;
+        return false;
+    }
+
+    bool ok = fwrite(job->data, 1, job->len, fp) == job->len;
+    if (!ok)
+        job->err = errno;
+    if (fclose(fp) != 0 && ok) {
+        job->err = errno;
+        ok = false;
+    }
+    if (!ok) {
+        remove(job->tmp_path);
+        return false;
+    }
+
+#ifdef _MSC_VER
+    if (!MoveFileExA(job->tmp_path, job->path, MOVEFILE_REPLACE_EXISTING)) {
+        job->err = EIO;
+        return false;
+    }
+#else
+    if (rename(job->tmp_path, job->path) != 0) {
+        job->err = errno;
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+#ifdef _MSC_VER
+static DWORD WINAPI save_worker(LPVOID arg)
+#else
+static void* save_worker(void* arg)
+#endif
+{
+    (void)arg;
+
+    for (;;) {
+        save_lock(&queue_lock);
+        while (pending_head == NULL)
+            save_wait(&work_ready, &queue_lock);
+        AreaSaveJob* job = pending_head;
+        pending_head = job->next;
+        if (pending_head == NULL)
+            pending_tail = NULL;
+        save_unlock(&queue_lock);
+
+        job->ok = write_snapshot(job);
+        free(job->data);
+        job->data = NULL;
+
+        save_lock(&queue_lock);
+        job->next = done_list;
+        done_list = job;
+        in_flight--;
+        if (in_flight == 0)
+            save_broadcast(&work_idle);
+        save_unlock(&queue_lock);
+    }
+
+#ifdef _MSC_VER
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+static bool start_worker()
+{
+    if (worker_started)
+        return true;
+
+#ifdef _MSC_VER
+    HANDLE thread = CreateThread(NULL, 0, save_worker, NULL, 0, NULL);
+    if (thread == NULL) {
+        perror("start_worker(): CreateThread()");
+        return false;
+    }
+    CloseHandle(thread);
+#else
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, save_worker, NULL) != 0) {
+        perror("start_worker(): pthread_create()");
+        return false;
+    }
+    pthread_detach(thread);
+#endif
+
+    worker_started = true;
+    return true;
+}
+
+AreaSaveBatch* begin_area_save_batch(Mobile* ch)
+{
+    AreaSaveBatch* batch = calloc(1, sizeof(AreaSaveBatch));
+    if (batch == NULL)
+        return NULL;
+
+    if (ch != NULL && !IS_NPC(ch))
+        snprintf(batch->requester, sizeof(batch->requester), "%s", NAME_STR(ch));
+
+    batch->next = batch_list;
+    batch_list = batch;
+    return batch;
+}
+
+bool queue_area_save(AreaSaveBatch* batch, AreaData* area)
+{
+    if (batch == NULL || area == NULL)
+        return false;
+
+    const AreaPersistFormat* fmt = area_persist_select_format(area->file_name);
+    AreaSaveJob* job = calloc(1, sizeof(AreaSaveJob));
+    if (fmt == NULL || job == NULL) {
+        free(job);
+        batch->failed++;
+        return false;
+    }
+
+    job->batch = batch;
+    snprintf(job->path, sizeof(job->path), "%s%s", cfg_get_area_dir(), area->file_name);
+    snprintf(job->tmp_path, sizeof(job->tmp_path), "%s.tmp", job->path);
+
+    PersistBufferWriter buf = { 0 };
+    PersistWriter writer = persist_writer_from_buffer(&buf, job->path);
+    AreaPersistSaveParams params = {
+        .writer = &writer,
+        .area = area,
+        .file_name = area->file_name,
+    };
+
+    PersistResult result = fmt->save(&params);
+    if (!persist_succeeded(result) || !start_worker()) {
+        bugf("queue_area_save : could not snapshot %s (%s)", area->file_name,
+            result.message ? result.message : "worker unavailable");
+        free(buf.data);
+        free(job);
+        batch->failed++;
+        return false;
+    }
+
+    job->data = buf.data;
+    job->len = buf.len;
+    batch->queued++;
+
+    save_lock(&queue_lock);
+    if (pending_tail)
+        pending_tail->next = job;
+    else
+        pending_head = job;
+    pending_tail = job;
+    in_flight++;
+    save_signal(&work_ready);
+    save_unlock(&queue_lock);
+
+    return true;
+}
+
+void end_area_save_batch(AreaSaveBatch* batch)
+{
+    if (batch == NULL)
+        return;
+
+    batch->sealed = true;
+    poll_area_saves();
+}
+
+static Mobile* find_requester(const char* name)
+{
+    Descriptor* d;
+
+    FOR_EACH(d, descriptor_list) {
+        Mobile* ch = d->original ? d->original : d->character;
+        if (d->connected == CON_PLAYING && ch != NULL
+            && !str_cmp(NAME_STR(ch), name))
+            return ch;
+    }
+
+    return NULL;
+}
+
+static void report_batch(AreaSaveBatch* batch)
+{
+    if (batch->requester[0] == '\0')
+        return;
+
+    Mobile* ch = find_requester(batch->requester);
+    if (ch == NULL)
+        return;
+
+    if (batch->failed == 0)
+        printf_to_char(ch, "Area save finished: %d area%s written.\n\r",
+            batch->written, batch->written == 1 ? "" : "s");
+    else
+        printf_to_char(ch, "Area save finished: %d area%s written, "
+            "{R%d failed{x (see the bug log).\n\r", batch->written,
+            batch->written == 1 ? "" : "s", batch->failed);
+}
+
+void poll_area_saves()
+{
+    AreaSaveJob* done;
+
+    save_lock(&queue_lock);
+    done = done_list;
+    done_list = NULL;
+    save_unlock(&queue_lock);
+
+    while (done != NULL) {
+        AreaSaveJob* job = done;
+        done = job->next;
+
+        job->batch->finished++;
+        if (job->ok)
+            job->batch->written++;
+        else {
+            job->batch->failed++;
+            bugf("poll_area_saves : could not write %s (%s)", job->path,
+                strerror(job->err));
+        }
+        free(job);
+    }
+
+    AreaSaveBatch** link = &batch_list;
+    while (*link != NULL) {
+        AreaSaveBatch* batch = *link;
+        if (batch->sealed && batch->finished == batch->queued) {
+            report_batch(batch);
+            *link = batch->next;
+            free(batch);
+        }
+        else {
+            link = &batch->next;
+        }
+    }
+}
+
+void flush_area_saves()
+{
+    save_lock(&queue_lock);
+    while (in_flight > 0)
+        save_wait(&work_idle, &queue_lock);
+    save_unlock(&queue_lock);
+
+    poll_area_saves();
+}
+
+int pending_area_saves()
+{
+    save_lock(&queue_lock);
+    int count = in_flight;
+    save_unlock(&queue_lock);
+    return count;
+}
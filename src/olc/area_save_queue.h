@@ -0,0 +1,41 @@
+////////////////////////////////////////////////////////////////////////////////
+// olc/area_save_queue.h
+//
+// Background area saves for asave world/changed. Each area is captured as an
+// immutable snapshot on the game thread, then written and renamed into place
+// by a worker thread while play continues.
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__OLC__AREA_SAVE_QUEUE_H
+#define MUD98__OLC__AREA_SAVE_QUEUE_H
+
+#include <merc.h>
+
+#include <entities/area.h>
+
+#include <stdbool.h>
+
+typedef struct area_save_batch_t AreaSaveBatch;
+
+// Starts a batch of area saves requested by 'ch' (NULL for automatic saves).
+// The requester is told when every area in the batch is on disk.
+AreaSaveBatch* begin_area_save_batch(Mobile* ch);
+
+// Captures 'area' in its persist format and queues it for writing. Returns
+// false if the snapshot couldn't be taken; nothing is queued in that case.
+bool queue_area_save(AreaSaveBatch* batch, AreaData* area);
+
+// Seals the batch. Completion is reported once all of its saves finish.
+void end_area_save_batch(AreaSaveBatch* batch);
+
+// Reports finished batches. Called once per pulse from the game loop.
+void poll_area_saves();
+
+// Blocks until every queued save has been written, then reports them.
+void flush_area_saves();
+
+// Number of snapshots queued or being written.
+int pending_area_saves();
+
+#endif // !MUD98__OLC__AREA_SAVE_QUEUE_H
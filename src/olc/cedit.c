@@ -130,7 +130,9 @@ void cedit(Mobile* ch, char* argument)
         return;
     }
 
-    if (!process_olc_command(ch, argument, class_olc_comm_table))
+    if (process_olc_command(ch, argument, class_olc_comm_table))
+        invalidate_derived_stats();
+    else
         interpret(ch, argument);
     return;
 }
@@ -94,6 +94,7 @@ bool olc_edit_event(Mobile* ch, char* argument)
         else {
             event->method_name = lox_string(get_event_default_callback(trig));
         }
+        GC_BARRIER_OBJ(event->method_name);
 
         READ_ARG(criteria_arg);
         if (criteria_arg[0] != '\0') {
@@ -152,6 +153,7 @@ bool olc_edit_event(Mobile* ch, char* argument)
             send_to_char(COLOR_INFO "Event created." COLOR_EOL, ch);
         }
         else {
+            invalidate_event_indexes();
             send_to_char(COLOR_INFO "Event changed." COLOR_EOL, ch);
         }
 
@@ -113,6 +113,7 @@ HEDIT(hedit_keyword)
 
     free_string(help->keyword);
     help->keyword = str_dup(argument);
+    invalidate_help_index();
 
     send_to_char("Ok.\n\r", ch);
     return true;
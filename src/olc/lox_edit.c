@@ -103,8 +103,9 @@ static bool lox_script_compile(Mobile* ch, bool assign)
         return false;
     }
     else if (assign) {
-        entity->klass = klass;
-        entity->script = pLoxScript;
+        set_entity_class(entity, klass);
+        set_entity_script(entity, pLoxScript);
+        invalidate_inline_caches();
         pop_editor(ch->desc);
         printf_to_char(ch, COLOR_DECOR_1 "[" COLOR_GREEN "***" COLOR_DECOR_1 "]"
             COLOR_INFO "Class \"%s\" for %s %d compiled successfully and "
@@ -112,7 +113,7 @@ static bool lox_script_compile(Mobile* ch, bool assign)
             COLOR_CLEAR, class_name, entity_type_name, entity->vnum);
         if (entity->obj.type == OBJ_ROOM
             && entity->vnum == ch->in_room->header.vnum) {
-            ch->in_room->header.klass = entity->klass;
+            set_entity_class(&ch->in_room->header, entity->klass);
             init_entity_class((Entity*)ch->in_room);
         }
     }
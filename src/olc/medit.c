@@ -437,6 +437,17 @@ MEDIT(medit_wealth)
     return true;
 }
 
+// Instances without a faction of their own go by the prototype's.
+static void update_instance_aggressors(MobPrototype* pMob)
+{
+    Mobile* mob;
+
+    FOR_EACH_GLOBAL_MOB(mob) {
+        if (mob->prototype == pMob)
+            update_room_aggressor(mob);
+    }
+}
+
 MEDIT(medit_faction)
 {
     MobPrototype* pMob;
@@ -454,6 +465,7 @@ MEDIT(medit_faction)
 
     if (!str_cmp(arg, "none")) {
         pMob->faction_vnum = 0;
+        update_instance_aggressors(pMob);
         if (pMob->area != NULL)
             SET_BIT(pMob->area->area_flags, AREA_CHANGED);
         send_to_char(COLOR_INFO "Faction cleared." COLOR_EOL, ch);
@@ -472,6 +484,7 @@ MEDIT(medit_faction)
     }
 
     pMob->faction_vnum = VNUM_FIELD(faction);
+    update_instance_aggressors(pMob);
     if (pMob->area != NULL)
         SET_BIT(pMob->area->area_flags, AREA_CHANGED);
 
@@ -950,6 +963,7 @@ ED_FUN_DEC(ed_addprog)
     case ED_MOBILE:
         EDIT_MOB(ch, pMob);
         SET_BIT(pMob->mprog_flags, value);
+        invalidate_room_listeners();
         break;
 
     default:
@@ -1014,6 +1028,7 @@ ED_FUN_DEC(ed_delprog)
     case ED_MOBILE:
         EDIT_MOB(ch, pMob);
         REMOVE_BIT(pMob->mprog_flags, t2rem);
+        invalidate_room_listeners();
         break;
 
     default:
@@ -484,6 +484,7 @@ ED_FUN_DEC(ed_line_lox_string)
         sprintf(buf, "%s%s", argument, par == 0 ? "" : "\n\r");
         *string = copy_string(buf, (int)strlen(buf));
     }
+    GC_BARRIER_OBJ(*string);
 
     send_to_char(COLOR_INFO "Ok." COLOR_EOL, ch);
 
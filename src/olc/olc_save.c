@@ -22,6 +22,8 @@
 #include "olc.h"
 #include "olc_save.h"
 
+#include "area_save_queue.h"
+
 #include <persist/area/area_persist.h>
 #include <persist/persist_io_adapters.h>
 #include <persist/area/rom-olc/area_persist_rom_olc.h>
@@ -1184,6 +1186,11 @@ void save_area(AreaData* area)
 
     sprintf(area_file, "%s%s", cfg_get_area_dir(), area->file_name);
 
+    // Let any queued snapshots land first so an older one can't overwrite
+    // this save.
+    if (pending_area_saves() > 0)
+        flush_area_saves();
+
     OPEN_OR_RETURN(fp = open_write_file(tmp));
 
     PersistWriter writer = persist_writer_from_file(fp, tmp);
@@ -1316,6 +1323,9 @@ void do_asave(Mobile* ch, char* argument)
     /* Save the world, only authorized areas. */
     /* -------------------------------------- */
     if (!str_cmp("world", arg1)) {
+        AreaSaveBatch* batch = begin_area_save_batch(ch);
+        int queued = 0;
+
         save_area_list();
         FOR_EACH_AREA(area) {
             /* Builder must be assigned this area. */
@@ -1333,14 +1343,17 @@ void do_asave(Mobile* ch, char* argument)
                 area->file_name = str_dup(newname);
             }
 
-            save_area(area);
+            if (queue_area_save(batch, area))
+                queued++;
             REMOVE_BIT(area->area_flags, AREA_CHANGED);
             REMOVE_BIT(area->area_flags, AREA_ADDED);
         }
 
         save_other_helps(ch);
 
-        send_to_char("You saved the world.\n\r", ch);
+        printf_to_char(ch, "World snapshot taken; writing %d area%s in the "
+            "background.\n\r", queued, queued == 1 ? "" : "s");
+        end_area_save_batch(batch);
         save_lox_public_scripts_if_dirty();
         return;
     }
@@ -1350,6 +1363,7 @@ void do_asave(Mobile* ch, char* argument)
 
     if (!str_cmp("changed", arg1)) {
         char buf[MAX_INPUT_LENGTH];
+        AreaSaveBatch* batch = begin_area_save_batch(ch);
 
         save_area_list();
 
@@ -1374,7 +1388,7 @@ void do_asave(Mobile* ch, char* argument)
                     area->file_name = str_dup(newname);
                 }
 
-                save_area(area);
+                queue_area_save(batch, area);
                 sprintf(buf, "%24s - '%s'\n\r", NAME_STR(area), area->file_name);
                 send_to_char(buf, ch);
                 REMOVE_BIT(area->area_flags, AREA_CHANGED);
@@ -1386,6 +1400,7 @@ void do_asave(Mobile* ch, char* argument)
 
         if (!str_cmp(buf, "None.\n\r"))
             send_to_char(buf, ch);
+        end_area_save_batch(batch);
         save_lox_public_scripts_if_dirty();
         return;
     }
@@ -138,7 +138,9 @@ void raedit(Mobile* ch, char* argument)
     }
 
     /* Search Table and Dispatch Command. */
-    if (!process_olc_command(ch, argument, race_olc_comm_table))
+    if (process_olc_command(ch, argument, race_olc_comm_table))
+        invalidate_derived_stats();
+    else
         interpret(ch, argument);
 
     return;
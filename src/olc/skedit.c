@@ -206,7 +206,9 @@ void skedit(Mobile* ch, char* argument)
     }
 
     /* Search Table and Dispatch Command. */
-    if (!process_olc_command(ch, argument, skill_olc_comm_table))
+    if (process_olc_command(ch, argument, skill_olc_comm_table))
+        invalidate_derived_stats();
+    else
         interpret(ch, argument);
 
     return;
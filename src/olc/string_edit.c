@@ -18,6 +18,7 @@
 #include <comm.h>
 #include <db.h>
 #include <format.h>
+#include <mob_prog.h>
 #include <stringutils.h>
 
 #include <entities/mobile.h>
@@ -49,12 +50,9 @@ void string_edit(Mobile* ch, char** pString)
     send_to_char(" Terminate with a @ on a blank line.\n\r", ch);
     send_to_char(COLOR_DECOR_2 "-=======================================-" COLOR_EOL, ch);
 
-    if (*pString == NULL) {
-        *pString = str_dup("");
-    }
-    else {
-        **pString = '\0';
-    }
+    // Strings are shared; drop our reference rather than blanking the text.
+    free_string(*pString);
+    *pString = str_dup("");
 
     push_editor(ch->desc, ED_STRING, (uintptr_t)pString);
 
@@ -245,11 +243,14 @@ void string_add(Mobile* ch, char* argument)
             MobProgCode* mpc = (MobProgCode*)get_pEdit(ch->desc);
 
             mpc->changed = true;
+            free_mob_program(mpc->program);
+            mpc->program = NULL;
 
             FOR_EACH_MOB_PROTO(mob)
                 FOR_EACH(mp, mob->mprogs)
                     if (mp->vnum == mpc->vnum) {
                         mp->code = mpc->code;
+                        recompile_mob_prog(mp);
                         printf_to_char(ch, "Updated mob %d.\n\r", VNUM_FIELD(mob));
                     }
         }
@@ -358,7 +359,8 @@ char* string_unpad(char* argument)
 
 /*
  * Same as capitalize but changes the pointer's data.
- * Used in olc_act.c in aedit_builder.
+ * Used in olc_act.c in aedit_builder. Never pass it str_dup() text, which
+ * may be shared.
  */
 char* string_proper(char* argument)
 {
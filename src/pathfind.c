@@ -0,0 +1,701 @@
+////////////////////////////////////////////////////////////////////////////////
+// pathfind.c
+// Shortest paths over the Room/RoomExit graph
+//
+// Fewest-steps searches are a bidirectional BFS: forward along 'exit', back
+// along 'inbound_exits', a whole level at a time from whichever side has the
+// smaller frontier. Cheapest-cost searches (PATH_COSTS) are A*, guided by
+// landmark ("ALT") bounds: hop counts to and from a handful of rooms spread
+// across the world. By the triangle inequality, |d(L,t) - d(L,v)| can't be
+// more than the distance from v to t; and since every step costs at least 1,
+// it holds for costs too. The same tables can also show that no path exists
+// at all (the rooms are in separate pieces of the map, or a landmark reaches
+// one but not the other), which ends a search before it starts.
+//
+// The tables only depend on which exits lead where, so they are rebuilt
+// (lazily) when exits are created, freed or repointed. Doors, NO_MOB and
+// private rooms can only take edges away, which leaves the bounds valid; they
+// are read live by each search.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "pathfind.h"
+
+#include "db.h"
+#include "handler.h"
+
+#include <data/direction.h>
+
+#include <entities/mobile.h>
+#include <entities/object.h>
+#include <entities/room.h>
+#include <entities/room_exit.h>
+
+#include <lox/list.h>
+#include <lox/object.h>
+
+#include <limits.h>
+#include <stdlib.h>
+
+#define PATH_LANDMARKS      8
+#define LANDMARK_FAR        UINT16_MAX
+
+#define SIDE_SOURCE         1
+#define SIDE_TARGET         2
+
+typedef struct room_vec_t {
+    Room** rooms;
+    int count;
+    int capacity;
+} RoomVec;
+
+typedef struct open_entry_t {
+    int32_t estimate;       // Cost so far plus the landmark bound
+    int32_t cost;
+    Room* room;
+} OpenEntry;
+
+static uint32_t path_graph_gen = 1;
+static uint32_t search_stamp = 0;
+
+// Landmark tables, [index * PATH_LANDMARKS + landmark]
+static uint32_t landmark_gen = 0;
+static int landmark_count = 0;
+static uint16_t* dist_from = NULL;  // Hops from the landmark to the room
+static uint16_t* dist_to = NULL;    // Hops from the room to the landmark
+static int32_t* components = NULL; // Weakly connected component of the room
+static int dist_capacity = 0;
+static RoomVec indexed = { 0 };     // Rooms by index
+
+static RoomVec frontier[2] = { 0 };
+static RoomVec next_frontier = { 0 };
+static OpenEntry* open_set = NULL;
+static int open_count = 0;
+static int open_capacity = 0;
+
+static PathStats stats = { 0 };
+
+const PathStats* path_stats()
+{
+    return &stats;
+}
+
+void path_graph_changed()
+{
+    if (++path_graph_gen == 0)
+        path_graph_gen = 1;
+}
+
+static void push_room(RoomVec* vec, Room* room)
+{
+    if (vec->count == vec->capacity) {
+        int capacity = vec->capacity < 64 ? 64 : vec->capacity * 2;
+        Room** grown = realloc(vec->rooms, sizeof(Room*) * (size_t)capacity);
+        if (grown == NULL) {
+            bug("pathfind: out of memory.");
+            exit(1);
+        }
+        vec->rooms = grown;
+        vec->capacity = capacity;
+    }
+    vec->rooms[vec->count++] = room;
+}
+
+static uint32_t next_stamp()
+{
+    if (++search_stamp == 0) {
+        // Wrapped; forget every old stamp so none can pass for a new one.
+        RoomData* room_data;
+        Room* room;
+        FOR_EACH_GLOBAL_ROOM(room_data) {
+            FOR_EACH_ROOM_INST(room, room_data)
+                room->path.stamp = 0;
+        }
+        search_stamp = 1;
+    }
+    return search_stamp;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Landmarks
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool is_indexed(Room* room)
+{
+    return room->path.index_gen == landmark_gen;
+}
+
+static void index_room(Room* room)
+{
+    if (is_indexed(room))
+        return;
+
+    int index = indexed.count;
+    push_room(&indexed, room);
+    room->path.index = index;
+    room->path.index_gen = landmark_gen;
+
+    // Rows are added as rooms turn up; anything a landmark's search didn't
+    // reach is out of its reach.
+    if (dist_capacity < indexed.capacity) {
+        size_t size = sizeof(uint16_t) * PATH_LANDMARKS
+            * (size_t)indexed.capacity;
+        uint16_t* from = realloc(dist_from, size);
+        uint16_t* to = from ? realloc(dist_to, size) : NULL;
+        int32_t* comps = to ? realloc(components, sizeof(int32_t)
+            * (size_t)indexed.capacity) : NULL;
+        if (from == NULL || to == NULL || comps == NULL) {
+            bug("pathfind: out of memory.");
+            exit(1);
+        }
+        dist_from = from;
+        dist_to = to;
+        components = comps;
+        dist_capacity = indexed.capacity;
+    }
+    components[index] = -1;
+    for (int k = 0; k < PATH_LANDMARKS; k++) {
+        dist_from[index * PATH_LANDMARKS + k] = LANDMARK_FAR;
+        dist_to[index * PATH_LANDMARKS + k] = LANDMARK_FAR;
+    }
+}
+
+static int exit_dir(Room* room, RoomExit* room_exit)
+{
+    for (int dir = 0; dir < DIR_MAX; dir++)
+        if (room->exit[dir] == room_exit)
+            return dir;
+    return -1;
+}
+
+// The room an inbound exit of 'room' leads from, or NULL if the exit no longer
+// leads here from there (redit can repoint an exit without the old target
+// hearing about it).
+static Room* inbound_from(Room* room, RoomExit* room_exit)
+{
+    Room* prev = room_exit->from_room;
+    if (prev == NULL || room_exit->to_room != room
+        || exit_dir(prev, room_exit) < 0)
+        return NULL;
+    return prev;
+}
+
+// Plain BFS over every exit, doors and all, from (or, backward, to) the
+// landmark; fills its column of 'dist'.
+static void measure_landmark(Room* landmark, int k, uint16_t* dist,
+    bool backward)
+{
+    RoomVec* queue = &frontier[0];
+    queue->count = 0;
+    push_room(queue, landmark);
+    dist[landmark->path.index * PATH_LANDMARKS + k] = 0;
+
+    for (int head = 0; head < queue->count; head++) {
+        Room* room = queue->rooms[head];
+        uint16_t hops = dist[room->path.index * PATH_LANDMARKS + k];
+        if (hops == LANDMARK_FAR - 1)
+            continue;
+
+        if (!backward) {
+            for (int dir = 0; dir < DIR_MAX; dir++) {
+                Room* next = room->exit[dir] ? room->exit[dir]->to_room : NULL;
+                if (next == NULL)
+                    continue;
+                index_room(next);
+                uint16_t* slot = &dist[next->path.index * PATH_LANDMARKS + k];
+                if (*slot == LANDMARK_FAR) {
+                    *slot = hops + 1;
+                    push_room(queue, next);
+                }
+            }
+            continue;
+        }
+
+        for (Node* node = room->inbound_exits.front; node != NULL;
+                node = node->next) {
+            Room* prev = inbound_from(room, AS_ROOM_EXIT(node->value));
+            if (prev == NULL)
+                continue;
+            index_room(prev);
+            uint16_t* slot = &dist[prev->path.index * PATH_LANDMARKS + k];
+            if (*slot == LANDMARK_FAR) {
+                *slot = hops + 1;
+                push_room(queue, prev);
+            }
+        }
+    }
+}
+
+// Labels every indexed room with its weakly connected component (exits
+// followed both ways); rooms in different components can't reach each other.
+// Returns the index of a room in the largest one.
+static int label_components()
+{
+    RoomVec* queue = &frontier[0];
+    int component = 0;
+    int largest = 0;
+    int largest_size = 0;
+
+    for (int i = 0; i < indexed.count; i++) {
+        if (components[i] >= 0)
+            continue;
+
+        queue->count = 0;
+        push_room(queue, indexed.rooms[i]);
+        components[i] = component;
+
+        for (int head = 0; head < queue->count; head++) {
+            Room* room = queue->rooms[head];
+            for (int dir = 0; dir < DIR_MAX; dir++) {
+                Room* next = room->exit[dir] ? room->exit[dir]->to_room : NULL;
+                if (next == NULL)
+                    continue;
+                index_room(next);
+                if (components[next->path.index] < 0) {
+                    components[next->path.index] = component;
+                    push_room(queue, next);
+                }
+            }
+            for (Node* node = room->inbound_exits.front; node != NULL;
+                    node = node->next) {
+                Room* prev = inbound_from(room, AS_ROOM_EXIT(node->value));
+                if (prev == NULL)
+                    continue;
+                index_room(prev);
+                if (components[prev->path.index] < 0) {
+                    components[prev->path.index] = component;
+                    push_room(queue, prev);
+                }
+            }
+        }
+
+        if (queue->count > largest_size) {
+            largest_size = queue->count;
+            largest = i;
+        }
+        component++;
+    }
+
+    return largest;
+}
+
+// Picks landmarks by farthest-point sampling: each one is the room farthest
+// (in hops) from the nearest landmark already chosen, which spreads them to
+// the edges of the map where their bounds are tightest. They all land in the
+// largest component; the others are told apart by their labels alone.
+static void build_landmarks()
+{
+    landmark_gen = path_graph_gen;
+    landmark_count = 0;
+    indexed.count = 0;
+    stats.landmark_builds++;
+
+    RoomData* room_data;
+    Room* room;
+    FOR_EACH_GLOBAL_ROOM(room_data) {
+        FOR_EACH_ROOM_INST(room, room_data)
+            index_room(room);
+    }
+
+    if (indexed.count == 0) {
+        stats.landmark_rooms = 0;
+        return;
+    }
+
+    // Start from whatever is farthest from somewhere in the thick of it.
+    Room* seed = indexed.rooms[label_components()];
+    measure_landmark(seed, 0, dist_from, false);
+    Room* next = seed;
+    uint16_t far = 0;
+    for (int i = 0; i < indexed.count; i++) {
+        uint16_t hops = dist_from[i * PATH_LANDMARKS];
+        if (hops != LANDMARK_FAR && hops > far) {
+            far = hops;
+            next = indexed.rooms[i];
+        }
+    }
+    for (int i = 0; i < indexed.count; i++)
+        dist_from[i * PATH_LANDMARKS] = LANDMARK_FAR;
+
+    while (next != NULL && landmark_count < PATH_LANDMARKS) {
+        int k = landmark_count++;
+        measure_landmark(next, k, dist_from, false);
+        measure_landmark(next, k, dist_to, true);
+
+        next = NULL;
+        int best = 0;
+        for (int i = 0; i < indexed.count; i++) {
+            int nearest = INT_MAX;
+            for (int j = 0; j <= k; j++) {
+                uint16_t hops = dist_from[i * PATH_LANDMARKS + j];
+                if (hops != LANDMARK_FAR && hops < nearest)
+                    nearest = hops;
+            }
+            if (nearest != INT_MAX && nearest > best) {
+                best = nearest;
+                next = indexed.rooms[i];
+            }
+        }
+    }
+
+    stats.landmark_rooms = indexed.count;
+}
+
+// A lower bound on the steps from 'room' to 'to', or -1 if the tables show
+// there's no way at all.
+static int landmark_bound(Room* room, Room* to)
+{
+    if (!is_indexed(room) || !is_indexed(to))
+        return 0;
+
+    if (components[room->path.index] != components[to->path.index])
+        return -1;
+
+    const uint16_t* from_v = &dist_from[room->path.index * PATH_LANDMARKS];
+    const uint16_t* from_t = &dist_from[to->path.index * PATH_LANDMARKS];
+    const uint16_t* to_v = &dist_to[room->path.index * PATH_LANDMARKS];
+    const uint16_t* to_t = &dist_to[to->path.index * PATH_LANDMARKS];
+    int bound = 0;
+
+    for (int k = 0; k < landmark_count; k++) {
+        if (from_v[k] != LANDMARK_FAR) {
+            if (from_t[k] == LANDMARK_FAR)
+                return -1;
+            if (from_t[k] - from_v[k] > bound)
+                bound = from_t[k] - from_v[k];
+        }
+        if (to_t[k] != LANDMARK_FAR) {
+            if (to_v[k] == LANDMARK_FAR)
+                return -1;
+            if (to_v[k] - to_t[k] > bound)
+                bound = to_v[k] - to_t[k];
+        }
+    }
+
+    return bound;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Searches
+////////////////////////////////////////////////////////////////////////////////
+
+// What it costs to take 'room_exit' out of 'room' by the rules in 'flags', or
+// -1 if it can't be taken. Mirrors move_char().
+static int step_cost(Room* room, RoomExit* room_exit, Room* origin, Room* goal,
+    FLAGS flags)
+{
+    Room* next = room_exit->to_room;
+    int cost = 0;
+
+    if (next == NULL)
+        return -1;
+
+    if (IS_SET(room_exit->exit_flags, EX_CLOSED)
+        && (!IS_SET(flags, PATH_PASS_DOOR)
+            || IS_SET(room_exit->exit_flags, EX_NOPASS))) {
+        if (!IS_SET(flags, PATH_OPEN_DOORS))
+            return -1;
+        if (IS_SET(room_exit->exit_flags, EX_LOCKED)) {
+            if (!IS_SET(flags, PATH_UNLOCK))
+                return -1;
+            cost++;
+        }
+        cost++;
+    }
+
+    if (IS_SET(flags, PATH_SAME_AREA) && next->area != origin->area)
+        return -1;
+
+    // Wherever it's going is where it's going, NO_MOB or not.
+    if (next != goal) {
+        if (IS_SET(flags, PATH_AVOID_NO_MOB)
+            && IS_SET(next->data->room_flags, ROOM_NO_MOB))
+            return -1;
+        if (room_is_private(next))
+            return -1;
+    }
+
+    Sector in = room->data->sector_type;
+    Sector to = next->data->sector_type;
+
+    if (!IS_SET(flags, PATH_FLY)) {
+        if (in == SECT_AIR || to == SECT_AIR)
+            return -1;
+        if (!IS_SET(flags, PATH_SWIM)
+            && (in == SECT_WATER_NOSWIM || to == SECT_WATER_NOSWIM))
+            return -1;
+    }
+
+    int move = (movement_loss[UMIN(SECT_MAX - 1, in)]
+        + movement_loss[UMIN(SECT_MAX - 1, to)]) / 2;
+
+    return cost + UMAX(1, move);
+}
+
+static inline void visit(Room* room, uint32_t stamp, uint8_t side, int cost,
+    int steps, int first_dir)
+{
+    room->path.stamp = stamp;
+    room->path.side = side;
+    room->path.cost = cost;
+    room->path.steps = (int16_t)steps;
+    room->path.first_dir = (int8_t)first_dir;
+    stats.rooms_visited++;
+}
+
+static bool search_steps(Room* from, Room* to, int limit, FLAGS flags,
+    PathResult* result)
+{
+    uint32_t stamp = next_stamp();
+    RoomVec* forward = &frontier[0];
+    RoomVec* backward = &frontier[1];
+    int forward_depth = 0;
+    int backward_depth = 0;
+
+    forward->count = 0;
+    backward->count = 0;
+    visit(from, stamp, SIDE_SOURCE, 0, 0, -1);
+    visit(to, stamp, SIDE_TARGET, 0, 0, -1);
+    push_room(forward, from);
+    push_room(backward, to);
+
+    while (forward->count > 0 && backward->count > 0) {
+        // Every path not met yet is longer than this.
+        if (limit > 0 && forward_depth + backward_depth >= limit)
+            break;
+
+        int best = INT_MAX;
+        int best_dir = -1;
+
+        next_frontier.count = 0;
+
+        if (forward->count <= backward->count) {
+            for (int i = 0; i < forward->count; i++) {
+                Room* room = forward->rooms[i];
+                for (int dir = 0; dir < DIR_MAX; dir++) {
+                    RoomExit* room_exit = room->exit[dir];
+                    Room* next;
+                    if (room_exit == NULL || (next = room_exit->to_room) == NULL
+                        || (next->path.stamp == stamp
+                            && next->path.side == SIDE_SOURCE)
+                        || step_cost(room, room_exit, from, to, flags) < 0)
+                        continue;
+
+                    int first = room == from ? dir : room->path.first_dir;
+                    if (next->path.stamp == stamp) {
+                        int steps = room->path.cost + 1 + next->path.cost;
+                        if (steps < best) {
+                            best = steps;
+                            best_dir = first;
+                        }
+                        continue;
+                    }
+                    visit(next, stamp, SIDE_SOURCE, room->path.cost + 1, 0,
+                        first);
+                    push_room(&next_frontier, next);
+                }
+            }
+            forward_depth++;
+            RoomVec swap = *forward;
+            *forward = next_frontier;
+            next_frontier = swap;
+        }
+        else {
+            for (int i = 0; i < backward->count; i++) {
+                Room* room = backward->rooms[i];
+                for (Node* node = room->inbound_exits.front; node != NULL;
+                        node = node->next) {
+                    RoomExit* room_exit = AS_ROOM_EXIT(node->value);
+                    Room* prev = inbound_from(room, room_exit);
+                    if (prev == NULL
+                        || (prev->path.stamp == stamp
+                            && prev->path.side == SIDE_TARGET)
+                        || step_cost(prev, room_exit, from, to, flags) < 0)
+                        continue;
+
+                    if (prev->path.stamp == stamp) {
+                        int steps = prev->path.cost + 1 + room->path.cost;
+                        if (steps < best) {
+                            best = steps;
+                            best_dir = prev == from
+                                ? exit_dir(prev, room_exit)
+                                : prev->path.first_dir;
+                        }
+                        continue;
+                    }
+                    visit(prev, stamp, SIDE_TARGET, room->path.cost + 1, 0,
+                        -1);
+                    push_room(&next_frontier, prev);
+                }
+            }
+            backward_depth++;
+            RoomVec swap = *backward;
+            *backward = next_frontier;
+            next_frontier = swap;
+        }
+
+        if (best != INT_MAX) {
+            result->first_dir = best_dir;
+            result->steps = best;
+            result->cost = best;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void open_push(Room* room, int cost, int estimate)
+{
+    if (open_count == open_capacity) {
+        int capacity = open_capacity < 64 ? 64 : open_capacity * 2;
+        OpenEntry* grown = realloc(open_set,
+            sizeof(OpenEntry) * (size_t)capacity);
+        if (grown == NULL) {
+            bug("pathfind: out of memory.");
+            exit(1);
+        }
+        open_set = grown;
+        open_capacity = capacity;
+    }
+
+    int i = open_count++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (open_set[parent].estimate <= estimate)
+            break;
+        open_set[i] = open_set[parent];
+        i = parent;
+    }
+    open_set[i] = (OpenEntry){ estimate, cost, room };
+}
+
+static OpenEntry open_pop()
+{
+    OpenEntry top = open_set[0];
+    OpenEntry last = open_set[--open_count];
+    int i = 0;
+
+    for (;;) {
+        int child = i * 2 + 1;
+        if (child >= open_count)
+            break;
+        if (child + 1 < open_count
+            && open_set[child + 1].estimate < open_set[child].estimate)
+            child++;
+        if (last.estimate <= open_set[child].estimate)
+            break;
+        open_set[i] = open_set[child];
+        i = child;
+    }
+    if (open_count > 0)
+        open_set[i] = last;
+
+    return top;
+}
+
+static bool search_costs(Room* from, Room* to, int limit, FLAGS flags,
+    PathResult* result)
+{
+    uint32_t stamp = next_stamp();
+
+    open_count = 0;
+    visit(from, stamp, SIDE_SOURCE, 0, 0, -1);
+    open_push(from, 0, 0);
+
+    while (open_count > 0) {
+        OpenEntry entry = open_pop();
+        Room* room = entry.room;
+
+        // Superseded by a cheaper way here.
+        if (entry.cost != room->path.cost)
+            continue;
+
+        if (room == to) {
+            result->first_dir = room->path.first_dir;
+            result->steps = room->path.steps;
+            result->cost = room->path.cost;
+            return true;
+        }
+
+        for (int dir = 0; dir < DIR_MAX; dir++) {
+            RoomExit* room_exit = room->exit[dir];
+            Room* next;
+            int step;
+            if (room_exit == NULL || (next = room_exit->to_room) == NULL
+                || (step = step_cost(room, room_exit, from, to, flags)) < 0)
+                continue;
+
+            int cost = room->path.cost + step;
+            if ((limit > 0 && cost > limit)
+                || (next->path.stamp == stamp && next->path.cost <= cost))
+                continue;
+
+            int bound = landmark_bound(next, to);
+            if (bound < 0)
+                continue;
+
+            visit(next, stamp, SIDE_SOURCE, cost, room->path.steps + 1,
+                room == from ? dir : room->path.first_dir);
+            open_push(next, cost, cost + bound);
+        }
+    }
+
+    return false;
+}
+
+bool find_path(Room* from, Room* to, int limit, FLAGS flags, PathResult* result)
+{
+    stats.searches++;
+
+    if (from == NULL || to == NULL)
+        return false;
+
+    if (from == to) {
+        *result = (PathResult){ -1, 0, 0 };
+        stats.found++;
+        return true;
+    }
+
+    if (landmark_gen != path_graph_gen)
+        build_landmarks();
+
+    if (landmark_bound(from, to) < 0) {
+        stats.pruned++;
+        return false;
+    }
+
+    bool found = IS_SET(flags, PATH_COSTS)
+        ? search_costs(from, to, limit, flags, result)
+        : search_steps(from, to, limit, flags, result);
+
+    if (found)
+        stats.found++;
+
+    return found;
+}
+
+FLAGS path_flags_for(Mobile* ch)
+{
+    FLAGS flags = PATH_OPEN_DOORS;
+
+    // move_char() doesn't hold NPCs to sector rules.
+    if (IS_NPC(ch))
+        return flags | PATH_FLY | PATH_SWIM | PATH_AVOID_NO_MOB;
+
+    if (IS_AFFECTED(ch, AFF_PASS_DOOR) || IS_TRUSTED(ch, ANGEL))
+        SET_BIT(flags, PATH_PASS_DOOR);
+
+    if (IS_AFFECTED(ch, AFF_FLYING) || IS_IMMORTAL(ch))
+        SET_BIT(flags, PATH_FLY);
+    else {
+        Object* obj;
+        FOR_EACH_MOB_OBJ(obj, ch) {
+            if (obj->item_type == ITEM_BOAT) {
+                SET_BIT(flags, PATH_SWIM);
+                break;
+            }
+        }
+    }
+
+    return flags;
+}
@@ -0,0 +1,58 @@
+////////////////////////////////////////////////////////////////////////////////
+// pathfind.h
+// Shortest paths over the Room/RoomExit graph
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__PATHFIND_H
+#define MUD98__PATHFIND_H
+
+#include "merc.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct room_t Room;
+typedef struct mobile_t Mobile;
+
+typedef enum path_flags_t {
+    PATH_OPEN_DOORS     = BIT(0),   // Closed doors can be opened on the way
+    PATH_UNLOCK         = BIT(1),   // ...and locked ones unlocked
+    PATH_PASS_DOOR      = BIT(2),   // Closed doors are no obstacle (but NOPASS)
+    PATH_FLY            = BIT(3),   // Air (and deep water) is fine
+    PATH_SWIM           = BIT(4),   // Deep water is fine
+    PATH_SAME_AREA      = BIT(5),   // Don't leave the area it starts in
+    PATH_AVOID_NO_MOB   = BIT(6),   // Keep out of NO_MOB rooms on the way
+    PATH_COSTS          = BIT(7),   // Cheapest by movement cost, not steps
+} PathFlags;
+
+typedef struct path_result_t {
+    int first_dir;          // Direction of the first step; -1 if already there
+    int steps;
+    int cost;               // Movement cost (steps, without PATH_COSTS)
+} PathResult;
+
+typedef struct path_stats_t {
+    uint64_t searches;
+    uint64_t found;
+    uint64_t rooms_visited;
+    uint64_t pruned;        // Ruled out by the landmark tables without a search
+    int landmark_builds;
+    int landmark_rooms;     // Rooms covered by the current tables
+} PathStats;
+
+// Finds the shortest way from 'from' to 'to'. 'limit' caps the steps (or the
+// cost, with PATH_COSTS) it will look for; 0 means no limit. Door states,
+// NO_MOB and private rooms are read as they are now; only the shape of the
+// graph is cached.
+bool find_path(Room* from, Room* to, int limit, FLAGS flags, PathResult* result);
+
+// What 'ch' could walk through, by move_char()'s rules.
+FLAGS path_flags_for(Mobile* ch);
+
+// Call when an exit is added, removed or repointed.
+void path_graph_changed();
+
+const PathStats* path_stats();
+
+#endif // !MUD98__PATHFIND_H
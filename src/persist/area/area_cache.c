@@ -0,0 +1,351 @@
+////////////////////////////////////////////////////////////////////////////////
+// persist/area/area_cache.c
+// Boot-time binary area cache.
+//
+// After an area loads from its text or JSON source it is serialized with the
+// binary area format and written to <area_cache_dir>/<file>.arc. The image
+// header records an FNV-1a hash of the source bytes and the format build ID;
+// on later boots a matching image is mapped and loaded in place of the
+// source. Any mismatch, read error, or unsupported content falls back to the
+// source load, so a missing or damaged cache only costs boot time.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "area_cache.h"
+
+#include "binary/area_persist_binary.h"
+
+#include <persist/persist_io_adapters.h>
+
+#include <entities/area.h>
+
+#include <comm.h>
+#include <config.h>
+#include <db.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static AreaCacheStats stats = { 0 };
+
+typedef struct cache_image_t {
+    const uint8_t* data;
+    size_t len;
+    bool mapped;
+} CacheImage;
+
+const AreaCacheStats* area_cache_stats(void)
+{
+    return &stats;
+}
+
+void area_cache_log_stats(void)
+{
+    if (!cfg_get_area_cache())
+        return;
+
+    printf_log("Area cache: %d hit(s), %d miss(es) (%d stale), %d written, "
+        "%d uncacheable.", stats.hits, stats.misses, stats.stale, stats.writes,
+        stats.skipped);
+
+    if (cfg_get_area_cache_verify())
+        printf_log("Area cache verify: %d area(s) differ from their cached image.",
+            stats.mismatches);
+}
+
+static bool hash_source(FILE* fp, uint64_t* out)
+{
+    unsigned char buf[16 * 1024];
+    uint64_t hash = 0;
+    size_t n;
+
+    rewind(fp);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+        hash = area_binary_hash_bytes(buf, n, hash);
+
+    bool ok = !ferror(fp);
+    rewind(fp);
+    *out = hash;
+    return ok;
+}
+
+static bool ensure_cache_dir(const char* path)
+{
+#ifdef _MSC_VER
+    if (_mkdir(path) == 0 || errno == EEXIST)
+        return true;
+#else
+    if (mkdir(path, 0775) == 0 || errno == EEXIST)
+        return true;
+#endif
+
+    perror(path);
+    return false;
+}
+
+static bool open_image(const char* path, CacheImage* image)
+{
+    memset(image, 0, sizeof(*image));
+
+#ifndef _MSC_VER
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    image->data = map;
+    image->len = (size_t)st.st_size;
+    image->mapped = true;
+    return true;
+#else
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return false;
+
+    if (fseek(fp, 0, SEEK_END) != 0) {
+        fclose(fp);
+        return false;
+    }
+    long size = ftell(fp);
+    rewind(fp);
+    if (size <= 0) {
+        fclose(fp);
+        return false;
+    }
+
+    uint8_t* buf = malloc((size_t)size);
+    if (!buf || fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+        free(buf);
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+
+    image->data = buf;
+    image->len = (size_t)size;
+    return true;
+#endif
+}
+
+static void close_image(CacheImage* image)
+{
+    if (!image->data)
+        return;
+#ifndef _MSC_VER
+    if (image->mapped)
+        munmap((void*)image->data, image->len);
+    else
+#endif
+        free((void*)image->data);
+    memset(image, 0, sizeof(*image));
+}
+
+static bool write_image(const char* path, const PersistBufferWriter* buf)
+{
+    char tmp[MAX_INPUT_LENGTH * 2];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) {
+        perror(tmp);
+        return false;
+    }
+
+    bool ok = fwrite(buf->data, 1, buf->len, fp) == buf->len;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok) {
+        bugf("area_cache: could not write %s", tmp);
+        remove(tmp);
+        return false;
+    }
+
+#ifdef _MSC_VER
+    if (!MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (rename(tmp, path) != 0) {
+#endif
+        bugf("area_cache: could not rename %s to %s", tmp, path);
+        remove(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+// Serializes the area that was just loaded from source and stamps it with
+// 'key'. Returns false (leaving 'out' empty) if the area can't be cached.
+static bool build_image(const AreaPersistLoadParams* params,
+    const AreaBinaryKey* key, PersistBufferWriter* out)
+{
+    AreaData* area = current_area_data;
+    if (!area || !area_binary_can_save(area)) {
+        stats.skipped++;
+        return false;
+    }
+
+    PersistWriter writer = persist_writer_from_buffer(out, params->file_name);
+    AreaPersistSaveParams save_params = {
+        .writer = &writer,
+        .area = area,
+        .file_name = params->file_name,
+    };
+
+    PersistResult result = AREA_PERSIST_BINARY.save(&save_params);
+    if (!persist_succeeded(result)) {
+        if (result.status == PERSIST_ERR_UNSUPPORTED)
+            stats.skipped++;
+        else
+            bugf("area_cache: could not serialize %s (%s)", params->file_name,
+                result.message ? result.message : "unknown error");
+        return false;
+    }
+
+    return area_binary_stamp_key(out->data, out->len, key);
+}
+
+// Loads the cached image into a scratch area and saves that area to 'out', so
+// a reader that drops or mangles a field shows up when 'out' is compared with
+// the image built from the source.
+static bool reload_image(const AreaPersistLoadParams* params,
+    const CacheImage* image, PersistBufferWriter* out)
+{
+    PersistBufferReaderCtx ctx = { 0 };
+    PersistReader reader = persist_reader_from_buffer(image->data, image->len,
+        params->file_name, &ctx);
+    PersistWriter writer = persist_writer_from_buffer(out, params->file_name);
+    AreaPersistLoadParams scratch_params = *params;
+    scratch_params.reader = &reader;
+    scratch_params.create_single_instance = false;
+    scratch_params.verify_writer = &writer;
+
+    PersistResult result = AREA_PERSIST_BINARY.load(&scratch_params);
+    if (!persist_succeeded(result)) {
+        bugf("area_cache: could not reload %s (%s)", params->file_name,
+            result.message ? result.message : "unknown error");
+        return false;
+    }
+    return true;
+}
+
+PersistResult area_cache_load(const AreaPersistFormat* source_fmt,
+    const AreaPersistLoadParams* params)
+{
+    if (!cfg_get_area_cache() || !params || !params->reader || !params->file_name
+        || params->reader->ops != &PERSIST_FILE_STREAM_OPS
+        || source_fmt == &AREA_PERSIST_BINARY)
+        return source_fmt->load(params);
+
+    FILE* source = (FILE*)params->reader->ctx;
+    AreaBinaryKey key = { .build_id = area_binary_build_id() };
+    if (!hash_source(source, &key.source_hash))
+        return source_fmt->load(params);
+
+    char path[MAX_INPUT_LENGTH * 2];
+    snprintf(path, sizeof(path), "%s%s.%s", cfg_get_area_cache_dir(),
+        params->file_name, AREA_BINARY_EXT);
+
+    bool verify = cfg_get_area_cache_verify();
+    CacheImage image;
+    bool have_image = open_image(path, &image);
+    AreaBinaryKey cached_key = { 0 };
+    bool current = have_image
+        && area_binary_read_key(image.data, image.len, &cached_key)
+        && cached_key.source_hash == key.source_hash
+        && cached_key.build_id == key.build_id;
+
+    if (current && !verify) {
+        PersistBufferReaderCtx ctx = { 0 };
+        PersistReader reader = persist_reader_from_buffer(image.data, image.len,
+            params->file_name, &ctx);
+        AreaPersistLoadParams cache_params = *params;
+        cache_params.reader = &reader;
+
+        PersistResult result = AREA_PERSIST_BINARY.load(&cache_params);
+        close_image(&image);
+        if (persist_succeeded(result)) {
+            stats.hits++;
+            return result;
+        }
+
+        // The binary loader validates the whole image before creating
+        // anything, so a failed load leaves nothing behind to clean up.
+        bugf("area_cache: %s is unusable (%s); loading from source", path,
+            result.message ? result.message : "unknown error");
+        current = false;
+        have_image = false;
+    }
+
+    stats.misses++;
+    if (have_image && !current)
+        stats.stale++;
+
+    PersistResult result = source_fmt->load(params);
+    if (!persist_succeeded(result)) {
+        close_image(&image);
+        return result;
+    }
+
+    PersistBufferWriter buf = { 0 };
+    if (!build_image(params, &key, &buf)) {
+        free(buf.data);
+        close_image(&image);
+        return result;
+    }
+
+    if (verify && current) {
+        // The stored bytes must match a fresh build, and so must what the
+        // binary loader makes of them.
+        const char* first_diff = NULL;
+        PersistBufferWriter reloaded = { 0 };
+        bool same = area_binary_diff(image.data, image.len, buf.data, buf.len, &first_diff) == 0;
+        if (same && !reload_image(params, &image, &reloaded)) {
+            same = false;
+            first_diff = "load";
+        }
+        same = same && area_binary_diff(reloaded.data, reloaded.len, buf.data, buf.len,
+            &first_diff) == 0;
+        free(reloaded.data);
+
+        if (!same) {
+            stats.mismatches++;
+            bugf("area_cache: %s does not match its source load (first "
+                "difference in '%s')", path, first_diff ? first_diff : "?");
+        }
+        else {
+            // Identical; no need to rewrite it.
+            free(buf.data);
+            close_image(&image);
+            return result;
+        }
+    }
+
+    close_image(&image);
+
+    if (ensure_cache_dir(cfg_get_area_cache_dir()) && write_image(path, &buf))
+        stats.writes++;
+
+    free(buf.data);
+    return result;
+}
@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////////////////
+// persist/area/area_cache.h
+// Boot-time binary area cache, keyed by source hash and server build.
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__PERSIST__AREA__AREA_CACHE_H
+#define MUD98__PERSIST__AREA__AREA_CACHE_H
+
+#include "area_persist.h"
+
+typedef struct area_cache_stats_t {
+    int hits;           // Loaded from a current cache image
+    int misses;         // No usable image; loaded from source
+    int stale;          // Image existed but its key didn't match
+    int writes;         // Images written after a source load
+    int skipped;        // Area content the binary format can't represent
+    int mismatches;     // Verify mode: image differs from the source load
+} AreaCacheStats;
+
+// Loads an area through the cache when 'area_cache' is enabled. 'source_fmt'
+// and 'params' describe the normal source load; 'params->reader' must be a
+// FILE reader positioned at the start of the source file. Falls back to
+// 'source_fmt' whenever the cache can't be used.
+PersistResult area_cache_load(const AreaPersistFormat* source_fmt,
+    const AreaPersistLoadParams* params);
+
+const AreaCacheStats* area_cache_stats(void);
+void area_cache_log_stats(void);
+
+#endif // !MUD98__PERSIST__AREA__AREA_CACHE_H
@@ -5,6 +5,8 @@
 
 #include "area_persist.h"
 
+#include "binary/area_persist_binary.h"
+
 #ifdef ENABLE_ROM_OLC_PERSISTENCE
 #include "rom-olc/area_persist_rom_olc.h"
 #endif
@@ -30,6 +32,8 @@ static const char* file_ext(const char* path)
 const AreaPersistFormat* area_persist_select_format(const char* file_name)
 {
     const char* ext = file_ext(file_name);
+    if (ext && strcasecmp(ext, AREA_BINARY_EXT) == 0)
+        return &AREA_PERSIST_BINARY;
 #ifdef ENABLE_JSON_PERSISTENCE
     if (ext && strcasecmp(ext, "json") == 0)
         return &AREA_PERSIST_JSON;
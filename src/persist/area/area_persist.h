@@ -18,6 +18,9 @@ typedef struct area_persist_load_params_t {
     const PersistReader* reader;
     const char* file_name; // Used for error text and to seed AreaData->file_name.
     bool create_single_instance; // Mirror boot_db behavior for AREA_INST_SINGLE.
+    // Binary images only: load into a detached scratch area, save that area
+    // back out through this writer, and discard it. Nothing joins the world.
+    const PersistWriter* verify_writer;
 } AreaPersistLoadParams;
 
 typedef struct area_persist_save_params_t {
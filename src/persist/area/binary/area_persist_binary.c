@@ -0,0 +1,1896 @@
+////////////////////////////////////////////////////////////////////////////////
+// persist/area/binary/area_persist_binary.c
+// Fixed-layout binary area images used by the boot-time area cache.
+//
+// An image is a header, a section table, and one section per record kind.
+// Every record is a fixed-width struct of 32-bit fields; strings are stored
+// once in a NUL-separated string table and referenced by byte offset, and
+// child records (exits, affects, events, ...) are referenced by index ranges
+// into their own sections. Loading walks the sections in place, so an image
+// that has been mmap'd is never copied or tokenized.
+//
+// Images capture the state an area is in right after a source load (race
+// flags already merged, 'D' resets already folded into exit flags), so they
+// are only valid for the build and runtime tables that produced them. See
+// area_binary_build_id().
+////////////////////////////////////////////////////////////////////////////////
+
+#include "area_persist_binary.h"
+
+#include <persist/persist_io_adapters.h>
+
+#include <craft/gather.h>
+#include <craft/recipe.h>
+
+#include <data/loot.h>
+#include <data/mobile_data.h>
+#include <data/race.h>
+#include <data/skill.h>
+
+#include <entities/area.h>
+#include <entities/event.h>
+#include <entities/extra_desc.h>
+#include <entities/faction.h>
+#include <entities/help_data.h>
+#include <entities/mob_prototype.h>
+#include <entities/obj_prototype.h>
+#include <entities/reset.h>
+#include <entities/room.h>
+#include <entities/room_exit.h>
+#include <entities/shop_data.h>
+
+#include <lox/ordered_table.h>
+
+#include <comm.h>
+#include <db.h>
+#include <merc.h>
+#include <mob_prog.h>
+#include <special.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const AreaPersistFormat AREA_PERSIST_BINARY = {
+    .name = "binary",
+    .load = area_binary_load,
+    .save = area_binary_save,
+};
+
+#define ARC_MAGIC           "M98AREA"
+#define ARC_ENDIAN_MARK     0x01020304u
+#define ARC_STR_NONE        UINT32_MAX
+#define ARC_ALIGN           8
+#define ARC_NO_SHOP         -1
+
+#define FNV64_BASIS         0xcbf29ce484222325ULL
+#define FNV64_PRIME         0x100000001b3ULL
+
+typedef enum arc_section_kind_t {
+    ARC_SEC_STRINGS,
+    ARC_SEC_AREA,
+    ARC_SEC_PERIODS,
+    ARC_SEC_STORY_BEATS,
+    ARC_SEC_CHECKLIST,
+    ARC_SEC_GATHER,
+    ARC_SEC_ROOMS,
+    ARC_SEC_EXITS,
+    ARC_SEC_EXTRA_DESCS,
+    ARC_SEC_EVENTS,
+    ARC_SEC_RESETS,
+    ARC_SEC_MOBS,
+    ARC_SEC_MOB_PROGS,
+    ARC_SEC_SHOPS,
+    ARC_SEC_OBJS,
+    ARC_SEC_AFFECTS,
+    ARC_SEC_VNUMS,
+    ARC_SEC_PROG_CODE,
+    ARC_SEC_COUNT
+} ArcSectionKind;
+
+static const char* arc_section_names[ARC_SEC_COUNT] = {
+    "strings", "area", "periods", "story_beats", "checklist", "gather",
+    "rooms", "exits", "extra_descs", "events", "resets", "mobs", "mob_progs",
+    "shops", "objs", "affects", "vnums", "prog_code",
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// On-disk layout
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct arc_section_t {
+    uint32_t count;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t reserved;
+} ArcSection;
+
+typedef struct arc_header_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t source_hash;
+    uint64_t build_id;
+    uint32_t section_count;
+    uint32_t total_size;
+    ArcSection sections[ARC_SEC_COUNT];
+} ArcHeader;
+
+typedef struct arc_range_t {
+    uint32_t first;
+    uint32_t count;
+} ArcRange;
+
+typedef struct arc_area_t {
+    uint32_t name;
+    uint32_t builders;
+    uint32_t credits;
+    uint32_t loot_table;
+    int32_t security;
+    int32_t low_range;
+    int32_t high_range;
+    int32_t min_vnum;
+    int32_t max_vnum;
+    int32_t sector;
+    int32_t area_flags;
+    int32_t reset_thresh;
+    int32_t always_reset;
+    int32_t inst_type;
+    int32_t suppress_daycycle;
+    ArcRange periods;
+    ArcRange story_beats;
+    ArcRange checklist;
+    ArcRange gather_spawns;
+} ArcArea;
+
+typedef struct arc_period_t {
+    uint32_t name;
+    uint32_t description;
+    uint32_t enter_message;
+    uint32_t exit_message;
+    int32_t start_hour;
+    int32_t end_hour;
+} ArcPeriod;
+
+typedef struct arc_story_beat_t {
+    uint32_t title;
+    uint32_t description;
+} ArcStoryBeat;
+
+typedef struct arc_checklist_t {
+    uint32_t title;
+    uint32_t description;
+    int32_t status;
+} ArcChecklist;
+
+typedef struct arc_gather_t {
+    int32_t sector;
+    int32_t vnum;
+    int32_t quantity;
+    int32_t respawn_timer;
+} ArcGather;
+
+typedef struct arc_room_t {
+    int32_t vnum;
+    uint32_t name;
+    uint32_t description;
+    uint32_t script;
+    int32_t room_flags;
+    int32_t sector_type;
+    int32_t suppress_daycycle;
+    ArcRange exits;
+    ArcRange extra_descs;
+    ArcRange periods;
+    ArcRange events;
+    ArcRange resets;
+} ArcRoom;
+
+typedef struct arc_exit_t {
+    int32_t dir;
+    int32_t to_vnum;
+    int32_t key;
+    int32_t exit_reset_flags;
+    uint32_t keyword;
+    uint32_t description;
+} ArcExit;
+
+typedef struct arc_extra_desc_t {
+    uint32_t keyword;
+    uint32_t description;
+} ArcExtraDesc;
+
+typedef enum arc_criteria_kind_t {
+    ARC_CRIT_NONE,
+    ARC_CRIT_INT,
+    ARC_CRIT_STRING,
+} ArcCriteriaKind;
+
+typedef struct arc_event_t {
+    int32_t trigger;
+    uint32_t method_name;
+    int32_t criteria_kind;
+    int32_t criteria_int;
+    uint32_t criteria_str;
+} ArcEvent;
+
+typedef struct arc_reset_t {
+    int32_t command;
+    int32_t arg1;
+    int32_t arg2;
+    int32_t arg3;
+    int32_t arg4;
+} ArcReset;
+
+typedef struct arc_mob_t {
+    int32_t vnum;
+    uint32_t name;
+    uint32_t short_descr;
+    uint32_t long_descr;
+    uint32_t description;
+    uint32_t material;
+    uint32_t loot_table;
+    uint32_t script;
+    uint32_t spec_fun;
+    int32_t act_flags;
+    int32_t affect_flags;
+    int32_t atk_flags;
+    int32_t imm_flags;
+    int32_t res_flags;
+    int32_t vuln_flags;
+    int32_t form;
+    int32_t parts;
+    int32_t mprog_flags;
+    int32_t wealth;
+    int32_t hit[3];
+    int32_t mana[3];
+    int32_t damage[3];
+    int32_t ac[AC_COUNT];
+    int32_t faction_vnum;
+    int32_t group;
+    int32_t alignment;
+    int32_t level;
+    int32_t hitroll;
+    int32_t dam_type;
+    int32_t start_pos;
+    int32_t default_pos;
+    int32_t sex;
+    int32_t race;
+    int32_t size;
+    int32_t shop;
+    ArcRange mprogs;
+    ArcRange craft_mats;
+    ArcRange events;
+} ArcMob;
+
+typedef struct arc_mob_prog_t {
+    int32_t trig_type;
+    int32_t vnum;
+    uint32_t trig_phrase;
+} ArcMobProg;
+
+typedef struct arc_shop_t {
+    int32_t keeper;
+    int32_t buy_type[MAX_TRADE];
+    int32_t profit_buy;
+    int32_t profit_sell;
+    int32_t open_hour;
+    int32_t close_hour;
+} ArcShop;
+
+typedef struct arc_obj_t {
+    int32_t vnum;
+    uint32_t name;
+    uint32_t short_descr;
+    uint32_t description;
+    uint32_t material;
+    uint32_t script;
+    int32_t item_type;
+    int32_t extra_flags;
+    int32_t wear_flags;
+    int32_t value[5];
+    int32_t level;
+    int32_t weight;
+    int32_t cost;
+    int32_t condition;
+    ArcRange extra_descs;
+    ArcRange affects;
+    ArcRange salvage_mats;
+    ArcRange events;
+} ArcObj;
+
+typedef struct arc_affect_t {
+    int32_t where;
+    int32_t type;
+    int32_t level;
+    int32_t duration;
+    int32_t location;
+    int32_t modifier;
+    int32_t bitvector;
+} ArcAffect;
+
+typedef struct arc_prog_code_t {
+    int32_t vnum;
+    uint32_t code;
+} ArcProgCode;
+
+_Static_assert(sizeof(ArcHeader) % ARC_ALIGN == 0, "ArcHeader must stay 8-byte aligned");
+
+static const size_t arc_record_sizes[ARC_SEC_COUNT] = {
+    [ARC_SEC_STRINGS]       = 1,
+    [ARC_SEC_AREA]          = sizeof(ArcArea),
+    [ARC_SEC_PERIODS]       = sizeof(ArcPeriod),
+    [ARC_SEC_STORY_BEATS]   = sizeof(ArcStoryBeat),
+    [ARC_SEC_CHECKLIST]     = sizeof(ArcChecklist),
+    [ARC_SEC_GATHER]        = sizeof(ArcGather),
+    [ARC_SEC_ROOMS]         = sizeof(ArcRoom),
+    [ARC_SEC_EXITS]         = sizeof(ArcExit),
+    [ARC_SEC_EXTRA_DESCS]   = sizeof(ArcExtraDesc),
+    [ARC_SEC_EVENTS]        = sizeof(ArcEvent),
+    [ARC_SEC_RESETS]        = sizeof(ArcReset),
+    [ARC_SEC_MOBS]          = sizeof(ArcMob),
+    [ARC_SEC_MOB_PROGS]     = sizeof(ArcMobProg),
+    [ARC_SEC_SHOPS]         = sizeof(ArcShop),
+    [ARC_SEC_OBJS]          = sizeof(ArcObj),
+    [ARC_SEC_AFFECTS]       = sizeof(ArcAffect),
+    [ARC_SEC_VNUMS]         = sizeof(int32_t),
+    [ARC_SEC_PROG_CODE]     = sizeof(ArcProgCode),
+};
+
+// Where each record type keeps its string references, so the reader can check
+// all of them before it creates anything.
+#define ARC_MAX_STR_FIELDS  8
+
+typedef struct arc_str_fields_t {
+    int count;
+    size_t offsets[ARC_MAX_STR_FIELDS];
+} ArcStrFields;
+
+static const ArcStrFields arc_str_fields[ARC_SEC_COUNT] = {
+    [ARC_SEC_AREA]          = { 4, { offsetof(ArcArea, name), offsetof(ArcArea, builders),
+                                offsetof(ArcArea, credits), offsetof(ArcArea, loot_table) } },
+    [ARC_SEC_PERIODS]       = { 4, { offsetof(ArcPeriod, name), offsetof(ArcPeriod, description),
+                                offsetof(ArcPeriod, enter_message), offsetof(ArcPeriod, exit_message) } },
+    [ARC_SEC_STORY_BEATS]   = { 2, { offsetof(ArcStoryBeat, title), offsetof(ArcStoryBeat, description) } },
+    [ARC_SEC_CHECKLIST]     = { 2, { offsetof(ArcChecklist, title), offsetof(ArcChecklist, description) } },
+    [ARC_SEC_ROOMS]         = { 3, { offsetof(ArcRoom, name), offsetof(ArcRoom, description),
+                                offsetof(ArcRoom, script) } },
+    [ARC_SEC_EXITS]         = { 2, { offsetof(ArcExit, keyword), offsetof(ArcExit, description) } },
+    [ARC_SEC_EXTRA_DESCS]   = { 2, { offsetof(ArcExtraDesc, keyword), offsetof(ArcExtraDesc, description) } },
+    [ARC_SEC_EVENTS]        = { 2, { offsetof(ArcEvent, method_name), offsetof(ArcEvent, criteria_str) } },
+    [ARC_SEC_MOBS]          = { 8, { offsetof(ArcMob, name), offsetof(ArcMob, short_descr),
+                                offsetof(ArcMob, long_descr), offsetof(ArcMob, description),
+                                offsetof(ArcMob, material), offsetof(ArcMob, loot_table),
+                                offsetof(ArcMob, script), offsetof(ArcMob, spec_fun) } },
+    [ARC_SEC_MOB_PROGS]     = { 1, { offsetof(ArcMobProg, trig_phrase) } },
+    [ARC_SEC_OBJS]          = { 5, { offsetof(ArcObj, name), offsetof(ArcObj, short_descr),
+                                offsetof(ArcObj, description), offsetof(ArcObj, material),
+                                offsetof(ArcObj, script) } },
+    [ARC_SEC_PROG_CODE]     = { 1, { offsetof(ArcProgCode, code) } },
+};
+
+static inline size_t arc_align(size_t n)
+{
+    return (n + (ARC_ALIGN - 1)) & ~(size_t)(ARC_ALIGN - 1);
+}
+
+static uint64_t fnv64_update(uint64_t hash, const void* data, size_t len)
+{
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= FNV64_PRIME;
+    }
+    return hash;
+}
+
+uint64_t area_binary_hash_bytes(const void* data, size_t len, uint64_t seed)
+{
+    return fnv64_update(seed ? seed : FNV64_BASIS, data, len);
+}
+
+static uint64_t fnv64_str(uint64_t hash, const char* str)
+{
+    // Include the terminator so adjacent strings can't run together.
+    return str ? fnv64_update(hash, str, strlen(str) + 1) : fnv64_update(hash, "", 1);
+}
+
+// The build ID folds together everything a stored value depends on that the
+// source hash doesn't cover: the schema version (bumped by hand when a source
+// loader starts producing different values), the layout of the records, and
+// the race and skill tables whose contents are baked into mob flags and object
+// spell values at load time. It deliberately leaves out anything tied to the
+// compile itself, so rebuilding the same sources keeps the cache warm.
+uint64_t area_binary_build_id(void)
+{
+    uint64_t hash = FNV64_BASIS;
+
+    const uint32_t layout[] = {
+        AREA_BINARY_FORMAT_VERSION, AREA_BINARY_SCHEMA_VERSION, AREA_VERSION,
+        (uint32_t)sizeof(ArcHeader), (uint32_t)sizeof(ArcMob),
+        (uint32_t)sizeof(ArcObj), (uint32_t)sizeof(ArcRoom),
+    };
+    hash = fnv64_update(hash, layout, sizeof(layout));
+
+    for (int i = 0; i < race_count; i++) {
+        const Race* race = &race_table[i];
+        hash = fnv64_str(hash, race->name);
+        const FLAGS flags[] = {
+            race->act_flags, race->aff, race->off, race->imm,
+            race->res, race->vuln, race->form, race->parts,
+        };
+        hash = fnv64_update(hash, flags, sizeof(flags));
+    }
+
+    for (int i = 0; i < skill_count; i++)
+        hash = fnv64_str(hash, skill_table[i].name);
+
+    return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Writer
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct arc_buf_t {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+} ArcBuf;
+
+// A verify load decodes an image into entities that never join the world.
+// They're indexed here instead, and saving that area back out looks them up
+// here rather than in the global tables.
+typedef struct arc_scratch_t {
+    OrderedTable rooms;
+    OrderedTable mobs;
+    OrderedTable objs;
+    MobProgCode* progs;
+} ArcScratch;
+
+typedef struct arc_writer_t {
+    ArcBuf sections[ARC_SEC_COUNT];
+    uint32_t* str_slots;        // Open-addressed offsets into the string table
+    size_t str_cap;
+    size_t str_used;
+    ArcScratch* scratch;        // Set when saving a verify load's scratch area
+    bool failed;
+} ArcWriter;
+
+static bool arc_buf_append(ArcBuf* buf, const void* data, size_t len)
+{
+    if (buf->len + len > buf->cap) {
+        size_t new_cap = buf->cap ? buf->cap : 256;
+        while (new_cap < buf->len + len)
+            new_cap *= 2;
+        uint8_t* grown = realloc(buf->data, new_cap);
+        if (!grown)
+            return false;
+        buf->data = grown;
+        buf->cap = new_cap;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return true;
+}
+
+static uint32_t arc_count(const ArcWriter* w, ArcSectionKind kind)
+{
+    return (uint32_t)(w->sections[kind].len / arc_record_sizes[kind]);
+}
+
+static void arc_push(ArcWriter* w, ArcSectionKind kind, const void* rec)
+{
+    if (!arc_buf_append(&w->sections[kind], rec, arc_record_sizes[kind]))
+        w->failed = true;
+}
+
+static uint32_t arc_str_hash(const char* str, size_t len)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool arc_strings_grow(ArcWriter* w)
+{
+    size_t new_cap = w->str_cap ? w->str_cap * 2 : 1024;
+    uint32_t* slots = malloc(new_cap * sizeof(uint32_t));
+    if (!slots)
+        return false;
+    for (size_t i = 0; i < new_cap; i++)
+        slots[i] = ARC_STR_NONE;
+
+    const char* table = (const char*)w->sections[ARC_SEC_STRINGS].data;
+    for (size_t i = 0; i < w->str_cap; i++) {
+        uint32_t off = w->str_slots[i];
+        if (off == ARC_STR_NONE)
+            continue;
+        const char* s = table + off;
+        size_t idx = arc_str_hash(s, strlen(s)) & (new_cap - 1);
+        while (slots[idx] != ARC_STR_NONE)
+            idx = (idx + 1) & (new_cap - 1);
+        slots[idx] = off;
+    }
+
+    free(w->str_slots);
+    w->str_slots = slots;
+    w->str_cap = new_cap;
+    return true;
+}
+
+// Returns the string table offset for 'str', adding it if it isn't there yet.
+// NULL maps to ARC_STR_NONE; "" always lives at offset 0.
+static uint32_t arc_string(ArcWriter* w, const char* str)
+{
+    if (str == NULL)
+        return ARC_STR_NONE;
+    if (str[0] == '\0')
+        return 0;
+
+    if ((w->str_used + 1) * 2 > w->str_cap && !arc_strings_grow(w)) {
+        w->failed = true;
+        return 0;
+    }
+
+    size_t len = strlen(str);
+    size_t idx = arc_str_hash(str, len) & (w->str_cap - 1);
+    ArcBuf* table = &w->sections[ARC_SEC_STRINGS];
+    while (w->str_slots[idx] != ARC_STR_NONE) {
+        const char* existing = (const char*)table->data + w->str_slots[idx];
+        if (strcmp(existing, str) == 0)
+            return w->str_slots[idx];
+        idx = (idx + 1) & (w->str_cap - 1);
+    }
+
+    if (table->len + len + 1 >= ARC_STR_NONE) {
+        w->failed = true;
+        return 0;
+    }
+
+    uint32_t off = (uint32_t)table->len;
+    if (!arc_buf_append(table, str, len + 1)) {
+        w->failed = true;
+        return 0;
+    }
+    w->str_slots[idx] = off;
+    w->str_used++;
+    return off;
+}
+
+static void arc_writer_init(ArcWriter* w)
+{
+    memset(w, 0, sizeof(*w));
+    // Offset 0 is reserved for the empty string.
+    if (!arc_buf_append(&w->sections[ARC_SEC_STRINGS], "", 1))
+        w->failed = true;
+}
+
+static void arc_writer_free(ArcWriter* w)
+{
+    for (int i = 0; i < ARC_SEC_COUNT; i++)
+        free(w->sections[i].data);
+    free(w->str_slots);
+}
+
+static const char* script_chars(const Entity* ent)
+{
+    return (ent->script && ent->script->chars[0] != '\0') ? ent->script->chars : NULL;
+}
+
+static RoomData* writer_room(const ArcWriter* w, VNUM vnum)
+{
+    Value val;
+    if (!w->scratch)
+        return global_room_get(vnum);
+    return ordered_table_get_vnum(&w->scratch->rooms, vnum, &val) ? AS_ROOM_DATA(val) : NULL;
+}
+
+static MobPrototype* writer_mob(const ArcWriter* w, VNUM vnum)
+{
+    Value val;
+    if (!w->scratch)
+        return global_mob_proto_get(vnum);
+    return ordered_table_get_vnum(&w->scratch->mobs, vnum, &val) ? AS_MOB_PROTO(val) : NULL;
+}
+
+static ObjPrototype* writer_obj(const ArcWriter* w, VNUM vnum)
+{
+    Value val;
+    if (!w->scratch)
+        return global_obj_proto_get(vnum);
+    return ordered_table_get_vnum(&w->scratch->objs, vnum, &val) ? AS_OBJ_PROTO(val) : NULL;
+}
+
+static ArcRange write_events(ArcWriter* w, const Entity* ent)
+{
+    ArcRange range = { arc_count(w, ARC_SEC_EVENTS), 0 };
+
+    // add_event() pushes to the front of the list, so store back-to-front and
+    // replaying the records in order recreates the original list.
+    for (Node* node = ent->events.back; node != NULL; node = node->prev) {
+        Event* ev = AS_EVENT(node->value);
+        if (!ev)
+            continue;
+        ArcEvent rec = {
+            .trigger = ev->trigger,
+            .method_name = arc_string(w, ev->method_name ? ev->method_name->chars : NULL),
+            .criteria_kind = ARC_CRIT_NONE,
+            .criteria_str = ARC_STR_NONE,
+        };
+        if (IS_INT(ev->criteria)) {
+            rec.criteria_kind = ARC_CRIT_INT;
+            rec.criteria_int = AS_INT(ev->criteria);
+        }
+        else if (IS_STRING(ev->criteria)) {
+            rec.criteria_kind = ARC_CRIT_STRING;
+            rec.criteria_str = arc_string(w, AS_STRING(ev->criteria)->chars);
+        }
+        arc_push(w, ARC_SEC_EVENTS, &rec);
+        range.count++;
+    }
+
+    return range;
+}
+
+static ArcRange write_periods(ArcWriter* w, const DayCyclePeriod* head)
+{
+    ArcRange range = { arc_count(w, ARC_SEC_PERIODS), 0 };
+    for (const DayCyclePeriod* p = head; p != NULL; p = p->next) {
+        ArcPeriod rec = {
+            .name = arc_string(w, p->name),
+            .description = arc_string(w, p->description),
+            .enter_message = arc_string(w, p->enter_message),
+            .exit_message = arc_string(w, p->exit_message),
+            .start_hour = p->start_hour,
+            .end_hour = p->end_hour,
+        };
+        arc_push(w, ARC_SEC_PERIODS, &rec);
+        range.count++;
+    }
+    return range;
+}
+
+static ArcRange write_extra_descs(ArcWriter* w, const ExtraDesc* head)
+{
+    ArcRange range = { arc_count(w, ARC_SEC_EXTRA_DESCS), 0 };
+    for (const ExtraDesc* ed = head; ed != NULL; ed = ed->next) {
+        ArcExtraDesc rec = {
+            .keyword = arc_string(w, ed->keyword),
+            .description = arc_string(w, ed->description),
+        };
+        arc_push(w, ARC_SEC_EXTRA_DESCS, &rec);
+        range.count++;
+    }
+    return range;
+}
+
+static ArcRange write_vnums(ArcWriter* w, const VNUM* vnums, int count)
+{
+    ArcRange range = { arc_count(w, ARC_SEC_VNUMS), 0 };
+    for (int i = 0; vnums && i < count; i++) {
+        int32_t v = vnums[i];
+        arc_push(w, ARC_SEC_VNUMS, &v);
+        range.count++;
+    }
+    return range;
+}
+
+static void write_area(ArcWriter* w, const AreaData* area)
+{
+    ArcArea rec = {
+        .name = arc_string(w, area->header.name ? NAME_STR(area) : NULL),
+        .builders = arc_string(w, area->builders),
+        .credits = arc_string(w, area->credits),
+        .loot_table = arc_string(w, area->loot_table),
+        .security = area->security,
+        .low_range = area->low_range,
+        .high_range = area->high_range,
+        .min_vnum = area->min_vnum,
+        .max_vnum = area->max_vnum,
+        .sector = area->sector,
+        .area_flags = area->area_flags,
+        .reset_thresh = area->reset_thresh,
+        .always_reset = area->always_reset,
+        .inst_type = area->inst_type,
+        .suppress_daycycle = area->suppress_daycycle_messages,
+    };
+
+    rec.periods = write_periods(w, area->periods);
+
+    rec.story_beats.first = arc_count(w, ARC_SEC_STORY_BEATS);
+    for (const StoryBeat* sb = area->story_beats; sb != NULL; sb = sb->next) {
+        ArcStoryBeat beat = {
+            .title = arc_string(w, sb->title),
+            .description = arc_string(w, sb->description),
+        };
+        arc_push(w, ARC_SEC_STORY_BEATS, &beat);
+        rec.story_beats.count++;
+    }
+
+    rec.checklist.first = arc_count(w, ARC_SEC_CHECKLIST);
+    for (const ChecklistItem* it = area->checklist; it != NULL; it = it->next) {
+        ArcChecklist item = {
+            .title = arc_string(w, it->title),
+            .description = arc_string(w, it->description),
+            .status = it->status,
+        };
+        arc_push(w, ARC_SEC_CHECKLIST, &item);
+        rec.checklist.count++;
+    }
+
+    rec.gather_spawns.first = arc_count(w, ARC_SEC_GATHER);
+    for (size_t i = 0; i < area->gather_spawns.count; i++) {
+        const GatherSpawn* gs = &area->gather_spawns.spawns[i];
+        ArcGather spawn = {
+            .sector = gs->spawn_sector,
+            .vnum = gs->vnum,
+            .quantity = gs->quantity,
+            .respawn_timer = gs->respawn_timer,
+        };
+        arc_push(w, ARC_SEC_GATHER, &spawn);
+        rec.gather_spawns.count++;
+    }
+
+    arc_push(w, ARC_SEC_AREA, &rec);
+}
+
+static int write_rooms(ArcWriter* w, const AreaData* area)
+{
+    int written = 0;
+    for (VNUM vnum = area->min_vnum; vnum <= area->max_vnum; vnum++) {
+        RoomData* room = writer_room(w, vnum);
+        if (!room || room->area_data != area)
+            continue;
+
+        ArcRoom rec = {
+            .vnum = vnum,
+            .name = arc_string(w, room->header.name ? NAME_STR(room) : NULL),
+            .description = arc_string(w, room->description),
+            .script = arc_string(w, script_chars(&room->header)),
+            .room_flags = room->room_flags,
+            .sector_type = room->sector_type,
+            .suppress_daycycle = room->suppress_daycycle_messages,
+        };
+
+        rec.exits.first = arc_count(w, ARC_SEC_EXITS);
+        for (int dir = 0; dir < DIR_MAX; dir++) {
+            RoomExitData* ex = room->exit_data[dir];
+            if (!ex)
+                continue;
+            ArcExit exit = {
+                .dir = dir,
+                .to_vnum = ex->to_vnum,
+                .key = ex->key,
+                .exit_reset_flags = ex->exit_reset_flags,
+                .keyword = arc_string(w, ex->keyword),
+                .description = arc_string(w, ex->description),
+            };
+            arc_push(w, ARC_SEC_EXITS, &exit);
+            rec.exits.count++;
+        }
+
+        rec.extra_descs = write_extra_descs(w, room->extra_desc);
+        rec.periods = write_periods(w, room->periods);
+        rec.events = write_events(w, &room->header);
+
+        rec.resets.first = arc_count(w, ARC_SEC_RESETS);
+        for (Reset* reset = room->reset_first; reset != NULL; reset = reset->next) {
+            ArcReset r = {
+                .command = reset->command,
+                .arg1 = reset->arg1,
+                .arg2 = reset->arg2,
+                .arg3 = reset->arg3,
+                .arg4 = reset->arg4,
+            };
+            arc_push(w, ARC_SEC_RESETS, &r);
+            rec.resets.count++;
+        }
+
+        arc_push(w, ARC_SEC_ROOMS, &rec);
+        written++;
+    }
+    return written;
+}
+
+static int write_mobs(ArcWriter* w, const AreaData* area)
+{
+    int written = 0;
+    for (VNUM vnum = area->min_vnum; vnum <= area->max_vnum; vnum++) {
+        MobPrototype* mob = writer_mob(w, vnum);
+        if (!mob || mob->area != area)
+            continue;
+
+        ArcMob rec = {
+            .vnum = vnum,
+            .name = arc_string(w, mob->header.name ? NAME_STR(mob) : NULL),
+            .short_descr = arc_string(w, mob->short_descr),
+            .long_descr = arc_string(w, mob->long_descr),
+            .description = arc_string(w, mob->description),
+            .material = arc_string(w, mob->material),
+            .loot_table = arc_string(w, mob->loot_table),
+            .script = arc_string(w, script_chars(&mob->header)),
+            .spec_fun = arc_string(w, mob->spec_fun ? spec_name(mob->spec_fun) : NULL),
+            .act_flags = mob->act_flags,
+            .affect_flags = mob->affect_flags,
+            .atk_flags = mob->atk_flags,
+            .imm_flags = mob->imm_flags,
+            .res_flags = mob->res_flags,
+            .vuln_flags = mob->vuln_flags,
+            .form = mob->form,
+            .parts = mob->parts,
+            .mprog_flags = mob->mprog_flags,
+            .wealth = mob->wealth,
+            .faction_vnum = mob->faction_vnum,
+            .group = mob->group,
+            .alignment = mob->alignment,
+            .level = mob->level,
+            .hitroll = mob->hitroll,
+            .dam_type = mob->dam_type,
+            .start_pos = mob->start_pos,
+            .default_pos = mob->default_pos,
+            .sex = mob->sex,
+            .race = mob->race,
+            .size = mob->size,
+            .shop = ARC_NO_SHOP,
+        };
+        for (int i = 0; i < 3; i++) {
+            rec.hit[i] = mob->hit[i];
+            rec.mana[i] = mob->mana[i];
+            rec.damage[i] = mob->damage[i];
+        }
+        for (int i = 0; i < AC_COUNT; i++)
+            rec.ac[i] = mob->ac[i];
+
+        if (mob->pShop) {
+            const ShopData* shop = mob->pShop;
+            ArcShop s = {
+                .keeper = shop->keeper,
+                .profit_buy = shop->profit_buy,
+                .profit_sell = shop->profit_sell,
+                .open_hour = shop->open_hour,
+                .close_hour = shop->close_hour,
+            };
+            for (int i = 0; i < MAX_TRADE; i++)
+                s.buy_type[i] = shop->buy_type[i];
+            rec.shop = (int32_t)arc_count(w, ARC_SEC_SHOPS);
+            arc_push(w, ARC_SEC_SHOPS, &s);
+        }
+
+        rec.mprogs.first = arc_count(w, ARC_SEC_MOB_PROGS);
+        for (MobProg* mp = mob->mprogs; mp != NULL; mp = mp->next) {
+            ArcMobProg prog = {
+                .trig_type = mp->trig_type,
+                .vnum = mp->vnum,
+                .trig_phrase = arc_string(w, mp->trig_phrase),
+            };
+            arc_push(w, ARC_SEC_MOB_PROGS, &prog);
+            rec.mprogs.count++;
+        }
+
+        rec.craft_mats = write_vnums(w, mob->craft_mats, mob->craft_mat_count);
+        rec.events = write_events(w, &mob->header);
+
+        arc_push(w, ARC_SEC_MOBS, &rec);
+        written++;
+    }
+    return written;
+}
+
+static int write_objs(ArcWriter* w, const AreaData* area)
+{
+    int written = 0;
+    for (VNUM vnum = area->min_vnum; vnum <= area->max_vnum; vnum++) {
+        ObjPrototype* obj = writer_obj(w, vnum);
+        if (!obj || obj->area != area)
+            continue;
+
+        ArcObj rec = {
+            .vnum = vnum,
+            .name = arc_string(w, obj->header.name ? NAME_STR(obj) : NULL),
+            .short_descr = arc_string(w, obj->short_descr),
+            .description = arc_string(w, obj->description),
+            .material = arc_string(w, obj->material),
+            .script = arc_string(w, script_chars(&obj->header)),
+            .item_type = obj->item_type,
+            .extra_flags = obj->extra_flags,
+            .wear_flags = obj->wear_flags,
+            .level = obj->level,
+            .weight = obj->weight,
+            .cost = obj->cost,
+            .condition = obj->condition,
+        };
+        for (int i = 0; i < 5; i++)
+            rec.value[i] = obj->value[i];
+
+        rec.extra_descs = write_extra_descs(w, obj->extra_desc);
+
+        rec.affects.first = arc_count(w, ARC_SEC_AFFECTS);
+        for (const Affect* af = obj->affected; af != NULL; af = af->next) {
+            ArcAffect a = {
+                .where = af->where,
+                .type = af->type,
+                .level = af->level,
+                .duration = af->duration,
+                .location = af->location,
+                .modifier = af->modifier,
+                .bitvector = af->bitvector,
+            };
+            arc_push(w, ARC_SEC_AFFECTS, &a);
+            rec.affects.count++;
+        }
+
+        rec.salvage_mats = write_vnums(w, obj->salvage_mats, obj->salvage_mat_count);
+        rec.events = write_events(w, &obj->header);
+
+        arc_push(w, ARC_SEC_OBJS, &rec);
+        written++;
+    }
+    return written;
+}
+
+static void write_prog_code(ArcWriter* w, const AreaData* area)
+{
+    // Keep mprog_list order; the loader re-links these at the list head in
+    // reverse so the area's block comes back in the same order.
+    MobProgCode* head = w->scratch ? w->scratch->progs : mprog_list;
+    for (MobProgCode* prog = head; prog != NULL; prog = prog->next) {
+        if (prog->vnum < area->min_vnum || prog->vnum > area->max_vnum)
+            continue;
+        ArcProgCode rec = {
+            .vnum = prog->vnum,
+            .code = arc_string(w, prog->code),
+        };
+        arc_push(w, ARC_SEC_PROG_CODE, &rec);
+    }
+}
+
+static bool loot_owned_by_area(const Entity* owner, const AreaData* area)
+{
+    if (owner == NULL)
+        return false;
+    if (owner == &area->header)
+        return true;
+    if (owner->obj.type == OBJ_MOB_PROTO)
+        return ((const MobPrototype*)owner)->area == area;
+    return false;
+}
+
+bool area_binary_can_save(const AreaData* area)
+{
+    if (!area)
+        return false;
+
+    if (area->helps && area->helps->first)
+        return false;
+
+    if (ordered_table_count(&area->quests) > 0)
+        return false;
+
+    for (int i = 0; i < faction_table.capacity && faction_table.entries; i++) {
+        Entry* entry = &faction_table.entries[i];
+        if (IS_NIL(entry->value) || !IS_FACTION(entry->value))
+            continue;
+        if (AS_FACTION(entry->value)->area == area)
+            return false;
+    }
+
+    if (global_loot_db) {
+        for (int i = 0; i < global_loot_db->group_count; i++)
+            if (loot_owned_by_area(global_loot_db->groups[i].owner, area))
+                return false;
+        for (int i = 0; i < global_loot_db->table_count; i++)
+            if (loot_owned_by_area(global_loot_db->tables[i].owner, area))
+                return false;
+    }
+
+    RecipeIter iter = make_recipe_iter();
+    Recipe* recipe;
+    while ((recipe = recipe_iter_next(&iter)) != NULL) {
+        if (recipe->area == area)
+            return false;
+    }
+
+    return true;
+}
+
+static int count_area_rooms(const AreaData* area)
+{
+    int count = 0;
+    RoomData* room;
+    FOR_EACH_GLOBAL_ROOM(room)
+        if (room->area_data == area)
+            count++;
+    return count;
+}
+
+static int count_area_mobs(const AreaData* area)
+{
+    int count = 0;
+    MobPrototype* mob;
+    FOR_EACH_MOB_PROTO(mob)
+        if (mob->area == area)
+            count++;
+    return count;
+}
+
+static int count_area_objs(const AreaData* area)
+{
+    int count = 0;
+    ObjPrototype* obj;
+    FOR_EACH_OBJ_PROTO(obj)
+        if (obj->area == area)
+            count++;
+    return count;
+}
+
+static bool emit(const PersistWriter* writer, const void* data, size_t len)
+{
+    if (len == 0)
+        return true;
+    if (writer->ops->write)
+        return writer->ops->write(data, len, writer->ctx) == len;
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < len; i++)
+        if (writer->ops->putc(p[i], writer->ctx) == EOF)
+            return false;
+    return true;
+}
+
+// Writes 'area' as an image. With 'scratch' set, the area is a verify load's
+// detached copy: its entities are looked up in 'scratch', and the checks
+// against the world's tables don't apply.
+static PersistResult save_image(const PersistWriter* writer, const AreaData* area,
+    ArcScratch* scratch)
+{
+    if (!scratch && !area_binary_can_save(area))
+        return (PersistResult){ PERSIST_ERR_UNSUPPORTED,
+            "binary area save: area has helps, quests, factions, loot, or recipes", -1 };
+
+    ArcWriter w;
+    arc_writer_init(&w);
+    w.scratch = scratch;
+
+    write_area(&w, area);
+    int rooms = write_rooms(&w, area);
+    int mobs = write_mobs(&w, area);
+    int objs = write_objs(&w, area);
+    write_prog_code(&w, area);
+
+    if (!scratch && (rooms != count_area_rooms(area) || mobs != count_area_mobs(area)
+        || objs != count_area_objs(area))) {
+        arc_writer_free(&w);
+        return (PersistResult){ PERSIST_ERR_UNSUPPORTED,
+            "binary area save: area owns entities outside its vnum range", -1 };
+    }
+
+    if (w.failed) {
+        arc_writer_free(&w);
+        return (PersistResult){ PERSIST_ERR_INTERNAL, "binary area save: out of memory", -1 };
+    }
+
+    ArcHeader header = { 0 };
+    memcpy(header.magic, ARC_MAGIC, sizeof(header.magic));
+    header.version = AREA_BINARY_FORMAT_VERSION;
+    header.endian = ARC_ENDIAN_MARK;
+    header.build_id = area_binary_build_id();
+    header.section_count = ARC_SEC_COUNT;
+
+    size_t offset = sizeof(ArcHeader);
+    for (int i = 0; i < ARC_SEC_COUNT; i++) {
+        offset = arc_align(offset);
+        header.sections[i].count = (uint32_t)(w.sections[i].len / arc_record_sizes[i]);
+        header.sections[i].offset = (uint32_t)offset;
+        header.sections[i].size = (uint32_t)w.sections[i].len;
+        offset += w.sections[i].len;
+    }
+    header.total_size = (uint32_t)arc_align(offset);
+
+    static const uint8_t zeros[ARC_ALIGN] = { 0 };
+    bool ok = emit(writer, &header, sizeof(header));
+    size_t pos = sizeof(header);
+    for (int i = 0; ok && i < ARC_SEC_COUNT; i++) {
+        ok = emit(writer, zeros, header.sections[i].offset - pos);
+        ok = ok && emit(writer, w.sections[i].data, w.sections[i].len);
+        pos = header.sections[i].offset + w.sections[i].len;
+    }
+    ok = ok && emit(writer, zeros, header.total_size - pos);
+
+    arc_writer_free(&w);
+
+    if (ok && writer->ops->flush)
+        ok = writer->ops->flush(writer->ctx);
+
+    if (!ok)
+        return (PersistResult){ PERSIST_ERR_IO, "binary area save: write failed", -1 };
+
+    return (PersistResult){ PERSIST_OK, NULL, -1 };
+}
+
+PersistResult area_binary_save(const AreaPersistSaveParams* params)
+{
+    if (!params || !params->writer || !params->area)
+        return (PersistResult){ PERSIST_ERR_INTERNAL, "binary area save: missing params", -1 };
+
+    return save_image(params->writer, params->area, NULL);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Reader
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct arc_reader_t {
+    const uint8_t* base;
+    const ArcHeader* header;
+    const char* strings;
+    uint32_t strings_size;
+    ArcScratch* scratch;        // Set for a verify load
+} ArcReader;
+
+static const void* arc_records(const ArcReader* r, ArcSectionKind kind)
+{
+    return r->base + r->header->sections[kind].offset;
+}
+
+// arc_reader_open() has already checked every reference against the table.
+static const char* arc_str(const ArcReader* r, uint32_t ref)
+{
+    return ref == ARC_STR_NONE ? NULL : r->strings + ref;
+}
+
+static bool strings_ok(const ArcReader* r)
+{
+    for (int i = 0; i < ARC_SEC_COUNT; i++) {
+        const ArcStrFields* fields = &arc_str_fields[i];
+        const uint8_t* rec = arc_records(r, (ArcSectionKind)i);
+        for (uint32_t j = 0; j < r->header->sections[i].count; j++, rec += arc_record_sizes[i]) {
+            for (int k = 0; k < fields->count; k++) {
+                uint32_t ref;
+                memcpy(&ref, rec + fields->offsets[k], sizeof(ref));
+                if (ref != ARC_STR_NONE && ref >= r->strings_size)
+                    return false;
+            }
+        }
+    }
+
+    // String criteria are handed straight to lox_string().
+    const ArcEvent* events = arc_records(r, ARC_SEC_EVENTS);
+    for (uint32_t i = 0; i < r->header->sections[ARC_SEC_EVENTS].count; i++)
+        if (events[i].criteria_kind == ARC_CRIT_STRING && events[i].criteria_str == ARC_STR_NONE)
+            return false;
+
+    return true;
+}
+
+static bool range_ok(const ArcReader* r, ArcRange range, ArcSectionKind kind)
+{
+    uint32_t count = r->header->sections[kind].count;
+    return range.first <= count && range.count <= count - range.first;
+}
+
+static bool arc_check_header(const uint8_t* data, size_t len)
+{
+    if (len < sizeof(ArcHeader))
+        return false;
+    const ArcHeader* h = (const ArcHeader*)data;
+    return memcmp(h->magic, ARC_MAGIC, sizeof(h->magic)) == 0
+        && h->version == AREA_BINARY_FORMAT_VERSION
+        && h->endian == ARC_ENDIAN_MARK
+        && h->section_count == ARC_SEC_COUNT
+        && h->total_size <= len;
+}
+
+static PersistResult arc_reader_open(ArcReader* r, const uint8_t* data, size_t len)
+{
+    memset(r, 0, sizeof(*r));
+
+    if (!arc_check_header(data, len))
+        return (PersistResult){ PERSIST_ERR_FORMAT, "binary area load: bad header", -1 };
+
+    const ArcHeader* h = (const ArcHeader*)data;
+    for (int i = 0; i < ARC_SEC_COUNT; i++) {
+        const ArcSection* s = &h->sections[i];
+        if (s->offset % ARC_ALIGN != 0 || s->offset < sizeof(ArcHeader)
+            || s->size > h->total_size || s->offset > h->total_size - s->size
+            || (uint64_t)s->count * arc_record_sizes[i] != s->size)
+            return (PersistResult){ PERSIST_ERR_FORMAT, "binary area load: bad section table", -1 };
+    }
+
+    r->base = data;
+    r->header = h;
+    r->strings = (const char*)arc_records(r, ARC_SEC_STRINGS);
+    r->strings_size = h->sections[ARC_SEC_STRINGS].size;
+
+    if (r->strings_size == 0 || r->strings[r->strings_size - 1] != '\0'
+        || h->sections[ARC_SEC_AREA].count != 1)
+        return (PersistResult){ PERSIST_ERR_FORMAT, "binary area load: bad string table", -1 };
+
+    // Validate every child range up front so a damaged image is rejected
+    // before any entities are created.
+    bool ok = true;
+    const ArcArea* area = arc_records(r, ARC_SEC_AREA);
+    ok = ok && range_ok(r, area->periods, ARC_SEC_PERIODS)
+        && range_ok(r, area->story_beats, ARC_SEC_STORY_BEATS)
+        && range_ok(r, area->checklist, ARC_SEC_CHECKLIST)
+        && range_ok(r, area->gather_spawns, ARC_SEC_GATHER);
+
+    const ArcRoom* rooms = arc_records(r, ARC_SEC_ROOMS);
+    for (uint32_t i = 0; ok && i < h->sections[ARC_SEC_ROOMS].count; i++) {
+        ok = range_ok(r, rooms[i].exits, ARC_SEC_EXITS)
+            && range_ok(r, rooms[i].extra_descs, ARC_SEC_EXTRA_DESCS)
+            && range_ok(r, rooms[i].periods, ARC_SEC_PERIODS)
+            && range_ok(r, rooms[i].events, ARC_SEC_EVENTS)
+            && range_ok(r, rooms[i].resets, ARC_SEC_RESETS);
+    }
+
+    const ArcMob* mobs = arc_records(r, ARC_SEC_MOBS);
+    for (uint32_t i = 0; ok && i < h->sections[ARC_SEC_MOBS].count; i++) {
+        ok = range_ok(r, mobs[i].mprogs, ARC_SEC_MOB_PROGS)
+            && range_ok(r, mobs[i].craft_mats, ARC_SEC_VNUMS)
+            && range_ok(r, mobs[i].events, ARC_SEC_EVENTS)
+            && (mobs[i].shop == ARC_NO_SHOP
+                || (mobs[i].shop >= 0 && (uint32_t)mobs[i].shop < h->sections[ARC_SEC_SHOPS].count));
+    }
+
+    const ArcObj* objs = arc_records(r, ARC_SEC_OBJS);
+    for (uint32_t i = 0; ok && i < h->sections[ARC_SEC_OBJS].count; i++) {
+        ok = range_ok(r, objs[i].extra_descs, ARC_SEC_EXTRA_DESCS)
+            && range_ok(r, objs[i].affects, ARC_SEC_AFFECTS)
+            && range_ok(r, objs[i].salvage_mats, ARC_SEC_VNUMS)
+            && range_ok(r, objs[i].events, ARC_SEC_EVENTS);
+    }
+
+    if (!ok)
+        return (PersistResult){ PERSIST_ERR_FORMAT, "binary area load: bad record range", -1 };
+
+    if (!strings_ok(r))
+        return (PersistResult){ PERSIST_ERR_FORMAT, "binary area load: bad string reference", -1 };
+
+    return (PersistResult){ PERSIST_OK, NULL, -1 };
+}
+
+static void assign_str(char** tgt, const char* str)
+{
+    free_string(*tgt);
+    *tgt = str ? boot_intern_string(str) : NULL;
+}
+
+static void ensure_entity_class(Entity* ent, const char* prefix)
+{
+    if (!ent || !ent->script || ent->klass)
+        return;
+    char class_name[MIL];
+    snprintf(class_name, sizeof(class_name), "%s_%" PRVNUM, prefix, ent->vnum);
+    ObjClass* klass = create_entity_class(ent, class_name, ent->script->chars);
+    if (klass)
+        set_entity_class(ent, klass);
+}
+
+static void read_script_and_events(const ArcReader* r, Entity* ent, uint32_t script,
+    ArcRange events, const char* prefix)
+{
+    const char* source = arc_str(r, script);
+    if (source && source[0] != '\0')
+        set_entity_script(ent, lox_string(source));
+
+    const ArcEvent* recs = arc_records(r, ARC_SEC_EVENTS);
+    for (uint32_t i = events.first; i < events.first + events.count; i++) {
+        const ArcEvent* rec = &recs[i];
+        Event* ev = new_event();
+        ev->trigger = rec->trigger;
+        const char* method = arc_str(r, rec->method_name);
+        if (method)
+            ev->method_name = lox_string(method);
+        if (rec->criteria_kind == ARC_CRIT_INT)
+            ev->criteria = INT_VAL(rec->criteria_int);
+        else if (rec->criteria_kind == ARC_CRIT_STRING)
+            ev->criteria = OBJ_VAL(lox_string(arc_str(r, rec->criteria_str)));
+        add_event(ent, ev);
+    }
+
+    // Classes aren't part of the image, so a scratch copy doesn't need one.
+    if (!r->scratch)
+        ensure_entity_class(ent, prefix);
+}
+
+static void read_period_strings(const ArcReader* r, DayCyclePeriod* period, const ArcPeriod* rec)
+{
+    assign_str(&period->name, arc_str(r, rec->name));
+    assign_str(&period->description, arc_str(r, rec->description));
+    assign_str(&period->enter_message, arc_str(r, rec->enter_message));
+    assign_str(&period->exit_message, arc_str(r, rec->exit_message));
+}
+
+static void read_extra_descs(const ArcReader* r, ArcRange range, ExtraDesc** head)
+{
+    const ArcExtraDesc* recs = arc_records(r, ARC_SEC_EXTRA_DESCS);
+    ExtraDesc* tail = *head;
+    while (tail && tail->next)
+        tail = tail->next;
+
+    for (uint32_t i = range.first; i < range.first + range.count; i++) {
+        ExtraDesc* ed = new_extra_desc();
+        ed->keyword = boot_intern_string(arc_str(r, recs[i].keyword));
+        ed->description = boot_intern_string(arc_str(r, recs[i].description));
+        ed->next = NULL;
+        if (tail)
+            tail->next = ed;
+        else
+            *head = ed;
+        tail = ed;
+    }
+}
+
+static VNUM* read_vnums(const ArcReader* r, ArcRange range, int* out_count)
+{
+    *out_count = 0;
+    if (range.count == 0)
+        return NULL;
+    VNUM* vnums = malloc(sizeof(VNUM) * range.count);
+    if (!vnums)
+        return NULL;
+    const int32_t* recs = arc_records(r, ARC_SEC_VNUMS);
+    for (uint32_t i = 0; i < range.count; i++)
+        vnums[i] = recs[range.first + i];
+    *out_count = (int)range.count;
+    return vnums;
+}
+
+static AreaData* read_area(const ArcReader* r, const AreaPersistLoadParams* params)
+{
+    const ArcArea* rec = arc_records(r, ARC_SEC_AREA);
+
+    AreaData* area = new_area_data();
+    free_string(area->file_name);
+    area->file_name = boot_intern_string(params->file_name ? params->file_name : "area." AREA_BINARY_EXT);
+
+    const char* name = arc_str(r, rec->name);
+    if (name)
+        SET_NAME(area, lox_string(name));
+    assign_str(&area->builders, arc_str(r, rec->builders));
+    assign_str(&area->credits, arc_str(r, rec->credits));
+    assign_str(&area->loot_table, arc_str(r, rec->loot_table));
+
+    area->security = rec->security;
+    area->low_range = (LEVEL)rec->low_range;
+    area->high_range = (LEVEL)rec->high_range;
+    area->min_vnum = rec->min_vnum;
+    area->max_vnum = rec->max_vnum;
+    area->sector = (Sector)rec->sector;
+    area->area_flags = rec->area_flags;
+    area->reset_thresh = (int16_t)rec->reset_thresh;
+    area->always_reset = rec->always_reset != 0;
+    area->inst_type = (InstanceType)rec->inst_type;
+    area->suppress_daycycle_messages = rec->suppress_daycycle != 0;
+
+    const ArcPeriod* periods = arc_records(r, ARC_SEC_PERIODS);
+    for (uint32_t i = rec->periods.first; i < rec->periods.first + rec->periods.count; i++) {
+        const char* pname = arc_str(r, periods[i].name);
+        DayCyclePeriod* period = area_daycycle_period_add(area, pname ? pname : "",
+            periods[i].start_hour, periods[i].end_hour);
+        if (period)
+            read_period_strings(r, period, &periods[i]);
+    }
+
+    const ArcStoryBeat* beats = arc_records(r, ARC_SEC_STORY_BEATS);
+    for (uint32_t i = rec->story_beats.first; i < rec->story_beats.first + rec->story_beats.count; i++) {
+        const char* title = arc_str(r, beats[i].title);
+        const char* desc = arc_str(r, beats[i].description);
+        add_story_beat(area, title ? title : "", desc ? desc : "");
+    }
+
+    const ArcChecklist* items = arc_records(r, ARC_SEC_CHECKLIST);
+    for (uint32_t i = rec->checklist.first; i < rec->checklist.first + rec->checklist.count; i++) {
+        const char* title = arc_str(r, items[i].title);
+        const char* desc = arc_str(r, items[i].description);
+        add_checklist_item(area, title ? title : "", desc ? desc : "", (ChecklistStatus)items[i].status);
+    }
+
+    const ArcGather* spawns = arc_records(r, ARC_SEC_GATHER);
+    for (uint32_t i = rec->gather_spawns.first; i < rec->gather_spawns.first + rec->gather_spawns.count; i++)
+        add_gather_spawn(&area->gather_spawns, (Sector)spawns[i].sector, spawns[i].vnum,
+            spawns[i].quantity, spawns[i].respawn_timer);
+
+    if (r->scratch)
+        return area;
+
+    write_value_array(&global_areas, OBJ_VAL(area));
+    if (global_areas.count > 0)
+        LAST_AREA_DATA->next = area;
+    area->next = NULL;
+    current_area_data = area;
+
+    return area;
+}
+
+static void read_rooms(const ArcReader* r, AreaData* area)
+{
+    const ArcRoom* rooms = arc_records(r, ARC_SEC_ROOMS);
+    const ArcExit* exits = arc_records(r, ARC_SEC_EXITS);
+    const ArcPeriod* periods = arc_records(r, ARC_SEC_PERIODS);
+    const ArcReset* resets = arc_records(r, ARC_SEC_RESETS);
+
+    for (uint32_t i = 0; i < r->header->sections[ARC_SEC_ROOMS].count; i++) {
+        const ArcRoom* rec = &rooms[i];
+        if (r->scratch && ordered_table_contains_vnum(&r->scratch->rooms, rec->vnum))
+            continue;
+
+        RoomData* room = new_room_data();
+        room->area_data = area;
+        VNUM_FIELD(room) = rec->vnum;
+
+        const char* name = arc_str(r, rec->name);
+        if (name)
+            SET_NAME(room, lox_string(name));
+        assign_str(&room->description, arc_str(r, rec->description));
+        room->room_flags = rec->room_flags;
+        room->sector_type = (Sector)rec->sector_type;
+        room->suppress_daycycle_messages = rec->suppress_daycycle != 0;
+
+        for (uint32_t j = rec->periods.first; j < rec->periods.first + rec->periods.count; j++) {
+            const char* pname = arc_str(r, periods[j].name);
+            DayCyclePeriod* period = room_daycycle_period_add(room, pname ? pname : "",
+                periods[j].start_hour, periods[j].end_hour);
+            if (period)
+                read_period_strings(r, period, &periods[j]);
+        }
+
+        for (uint32_t j = rec->exits.first; j < rec->exits.first + rec->exits.count; j++) {
+            const ArcExit* ex = &exits[j];
+            if (ex->dir < 0 || ex->dir >= DIR_MAX)
+                continue;
+            RoomExitData* ex_data = new_room_exit_data();
+            ex_data->orig_dir = (Direction)ex->dir;
+            ex_data->to_vnum = ex->to_vnum;
+            ex_data->key = ex->key;
+            ex_data->exit_reset_flags = (SHORT_FLAGS)ex->exit_reset_flags;
+            assign_str(&ex_data->keyword, arc_str(r, ex->keyword));
+            assign_str(&ex_data->description, arc_str(r, ex->description));
+            room->exit_data[ex->dir] = ex_data;
+        }
+
+        read_extra_descs(r, rec->extra_descs, &room->extra_desc);
+
+        for (uint32_t j = rec->resets.first; j < rec->resets.first + rec->resets.count; j++) {
+            Reset* reset = new_reset();
+            reset->command = (char)resets[j].command;
+            reset->arg1 = resets[j].arg1;
+            reset->arg2 = (int16_t)resets[j].arg2;
+            reset->arg3 = resets[j].arg3;
+            reset->arg4 = (int16_t)resets[j].arg4;
+            reset->next = NULL;
+            if (room->reset_first == NULL)
+                room->reset_first = reset;
+            if (room->reset_last != NULL)
+                room->reset_last->next = reset;
+            room->reset_last = reset;
+        }
+
+        read_script_and_events(r, &room->header, rec->script, rec->events, "room");
+
+        if (r->scratch) {
+            ordered_table_set_vnum(&r->scratch->rooms, rec->vnum, OBJ_VAL(room));
+            continue;
+        }
+
+        global_room_set(room);
+        top_vnum_room = top_vnum_room < rec->vnum ? rec->vnum : top_vnum_room;
+        assign_area_vnum(rec->vnum);
+    }
+}
+
+static void read_mobs(const ArcReader* r, AreaData* area)
+{
+    const ArcMob* mobs = arc_records(r, ARC_SEC_MOBS);
+    const ArcMobProg* progs = arc_records(r, ARC_SEC_MOB_PROGS);
+    const ArcShop* shops = arc_records(r, ARC_SEC_SHOPS);
+
+    for (uint32_t i = 0; i < r->header->sections[ARC_SEC_MOBS].count; i++) {
+        const ArcMob* rec = &mobs[i];
+        if (r->scratch && ordered_table_contains_vnum(&r->scratch->mobs, rec->vnum))
+            continue;
+
+        MobPrototype* mob = new_mob_prototype();
+        mob->area = area;
+        VNUM_FIELD(mob) = rec->vnum;
+
+        const char* name = arc_str(r, rec->name);
+        if (name)
+            SET_NAME(mob, lox_string(name));
+        assign_str(&mob->short_descr, arc_str(r, rec->short_descr));
+        assign_str(&mob->long_descr, arc_str(r, rec->long_descr));
+        assign_str(&mob->description, arc_str(r, rec->description));
+        assign_str(&mob->material, arc_str(r, rec->material));
+        assign_str(&mob->loot_table, arc_str(r, rec->loot_table));
+
+        const char* spec = arc_str(r, rec->spec_fun);
+        if (spec)
+            mob->spec_fun = spec_lookup(spec);
+
+        mob->act_flags = rec->act_flags;
+        mob->affect_flags = rec->affect_flags;
+        mob->atk_flags = rec->atk_flags;
+        mob->imm_flags = rec->imm_flags;
+        mob->res_flags = rec->res_flags;
+        mob->vuln_flags = rec->vuln_flags;
+        mob->form = rec->form;
+        mob->parts = rec->parts;
+        mob->mprog_flags = rec->mprog_flags;
+        mob->wealth = rec->wealth;
+        for (int j = 0; j < 3; j++) {
+            mob->hit[j] = (int16_t)rec->hit[j];
+            mob->mana[j] = (int16_t)rec->mana[j];
+            mob->damage[j] = (int16_t)rec->damage[j];
+        }
+        for (int j = 0; j < AC_COUNT; j++)
+            mob->ac[j] = (int16_t)rec->ac[j];
+        mob->faction_vnum = rec->faction_vnum;
+        mob->group = rec->group;
+        mob->alignment = (int16_t)rec->alignment;
+        mob->level = (int16_t)rec->level;
+        mob->hitroll = (int16_t)rec->hitroll;
+        mob->dam_type = (int16_t)rec->dam_type;
+        mob->start_pos = (Position)rec->start_pos;
+        mob->default_pos = (Position)rec->default_pos;
+        mob->sex = (Sex)rec->sex;
+        mob->race = (int16_t)rec->race;
+        mob->size = (MobSize)rec->size;
+
+        MobProg* tail = NULL;
+        for (uint32_t j = rec->mprogs.first; j < rec->mprogs.first + rec->mprogs.count; j++) {
+            MobProg* mp = new_mob_prog();
+            mp->trig_type = (EventTrigger)progs[j].trig_type;
+            mp->vnum = progs[j].vnum;
+            mp->trig_phrase = boot_intern_string(arc_str(r, progs[j].trig_phrase));
+            mp->next = NULL;
+            if (tail)
+                tail->next = mp;
+            else
+                mob->mprogs = mp;
+            tail = mp;
+        }
+
+        if (rec->shop != ARC_NO_SHOP) {
+            const ArcShop* s = &shops[rec->shop];
+            ShopData* shop = new_shop_data();
+            shop->keeper = s->keeper;
+            for (int j = 0; j < MAX_TRADE; j++)
+                shop->buy_type[j] = (ItemType)s->buy_type[j];
+            shop->profit_buy = (int16_t)s->profit_buy;
+            shop->profit_sell = (int16_t)s->profit_sell;
+            shop->open_hour = (int16_t)s->open_hour;
+            shop->close_hour = (int16_t)s->close_hour;
+            mob->pShop = shop;
+            shop->next = NULL;
+            if (!r->scratch) {
+                if (shop_first == NULL)
+                    shop_first = shop;
+                if (shop_last != NULL)
+                    shop_last->next = shop;
+                shop_last = shop;
+            }
+        }
+
+        mob->craft_mats = read_vnums(r, rec->craft_mats, &mob->craft_mat_count);
+
+        read_script_and_events(r, &mob->header, rec->script, rec->events, "mob");
+
+        if (r->scratch) {
+            ordered_table_set_vnum(&r->scratch->mobs, rec->vnum, OBJ_VAL(mob));
+            continue;
+        }
+
+        global_mob_proto_set(mob);
+        top_vnum_mob = top_vnum_mob < rec->vnum ? rec->vnum : top_vnum_mob;
+        assign_area_vnum(rec->vnum);
+        kill_table[URANGE(0, mob->level, MAX_LEVEL - 1)].number++;
+    }
+}
+
+static void read_objs(const ArcReader* r, AreaData* area)
+{
+    const ArcObj* objs = arc_records(r, ARC_SEC_OBJS);
+    const ArcAffect* affects = arc_records(r, ARC_SEC_AFFECTS);
+
+    for (uint32_t i = 0; i < r->header->sections[ARC_SEC_OBJS].count; i++) {
+        const ArcObj* rec = &objs[i];
+        if (r->scratch && ordered_table_contains_vnum(&r->scratch->objs, rec->vnum))
+            continue;
+
+        ObjPrototype* obj = new_object_prototype();
+        obj->area = area;
+        VNUM_FIELD(obj) = rec->vnum;
+
+        const char* name = arc_str(r, rec->name);
+        if (name)
+            SET_NAME(obj, lox_string(name));
+        assign_str(&obj->short_descr, arc_str(r, rec->short_descr));
+        assign_str(&obj->description, arc_str(r, rec->description));
+        assign_str(&obj->material, arc_str(r, rec->material));
+
+        obj->item_type = (ItemType)rec->item_type;
+        obj->extra_flags = rec->extra_flags;
+        obj->wear_flags = rec->wear_flags;
+        for (int j = 0; j < 5; j++)
+            obj->value[j] = rec->value[j];
+        obj->level = (LEVEL)rec->level;
+        obj->weight = (int16_t)rec->weight;
+        obj->cost = rec->cost;
+        obj->condition = (int16_t)rec->condition;
+
+        read_extra_descs(r, rec->extra_descs, &obj->extra_desc);
+
+        Affect* tail = NULL;
+        for (uint32_t j = rec->affects.first; j < rec->affects.first + rec->affects.count; j++) {
+            Affect* af = new_affect();
+            af->where = (Where)affects[j].where;
+            af->type = (SKNUM)affects[j].type;
+            af->level = (LEVEL)affects[j].level;
+            af->duration = (int16_t)affects[j].duration;
+            af->location = (AffectLocation)affects[j].location;
+            af->modifier = (int16_t)affects[j].modifier;
+            af->bitvector = affects[j].bitvector;
+            af->next = NULL;
+            if (tail)
+                tail->next = af;
+            else
+                obj->affected = af;
+            tail = af;
+        }
+
+        obj->salvage_mats = read_vnums(r, rec->salvage_mats, &obj->salvage_mat_count);
+
+        read_script_and_events(r, &obj->header, rec->script, rec->events, "obj");
+
+        if (r->scratch) {
+            ordered_table_set_vnum(&r->scratch->objs, rec->vnum, OBJ_VAL(obj));
+            continue;
+        }
+
+        global_obj_proto_set(obj);
+        top_vnum_obj = top_vnum_obj < rec->vnum ? rec->vnum : top_vnum_obj;
+        assign_area_vnum(rec->vnum);
+    }
+}
+
+static void read_prog_code(const ArcReader* r)
+{
+    const ArcProgCode* recs = arc_records(r, ARC_SEC_PROG_CODE);
+    MobProgCode** head = r->scratch ? &r->scratch->progs : &mprog_list;
+    for (uint32_t i = r->header->sections[ARC_SEC_PROG_CODE].count; i-- > 0; ) {
+        MobProgCode* prog = new_mob_prog_code();
+        prog->vnum = recs[i].vnum;
+        prog->code = boot_intern_string(arc_str(r, recs[i].code));
+        prog->next = *head;
+        *head = prog;
+    }
+}
+
+// Gets a contiguous, 8-byte aligned view of the reader's remaining bytes.
+// Buffer readers (including mmap'd cache files) are used in place.
+static bool reader_bytes(const PersistReader* reader, const uint8_t** out,
+    size_t* out_len, uint8_t** owned)
+{
+    *owned = NULL;
+
+    if (reader->ops == &PERSIST_BUFFER_STREAM_OPS) {
+        PersistBufferReaderCtx* ctx = (PersistBufferReaderCtx*)reader->ctx;
+        const uint8_t* data = ctx->data + ctx->pos;
+        size_t len = ctx->len > ctx->pos ? ctx->len - ctx->pos : 0;
+        ctx->pos = ctx->len;
+        if (((uintptr_t)data % ARC_ALIGN) == 0) {
+            *out = data;
+            *out_len = len;
+            return true;
+        }
+        if ((*owned = malloc(len ? len : 1)) == NULL)
+            return false;
+        memcpy(*owned, data, len);
+        *out = *owned;
+        *out_len = len;
+        return true;
+    }
+
+    size_t cap = 64 * 1024;
+    size_t len = 0;
+    uint8_t* buf = malloc(cap);
+    if (!buf)
+        return false;
+
+    if (reader->ops == &PERSIST_FILE_STREAM_OPS) {
+        size_t n;
+        while ((n = fread(buf + len, 1, cap - len, (FILE*)reader->ctx)) > 0) {
+            len += n;
+            if (len == cap) {
+                uint8_t* grown = realloc(buf, cap * 2);
+                if (!grown) {
+                    free(buf);
+                    return false;
+                }
+                buf = grown;
+                cap *= 2;
+            }
+        }
+    }
+    else {
+        int c;
+        while ((c = reader->ops->getc(reader->ctx)) != EOF) {
+            if (len == cap) {
+                uint8_t* grown = realloc(buf, cap * 2);
+                if (!grown) {
+                    free(buf);
+                    return false;
+                }
+                buf = grown;
+                cap *= 2;
+            }
+            buf[len++] = (uint8_t)c;
+        }
+    }
+
+    *owned = buf;
+    *out = buf;
+    *out_len = len;
+    return true;
+}
+
+static void free_scratch(ArcScratch* scratch, AreaData* area)
+{
+    VNUM vnum;
+    Value value;
+
+    OrderedTableIter iter = ordered_table_iter(&scratch->rooms);
+    while (ordered_table_iter_next(&iter, &vnum, &value))
+        free_room_data(AS_ROOM_DATA(value));
+
+    // free_mob_prototype() only frees the head of the prog list.
+    iter = ordered_table_iter(&scratch->mobs);
+    while (ordered_table_iter_next(&iter, &vnum, &value)) {
+        MobPrototype* mob = AS_MOB_PROTO(value);
+        MobProg* mp;
+        while ((mp = mob->mprogs) != NULL) {
+            NEXT_LINK(mob->mprogs);
+            free_mob_prog(mp);
+        }
+        free_mob_prototype(mob);
+    }
+
+    iter = ordered_table_iter(&scratch->objs);
+    while (ordered_table_iter_next(&iter, &vnum, &value))
+        free_object_prototype(AS_OBJ_PROTO(value));
+
+    MobProgCode* prog;
+    while ((prog = scratch->progs) != NULL) {
+        NEXT_LINK(scratch->progs);
+        free_mob_prog_code(prog);
+    }
+
+    ordered_table_free(&scratch->rooms);
+    ordered_table_free(&scratch->mobs);
+    ordered_table_free(&scratch->objs);
+    free_area_data(area);
+}
+
+// Decodes the image into a detached copy of its area, saves that copy to
+// 'params->verify_writer', and frees it. Comparing the result against an
+// image built from the source checks the reader as well as the writer.
+static PersistResult load_scratch(ArcReader* r, const AreaPersistLoadParams* params)
+{
+    ArcScratch scratch = { 0 };
+    ordered_table_init(&scratch.rooms);
+    ordered_table_init(&scratch.mobs);
+    ordered_table_init(&scratch.objs);
+    r->scratch = &scratch;
+
+    // Nothing in the scratch area is reachable from a GC root, so hold off
+    // collection the way a boot load does.
+    bool prev_fBootDb = fBootDb;
+    fBootDb = true;
+
+    AreaData* area = read_area(r, params);
+    read_rooms(r, area);
+    read_mobs(r, area);
+    read_objs(r, area);
+    read_prog_code(r);
+
+    PersistResult result = save_image(params->verify_writer, area, &scratch);
+
+    free_scratch(&scratch, area);
+    fBootDb = prev_fBootDb;
+    r->scratch = NULL;
+    return result;
+}
+
+PersistResult area_binary_load(const AreaPersistLoadParams* params)
+{
+    if (!params || !params->reader)
+        return (PersistResult){ PERSIST_ERR_INTERNAL, "binary area load: missing reader", -1 };
+
+    const uint8_t* data;
+    size_t len;
+    uint8_t* owned;
+    if (!reader_bytes(params->reader, &data, &len, &owned))
+        return (PersistResult){ PERSIST_ERR_IO, "binary area load: failed to read", -1 };
+
+    ArcReader r;
+    PersistResult result = arc_reader_open(&r, data, len);
+    if (persist_succeeded(result) && r.header->build_id != area_binary_build_id())
+        result = (PersistResult){ PERSIST_ERR_UNSUPPORTED,
+            "binary area load: image was written by a different build", -1 };
+
+    if (persist_succeeded(result) && params->verify_writer) {
+        result = load_scratch(&r, params);
+    }
+    else if (persist_succeeded(result)) {
+        AreaData* area = read_area(&r, params);
+        read_rooms(&r, area);
+        read_mobs(&r, area);
+        read_objs(&r, area);
+        read_prog_code(&r);
+
+        if (params->create_single_instance && area->inst_type == AREA_INST_SINGLE)
+            create_area_instance(area, false);
+    }
+
+    free(owned);
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Keys and verification
+////////////////////////////////////////////////////////////////////////////////
+
+bool area_binary_read_key(const void* data, size_t len, AreaBinaryKey* out)
+{
+    if (!data || !arc_check_header(data, len))
+        return false;
+    const ArcHeader* h = (const ArcHeader*)data;
+    out->source_hash = h->source_hash;
+    out->build_id = h->build_id;
+    return true;
+}
+
+bool area_binary_stamp_key(void* data, size_t len, const AreaBinaryKey* key)
+{
+    if (!data || !arc_check_header(data, len))
+        return false;
+    ArcHeader* h = (ArcHeader*)data;
+    h->source_hash = key->source_hash;
+    h->build_id = key->build_id;
+    return true;
+}
+
+int area_binary_diff(const void* lhs, size_t lhs_len, const void* rhs,
+    size_t rhs_len, const char** first_diff)
+{
+    if (first_diff)
+        *first_diff = NULL;
+
+    if (!lhs || !rhs || !arc_check_header(lhs, lhs_len) || !arc_check_header(rhs, rhs_len)) {
+        if (first_diff)
+            *first_diff = "header";
+        return 1;
+    }
+
+    const ArcHeader* a = (const ArcHeader*)lhs;
+    const ArcHeader* b = (const ArcHeader*)rhs;
+    int diffs = 0;
+    for (int i = 0; i < ARC_SEC_COUNT; i++) {
+        const ArcSection* sa = &a->sections[i];
+        const ArcSection* sb = &b->sections[i];
+        bool same = sa->size == sb->size
+            && sa->offset <= lhs_len && sa->size <= lhs_len - sa->offset
+            && sb->offset <= rhs_len && sb->size <= rhs_len - sb->offset
+            && memcmp((const uint8_t*)lhs + sa->offset,
+                (const uint8_t*)rhs + sb->offset, sa->size) == 0;
+        if (!same) {
+            if (first_diff && *first_diff == NULL)
+                *first_diff = arc_section_names[i];
+            diffs++;
+        }
+    }
+    return diffs;
+}
@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////
+// persist/area/binary/area_persist_binary.h
+// Fixed-layout binary area images used by the boot-time area cache.
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__PERSIST__AREA__BINARY__AREA_PERSIST_BINARY_H
+#define MUD98__PERSIST__AREA__BINARY__AREA_PERSIST_BINARY_H
+
+#include <persist/area/area_persist.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AREA_BINARY_EXT             "arc"
+#define AREA_BINARY_FORMAT_VERSION  1
+
+// Bump when a text or JSON area loader changes the values it produces for the
+// same source (new defaults, different flag conversion, and so on). Images
+// written under an older schema are then treated as stale. Record layout
+// changes are covered by AREA_BINARY_FORMAT_VERSION instead.
+#define AREA_BINARY_SCHEMA_VERSION  1
+
+// The key an image was written under. The source hash identifies the text or
+// JSON file the image was built from; the build ID identifies the format and
+// schema versions and the runtime tables (races, skills) baked into stored
+// values.
+typedef struct area_binary_key_t {
+    uint64_t source_hash;
+    uint64_t build_id;
+} AreaBinaryKey;
+
+PersistResult area_binary_load(const AreaPersistLoadParams* params);
+PersistResult area_binary_save(const AreaPersistSaveParams* params);
+
+// Returns true if 'area' only uses content the binary format can represent.
+// Helps, quests, factions, loot, and recipes are left to the source format.
+bool area_binary_can_save(const AreaData* area);
+
+// FNV-1a over 'len' bytes, continuing from 'seed' (pass 0 to start fresh).
+uint64_t area_binary_hash_bytes(const void* data, size_t len, uint64_t seed);
+
+uint64_t area_binary_build_id(void);
+bool area_binary_read_key(const void* data, size_t len, AreaBinaryKey* out);
+bool area_binary_stamp_key(void* data, size_t len, const AreaBinaryKey* key);
+
+// Compares two images section by section. Returns the number of sections
+// that differ; if 'first_diff' is non-NULL it receives the first differing
+// section's name (or "header" for layout mismatches).
+int area_binary_diff(const void* lhs, size_t lhs_len, const void* rhs,
+    size_t rhs_len, const char** first_diff);
+
+extern const AreaPersistFormat AREA_PERSIST_BINARY;
+
+#endif // !MUD98__PERSIST__AREA__BINARY__AREA_PERSIST_BINARY_H
@@ -125,7 +125,7 @@ static void ensure_entity_class(Entity* ent, const char* prefix)
     snprintf(class_name, sizeof(class_name), "%s_%" PRVNUM, prefix, ent->vnum);
     ObjClass* klass = create_entity_class(ent, class_name, ent->script->chars);
     if (klass)
-        ent->klass = klass;
+        set_entity_class(ent, klass);
 }
 
 static const EventTypeInfo* trigger_info_from_name(const char* name)
@@ -759,7 +759,7 @@ static PersistResult parse_rooms(json_t* root, AreaData* area)
 
         const char* script = JSON_STRING(r, "loxScript");
         if (script && script[0] != '\0')
-            ((Entity*)room)->script = lox_string(script);
+            set_entity_script((Entity*)room, lox_string(script));
         parse_events(json_object_get(r, "events"), (Entity*)room, ENT_ROOM);
         ensure_entity_class((Entity*)room, "room");
     }
@@ -1166,7 +1166,7 @@ static PersistResult parse_mobiles(json_t* root, AreaData* area)
 
         const char* script = JSON_STRING(m, "loxScript");
         if (script && script[0] != '\0')
-            ((Entity*)mob)->script = lox_string(script);
+            set_entity_script((Entity*)mob, lox_string(script));
         parse_events(json_object_get(m, "events"), (Entity*)mob, ENT_MOB);
         ensure_entity_class((Entity*)mob, "mob");
 
@@ -1897,7 +1897,7 @@ static PersistResult parse_objects(json_t* root, AreaData* area)
 
         const char* script = JSON_STRING(o, "loxScript");
         if (script && script[0] != '\0')
-            ((Entity*)obj)->script = lox_string(script);
+            set_entity_script((Entity*)obj, lox_string(script));
         parse_events(json_object_get(o, "events"), (Entity*)obj, ENT_OBJ);
         ensure_entity_class((Entity*)obj, "obj");
 
@@ -29,6 +29,7 @@
 #include <db.h>
 #include <mob_prog.h>
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -207,12 +208,20 @@ PersistResult persist_area_rom_olc_save(const AreaPersistSaveParams* params)
 
     FILE* fp = NULL;
     bool owns_file = false;
+    char* mem_buf = NULL;
+    size_t mem_len = 0;
 
     if (params->writer->ops == &PERSIST_FILE_WRITER_OPS) {
         fp = (FILE*)params->writer->ctx;
     }
     else if (params->writer->ops == &PERSIST_BUFFER_WRITER_OPS) {
+#ifndef _MSC_VER
+        // Format straight into memory so buffer saves (area save snapshots)
+        // never touch the disk.
+        fp = open_memstream(&mem_buf, &mem_len);
+#else
         fp = tmpfile();
+#endif
         if (!fp) {
             return (PersistResult){ PERSIST_ERR_IO, "rom-olc save: could not create tmpfile", -1 };
         }
@@ -276,6 +285,15 @@ PersistResult persist_area_rom_olc_save(const AreaPersistSaveParams* params)
         params->writer->ops->flush(params->writer->ctx);
 
     // If writing to buffer, copy temp file contents into the buffer writer.
+#ifndef _MSC_VER
+    if (owns_file) {
+        bool ok = fclose(fp) == 0 && mem_buf != NULL;
+        size_t written = ok ? params->writer->ops->write(mem_buf, mem_len, params->writer->ctx) : 0;
+        free(mem_buf);
+        if (!ok || written != mem_len)
+            return (PersistResult){ PERSIST_ERR_IO, "rom-olc save: buffer write failed", -1 };
+    }
+#else
     if (owns_file) {
         fflush(fp);
         fseek(fp, 0, SEEK_END);
@@ -306,6 +324,7 @@ PersistResult persist_area_rom_olc_save(const AreaPersistSaveParams* params)
         }
         fclose(fp);
     }
+#endif
 
     return (PersistResult){ PERSIST_OK, NULL, -1 };
 }
@@ -0,0 +1,221 @@
+////////////////////////////////////////////////////////////////////////////////
+// persist/lox/lox_cache.c
+// Compiled Lox script cache.
+//
+// Public scripts and entity class scripts are compiled through here. The
+// compiled script function is serialized (see lox/bytecode.h) to
+// <lox_cache_dir>/<hash>.loxc, named for a hash of the source and the compile
+// settings that affect it; the image header also records the compiler build.
+// Later boots and reloads run a matching image instead of compiling. Global
+// consts are folded into compiled code, so an image also records the ones it
+// read, and is passed over if any of them has changed since.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "lox_cache.h"
+
+#include <lox/bytecode.h>
+#include <lox/compiler.h>
+#include <lox/vm.h>
+
+#include <comm.h>
+#include <config.h>
+#include <db.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#include <windows.h>
+#endif
+
+static LoxCacheStats stats = { 0 };
+
+const LoxCacheStats* lox_cache_stats(void)
+{
+    return &stats;
+}
+
+void lox_cache_log_stats(void)
+{
+    if (!cfg_get_lox_cache())
+        return;
+
+    printf_log("Lox cache: %d hit(s), %d miss(es) (%d stale), %d written, "
+        "%d uncacheable.", stats.hits, stats.misses, stats.stale, stats.writes,
+        stats.skipped);
+
+    if (cfg_get_lox_cache_verify())
+        printf_log("Lox cache verify: %d script(s) differ from their cached "
+            "image.", stats.mismatches);
+}
+
+static bool ensure_cache_dir(const char* path)
+{
+#ifdef _MSC_VER
+    if (_mkdir(path) == 0 || errno == EEXIST)
+        return true;
+#else
+    if (mkdir(path, 0775) == 0 || errno == EEXIST)
+        return true;
+#endif
+
+    perror(path);
+    return false;
+}
+
+// Images are a few KB at most, so they're simply read into memory.
+static uint8_t* read_image(const char* path, size_t* len)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp)
+        return NULL;
+
+    uint8_t* data = NULL;
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0)
+        size = ftell(fp);
+    rewind(fp);
+
+    if (size > 0 && (data = malloc((size_t)size)) != NULL
+        && fread(data, 1, (size_t)size, fp) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+
+    fclose(fp);
+    *len = data ? (size_t)size : 0;
+    return data;
+}
+
+static bool write_image(const char* path, const BytecodeBuffer* buf)
+{
+    char tmp[MAX_INPUT_LENGTH * 2];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    FILE* fp = fopen(tmp, "wb");
+    if (!fp) {
+        perror(tmp);
+        return false;
+    }
+
+    bool ok = fwrite(buf->data, 1, buf->len, fp) == buf->len;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok) {
+        bugf("lox_cache: could not write %s", tmp);
+        remove(tmp);
+        return false;
+    }
+
+#ifdef _MSC_VER
+    if (!MoveFileExA(tmp, path, MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (rename(tmp, path) != 0) {
+#endif
+        bugf("lox_cache: could not rename %s to %s", tmp, path);
+        remove(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+static size_t first_difference(const BytecodeBuffer* buf, const uint8_t* image,
+    size_t len)
+{
+    size_t i = 0;
+    while (i < buf->len && i < len && buf->data[i] == image[i])
+        i++;
+    return i;
+}
+
+InterpretResult lox_cache_interpret(const char* source)
+{
+    if (!cfg_get_lox_cache())
+        return interpret_code(source);
+
+    uint32_t flags = 0;
+    if (compile_context.this_ != NULL)
+        flags |= BYTECODE_ENTITY_CLASS;
+    if (exec_context.is_repl)
+        flags |= BYTECODE_REPL;
+
+    BytecodeKey key = {
+        .build_id = bytecode_build_id(),
+        .source_hash = bytecode_source_hash(source, flags),
+    };
+
+    char path[MAX_INPUT_LENGTH * 2];
+    snprintf(path, sizeof(path), "%s%016" PRIx64 ".%s", cfg_get_lox_cache_dir(),
+        key.source_hash, LOX_BYTECODE_EXT);
+
+    bool verify = cfg_get_lox_cache_verify();
+    size_t len = 0;
+    uint8_t* image = read_image(path, &len);
+    BytecodeKey cached_key = { 0 };
+    bool current = image != NULL
+        && read_bytecode_key(image, len, &cached_key)
+        && cached_key.source_hash == key.source_hash
+        && cached_key.build_id == key.build_id;
+
+    if (current && !verify) {
+        bool stale = false;
+        ObjFunction* function = load_bytecode_image(image, len, &stale);
+        if (function != NULL) {
+            free(image);
+            stats.hits++;
+            return interpret_function(function);
+        }
+
+        if (!stale)
+            bugf("lox_cache: %s is unusable; compiling from source", path);
+        current = false;
+    }
+
+    stats.misses++;
+    if (image != NULL && !current)
+        stats.stale++;
+
+    CompileDeps deps;
+    init_compile_deps(&deps);
+    record_compile_deps(&deps);
+    ObjFunction* function = compile(source);
+    record_compile_deps(NULL);
+
+    if (function == NULL) {
+        free_compile_deps(&deps);
+        free(image);
+        repl_ret_val = NIL_VAL;
+        return INTERPRET_COMPILE_ERROR;
+    }
+
+    BytecodeBuffer buf = { 0 };
+    if (!write_bytecode_image(&buf, &key, function, &deps)) {
+        stats.skipped++;
+    }
+    else if (verify && current && buf.len == len
+        && memcmp(buf.data, image, len) == 0) {
+        // Identical; no need to rewrite it.
+    }
+    else {
+        if (verify && current) {
+            stats.mismatches++;
+            bugf("lox_cache: %s does not match its source compile (first "
+                "difference at byte %zu)", path, first_difference(&buf, image, len));
+        }
+
+        if (ensure_cache_dir(cfg_get_lox_cache_dir()) && write_image(path, &buf))
+            stats.writes++;
+    }
+
+    free_bytecode_buffer(&buf);
+    free_compile_deps(&deps);
+    free(image);
+
+    return interpret_function(function);
+}
@@ -0,0 +1,29 @@
+////////////////////////////////////////////////////////////////////////////////
+// persist/lox/lox_cache.h
+// Compiled Lox script cache, keyed by source hash and compiler build.
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98__PERSIST__LOX__LOX_CACHE_H
+#define MUD98__PERSIST__LOX__LOX_CACHE_H
+
+#include <lox/lox.h>
+
+typedef struct lox_cache_stats_t {
+    int hits;           // Run from a current cache image
+    int misses;         // No usable image; compiled from source
+    int stale;          // Image existed but was built for other globals/build
+    int writes;         // Images written after a compile
+    int skipped;        // Scripts whose constants the image can't represent
+    int mismatches;     // Verify mode: image differs from the fresh compile
+} LoxCacheStats;
+
+// Drop-in for interpret_code() when 'lox_cache' is enabled: runs the cached
+// bytecode for 'source' if there is a current image, and otherwise compiles
+// it and writes one.
+InterpretResult lox_cache_interpret(const char* source);
+
+const LoxCacheStats* lox_cache_stats(void);
+void lox_cache_log_stats(void);
+
+#endif // !MUD98__PERSIST__LOX__LOX_CACHE_H
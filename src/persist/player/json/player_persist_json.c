@@ -905,6 +905,7 @@ static void pet_from_json(json_t* obj, Mobile* ch)
     }
 
     affects_from_json(json_object_get(obj, "affects"), &pet->affected);
+    rebuild_affect_index(pet);
 
     pet->leader = ch;
     pet->master = ch;
@@ -1238,6 +1239,7 @@ static void player_from_json(json_t* player_obj, Mobile* ch)
     }
 
     affects_from_json(json_object_get(player_obj, "affects"), &ch->affected);
+    rebuild_affect_index(ch);
 
     json_t* pcdata = json_object_get(player_obj, "pcdata");
     pcdata_from_json(pcdata, ch);
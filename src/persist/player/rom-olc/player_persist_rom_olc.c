@@ -495,7 +495,7 @@ static void fwrite_quests(Mobile* ch, FILE* fp)
 #define KEYLS(literal, entity, field, value)                                   \
     if (!str_cmp(word, literal)) {                                             \
         (entity)->header.field = (value);                                      \
-        SET_LOX_FIELD(&((entity)->header), (entity)->header.field, field);     \
+        GC_BARRIER_OBJ((entity)->header.field);                                \
         fMatch = true;                                                         \
         break;                                                                 \
     }
@@ -601,6 +601,7 @@ static void fread_char(Mobile* ch, FILE* fp)
                 affect->bitvector = fread_number(fp);
                 affect->next = ch->affected;
                 ch->affected = affect;
+                rebuild_affect_index(ch);
                 fMatch = true;
                 break;
             }
@@ -625,6 +626,7 @@ static void fread_char(Mobile* ch, FILE* fp)
                 affect->bitvector = fread_number(fp);
                 affect->next = ch->affected;
                 ch->affected = affect;
+                rebuild_affect_index(ch);
                 fMatch = true;
                 break;
             }
@@ -1012,6 +1014,7 @@ static void fread_pet(Mobile* ch, FILE* fp)
                 affect->bitvector = fread_number(fp);
                 affect->next = pet->affected;
                 pet->affected = affect;
+                rebuild_affect_index(pet);
                 fMatch = true;
                 break;
             }
@@ -1036,6 +1039,7 @@ static void fread_pet(Mobile* ch, FILE* fp)
                 affect->bitvector = fread_number(fp);
                 affect->next = pet->affected;
                 pet->affected = affect;
+                rebuild_affect_index(pet);
                 fMatch = true;
                 break;
             }
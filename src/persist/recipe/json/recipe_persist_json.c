@@ -157,7 +157,7 @@ static void parse_single_recipe(json_t* obj, Entity* owner)
     
     const char* name = JSON_STRING(obj, "name");
     if (name && name[0] != '\0')
-        recipe->header.name = AS_STRING(OBJ_VAL(copy_string(name, (int)strlen(name))));
+        SET_NAME(recipe, copy_string(name, (int)strlen(name)));
     
     // Required skill
     const char* skill_name = JSON_STRING(obj, "skill");
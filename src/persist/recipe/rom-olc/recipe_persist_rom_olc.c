@@ -67,7 +67,7 @@ void load_recipes(FILE* fp)
             VNUM_FIELD(recipe) = fread_number(fp);
             const char* name = fread_string(fp);
             if (name && name[0] != '\0')
-                recipe->header.name = AS_STRING(OBJ_VAL(copy_string(name, (int)strlen(name))));
+                SET_NAME(recipe, copy_string(name, (int)strlen(name)));
             
             // Set owner area
             recipe->area = current_area_data;
@@ -0,0 +1,620 @@
+////////////////////////////////////////////////////////////////////////////////
+// player_index.c
+//
+// The index file is a journal of one line per player:
+//
+//     <Name> <format> <level> <trust> <class> <race> <last save> <host>
+//
+// A save appends the player's new line and a deletion appends "-<Name>"; the
+// last line for a name wins. Each line goes out in a single write, and once
+// the journal holds twice as many lines as there are players it is compacted
+// into a temp file and renamed over the old one.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "player_index.h"
+
+#include "comm.h"
+#include "config.h"
+#include "db.h"
+#include "fileutils.h"
+#include "handler.h"
+#include "save.h"
+#include "stringutils.h"
+
+#include <entities/descriptor.h>
+#include <entities/player_data.h>
+
+#include <data/class.h>
+#include <data/race.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _MSC_VER
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#define PLAYER_INDEX_HASH_MIN   256
+#define PLAYER_INDEX_LINE_MAX   (MAX_INPUT_LENGTH * 2)
+
+static PlayerIndexEntry** index_hash = NULL;
+static size_t index_hash_size = 0;
+static int index_count = 0;
+static int journal_lines = 0;
+static bool index_loaded = false;
+static char index_dir[MAX_INPUT_LENGTH];
+
+static uint32_t hash_name(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    for (; *name; name++) {
+        hash ^= (uint8_t)LOWER(*name);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void index_path(char* out, size_t len, bool temp)
+{
+    snprintf(out, len, "%s%s%s", cfg_get_player_dir(),
+        cfg_get_player_index_file(), temp ? ".tmp" : "");
+}
+
+static void free_entry(PlayerIndexEntry* entry)
+{
+    free(entry->name);
+    free(entry->host);
+    free(entry);
+}
+
+static void clear_index()
+{
+    for (size_t i = 0; i < index_hash_size; i++) {
+        PlayerIndexEntry* entry = index_hash[i];
+        while (entry != NULL) {
+            PlayerIndexEntry* next = entry->next;
+            free_entry(entry);
+            entry = next;
+        }
+        index_hash[i] = NULL;
+    }
+    index_count = 0;
+    journal_lines = 0;
+}
+
+static void grow_index()
+{
+    size_t new_size = index_hash_size ? index_hash_size * 2 : PLAYER_INDEX_HASH_MIN;
+    PlayerIndexEntry** new_hash = calloc(new_size, sizeof(PlayerIndexEntry*));
+    if (new_hash == NULL)
+        return;
+
+    for (size_t i = 0; i < index_hash_size; i++) {
+        PlayerIndexEntry* entry = index_hash[i];
+        while (entry != NULL) {
+            PlayerIndexEntry* next = entry->next;
+            size_t bucket = hash_name(entry->name) & (new_size - 1);
+            entry->next = new_hash[bucket];
+            new_hash[bucket] = entry;
+            entry = next;
+        }
+    }
+
+    free(index_hash);
+    index_hash = new_hash;
+    index_hash_size = new_size;
+}
+
+static PlayerIndexEntry** find_link(const char* name)
+{
+    if (index_hash_size == 0)
+        return NULL;
+
+    PlayerIndexEntry** link = &index_hash[hash_name(name) & (index_hash_size - 1)];
+    for (; *link != NULL; link = &(*link)->next)
+        if (!str_cmp((*link)->name, name))
+            return link;
+
+    return NULL;
+}
+
+static PlayerIndexEntry* put_entry(const char* name)
+{
+    PlayerIndexEntry** link = find_link(name);
+    if (link != NULL)
+        return *link;
+
+    if ((size_t)index_count >= index_hash_size)
+        grow_index();
+    if (index_hash_size == 0)
+        return NULL;
+
+    PlayerIndexEntry* entry = calloc(1, sizeof(PlayerIndexEntry));
+    if (entry == NULL)
+        return NULL;
+    entry->name = strdup(capitalize(name));
+    entry->host = strdup("");
+
+    size_t bucket = hash_name(name) & (index_hash_size - 1);
+    entry->next = index_hash[bucket];
+    index_hash[bucket] = entry;
+    index_count++;
+    return entry;
+}
+
+static void drop_entry(const char* name)
+{
+    PlayerIndexEntry** link = find_link(name);
+    if (link == NULL)
+        return;
+
+    PlayerIndexEntry* entry = *link;
+    *link = entry->next;
+    free_entry(entry);
+    index_count--;
+}
+
+static void set_host(PlayerIndexEntry* entry, const char* host)
+{
+    free(entry->host);
+    entry->host = strdup(host ? host : "");
+}
+
+static void format_record(const PlayerIndexEntry* entry, char* buf, size_t len)
+{
+    snprintf(buf, len, "%s %s %d %d %d %d " TIME_FMT " %s\n", entry->name,
+        player_persist_format_name(entry->format), entry->level, entry->trust,
+        entry->ch_class, entry->race, (int64_t)entry->last_save,
+        entry->host[0] ? entry->host : "-");
+}
+
+static bool parse_record(char* line)
+{
+    char name[MAX_INPUT_LENGTH];
+    char format[MAX_INPUT_LENGTH];
+    char host[MAX_INPUT_LENGTH];
+    int level, trust, ch_class, race;
+    long long last_save;
+
+    if (line[0] == '-') {
+        if (sscanf(line + 1, "%255s", name) != 1)
+            return false;
+        drop_entry(name);
+        return true;
+    }
+
+    if (sscanf(line, "%255s %255s %d %d %d %d %lld %255s", name, format, &level,
+            &trust, &ch_class, &race, &last_save, host) != 8)
+        return false;
+
+    PlayerIndexEntry* entry = put_entry(name);
+    if (entry == NULL)
+        return false;
+
+    entry->format = player_persist_format_from_string(format);
+    entry->level = (LEVEL)level;
+    entry->trust = (LEVEL)trust;
+    entry->ch_class = (int16_t)ch_class;
+    entry->race = (int16_t)race;
+    entry->last_save = (time_t)last_save;
+    set_host(entry, strcmp(host, "-") ? host : "");
+    return true;
+}
+
+static bool write_index()
+{
+    char path[MAX_INPUT_LENGTH * 2];
+    char temp_path[MAX_INPUT_LENGTH * 2];
+    index_path(path, sizeof(path), false);
+    index_path(temp_path, sizeof(temp_path), true);
+
+    FILE* fp = fopen(temp_path, "w");
+    if (fp == NULL) {
+        perror(temp_path);
+        return false;
+    }
+
+    char line[PLAYER_INDEX_LINE_MAX];
+    for (size_t i = 0; i < index_hash_size; i++) {
+        for (PlayerIndexEntry* entry = index_hash[i]; entry; entry = entry->next) {
+            format_record(entry, line, sizeof(line));
+            fputs(line, fp);
+        }
+    }
+
+    bool ok = !ferror(fp);
+    ok = (fclose(fp) == 0) && ok;
+#ifdef _MSC_VER
+    ok = ok && MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING);
+#else
+    ok = ok && rename(temp_path, path) == 0;
+#endif
+    if (!ok) {
+        bugf("write_index: could not replace %s.", path);
+        remove(temp_path);
+        return false;
+    }
+
+    journal_lines = index_count;
+    return true;
+}
+
+static void append_record(const char* line)
+{
+    char path[MAX_INPUT_LENGTH * 2];
+    index_path(path, sizeof(path), false);
+
+    FILE* fp = fopen(path, "a");
+    if (fp == NULL) {
+        perror(path);
+        return;
+    }
+    fputs(line, fp);
+    fclose(fp);
+
+    if (++journal_lines > index_count * 2 + 64)
+        write_index();
+}
+
+bool player_index_ready()
+{
+    return index_loaded && !strcmp(index_dir, cfg_get_player_dir());
+}
+
+int player_index_count()
+{
+    return index_count;
+}
+
+void player_index_update(Mobile* ch, PlayerPersistFormat format)
+{
+    if (!player_index_ready() || IS_NPC(ch))
+        return;
+
+    PlayerIndexEntry* entry = put_entry(NAME_STR(ch));
+    if (entry == NULL)
+        return;
+
+    entry->format = format;
+    entry->level = ch->level;
+    entry->trust = ch->trust;
+    entry->ch_class = ch->ch_class;
+    entry->race = ch->race;
+    entry->last_save = current_time;
+    if (ch->desc != NULL)
+        set_host(entry, ch->desc->host);
+
+    char line[PLAYER_INDEX_LINE_MAX];
+    format_record(entry, line, sizeof(line));
+    append_record(line);
+}
+
+void player_index_remove(const char* name)
+{
+    if (!player_index_ready() || find_link(name) == NULL)
+        return;
+
+    drop_entry(name);
+
+    char line[PLAYER_INDEX_LINE_MAX];
+    snprintf(line, sizeof(line), "-%s\n", capitalize(name));
+    append_record(line);
+}
+
+// Adds the player file 'file' (a bare name, as the player directory lists it)
+// to the index. Anything that isn't a player file is ignored.
+static void index_player_file(const char* file)
+{
+    char name[MAX_INPUT_LENGTH];
+    size_t len = 0;
+
+    while (file[len] != '\0' && file[len] != '.' && len < sizeof(name) - 1) {
+        if (!ISALPHA(file[len]))
+            return;
+        name[len] = file[len];
+        len++;
+    }
+    name[len] = '\0';
+    if (len < 2 || len > 12)
+        return;
+
+    const char* ext = file + len;
+    PlayerPersistFormat format;
+    bool compressed = false;
+
+    if (!str_cmp(ext, "") || (compressed = !str_cmp(ext, ".gz")))
+        format = PLAYER_PERSIST_ROM_OLC;
+    else if (!str_cmp(ext, ".json") || (compressed = !str_cmp(ext, ".json.gz")))
+        format = PLAYER_PERSIST_JSON;
+    else
+        return;
+
+    char path[MAX_INPUT_LENGTH * 2];
+    snprintf(path, sizeof(path), "%s%s", cfg_get_player_dir(), file);
+
+    PlayerIndexEntry* entry = put_entry(name);
+    if (entry == NULL)
+        return;
+
+    entry->format = format;
+    struct stat st;
+    if (stat(path, &st) == 0)
+        entry->last_save = st.st_mtime;
+
+    // Compressed files are unpacked on login; until then all we know is that
+    // the player exists.
+    if (compressed)
+        return;
+
+    Mobile* ch = load_offline_player(name, format);
+    if (ch == NULL)
+        return;
+
+    entry->level = ch->level;
+    entry->trust = ch->trust;
+    entry->ch_class = ch->ch_class;
+    entry->race = ch->race;
+    free_offline_player(ch);
+}
+
+// Looks on disk for a player the index has no record of. The journal append
+// can fail, or the server can go down between renaming a player file into
+// place and recording it; either way the file is the truth, so it goes back
+// into the index.
+static PlayerIndexEntry* recover_entry(const char* name)
+{
+    static const char* const exts[] = { "", ".gz", ".json", ".json.gz" };
+    char file[MAX_INPUT_LENGTH];
+    char path[MAX_INPUT_LENGTH * 2];
+
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+        snprintf(file, sizeof(file), "%s%s", capitalize(name), exts[i]);
+        snprintf(path, sizeof(path), "%s%s", cfg_get_player_dir(), file);
+        if (!file_exists(path))
+            continue;
+
+        index_player_file(file);
+        PlayerIndexEntry** link = find_link(name);
+        if (link == NULL)
+            return NULL;
+
+        char line[PLAYER_INDEX_LINE_MAX];
+        format_record(*link, line, sizeof(line));
+        append_record(line);
+        printf_log("Player index: re-indexed %s from its player file.", (*link)->name);
+        return *link;
+    }
+
+    return NULL;
+}
+
+const PlayerIndexEntry* player_index_lookup(const char* name)
+{
+    PlayerIndexEntry** link = find_link(name);
+    if (link != NULL)
+        return *link;
+
+    return player_index_ready() ? recover_entry(name) : NULL;
+}
+
+int rebuild_player_index()
+{
+    clear_index();
+    snprintf(index_dir, sizeof(index_dir), "%s", cfg_get_player_dir());
+    index_loaded = true;
+
+    char index_file[MAX_INPUT_LENGTH];
+    snprintf(index_file, sizeof(index_file), "%s", cfg_get_player_index_file());
+
+#ifdef _MSC_VER
+    char pattern[MAX_INPUT_LENGTH * 2];
+    snprintf(pattern, sizeof(pattern), "%s*", cfg_get_player_dir());
+    WIN32_FIND_DATAA found;
+    HANDLE find = FindFirstFileA(pattern, &found);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            if (!(found.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                && strcmp(found.cFileName, index_file))
+                index_player_file(found.cFileName);
+        } while (FindNextFileA(find, &found));
+        FindClose(find);
+    }
+#else
+    DIR* dir = opendir(cfg_get_player_dir());
+    if (dir != NULL) {
+        struct dirent* de;
+        while ((de = readdir(dir)) != NULL) {
+            if (de->d_name[0] != '.' && strcmp(de->d_name, index_file))
+                index_player_file(de->d_name);
+        }
+        closedir(dir);
+    }
+#endif
+
+    write_index();
+    return index_count;
+}
+
+void load_player_index()
+{
+    char path[MAX_INPUT_LENGTH * 2];
+    index_path(path, sizeof(path), false);
+
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL) {
+        if (errno != ENOENT)
+            perror(path);
+        int count = rebuild_player_index();
+        printf_log("Player index: rebuilt from %d player file%s.", count,
+            count == 1 ? "" : "s");
+        return;
+    }
+
+    clear_index();
+    snprintf(index_dir, sizeof(index_dir), "%s", cfg_get_player_dir());
+    index_loaded = true;
+
+    char line[PLAYER_INDEX_LINE_MAX];
+    int bad = 0;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        journal_lines++;
+        if (!parse_record(line))
+            bad++;
+    }
+    fclose(fp);
+
+    if (bad > 0)
+        bugf("load_player_index: skipped %d unreadable line%s in %s.", bad,
+            bad == 1 ? "" : "s", path);
+
+    if (journal_lines > index_count)
+        write_index();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Immortal reports
+////////////////////////////////////////////////////////////////////////////////
+
+static int collect_entries(PlayerIndexEntry*** out)
+{
+    *out = NULL;
+    if (index_count == 0)
+        return 0;
+
+    PlayerIndexEntry** entries = malloc(sizeof(PlayerIndexEntry*) * (size_t)index_count);
+    if (entries == NULL)
+        return 0;
+
+    int count = 0;
+    for (size_t i = 0; i < index_hash_size; i++)
+        for (PlayerIndexEntry* entry = index_hash[i]; entry; entry = entry->next)
+            entries[count++] = entry;
+
+    *out = entries;
+    return count;
+}
+
+static int compare_last_save(const void* a, const void* b)
+{
+    const PlayerIndexEntry* ea = *(const PlayerIndexEntry**)a;
+    const PlayerIndexEntry* eb = *(const PlayerIndexEntry**)b;
+
+    if (ea->last_save != eb->last_save)
+        return ea->last_save < eb->last_save ? 1 : -1;
+    return strcmp(ea->name, eb->name);
+}
+
+static void show_entry(Buffer* out, const PlayerIndexEntry* entry)
+{
+    char when[32];
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M", localtime(&entry->last_save));
+
+    const char* class_name = (entry->ch_class >= 0 && entry->ch_class < class_count)
+        ? class_table[entry->ch_class].who_name : "???";
+    const char* race_name = (entry->race >= 0 && entry->race < race_count)
+        ? race_table[entry->race].name : "???";
+
+    addf_buf(out, "%-12s %3d %-5.5s %-10.10s %-7s %s  %s\n\r", entry->name,
+        entry->level, class_name, race_name,
+        player_persist_format_name(entry->format), when,
+        entry->host[0] ? entry->host : "-");
+}
+
+void do_pindex(Mobile* ch, char* argument)
+{
+    char arg[MAX_INPUT_LENGTH];
+
+    READ_ARG(arg);
+
+    if (arg[0] == '\0') {
+        send_to_char("Syntax: pindex <name>\n\r"
+            "        pindex host <host prefix>\n\r"
+            "        pindex level <min> [max]\n\r"
+            "        pindex rebuild\n\r", ch);
+        if (player_index_ready())
+            printf_to_char(ch, "The index lists %d player%s.\n\r", index_count,
+                index_count == 1 ? "" : "s");
+        return;
+    }
+
+    if (!str_cmp(arg, "rebuild")) {
+        int count = rebuild_player_index();
+        printf_to_char(ch, "Player index rebuilt: %d player%s.\n\r", count,
+            count == 1 ? "" : "s");
+        return;
+    }
+
+    if (!player_index_ready()) {
+        send_to_char("The player index isn't loaded; use 'pindex rebuild'.\n\r", ch);
+        return;
+    }
+
+    PlayerIndexEntry** entries;
+    int count = collect_entries(&entries);
+    int shown = 0;
+    INIT_BUF(out, MAX_STRING_LENGTH);
+
+    if (!str_cmp(arg, "host")) {
+        if (argument[0] == '\0') {
+            send_to_char("Which host?\n\r", ch);
+            free(entries);
+            free_buf(out);
+            return;
+        }
+
+        qsort(entries, (size_t)count, sizeof(PlayerIndexEntry*), compare_last_save);
+        for (int i = 0; i < count; i++) {
+            if (entries[i]->host[0] != '\0' && !str_prefix(argument, entries[i]->host)) {
+                show_entry(out, entries[i]);
+                shown++;
+            }
+        }
+        addf_buf(out, "%d player%s last saved from '%s'.\n\r", shown,
+            shown == 1 ? "" : "s", argument);
+    }
+    else if (!str_cmp(arg, "level")) {
+        char min_arg[MAX_INPUT_LENGTH];
+        READ_ARG(min_arg);
+        if (!is_number(min_arg) || (argument[0] != '\0' && !is_number(argument))) {
+            send_to_char("Syntax: pindex level <min> [max]\n\r", ch);
+            free(entries);
+            free_buf(out);
+            return;
+        }
+        int min = atoi(min_arg);
+        int max = argument[0] != '\0' ? atoi(argument) : MAX_LEVEL;
+        int by_level[MAX_LEVEL + 1] = { 0 };
+
+        for (int i = 0; i < count; i++) {
+            int level = entries[i]->level;
+            if (level >= min && level <= max && level >= 0 && level <= MAX_LEVEL) {
+                by_level[level]++;
+                shown++;
+            }
+        }
+        for (int level = UMAX(min, 0); level <= UMIN(max, MAX_LEVEL); level++)
+            if (by_level[level] > 0)
+                addf_buf(out, "Level %3d: %d\n\r", level, by_level[level]);
+        addf_buf(out, "%d player%s between levels %d and %d.\n\r", shown,
+            shown == 1 ? "" : "s", min, max);
+    }
+    else {
+        const PlayerIndexEntry* entry = player_index_lookup(arg);
+        if (entry == NULL)
+            addf_buf(out, "No player named '%s'.\n\r", arg);
+        else
+            show_entry(out, entry);
+    }
+
+    page_to_char(BUF(out), ch);
+    free_buf(out);
+    free(entries);
+}
@@ -0,0 +1,56 @@
+////////////////////////////////////////////////////////////////////////////////
+// player_index.h
+//
+// Resident index of every player file: name, format, level and where the
+// player last saved from. Kept in <player_dir>/<player_index_file> and updated
+// on every save, so name checks and immortal reports don't touch the player
+// files themselves.
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct player_index_entry_t PlayerIndexEntry;
+
+#pragma once
+#ifndef MUD98__PLAYER_INDEX_H
+#define MUD98__PLAYER_INDEX_H
+
+#include "merc.h"
+
+#include <persist/player/player_persist.h>
+
+#include <stdbool.h>
+#include <time.h>
+
+struct player_index_entry_t {
+    PlayerIndexEntry* next;
+    char* name;
+    char* host;             // Where the player last saved from; "" if unknown
+    time_t last_save;
+    PlayerPersistFormat format;
+    LEVEL level;
+    LEVEL trust;
+    int16_t ch_class;
+    int16_t race;
+};
+
+// Loads the index for the current player_dir, rebuilding it from the player
+// files if it doesn't exist yet.
+void load_player_index();
+
+// Rescans player_dir and rewrites the index. Returns the number of players.
+int rebuild_player_index();
+
+// True if the index describes the current player_dir. When it doesn't (not
+// loaded yet, or player_dir has changed) callers have to probe the files.
+bool player_index_ready();
+
+// The entry for 'name', or NULL if there is no such player. A name the index
+// doesn't list is looked for on disk before it is reported missing, and
+// indexed if its player file turns up.
+const PlayerIndexEntry* player_index_lookup(const char* name);
+
+void player_index_update(Mobile* ch, PlayerPersistFormat format);
+void player_index_remove(const char* name);
+
+int player_index_count();
+
+#endif // !MUD98__PLAYER_INDEX_H
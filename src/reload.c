@@ -10,6 +10,7 @@
 #include "fileutils.h"
 #include "handler.h"
 #include "interp.h"
+#include "pathfind.h"
 
 #include <persist/rom-olc/db_rom_olc.h>
 
@@ -207,6 +208,7 @@ void reload_room(Mobile* ch, Room* room)
     room->inbound_exits.front = NULL;
     room->inbound_exits.back = NULL;
     room->inbound_exits.count = 0;
+    path_graph_changed();
 
     // Step 2: Save all mobiles in the room (with gc_protect)
     ValueArray saved_mobs;
@@ -59,11 +59,58 @@ RngOps rng_production = {
     .number_fuzzy = prod_number_fuzzy,
 };
 
-// Global RNG pointer - defaults to production
-RngOps* rng = &rng_production;
+// Per-thread RNG pointer - defaults to production
+RNG_THREAD_LOCAL RngOps* rng = &rng_production;
+
+// Stream the production ops draw from on this thread; NULL is the shared one.
+static RNG_THREAD_LOCAL RngContext* bound_context = NULL;
+
+// pcg32_random_r(), inlined so dice and percent loops don't pay a call per draw.
+static inline uint32_t next_draw(RngContext* ctx)
+{
+    if (ctx == NULL)
+        return pcg32_random();
+
+    uint64_t oldstate = ctx->pcg.state;
+    ctx->pcg.state = oldstate * 6364136223846793005ULL + ctx->pcg.inc;
+    uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+    uint32_t rot = (uint32_t)(oldstate >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+void rng_context_seed(RngContext* ctx, uint64_t seed, uint64_t stream)
+{
+    pcg32_srandom_r(&ctx->pcg, seed, stream);
+}
+
+void rng_context_split(RngContext* parent, uint64_t stream, RngContext* child)
+{
+    // The parent picks where the child starts; the stream id picks its
+    // increment, so children split with different ids never share a sequence.
+    uint64_t seed = (uint64_t)next_draw(parent) << 32;
+    seed |= next_draw(parent);
+    pcg32_srandom_r(&child->pcg, seed, stream);
+}
+
+RngContext* rng_bind_context(RngContext* ctx)
+{
+    RngContext* prev = bound_context;
+    bound_context = ctx;
+    return prev;
+}
+
+RngContext* rng_bound_context(void)
+{
+    return bound_context;
+}
+
+uint32_t rng_next_r(RngContext* ctx)
+{
+    return next_draw(ctx);
+}
 
 // Generate a random number in range [from, to] inclusive
-static int prod_number_range(int from, int to)
+int rng_range_r(RngContext* ctx, int from, int to)
 {
     int power;
     int number;
@@ -77,23 +124,75 @@ static int prod_number_range(int from, int to)
     for (power = 2; power < to; power <<= 1)
         ;
 
-    while ((number = prod_number_mm() & (power - 1)) >= to)
+    while ((number = (int)(next_draw(ctx) & (uint32_t)(power - 1))) >= to)
         ;
 
     return from + number;
 }
 
 // Generate a percentile roll [1, 100]
-static int prod_number_percent(void)
+int rng_percent_r(RngContext* ctx)
 {
     int percent;
 
-    while ((percent = prod_number_mm() & (128 - 1)) > 99)
+    while ((percent = (int)(next_draw(ctx) & (128 - 1))) > 99)
         ;
 
     return 1 + percent;
 }
 
+// Roll dice: returns sum of 'number' d'size' rolls
+int rng_dice_r(RngContext* ctx, int number, int size)
+{
+    int power;
+    int sum = 0;
+
+    switch (size) {
+    case 0:
+        return 0;
+    case 1:
+        return number;
+    }
+
+    // Each die is a number_range(1, size); the mask only needs working out once.
+    if (size < 1)
+        return number > 0 ? number : 0;
+
+    for (power = 2; power < size; power <<= 1)
+        ;
+
+    for (int idice = 0; idice < number; idice++) {
+        int roll;
+        while ((roll = (int)(next_draw(ctx) & (uint32_t)(power - 1))) >= size)
+            ;
+        sum += 1 + roll;
+    }
+
+    return sum;
+}
+
+void rng_fill_r(RngContext* ctx, uint32_t* out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out[i] = next_draw(ctx);
+}
+
+void rng_percents_r(RngContext* ctx, int* out, int count)
+{
+    for (int i = 0; i < count; i++)
+        out[i] = rng_percent_r(ctx);
+}
+
+static int prod_number_range(int from, int to)
+{
+    return rng_range_r(bound_context, from, to);
+}
+
+static int prod_number_percent(void)
+{
+    return rng_percent_r(bound_context);
+}
+
 // Generate a random number in range [0, 2^width - 1]
 static int prod_number_bits(int width)
 {
@@ -114,26 +213,12 @@ static Direction prod_number_door(void)
 // Core PCG random number generator
 static long prod_number_mm(void)
 {
-    return pcg32_random();
+    return next_draw(bound_context);
 }
 
-// Roll dice: returns sum of 'number' d'size' rolls
 static int prod_dice(int number, int size)
 {
-    int idice;
-    int sum;
-
-    switch (size) {
-    case 0:
-        return 0;
-    case 1:
-        return number;
-    }
-
-    for (idice = 0, sum = 0; idice < number; idice++)
-        sum += prod_number_range(1, size);
-
-    return sum;
+    return rng_dice_r(bound_context, number, size);
 }
 
 // Add slight random variance to a number
@@ -5,6 +5,11 @@
 // Provides a seam for swapping RNG implementations (production vs test mocks).
 // This enables deterministic testing of combat, events, and other RNG-dependent
 // systems without changing production code.
+//
+// Both the ops table and the stream the production ops draw from are per
+// thread. By default every thread draws from the shared PCG stream seeded in
+// init_mm(), which is only safe on the main thread; anything else (simulation
+// workers, background generation) binds its own RngContext first.
 ////////////////////////////////////////////////////////////////////////////////
 
 #pragma once
@@ -12,9 +17,16 @@
 #define MUD98__RNG_H
 
 #include "data/direction.h"
+#include "pcg_basic.h"
 
 #include <stdint.h>
 
+#ifdef _MSC_VER
+#define RNG_THREAD_LOCAL __declspec(thread)
+#else
+#define RNG_THREAD_LOCAL _Thread_local
+#endif
+
 // RNG operations table.
 // Production code points to PCG implementation; tests can swap in mocks.
 typedef struct rng_ops_t {
@@ -40,14 +52,47 @@ typedef struct rng_ops_t {
     int (*number_fuzzy)(int number);
 } RngOps;
 
-// Global RNG ops pointer.
-// Defaults to production PCG implementation (rng_production.c).
-// Tests can swap to mock implementations (tests/mock_rng.c).
-extern RngOps* rng;
+// Per-thread RNG ops pointer.
+// Defaults to production PCG implementation (rng.c) on every thread.
+// Tests can swap to mock implementations (tests/mock_rng.c); that only affects
+// the thread that does it.
+extern RNG_THREAD_LOCAL RngOps* rng;
 
 // Production RNG ops table (backed by PCG)
 extern RngOps rng_production;
 
+// An independent PCG stream.
+//
+// Determinism: a context's sequence depends only on how it was seeded. One
+// made by rng_context_split() depends only on the parent's state at the time
+// of the split and the stream id, so a parent that splits its children in a
+// fixed order gets the same children every run, no matter which threads they
+// are later used on or how their draws interleave. Drawing from a child never
+// moves the parent or its siblings.
+typedef struct rng_context_t {
+    pcg32_random_t pcg;
+} RngContext;
+
+void rng_context_seed(RngContext* ctx, uint64_t seed, uint64_t stream);
+void rng_context_split(RngContext* parent, uint64_t stream, RngContext* child);
+
+// Makes the production ops on this thread draw from 'ctx' (NULL for the shared
+// stream). Returns the previously bound context, for restoring it afterward.
+RngContext* rng_bind_context(RngContext* ctx);
+RngContext* rng_bound_context(void);
+
+// Draws straight from a context (NULL for the shared stream), bypassing 'rng'.
+// They consume exactly what the matching production ops would, so the same
+// stream gives the same rolls either way.
+uint32_t rng_next_r(RngContext* ctx);
+int rng_range_r(RngContext* ctx, int from, int to);
+int rng_percent_r(RngContext* ctx);
+int rng_dice_r(RngContext* ctx, int number, int size);
+
+// Batched generation: fills 'out' with 'count' draws in one tight loop.
+void rng_fill_r(RngContext* ctx, uint32_t* out, int count);
+void rng_percents_r(RngContext* ctx, int* out, int count);
+
 // Convenience macros for calling through RNG ops.
 // These mirror the original function signatures for drop-in compatibility.
 #define RNG_RANGE(from, to)     (rng->number_range((from), (to)))
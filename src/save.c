@@ -35,6 +35,7 @@
 #include "handler.h"
 #include "lookup.h"
 #include "magic.h"
+#include "player_index.h"
 #include "recycle.h"
 #include "skills.h"
 #include "stringutils.h"
@@ -255,13 +256,17 @@ void save_char_obj(Mobile* ch)
     if (!MoveFileExA(temp_path, final_path, MOVEFILE_REPLACE_EXISTING)) {
         bugf("save_char_obj : Could not rename %s to %s!", temp_path, final_path);
         perror(final_path);
+        return;
     }
 #else
     if (rename(temp_path, final_path) != 0) {
         bugf("save_char_obj : Could not rename %s to %s!", temp_path, final_path);
         perror(final_path);
+        return;
     }
 #endif
+
+    player_index_update(ch, fmt);
 }
 
 static bool player_try_load_format(Descriptor* d, Mobile* ch, const char* name,
@@ -310,17 +315,14 @@ static void migrate_player_file(Mobile* ch, const char* capitalized_name,
     remove(old_path);
 }
 
-bool load_char_obj(Descriptor* d, char* name)
+static Mobile* new_player_mobile(char* name)
 {
-    char capitalized[MAX_INPUT_LENGTH] = { 0 };
     Mobile* ch;
     int stat;
 
     ch = new_mobile();
     ch->pcdata = new_player_data();
     ch->pcdata->ch = ch;
-    d->character = ch;
-    ch->desc = d;
     SET_NAME(ch, lox_string(name));
     ch->id = get_pc_id();
     ch->race = race_lookup("human");
@@ -345,19 +347,38 @@ bool load_char_obj(Descriptor* d, char* name)
     for (int i = 0; i < MAX_THEMES; ++i)
         ch->pcdata->color_themes[i] = NULL;
 
+    return ch;
+}
+
+// Reads the player file for 'name' into 'ch'. With the player index loaded,
+// its format is tried first, and a name it can't find (even on disk) has no
+// file. Files found in the other format are
+// migrated to the default one if 'migrate' is set.
+static bool read_player(Descriptor* d, Mobile* ch, char* name, bool migrate)
+{
+    char capitalized[MAX_INPUT_LENGTH] = { 0 };
+
     sprintf(capitalized, "%s", capitalize(name));
 
     PlayerPersistFormat preferred = player_persist_format_from_string(cfg_get_default_format());
-    PlayerPersistFormat loaded_fmt = preferred;
-    bool loaded = player_try_load_format(d, ch, name, capitalized, preferred, &loaded_fmt);
+    PlayerPersistFormat first = preferred;
+    if (player_index_ready()) {
+        const PlayerIndexEntry* entry = player_index_lookup(name);
+        if (entry == NULL)
+            return false;
+        first = entry->format;
+    }
+
+    PlayerPersistFormat loaded_fmt = first;
+    bool loaded = player_try_load_format(d, ch, name, capitalized, first, &loaded_fmt);
     if (!loaded) {
-        PlayerPersistFormat fallback = player_persist_alternate_format(preferred);
+        PlayerPersistFormat fallback = player_persist_alternate_format(first);
         loaded = player_try_load_format(d, ch, name, capitalized, fallback, &loaded_fmt);
         if (!loaded)
             return false;
     }
 
-    if (loaded_fmt != preferred)
+    if (migrate && loaded_fmt != preferred)
         migrate_player_file(ch, capitalized, loaded_fmt, preferred);
 
     int i;
@@ -407,3 +428,81 @@ bool load_char_obj(Descriptor* d, char* name)
 
     return true;
 }
+
+bool load_char_obj(Descriptor* d, char* name)
+{
+    Mobile* ch = new_player_mobile(name);
+    d->character = ch;
+    ch->desc = d;
+
+    return read_player(d, ch, name, true);
+}
+
+Mobile* load_offline_player(char* name, PlayerPersistFormat format)
+{
+    char capitalized[MAX_INPUT_LENGTH];
+    Mobile* ch = new_player_mobile(name);
+
+    sprintf(capitalized, "%s", capitalize(name));
+    if (!player_try_load_format(NULL, ch, name, capitalized, format, NULL)) {
+        free_offline_player(ch);
+        return NULL;
+    }
+
+    return ch;
+}
+
+void free_offline_player(Mobile* ch)
+{
+    // The pet was counted against its prototype when the file made it; undo
+    // that as extract_mob() would.
+    if (ch->pet != NULL) {
+        if (ch->pet->prototype != NULL)
+            --ch->pet->prototype->count;
+        free_mobile(ch->pet);
+    }
+    free_mobile(ch);
+}
+
+bool player_file_exists(const char* name)
+{
+    if (player_index_ready())
+        return player_index_lookup(name) != NULL;
+
+    char capitalized[MAX_INPUT_LENGTH];
+    char path[MIL];
+    sprintf(capitalized, "%s", capitalize(name));
+
+    PlayerPersistFormat formats[] = { PLAYER_PERSIST_ROM_OLC, PLAYER_PERSIST_JSON };
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        build_player_path(path, sizeof path, cfg_get_player_dir(), capitalized, formats[i], false);
+        if (path[0] == '\0')
+            continue;
+        if (file_exists(path))
+            return true;
+        strcat(path, ".gz");
+        if (file_exists(path))
+            return true;
+    }
+
+    return false;
+}
+
+void delete_player_file(const char* name)
+{
+    char capitalized[MAX_INPUT_LENGTH];
+    char path[MIL];
+    sprintf(capitalized, "%s", capitalize(name));
+
+    PlayerPersistFormat formats[] = { PLAYER_PERSIST_ROM_OLC, PLAYER_PERSIST_JSON };
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        build_player_path(path, sizeof path, cfg_get_player_dir(), capitalized, formats[i], false);
+        if (path[0] == '\0')
+            continue;
+        remove(path);
+        strcat(path, ".gz");
+        remove(path);
+    }
+
+    player_index_remove(name);
+}
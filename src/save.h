@@ -9,8 +9,20 @@
 #include "entities/mobile.h"
 #include "entities/descriptor.h"
 
+#include <persist/player/player_persist.h>
+
 void save_char_obj(Mobile* ch);
 bool load_char_obj(Descriptor* d, char* name);
+
+// Loads a player who isn't logging in (no descriptor, nothing migrated) from
+// their file in 'format'. Returns NULL if it can't be read.
+Mobile* load_offline_player(char* name, PlayerPersistFormat format);
+void free_offline_player(Mobile* ch);
+
+// True if 'name' has a player file, in either format.
+bool player_file_exists(const char* name);
+// Removes every file for 'name' and drops it from the player index.
+void delete_player_file(const char* name);
 int	race_exp_per_level(int race, int ch_class, int points);
 
 #endif // !MUD98__SAVE_H
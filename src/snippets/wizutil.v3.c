@@ -328,7 +328,7 @@ void do_rename(Mobile* ch, char* argument)
     // Rename the character and save him to a new file.
     // NOTE: Players who are level 1 do NOT get saved under a new name.
 
-    NAME_FIELD(victim) = lox_string(capitalize(new_name));
+    SET_NAME(victim, lox_string(capitalize(new_name)));
 
     save_char_obj(victim);
 
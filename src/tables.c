@@ -276,6 +276,7 @@ const struct flag_type comm_flag_table[] = {
     { "telnet_ga",      COMM_TELNET_GA,     true    },
     { "show_affects",   COMM_SHOW_AFFECTS,  true    },
     { "nograts",        COMM_NOGRATS,       true    },
+    { "combat_brief",   COMM_COMBAT_BRIEF,  true    },
     { "noemote",        COMM_NOEMOTE,       false   },
     { "noshout",        COMM_NOSHOUT,       false   },
     { "notell",         COMM_NOTELL,        false   },
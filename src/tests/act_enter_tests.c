@@ -5,6 +5,7 @@
 #include "tests.h"
 
 #include "act_enter.h"
+#include "fight.h"
 #include "handler.h"
 #include "interp.h"
 #include "mock.h"
@@ -349,7 +350,7 @@ static int test_enter_while_fighting()
     transfer_mob(mob, room1);
     
     // Set fighting state
-    ch->fighting = mob;
+    set_fighting(ch, mob);
     
     // Create a portal
     ObjPrototype* proto = mock_obj_proto(50200);
@@ -27,12 +27,18 @@
 #include "mock.h"
 
 #include <act_info.h>
+#include <color.h>
 #include <comm.h>
+#include <db.h>
 #include <handler.h>
 
 #include <data/mobile_data.h>
+#include <entities/descriptor.h>
+#include <entities/event.h>
 #include <entities/room.h>
 
+#include <string.h>
+
 TestGroup act_tests;
 
 static int test_to_vch()
@@ -88,6 +94,144 @@ static int test_to_room()
     return 0;
 }
 
+static int test_reused_format_buffer()
+{
+    Room* room = mock_room(50020, NULL, NULL);
+
+    Mobile* ch = mock_mob("Bob", 50021, NULL);
+    transfer_mob(ch, room);
+
+    Mobile* pc = mock_player("Jim");
+    transfer_mob(pc, room);
+
+    // Like dam_message(): one buffer, a new message in it each time.
+    char buf[MAX_INPUT_LENGTH];
+    const char* verbs[] = { "scratches", "hits", "MAULS" };
+
+    test_socket_output_enabled = true;
+    for (int i = 0; i < 3; i++) {
+        sprintf(buf, "$n %s you.", verbs[i]);
+        act(buf, ch, NULL, pc, TO_VICT);
+    }
+    test_socket_output_enabled = false;
+
+    ASSERT_OUTPUT_EQ("Bob scratches you.\n\rBob hits you.\n\r"
+        "Bob MAULS you.\n\r");
+    test_output_buffer = NIL_VAL;
+
+    return 0;
+}
+
+static int test_colour_codes_stripped()
+{
+    Room* room = mock_room(50030, NULL, NULL);
+
+    Mobile* ch = mock_mob("Bob", 50031, NULL);
+    transfer_mob(ch, room);
+
+    Mobile* pc = mock_player("Jim");
+    transfer_mob(pc, room);
+
+    // Jim has colour off; he gets the text without the codes.
+    test_socket_output_enabled = true;
+    act(COLOR_FIGHT_THIT "$n hits you" COLOR_CLEAR "!", ch, NULL, pc,
+        TO_VICT);
+    test_socket_output_enabled = false;
+
+    ASSERT_OUTPUT_EQ("Bob hits you!\n\r");
+    test_output_buffer = NIL_VAL;
+
+    return 0;
+}
+
+// With no test capture on, act() renders straight into the listener's output
+// buffer. Start it small so the buffer has to grow along the way.
+static int test_direct_to_descriptor()
+{
+    Room* room = mock_room(50040, NULL, NULL);
+
+    Mobile* ch = mock_mob("Bob", 50041, NULL);
+    transfer_mob(ch, room);
+
+    Mobile* pc = mock_player("Jim");
+    transfer_mob(pc, room);
+
+    Descriptor* d = pc->desc;
+    d->outsize = 16;
+    d->outbuf = alloc_mem(d->outsize);
+    d->outtop = 0;
+    d->fcommand = false;
+
+    bool old_output = test_output_enabled;
+    bool old_socket_output = test_socket_output_enabled;
+    bool old_act_output = test_act_output_enabled;
+    test_output_enabled = false;
+    test_socket_output_enabled = false;
+    test_act_output_enabled = false;
+
+    act("the wind howls around $n.", ch, NULL, pc, TO_VICT);
+    act(COLOR_FIGHT_THIT "$n hits you" COLOR_CLEAR "!", ch, NULL, pc,
+        TO_VICT);
+
+    test_output_enabled = old_output;
+    test_socket_output_enabled = old_socket_output;
+    test_act_output_enabled = old_act_output;
+
+    // The "\n\r" that starts a fresh buffer comes once, before everything.
+    const char* expected = "\n\rThe wind howls around Bob.\n\rBob hits you!\n\r";
+    ASSERT((size_t)d->outtop == strlen(expected));
+    ASSERT(d->outsize > 16);
+    ASSERT(!memcmp(d->outbuf, expected, strlen(expected)));
+
+    d->outtop = 0;
+    return 0;
+}
+
+static int test_room_listeners()
+{
+    Room* room = mock_room(50010, NULL, NULL);
+    Room* other = mock_room(50011, NULL, NULL);
+
+    Mobile* ch = mock_mob("Bob", 50012, NULL);
+    transfer_mob(ch, room);
+    for (int i = 0; i < 5; i++)
+        transfer_mob(mock_mob("Sheep", 50013, NULL), room);
+    Mobile* pc = mock_player("Jim");
+    transfer_mob(pc, room);
+
+    // NPCs without act triggers have nothing to hear.
+    List* listeners = get_room_listeners(room, true);
+    ASSERT(listeners->count == 1);
+    ASSERT(AS_MOBILE(listeners->front->value) == pc);
+
+    test_socket_output_enabled = true;
+    act("$n shears a sheep.", ch, NULL, NULL, TO_ROOM);
+    test_socket_output_enabled = false;
+    ASSERT_OUTPUT_EQ("Bob shears a sheep.\n\r");
+    test_output_buffer = NIL_VAL;
+
+    // Picking up an act trigger in place makes the list stale; it's rebuilt
+    // in room order when it's safe to.
+    Event* event = new_event();
+    event->trigger = TRIG_ACT;
+    event->method_name = lox_string("on_act");
+    add_event((Entity*)ch, event);
+    ASSERT(get_room_listeners(room, false) == &room->mobiles);
+    listeners = get_room_listeners(room, true);
+    ASSERT(listeners->count == 2);
+    ASSERT(AS_MOBILE(listeners->front->value) == ch);
+    ASSERT(AS_MOBILE(listeners->back->value) == pc);
+
+    transfer_mob(pc, other);
+    ASSERT(listeners->count == 1);
+    ASSERT(get_room_listeners(other, true)->count == 1);
+
+    remove_event((Entity*)ch, event);
+    ASSERT(get_room_listeners(room, true)->count == 0);
+
+    return 0;
+}
+
 // =============================================================================
 // Command Tests (act_info.c)
 // =============================================================================
@@ -1199,6 +1343,10 @@ void register_act_tests()
 
     REGISTER("Act: To Victim", test_to_vch);
     REGISTER("Act: To Room", test_to_room);
+    REGISTER("Act: Reused Format Buffer", test_reused_format_buffer);
+    REGISTER("Act: Colour Codes Stripped", test_colour_codes_stripped);
+    REGISTER("Act: Direct To Descriptor", test_direct_to_descriptor);
+    REGISTER("Act: Room Listeners", test_room_listeners);
     
     // Command Tests
     REGISTER("Cmd: Autoassist toggle", test_autoassist_toggle);
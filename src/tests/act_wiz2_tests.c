@@ -7,6 +7,7 @@
 #include "test_registry.h"
 
 #include <act_wiz.h>
+#include <fight.h>
 #include <handler.h>
 #include <merc.h>
 
@@ -194,8 +195,8 @@ static int test_peace()
     transfer_mob(mob2, room);
     
     // Make them fight
-    mob1->fighting = mob2;
-    mob2->fighting = mob1;
+    set_fighting(mob1, mob2);
+    set_fighting(mob2, mob1);
     
     ASSERT(mob1->fighting != NULL);
     ASSERT(mob2->fighting != NULL);
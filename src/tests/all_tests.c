@@ -61,13 +61,20 @@ void run_unit_tests()
     register_quest_tests();
     register_login_tests();
     register_persist_tests();
+    register_area_cache_tests();
     register_player_persist_tests();
     register_daycycle_tests();
     register_multihit_tests();
     register_loot_tests();
     register_thief_tests();
     register_magic_tests();
+    register_mob_prog_tests();
+    register_rng_tests();
+    register_pathfind_tests();
     register_olc_aedit_tests();
+    register_olc_asave_tests();
+    register_help_note_tests();
+    register_player_index_tests();
     register_craft_tests();
     register_gather_spawn_tests();
 
@@ -0,0 +1,616 @@
+////////////////////////////////////////////////////////////////////////////////
+// area_cache_tests.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+
+#include <persist/area/area_cache.h>
+#include <persist/area/area_persist.h>
+#include <persist/area/binary/area_persist_binary.h>
+#include <persist/persist_io_adapters.h>
+#include <persist/persist_result.h>
+
+#ifdef ENABLE_ROM_OLC_PERSISTENCE
+#include <persist/area/rom-olc/area_persist_rom_olc.h>
+#endif
+
+#include <entities/area.h>
+#include <entities/extra_desc.h>
+#include <entities/faction.h>
+#include <entities/help_data.h>
+#include <entities/mob_prototype.h>
+#include <entities/obj_prototype.h>
+#include <entities/room.h>
+#include <entities/shop_data.h>
+
+#include <config.h>
+#include <db.h>
+#include <mob_prog.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+TestGroup area_cache_tests;
+
+#ifdef ENABLE_ROM_OLC_PERSISTENCE
+
+// Globals we need to snapshot/restore to avoid polluting the live world.
+extern AreaData* area_data_free;
+extern int area_count;
+extern int area_perm_count;
+extern int area_data_count;
+extern int area_data_perm_count;
+
+typedef struct cache_state_snapshot_t {
+    ValueArray global_areas;
+    AreaData* current_area_data;
+    AreaData* area_data_free;
+    int area_count;
+    int area_perm_count;
+    int area_data_count;
+    int area_data_perm_count;
+    OrderedTable global_rooms;
+    OrderedTable mob_protos;
+    OrderedTable obj_protos;
+    Table faction_table;
+    VNUM top_vnum_room;
+    VNUM top_vnum_mob;
+    VNUM top_vnum_obj;
+    MobProgCode* mprog_list;
+    ShopData* shop_first;
+    ShopData* shop_last;
+} CacheStateSnapshot;
+
+static void cache_state_begin(CacheStateSnapshot* snap)
+{
+    snap->global_areas = global_areas;
+    snap->current_area_data = current_area_data;
+    snap->area_data_free = area_data_free;
+    snap->area_count = area_count;
+    snap->area_perm_count = area_perm_count;
+    snap->area_data_count = area_data_count;
+    snap->area_data_perm_count = area_data_perm_count;
+    snap->global_rooms = snapshot_global_rooms();
+    snap->mob_protos = snapshot_global_mob_protos();
+    snap->obj_protos = snapshot_global_obj_protos();
+    snap->faction_table = faction_table;
+    snap->top_vnum_room = top_vnum_room;
+    snap->top_vnum_mob = top_vnum_mob;
+    snap->top_vnum_obj = top_vnum_obj;
+    snap->mprog_list = mprog_list;
+    snap->shop_first = shop_first;
+    snap->shop_last = shop_last;
+
+    global_areas = (ValueArray){ 0 };
+    init_value_array(&global_areas);
+    current_area_data = NULL;
+    area_data_free = NULL;
+    area_count = 0;
+    area_perm_count = 0;
+    area_data_count = 0;
+    area_data_perm_count = 0;
+    init_global_rooms();
+    init_global_mob_protos();
+    init_global_obj_protos();
+    init_table(&faction_table);
+    top_vnum_room = 0;
+    top_vnum_mob = 0;
+    top_vnum_obj = 0;
+    mprog_list = NULL;
+    shop_first = NULL;
+    shop_last = NULL;
+}
+
+static void cache_state_end(CacheStateSnapshot* snap)
+{
+    free_global_rooms();
+    free_global_mob_protos();
+    free_global_obj_protos();
+    free_table(&faction_table);
+    free_value_array(&global_areas);
+    global_areas = snap->global_areas;
+    current_area_data = snap->current_area_data;
+    area_data_free = snap->area_data_free;
+    area_count = snap->area_count;
+    area_perm_count = snap->area_perm_count;
+    area_data_count = snap->area_data_count;
+    area_data_perm_count = snap->area_data_perm_count;
+    restore_global_rooms(snap->global_rooms);
+    restore_global_mob_protos(snap->mob_protos);
+    restore_global_obj_protos(snap->obj_protos);
+    faction_table = snap->faction_table;
+    top_vnum_room = snap->top_vnum_room;
+    top_vnum_mob = snap->top_vnum_mob;
+    top_vnum_obj = snap->top_vnum_obj;
+    mprog_list = snap->mprog_list;
+    shop_first = snap->shop_first;
+    shop_last = snap->shop_last;
+}
+
+static const char* CACHE_AREA_TEXT =
+    "#AREADATA\n"
+    "Version 2\n"
+    "Name Cache Test~\n"
+    "Builders Tester~\n"
+    "VNUMs 9900 9909\n"
+    "Credits None~\n"
+    "Security 9\n"
+    "Sector 0\n"
+    "Low 1\n"
+    "High 10\n"
+    "Reset 4\n"
+    "AlwaysReset 0\n"
+    "InstType 0\n"
+    "End\n"
+    "\n"
+    "#MOBILES\n"
+    "#9900\n"
+    "clerk cache~\n"
+    "the cache clerk~\n"
+    "A clerk stands here, counting boxes.\n"
+    "~\n"
+    "The clerk looks very organized.\n"
+    "~\n"
+    "human~\n"
+    "ABG 0 0 0\n"
+    "5 2 1d1+49 1d1+99 1d4+1 punch\n"
+    "-5 -5 -5 -5\n"
+    "0 0 0 0\n"
+    "stand stand male 25\n"
+    "0 0 medium '0'\n"
+    "M speech 9900 hello~\n"
+    "#0\n"
+    "\n"
+    "#OBJECTS\n"
+    "#9900\n"
+    "box cache~\n"
+    "a cache box~\n"
+    "A small box sits here.~\n"
+    "wood~\n"
+    "container 0 AO\n"
+    "10 0 0 5 100\n"
+    "3 5 40 P\n"
+    "A\n"
+    "18 2\n"
+    "E\n"
+    "box~\n"
+    "It is labeled 'cache'.\n"
+    "~\n"
+    "#0\n"
+    "\n"
+    "#ROOMS\n"
+    "#9900\n"
+    "Cache Entry~\n"
+    "Shelves of boxes line the walls.\n"
+    "~\n"
+    "0\n"
+    "0 1\n"
+    "D0\n"
+    "A door leads north.\n"
+    "~\n"
+    "door~\n"
+    "1 -1 9901\n"
+    "E\n"
+    "shelves~\n"
+    "They are full.\n"
+    "~\n"
+    "S\n"
+    "#9901\n"
+    "Cache Vault~\n"
+    "A quiet vault.\n"
+    "~\n"
+    "0\n"
+    "0 1\n"
+    "D2\n"
+    "~\n"
+    "door~\n"
+    "1 -1 9900\n"
+    "S\n"
+    "#0\n"
+    "\n"
+    "#RESETS\n"
+    "M 0 9900 1 9900 1\n"
+    "O 0 9900 0 9901\n"
+    "D 0 9900 0 1\n"
+    "S\n"
+    "\n"
+    "#SHOPS\n"
+    "9900 15 0 0 0 0 120 80 6 20\n"
+    "0\n"
+    "\n"
+    "#SPECIALS\n"
+    "S\n"
+    "\n"
+    "#MOBPROGS\n"
+    "#9900\n"
+    "say Welcome to the cache.\n"
+    "~\n"
+    "#0\n"
+    "\n"
+    "#$\n";
+
+static bool load_rom_text(const char* text)
+{
+    FILE* fp = tmpfile();
+    if (!fp)
+        return false;
+    fwrite(text, 1, strlen(text), fp);
+    rewind(fp);
+
+    PersistReader reader = persist_reader_from_file(fp, "cache.are");
+    AreaPersistLoadParams params = {
+        .reader = &reader,
+        .file_name = "cache.are",
+        .create_single_instance = false,
+    };
+    PersistResult result = AREA_PERSIST_ROM_OLC.load(&params);
+    fclose(fp);
+    return persist_succeeded(result);
+}
+
+static bool save_binary(AreaData* area, PersistBufferWriter* out)
+{
+    PersistWriter writer = persist_writer_from_buffer(out, "cache.are.arc");
+    AreaPersistSaveParams params = {
+        .writer = &writer,
+        .area = area,
+        .file_name = "cache.are",
+    };
+    return persist_succeeded(AREA_PERSIST_BINARY.save(&params));
+}
+
+static PersistResult load_binary(const void* data, size_t len)
+{
+    PersistBufferReaderCtx ctx;
+    PersistReader reader = persist_reader_from_buffer(data, len, "cache.are.arc", &ctx);
+    AreaPersistLoadParams params = {
+        .reader = &reader,
+        .file_name = "cache.are",
+        .create_single_instance = false,
+    };
+    return AREA_PERSIST_BINARY.load(&params);
+}
+
+static int test_binary_round_trip()
+{
+    CacheStateSnapshot snap;
+    PersistBufferWriter first = { 0 };
+    PersistBufferWriter second = { 0 };
+
+    cache_state_begin(&snap);
+    ASSERT_OR_GOTO(load_rom_text(CACHE_AREA_TEXT), cleanup);
+    ASSERT_OR_GOTO(save_binary(LAST_AREA_DATA, &first), cleanup);
+    cache_state_end(&snap);
+
+    cache_state_begin(&snap);
+    PersistResult result = load_binary(first.data, first.len);
+    ASSERT_OR_GOTO(persist_succeeded(result), cleanup);
+    ASSERT_OR_GOTO(global_areas.count == 1, cleanup);
+
+    AreaData* area = LAST_AREA_DATA;
+    ASSERT_STR_EQ("cache.are", area->file_name);
+    ASSERT_STR_EQ("Cache Test", NAME_STR(area));
+    ASSERT(area->min_vnum == 9900);
+    ASSERT(area->max_vnum == 9909);
+    ASSERT(area->reset_thresh == 4);
+
+    RoomData* entry = global_room_get(9900);
+    ASSERT_OR_GOTO(entry != NULL, cleanup);
+    ASSERT(entry->area_data == area);
+    ASSERT_STR_EQ("Cache Entry", NAME_STR(entry));
+    ASSERT_OR_GOTO(entry->exit_data[DIR_NORTH] != NULL, cleanup);
+    ASSERT(entry->exit_data[DIR_NORTH]->to_vnum == 9901);
+    ASSERT(IS_SET(entry->exit_data[DIR_NORTH]->exit_reset_flags, EX_ISDOOR));
+    ASSERT(IS_SET(entry->exit_data[DIR_NORTH]->exit_reset_flags, EX_CLOSED));
+    ASSERT_STR_EQ("door", entry->exit_data[DIR_NORTH]->keyword);
+    ASSERT_OR_GOTO(entry->extra_desc != NULL, cleanup);
+    ASSERT_STR_EQ("shelves", entry->extra_desc->keyword);
+    ASSERT_OR_GOTO(entry->reset_first != NULL, cleanup);
+    ASSERT(entry->reset_first->command == 'M');
+    ASSERT(entry->reset_first->arg1 == 9900);
+    ASSERT(entry->reset_first->next == NULL);
+
+    RoomData* vault = global_room_get(9901);
+    ASSERT_OR_GOTO(vault != NULL, cleanup);
+    ASSERT_OR_GOTO(vault->reset_first != NULL, cleanup);
+    ASSERT(vault->reset_first->command == 'O');
+
+    MobPrototype* mob = global_mob_proto_get(9900);
+    ASSERT_OR_GOTO(mob != NULL, cleanup);
+    ASSERT(mob->area == area);
+    ASSERT_STR_EQ("the cache clerk", mob->short_descr);
+    ASSERT(mob->level == 5);
+    ASSERT(mob->wealth == 25);
+    ASSERT_OR_GOTO(mob->mprogs != NULL, cleanup);
+    ASSERT(mob->mprogs->vnum == 9900);
+    ASSERT_STR_EQ("hello", mob->mprogs->trig_phrase);
+    ASSERT_OR_GOTO(mob->pShop != NULL, cleanup);
+    ASSERT(mob->pShop->buy_type[0] == 15);
+    ASSERT(mob->pShop->profit_buy == 120);
+    ASSERT(shop_first == mob->pShop);
+
+    ObjPrototype* obj = global_obj_proto_get(9900);
+    ASSERT_OR_GOTO(obj != NULL, cleanup);
+    ASSERT(obj->area == area);
+    ASSERT_STR_EQ("a cache box", obj->short_descr);
+    ASSERT(obj->weight == 5);
+    ASSERT(obj->cost == 40);
+    ASSERT_OR_GOTO(obj->affected != NULL, cleanup);
+    ASSERT(obj->affected->location == 18);
+    ASSERT(obj->affected->modifier == 2);
+    ASSERT_OR_GOTO(obj->extra_desc != NULL, cleanup);
+    ASSERT_STR_EQ("box", obj->extra_desc->keyword);
+
+    ASSERT_OR_GOTO(mprog_list != NULL, cleanup);
+    ASSERT(mprog_list->vnum == 9900);
+
+    // Saving what was loaded from the image must reproduce the image.
+    ASSERT_OR_GOTO(save_binary(area, &second), cleanup);
+    const char* first_diff = NULL;
+    ASSERT(area_binary_diff(first.data, first.len, second.data, second.len, &first_diff) == 0);
+    ASSERT(first.len == second.len);
+
+cleanup:
+    cache_state_end(&snap);
+    free(first.data);
+    free(second.data);
+    return 0;
+}
+
+// The leading fields of the image header, down to the string and area
+// section entries, so tests can damage a record in place.
+typedef struct image_prefix_t {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t source_hash;
+    uint64_t build_id;
+    uint32_t section_count;
+    uint32_t total_size;
+    struct {
+        uint32_t count;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t reserved;
+    } sections[2];
+} ImagePrefix;
+
+static int test_binary_key_and_validation()
+{
+    CacheStateSnapshot snap;
+    PersistBufferWriter image = { 0 };
+
+    cache_state_begin(&snap);
+    ASSERT_OR_GOTO(load_rom_text(CACHE_AREA_TEXT), cleanup);
+    ASSERT_OR_GOTO(save_binary(LAST_AREA_DATA, &image), cleanup);
+    cache_state_end(&snap);
+
+    AreaBinaryKey key = { 0 };
+    ASSERT(area_binary_read_key(image.data, image.len, &key));
+    ASSERT(key.build_id == area_binary_build_id());
+    ASSERT(key.source_hash == 0);
+
+    AreaBinaryKey stamped = {
+        .source_hash = area_binary_hash_bytes(CACHE_AREA_TEXT, strlen(CACHE_AREA_TEXT), 0),
+        .build_id = key.build_id,
+    };
+    ASSERT(area_binary_stamp_key(image.data, image.len, &stamped));
+    ASSERT(area_binary_read_key(image.data, image.len, &key));
+    ASSERT(key.source_hash == stamped.source_hash);
+    ASSERT(key.source_hash != area_binary_hash_bytes("x", 1, 0));
+
+    // A truncated image is rejected before anything is created.
+    cache_state_begin(&snap);
+    PersistResult result = load_binary(image.data, image.len / 2);
+    ASSERT(!persist_succeeded(result));
+    ASSERT(global_areas.count == 0);
+
+    // So is an image from a different build.
+    stamped.build_id ^= 1;
+    ASSERT(area_binary_stamp_key(image.data, image.len, &stamped));
+    result = load_binary(image.data, image.len);
+    ASSERT(result.status == PERSIST_ERR_UNSUPPORTED);
+    ASSERT(global_areas.count == 0);
+    stamped.build_id ^= 1;
+    ASSERT(area_binary_stamp_key(image.data, image.len, &stamped));
+
+    // And so is one with a string reference past the end of the string
+    // table; the area record's name is its first field.
+    ImagePrefix prefix;
+    memcpy(&prefix, image.data, sizeof(prefix));
+    uint32_t bad_ref = prefix.sections[0].size + 64;
+    memcpy(image.data + prefix.sections[1].offset, &bad_ref, sizeof(bad_ref));
+    result = load_binary(image.data, image.len);
+    ASSERT(result.status == PERSIST_ERR_FORMAT);
+    ASSERT(global_areas.count == 0);
+    ASSERT(global_room_get(9900) == NULL);
+
+cleanup:
+    cache_state_end(&snap);
+    free(image.data);
+    return 0;
+}
+
+static int test_binary_skips_areas_with_helps()
+{
+    CacheStateSnapshot snap;
+    PersistBufferWriter image = { 0 };
+
+    cache_state_begin(&snap);
+    ASSERT_OR_GOTO(load_rom_text(CACHE_AREA_TEXT), cleanup);
+
+    AreaData* area = LAST_AREA_DATA;
+    ASSERT(area_binary_can_save(area));
+
+    HelpArea* help_area = new_help_area();
+    HelpData* help = new_help_data();
+    help->keyword = str_dup("CACHE");
+    help->text = str_dup("Nothing to see.\n");
+    help_area->first = help;
+    help_area->last = help;
+    area->helps = help_area;
+
+    ASSERT(!area_binary_can_save(area));
+    PersistWriter writer = persist_writer_from_buffer(&image, "cache.are.arc");
+    AreaPersistSaveParams params = { .writer = &writer, .area = area, .file_name = "cache.are" };
+    PersistResult result = AREA_PERSIST_BINARY.save(&params);
+    ASSERT(result.status == PERSIST_ERR_UNSUPPORTED);
+    ASSERT(image.len == 0);
+
+    area->helps = NULL;
+
+cleanup:
+    cache_state_end(&snap);
+    free(image.data);
+    return 0;
+}
+
+// Loads 'text' through area_cache_load() into a throwaway world. Returns true
+// if the load worked and room 9900 came back named 'entry_name'.
+static bool cache_load_text(const char* text, const char* entry_name)
+{
+    FILE* fp = tmpfile();
+    if (!fp)
+        return false;
+    fwrite(text, 1, strlen(text), fp);
+    rewind(fp);
+
+    CacheStateSnapshot snap;
+    cache_state_begin(&snap);
+
+    PersistReader reader = persist_reader_from_file(fp, "cache.are");
+    AreaPersistLoadParams params = {
+        .reader = &reader,
+        .file_name = "cache.are",
+        .create_single_instance = false,
+    };
+    PersistResult result = area_cache_load(&AREA_PERSIST_ROM_OLC, &params);
+    RoomData* entry = global_room_get(9900);
+    bool ok = persist_succeeded(result) && entry != NULL
+        && !strcmp(NAME_STR(entry), entry_name);
+
+    cache_state_end(&snap);
+    fclose(fp);
+    return ok;
+}
+
+// Overwrites the first 'from' in the file at 'path' with 'to', which must be
+// the same length.
+static bool patch_file(const char* path, const char* from, const char* to)
+{
+    FILE* fp = fopen(path, "r+b");
+    if (!fp)
+        return false;
+
+    char buf[16 * 1024];
+    size_t len = fread(buf, 1, sizeof(buf), fp);
+    size_t from_len = strlen(from);
+    bool found = false;
+    for (size_t i = 0; !found && i + from_len <= len; i++) {
+        if (memcmp(buf + i, from, from_len) == 0) {
+            fseek(fp, (long)i, SEEK_SET);
+            fwrite(to, 1, from_len, fp);
+            found = true;
+        }
+    }
+    fclose(fp);
+    return found;
+}
+
+static int test_cache_hit_miss_and_stale()
+{
+    char old_dir[MIL];
+    snprintf(old_dir, sizeof(old_dir), "%s", cfg_get_area_cache_dir());
+    bool old_cache = cfg_get_area_cache();
+    bool old_verify = cfg_get_area_cache_verify();
+    cfg_set_area_cache_dir(cfg_get_temp_dir());
+    cfg_set_area_cache(true);
+    cfg_set_area_cache_verify(false);
+
+    char path[MIL * 2];
+    snprintf(path, sizeof(path), "%scache.are.%s", cfg_get_area_cache_dir(), AREA_BINARY_EXT);
+    remove(path);
+
+    // Same length as the original, so only the room name changes.
+    char edited[4096];
+    snprintf(edited, sizeof(edited), "%s", CACHE_AREA_TEXT);
+    char* name = strstr(edited, "Cache Entry~");
+    ASSERT_OR_GOTO(name != NULL, cleanup);
+    memcpy(name, "Cache Lobby", 11);
+
+    const AreaCacheStats* stats = area_cache_stats();
+    AreaCacheStats before = *stats;
+
+    // No image yet: load the source and write one.
+    ASSERT_OR_GOTO(cache_load_text(CACHE_AREA_TEXT, "Cache Entry"), cleanup);
+    ASSERT(stats->misses == before.misses + 1);
+    ASSERT(stats->stale == before.stale);
+    ASSERT(stats->writes == before.writes + 1);
+    ASSERT(stats->hits == before.hits);
+
+    // Unchanged source: the image is used.
+    ASSERT_OR_GOTO(cache_load_text(CACHE_AREA_TEXT, "Cache Entry"), cleanup);
+    ASSERT(stats->hits == before.hits + 1);
+    ASSERT(stats->misses == before.misses + 1);
+    ASSERT(stats->writes == before.writes + 1);
+
+    // Edited source: the image is stale, so the source is loaded and the
+    // image rewritten.
+    ASSERT_OR_GOTO(cache_load_text(edited, "Cache Lobby"), cleanup);
+    ASSERT(stats->misses == before.misses + 2);
+    ASSERT(stats->stale == before.stale + 1);
+    ASSERT(stats->writes == before.writes + 2);
+    ASSERT(stats->hits == before.hits + 1);
+
+    ASSERT_OR_GOTO(cache_load_text(edited, "Cache Lobby"), cleanup);
+    ASSERT(stats->hits == before.hits + 2);
+
+    // Verify mode reloads a current image and leaves it alone when it
+    // matches the source...
+    cfg_set_area_cache_verify(true);
+    ASSERT_OR_GOTO(cache_load_text(edited, "Cache Lobby"), cleanup);
+    ASSERT(stats->mismatches == before.mismatches);
+    ASSERT(stats->writes == before.writes + 2);
+
+    // ...and reports and replaces one that doesn't.
+    ASSERT_OR_GOTO(patch_file(path, "Cache Lobby", "Cache Lobbx"), cleanup);
+    ASSERT_OR_GOTO(cache_load_text(edited, "Cache Lobby"), cleanup);
+    ASSERT(stats->mismatches == before.mismatches + 1);
+    ASSERT(stats->writes == before.writes + 3);
+
+    ASSERT_OR_GOTO(cache_load_text(edited, "Cache Lobby"), cleanup);
+    ASSERT(stats->mismatches == before.mismatches + 1);
+
+cleanup:
+    remove(path);
+    cfg_set_area_cache_dir(old_dir);
+    cfg_set_area_cache(old_cache);
+    cfg_set_area_cache_verify(old_verify);
+    return 0;
+}
+
+void register_area_cache_tests()
+{
+#define REGISTER(n, f)  register_test(&area_cache_tests, (n), (f))
+
+    init_test_group(&area_cache_tests, "AREA CACHE TESTS");
+    register_test_group(&area_cache_tests);
+
+    REGISTER("Binary Area Round Trip", test_binary_round_trip);
+    REGISTER("Binary Area Key And Validation", test_binary_key_and_validation);
+    REGISTER("Binary Area Skips Areas With Helps", test_binary_skips_areas_with_helps);
+    REGISTER("Area Cache Hit, Miss, And Stale", test_cache_hit_miss_and_stale);
+
+#undef REGISTER
+}
+
+#else
+
+void register_area_cache_tests()
+{
+    // The round trip tests load their fixtures with the ROM-OLC format.
+}
+
+#endif // ENABLE_ROM_OLC_PERSISTENCE
@@ -386,9 +386,9 @@ static int test_stop_fighting()
     transfer_mob(victim, room);
     
     // Set up combat
-    ch->fighting = victim;
+    set_fighting(ch, victim);
     ch->position = POS_FIGHTING;
-    victim->fighting = ch;
+    set_fighting(victim, ch);
     victim->position = POS_FIGHTING;
     
     // Stop fighting
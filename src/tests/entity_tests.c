@@ -466,6 +466,48 @@ static int test_reload_room_recreates_from_prototype()
     return 0;
 }
 
+static int test_native_fields_use_shape()
+{
+    Room* room = mock_room(99200, NULL, NULL);
+    Mobile* mob = mock_mob("shapemob", 99200, NULL);
+    mob_to_room(mob, room);
+    mob->hit = 17;
+
+    // Native fields live in the C struct; nothing is stored per-entity.
+    ASSERT(mob->header.fields.count == 0);
+
+    add_global("test_mob", OBJ_VAL(mob));
+
+    const char* src =
+        "var m = test_mob;\n"
+        "print m.hp;\n"
+        "m.hp = 42;\n"
+        "m.short_desc = \"a shaped mob\";\n"
+        "print m.in_room.vnum;\n"
+        "m.mood = \"cheerful\";\n"
+        "print m.mood;\n";
+
+    test_output_buffer = NIL_VAL;
+    InterpretResult result = interpret_code(src);
+    ASSERT(result == INTERPRET_OK);
+    ASSERT_LOX_OUTPUT_EQ("17\n99200\ncheerful\n");
+
+    ASSERT(mob->hit == 42);
+    ASSERT(!str_cmp(mob->short_descr, "a shaped mob"));
+
+    // Only the script-added field went into the per-entity table.
+    ASSERT(mob->header.fields.count == 1);
+
+    // Entity references are read-only.
+    result = interpret_code("test_mob.in_room = nil;\n");
+    ASSERT(result == INTERPRET_RUNTIME_ERROR);
+    ASSERT(mob->in_room == room);
+
+    add_global("test_mob", NIL_VAL);
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
 void register_entity_tests()
 {
 #define REGISTER(n, f)  register_test(&entity_tests, (n), (f))
@@ -487,6 +529,7 @@ void register_entity_tests()
     REGISTER("Multi-Instance Area Exit NULL to_room", test_multi_instance_area_exit_null_to_room);
     REGISTER("Nullified Exit Reseats Single Instance", test_nullified_exit_reseats_single_instance);
     REGISTER("Reload Room Recreates From Prototype", test_reload_room_recreates_from_prototype);
+    REGISTER("Native Fields Use Shape", test_native_fields_use_shape);
 
 #undef REGISTER
 }
\ No newline at end of file
@@ -887,6 +887,192 @@ static int test_obj_dropped_event()
     return 0;
 }
 
+static int test_delay_timers()
+{
+    const char* src =
+        "delay(1, () -> { print \"soon\"; });\n"
+        "var timer_test_h = delay(3, () -> { print \"cancelled\"; });\n"
+        "delay(300, () -> { print \"later\"; });\n"
+        "delay(20000, () -> { print \"much later\"; });\n"
+        "print cancel_delay(timer_test_h);\n"
+        "print cancel_delay(timer_test_h);\n";
+
+    int pending = event_timer_stats()->pending;
+
+    InterpretResult result = interpret_code(src);
+    ASSERT_LOX_OUTPUT_EQ("true\nfalse\n");
+    ASSERT(event_timer_stats()->pending == pending + 3);
+    test_output_buffer = NIL_VAL;
+
+    event_timer_tick();
+    ASSERT_OUTPUT_EQ("soon\n");
+    ASSERT(event_timer_stats()->fired == 1);
+    test_output_buffer = NIL_VAL;
+
+    // The 300-pulse timer is filed on the second level of the wheel, and the
+    // 20000-pulse timer on the third; both have to cascade down in time.
+    for (int i = 2; i < 300; i++)
+        event_timer_tick();
+    ASSERT(IS_NIL(test_output_buffer));
+
+    event_timer_tick();
+    ASSERT_OUTPUT_EQ("later\n");
+    test_output_buffer = NIL_VAL;
+
+    for (int i = 301; i < 20000; i++)
+        event_timer_tick();
+    ASSERT(IS_NIL(test_output_buffer));
+
+    event_timer_tick();
+    ASSERT_OUTPUT_EQ("much later\n");
+    ASSERT(event_timer_stats()->pending == pending);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_delay_owner()
+{
+    Room* room = mock_room(65030, NULL, NULL);
+
+    Mobile* mob = mock_mob("Timekeeper", 65031, NULL);
+    transfer_mob(mob, room);
+
+    const char* event_src =
+        "on_greet(vch) {"
+        "   delay(2, () -> { print \"owned\"; });"
+        "   delay(2, () -> { print \"unowned\"; }, nil);"
+        "}";
+    ObjClass* mob_class = create_entity_class((Entity*)mob,
+        "mob_65031", event_src);
+    mob->header.klass = mob_class;
+    init_entity_class((Entity*)mob);
+
+    Event* greet_event = new_event();
+    greet_event->trigger = TRIG_GREET;
+    greet_event->method_name = lox_string("on_greet");
+    greet_event->criteria = NIL_VAL;
+    add_event((Entity*)mob, greet_event);
+
+    Mobile* ch = mock_player("Visitor");
+    transfer_mob(ch, room);
+    raise_greet_event(ch);
+    ASSERT(mob->header.timers != NULL);
+
+    // The timer set from the mob's own handler dies with the mob.
+    extract_char(mob, true);
+    event_timer_tick();
+    event_timer_tick();
+    ASSERT_OUTPUT_EQ("unowned\n");
+
+    extract_char(ch, true);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_spawn_coroutine()
+{
+    Room* room = mock_room(65050, NULL, NULL);
+
+    Mobile* mob = mock_mob("Patroller", 65051, NULL);
+    transfer_mob(mob, room);
+
+    const char* event_src =
+        "on_greet(vch) {"
+        "   spawn(() -> {"
+        "       for (var i = 1; i <= 3; i++) { print \"step \" + i; yield 2; }"
+        "   });"
+        "}";
+    ObjClass* mob_class = create_entity_class((Entity*)mob,
+        "mob_65051", event_src);
+    mob->header.klass = mob_class;
+    init_entity_class((Entity*)mob);
+
+    Event* greet_event = new_event();
+    greet_event->trigger = TRIG_GREET;
+    greet_event->method_name = lox_string("on_greet");
+    greet_event->criteria = NIL_VAL;
+    add_event((Entity*)mob, greet_event);
+
+    Mobile* ch = mock_player("Visitor");
+    transfer_mob(ch, room);
+    raise_greet_event(ch);
+    raise_greet_event(ch);
+    ASSERT(mob->header.timers != NULL);
+
+    // Both start on the next pulse, then wake every other one.
+    event_timer_tick();
+    ASSERT_OUTPUT_EQ("step 1\nstep 1\n");
+    test_output_buffer = NIL_VAL;
+
+    event_timer_tick();
+    ASSERT(IS_NIL(test_output_buffer));
+    event_timer_tick();
+    ASSERT_OUTPUT_EQ("step 2\nstep 2\n");
+    test_output_buffer = NIL_VAL;
+
+    // They die with the mob.
+    extract_char(mob, true);
+    for (int i = 0; i < 4; i++)
+        event_timer_tick();
+    ASSERT(IS_NIL(test_output_buffer));
+
+    extract_char(ch, true);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_event_index_order()
+{
+    Room* room = mock_room(65040, NULL, NULL);
+
+    Mobile* speaker = mock_mob("Speaker", 65041, NULL);
+    transfer_mob(speaker, room);
+
+    Mobile* listener = mock_mob("Listener", 65042, NULL);
+    transfer_mob(listener, room);
+
+    const char* event_src =
+        "on_zeta(actor, msg) { print \"zeta\"; }"
+        "on_tea(actor, msg) { print \"tea\"; }";
+    ObjClass* listener_class = create_entity_class((Entity*)listener,
+        "mob_65042", event_src);
+    listener->header.klass = listener_class;
+
+    Event* zeta_event = new_event();
+    zeta_event->trigger = TRIG_ACT;
+    zeta_event->method_name = lox_string("on_zeta");
+    zeta_event->criteria = OBJ_VAL(lox_string("zeta"));
+    add_event((Entity*)listener, zeta_event);
+
+    // Pushed to the front, so it's checked first even though "zeta" comes
+    // earlier in the message.
+    Event* tea_event = new_event();
+    tea_event->trigger = TRIG_ACT;
+    tea_event->method_name = lox_string("on_tea");
+    tea_event->criteria = OBJ_VAL(lox_string("tea"));
+    add_event((Entity*)listener, tea_event);
+
+    act("$n says zeta, then tea.", speaker, NULL, listener, TO_VICT);
+    ASSERT_OUTPUT_EQ("tea\n");
+    ASSERT(listener->header.event_index != NULL);
+    test_output_buffer = NIL_VAL;
+
+    // Removing an event rebuilds the index on the next dispatch.
+    remove_event((Entity*)listener, tea_event);
+    act("$n says zeta, then tea.", speaker, NULL, listener, TO_VICT);
+    ASSERT_OUTPUT_EQ("zeta\n");
+    test_output_buffer = NIL_VAL;
+
+    act("$n says nothing of note.", speaker, NULL, listener, TO_VICT);
+    ASSERT(IS_NIL(test_output_buffer));
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
 void register_event_tests()
 {
 #define REGISTER(n, f)  register_test(&event_tests, (n), (f))
@@ -912,6 +1098,10 @@ void register_event_tests()
     REGISTER("TRIG_TAKEN: Obj->Mob", test_obj_taken_event);
     REGISTER("TRIG_GIVEN: Obj->Mob+Mob", test_obj_given_event);
     REGISTER("TRIG_DROPPED: Obj->Mob", test_obj_dropped_event);
+    REGISTER("Event Index: Phrase Order", test_event_index_order);
+    REGISTER("Delay: Timing Wheel", test_delay_timers);
+    REGISTER("Delay: Entity Owner", test_delay_owner);
+    REGISTER("Delay: Spawned Coroutines", test_spawn_coroutine);
 
 #undef REGISTER
 }
@@ -7,6 +7,7 @@
 #include "mock.h"
 
 #include <act_info.h>
+#include <handler.h>
 #include <interp.h>
 #include <update.h>
 
@@ -261,6 +262,74 @@ static int test_lox_faction_relationship_methods()
     return 0;
 }
 
+static int test_room_aggressor_counts()
+{
+    Room* room = mock_room(9700, NULL, NULL);
+    Room* other = mock_room(9701, NULL, NULL);
+    Mobile* player = mock_player("Shepherd");
+    transfer_mob(player, room);
+
+    Faction* herd = faction_create(9702);
+    SET_NAME(herd, lox_string("Herd"));
+
+    Mobile* sheep = mock_mob("Sheep", 9703, NULL);
+    transfer_mob(sheep, room);
+    ASSERT(room->aggressors == 0);
+
+    SET_BIT(sheep->act_flags, ACT_AGGRESSIVE);
+    update_room_aggressor(sheep);
+    ASSERT(room->aggressors == 1);
+
+    // Counted once, however many reasons it has.
+    sheep->faction_vnum = VNUM_FIELD(herd);
+    update_room_aggressor(sheep);
+    ASSERT(room->aggressors == 1);
+
+    transfer_mob(sheep, other);
+    ASSERT(room->aggressors == 0);
+    ASSERT(other->aggressors == 1);
+
+    REMOVE_BIT(sheep->act_flags, ACT_AGGRESSIVE);
+    update_room_aggressor(sheep);
+    ASSERT(other->aggressors == 1);
+
+    sheep->faction_vnum = 0;
+    update_room_aggressor(sheep);
+    ASSERT(other->aggressors == 0);
+
+    return 0;
+}
+
+static int test_faction_set_in_place_aggresses()
+{
+    Room* room = mock_room(9800, NULL, NULL);
+    Mobile* player = mock_player("Heretic");
+    transfer_mob(player, room);
+    add_player_to_list(player->pcdata);
+
+    Faction* zealots = faction_create(9801);
+    SET_NAME(zealots, lox_string("Zealots"));
+    faction_set(player->pcdata, VNUM_FIELD(zealots), -5000);
+
+    Mobile* zealot = mock_mob("Zealot", 9802, NULL);
+    transfer_mob(zealot, room);
+
+    aggr_update();
+    ASSERT(zealot->fighting == NULL);
+
+    add_global("test_zealot", OBJ_VAL(zealot));
+    InterpretResult result = interpret_code("test_zealot.faction = 9801;");
+    ASSERT(result == INTERPRET_OK);
+    add_global("test_zealot", NIL_VAL);
+    ASSERT(room->aggressors == 1);
+
+    aggr_update();
+    ASSERT(zealot->fighting == player);
+
+    remove_player_from_list(player->pcdata);
+    return 0;
+}
+
 static TestGroup faction_tests;
 
 void register_faction_tests()
@@ -274,6 +343,8 @@ void register_faction_tests()
     REGISTER("Reputation Adjusts On Kill", test_reputation_adjust_on_kill);
     REGISTER("Friendly Factions Cannot Be Attacked", test_reputation_blocks_attack);
     REGISTER("Hostile Factions Attack On Sight", test_hostile_mobs_auto_aggress);
+    REGISTER("Rooms Count Their Aggressors", test_room_aggressor_counts);
+    REGISTER("Faction Set In Place Attacks", test_faction_set_in_place_aggresses);
     REGISTER("Lox Reputation Methods", test_lox_reputation_methods);
     REGISTER("Lox Faction Relationship Methods", test_lox_faction_relationship_methods);
 
@@ -1,5 +1,5 @@
 ////////////////////////////////////////////////////////////////////////////////
-// fight_tests.c - Combat command tests (15 tests)
+// fight_tests.c - Combat command tests (19 tests)
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "tests.h"
@@ -8,10 +8,12 @@
 #include "test_registry.h"
 
 #include <combat_ops.h>
+#include <comm.h>
 #include <fight.h>
 #include <handler.h>
 #include <db.h>
 #include <merc.h>
+#include <mob_prog.h>
 #include <rng.h>
 #include <skill_ops.h>
 
@@ -22,6 +24,8 @@
 #include <data/mobile_data.h>
 #include <data/player.h>
 
+#include <string.h>
+
 extern bool test_socket_output_enabled;
 extern Value test_output_buffer;
 
@@ -125,8 +129,8 @@ static int test_flee()
     transfer_mob(mob, room);
     
     // Start combat
-    player->fighting = mob;
-    mob->fighting = player;
+    set_fighting(player, mob);
+    set_fighting(mob, player);
     player->position = POS_FIGHTING;
     mob->position = POS_FIGHTING;
     
@@ -466,8 +470,8 @@ static int test_rescue()
     transfer_mob(mob, room);
     
     // Victim is fighting mob
-    victim->fighting = mob;
-    mob->fighting = victim;
+    set_fighting(victim, mob);
+    set_fighting(mob, victim);
     victim->position = POS_FIGHTING;
     mob->position = POS_FIGHTING;
     
@@ -518,8 +522,8 @@ static int test_surrender()
     transfer_mob(mob, room);
     
     // Start combat
-    player->fighting = mob;
-    mob->fighting = player;
+    set_fighting(player, mob);
+    set_fighting(mob, player);
     player->position = POS_FIGHTING;
     mob->position = POS_FIGHTING;
     
@@ -602,6 +606,228 @@ static int test_flee_not_fighting()
     return 0;
 }
 
+static bool is_combatant(Mobile* ch)
+{
+    for (Mobile* fch = first_combatant(); fch != NULL; fch = fch->combat_next)
+        if (fch == ch)
+            return true;
+    return false;
+}
+
+// set_fighting() and stop_fighting() keep the active-combat registry
+static int test_combat_registry()
+{
+    Room* room = mock_room(60001, NULL, NULL);
+
+    Mobile* a = mock_mob("alpha", 60010, NULL);
+    transfer_mob(a, room);
+    Mobile* b = mock_mob("beta", 60011, NULL);
+    transfer_mob(b, room);
+    Mobile* c = mock_mob("gamma", 60012, NULL);
+    transfer_mob(c, room);
+
+    ASSERT(!is_combatant(a));
+
+    set_fighting(a, b);
+    set_fighting(b, a);
+    set_fighting(c, a);
+    ASSERT(is_combatant(a));
+    ASSERT(is_combatant(b));
+    ASSERT(is_combatant(c));
+    // Newest first
+    ASSERT(first_combatant() == c);
+    ASSERT(c->combat_next == b);
+
+    // Only the one who stopped leaves...
+    stop_fighting(b, false);
+    ASSERT(!is_combatant(b));
+    ASSERT(is_combatant(a));
+    ASSERT(b->fighting == NULL);
+
+    // ...unless everyone fighting them is stopped, too.
+    stop_fighting(a, true);
+    ASSERT(!is_combatant(a));
+    ASSERT(!is_combatant(c));
+    ASSERT(c->fighting == NULL);
+    ASSERT(c->position != POS_FIGHTING);
+
+    // Extraction takes them out as well.
+    set_fighting(a, c);
+    set_fighting(c, a);
+    extract_char(c, true);
+    ASSERT(!is_combatant(a));
+    ASSERT(a->fighting == NULL);
+
+    return 0;
+}
+
+// A combatant extracted mid-round doesn't cost the rest their turn.
+static int test_violence_extraction()
+{
+    Room* room = mock_room(60001, NULL, NULL);
+
+    Mobile* c = mock_mob("gamma", 60012, NULL);
+    c->max_hit = c->hit = 100;
+    transfer_mob(c, room);
+    Mobile* d = mock_mob("delta", 60013, NULL);
+    d->max_hit = d->hit = 100;
+    transfer_mob(d, room);
+
+    // The brute's fight trigger purges its victim right after its attack,
+    // while the victim is the next combatant in line.
+    MobPrototype* proto = mock_mob_proto(60014);
+    Mobile* brute = mock_mob("brute", 60014, proto);
+    brute->max_hit = brute->hit = 100;
+    transfer_mob(brute, room);
+    MobProg* prg = new_mob_prog();
+    prg->vnum = 60014;
+    prg->trig_type = TRIG_FIGHT;
+    prg->trig_phrase = str_dup("101");
+    prg->code = str_dup("mob purge victim\n");
+    proto->mprogs = prg;
+    SET_BIT(proto->mprog_flags, TRIG_FIGHT);
+
+    Mobile* victim = mock_mob("victim", 60015, NULL);
+    victim->max_hit = victim->hit = 100;
+    transfer_mob(victim, room);
+
+    set_fighting(c, d);
+    set_fighting(d, c);
+    set_fighting(victim, brute);
+    set_fighting(brute, victim);
+    ASSERT(first_combatant() == brute);
+    ASSERT(brute->combat_next == victim);
+
+    CombatOps* saved_combat = combat;
+    combat = &mock_combat;
+    reset_mock_combat();
+    set_mock_always_hit(true);
+    set_mock_damage_override(1);
+    set_mock_prevent_death(true);
+
+    test_socket_output_enabled = true;
+    violence_update();
+    test_socket_output_enabled = false;
+    test_output_buffer = NIL_VAL;
+
+    combat = saved_combat;
+
+    ASSERT(brute->fighting == NULL);
+    ASSERT(!is_combatant(brute));
+    ASSERT(c->hit < 100);
+    ASSERT(d->hit < 100);
+    ASSERT(first_combatant() == d);
+    ASSERT(d->combat_next == c);
+
+    stop_fighting(c, true);
+    proto->mprogs = NULL;
+    REMOVE_BIT(proto->mprog_flags, TRIG_FIGHT);
+    free_mob_prog(prg);
+
+    return 0;
+}
+
+extern void dam_message(Mobile* ch, Mobile* victim, int dam, int dt, bool immune);
+
+// Brief players get one line per attacker and victim when the batch closes
+static int test_combat_brief()
+{
+    Room* room = mock_room(60001, NULL, NULL);
+
+    Mobile* ch = mock_player("Bob");
+    ch->position = POS_STANDING;
+    transfer_mob(ch, room);
+
+    Mobile* goblin = mock_mob("goblin", 60002, NULL);
+    goblin->position = POS_STANDING;
+    transfer_mob(goblin, room);
+
+    SET_BIT(ch->comm_flags, COMM_COMBAT_BRIEF);
+
+    test_output_buffer = NIL_VAL;
+    test_socket_output_enabled = true;
+    begin_combat_batch();
+    dam_message(ch, goblin, 10, TYPE_HIT, false);
+    dam_message(ch, goblin, 12, TYPE_HIT, false);
+    dam_message(ch, goblin, 0, TYPE_HIT, false);
+    dam_message(goblin, ch, 0, TYPE_HIT, false);
+    dam_message(goblin, ch, 0, TYPE_HIT, false);
+    ASSERT(IS_NIL(test_output_buffer));
+    end_combat_batch();
+    test_socket_output_enabled = false;
+
+    ASSERT_OUTPUT_EQ("You hit goblin twice for 22 damage, missing once.\n\r"
+        "Goblin misses you twice.\n\r");
+    test_output_buffer = NIL_VAL;
+
+    // Without the flag (or outside a batch), every blow is shown.
+    REMOVE_BIT(ch->comm_flags, COMM_COMBAT_BRIEF);
+    test_socket_output_enabled = true;
+    begin_combat_batch();
+    dam_message(ch, goblin, 10, TYPE_HIT, false);
+    dam_message(ch, goblin, 12, TYPE_HIT, false);
+    end_combat_batch();
+    test_socket_output_enabled = false;
+
+    ASSERT_OUTPUT_CONTAINS("goblin");
+    ASSERT(strstr(AS_CSTRING(test_output_buffer), "damage") == NULL);
+    test_output_buffer = NIL_VAL;
+
+    return 0;
+}
+
+// What a bystander's act trigger says isn't combat, so brief players hear it.
+static int test_combat_brief_trigger()
+{
+    Room* room = mock_room(60001, NULL, NULL);
+
+    Mobile* ch = mock_player("Bob");
+    ch->position = POS_STANDING;
+    SET_BIT(ch->comm_flags, COMM_COMBAT_BRIEF);
+    transfer_mob(ch, room);
+
+    Mobile* goblin = mock_mob("goblin", 60002, NULL);
+    goblin->position = POS_STANDING;
+    transfer_mob(goblin, room);
+
+    MobPrototype* proto = mock_mob_proto(60016);
+    MobProg* prg = new_mob_prog();
+    prg->vnum = 60016;
+    prg->trig_type = TRIG_ACT;
+    prg->trig_phrase = str_dup("goblin");
+    prg->code = str_dup("say That had to hurt.\n");
+    proto->mprogs = prg;
+    SET_BIT(proto->mprog_flags, TRIG_ACT);
+    Mobile* watcher = mock_mob("watcher", 60016, proto);
+    watcher->position = POS_STANDING;
+    transfer_mob(watcher, room);
+
+    test_output_buffer = NIL_VAL;
+    test_socket_output_enabled = true;
+    begin_combat_batch();
+    dam_message(ch, goblin, 10, TYPE_HIT, false);
+    ASSERT_OUTPUT_CONTAINS("That had to hurt.");
+    dam_message(ch, goblin, 12, TYPE_HIT, false);
+    end_combat_batch();
+    test_socket_output_enabled = false;
+
+    // The summary is the only line that names the goblin.
+    const char* out = AS_CSTRING(test_output_buffer);
+    const char* summary = strstr(out, "You hit goblin twice for 22 damage.");
+    ASSERT(summary != NULL);
+    const char* named = strstr(summary, "goblin");
+    ASSERT(strstr(out, "goblin") == named);
+    ASSERT(strstr(named + 1, "goblin") == NULL);
+    ASSERT(act_skip_comm_flags == 0);
+    test_output_buffer = NIL_VAL;
+
+    proto->mprogs = NULL;
+    REMOVE_BIT(proto->mprog_flags, TRIG_ACT);
+    free_mob_prog(prg);
+
+    return 0;
+}
+
 void register_fight_tests()
 {
     TestGroup* group = calloc(1, sizeof(TestGroup));
@@ -630,6 +856,12 @@ void register_fight_tests()
     REGISTER("Rescue: Save ally", test_rescue);
     REGISTER("Surrender: Stop fighting", test_surrender);
 
+    // Violence rounds
+    REGISTER("Combat Registry: Join and leave", test_combat_registry);
+    REGISTER("Combat Registry: Extraction mid-round", test_violence_extraction);
+    REGISTER("Combat Brief: Summarized round", test_combat_brief);
+    REGISTER("Combat Brief: Act triggers still heard", test_combat_brief_trigger);
+
 #undef REGISTER
 
     register_test_group(group);
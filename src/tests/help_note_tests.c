@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/help_note_tests.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+
+#include <entities/help_data.h>
+
+#include <config.h>
+#include <db.h>
+#include <note.h>
+
+#include <stdio.h>
+#include <string.h>
+
+TestGroup help_note_tests;
+
+void load_thread(const char* name, NoteData** list, int16_t type, time_t free_time);
+
+static HelpData* add_test_help(const char* keyword)
+{
+    HelpData* help = new_help_data();
+    help->level = 0;
+    help->keyword = str_dup(keyword);
+    help->text = str_dup("Test help.\n\r");
+    help->next = NULL;
+
+    if (help_last)
+        help_last->next = help;
+    if (help_first == NULL)
+        help_first = help;
+    help_last = help;
+
+    return help;
+}
+
+static int test_find_helps_by_prefix()
+{
+    HelpData* saved_last = help_last;
+    HelpData* alpha = add_test_help("'ZZINDEX ALPHA' ZZALPHA");
+    HelpData* beta = add_test_help("ZZINDEXBETA");
+
+    int count;
+    HelpData** helps = find_helps("zzind", &count);
+    ASSERT_OR_GOTO(count == 2, cleanup);
+    ASSERT_OR_GOTO(helps[0] == alpha && helps[1] == beta, cleanup);
+
+    helps = find_helps("zzindex alpha", &count);
+    ASSERT_OR_GOTO(count == 1 && helps[0] == alpha, cleanup);
+
+    helps = find_helps("zzalpha", &count);
+    ASSERT_OR_GOTO(count == 1 && helps[0] == alpha, cleanup);
+
+    find_helps("zzindexgamma", &count);
+    ASSERT_OR_GOTO(count == 0, cleanup);
+
+cleanup:
+    if (saved_last)
+        saved_last->next = NULL;
+    else
+        help_first = NULL;
+    help_last = saved_last;
+    free_help_data(alpha);
+    free_help_data(beta);
+    return 0;
+}
+
+static int test_note_text_read_on_demand()
+{
+    char original_area_dir[MIL];
+    snprintf(original_area_dir, sizeof(original_area_dir), "%s", cfg_get_area_dir());
+    const char* temp_dir = cfg_get_temp_dir();
+    char note_path[MIL];
+    snprintf(note_path, sizeof(note_path), "%s%s", temp_dir, cfg_get_note_file());
+
+    FILE* fp = fopen(note_path, "w");
+    ASSERT(fp != NULL);
+    fprintf(fp, "Sender  Tester~\nDate    Today~\nStamp   1\nTo      all~\n"
+        "Subject First~\nText\nThe first body.\n~\n"
+        "Sender  Tester~\nDate    Today~\nStamp   2\nTo      all~\n"
+        "Subject Second~\nText\nThe second body.\n~\n");
+    fclose(fp);
+
+    cfg_set_area_dir(temp_dir);
+
+    NoteData* list = NULL;
+    load_thread(cfg_get_note_file(), &list, NOTE_NOTE, 0);
+    ASSERT_OR_GOTO(list != NULL && list->next != NULL, cleanup);
+    ASSERT_OR_GOTO(list->text == NULL && list->next->text == NULL, cleanup);
+    ASSERT_STR_EQ("Second", list->next->subject);
+
+    ASSERT_STR_EQ("The second body.\n\r", note_text(list->next));
+    ASSERT_STR_EQ("The first body.\n\r", note_text(list));
+    ASSERT_OR_GOTO(list->text != NULL, cleanup);
+
+cleanup:
+    remove(note_path);
+    cfg_set_area_dir(original_area_dir);
+    return 0;
+}
+
+void register_help_note_tests()
+{
+#define REGISTER(name, func) register_test(&help_note_tests, name, func)
+
+    init_test_group(&help_note_tests, "HELP AND NOTE TESTS");
+    register_test_group(&help_note_tests);
+
+    REGISTER("Help: Find Helps By Prefix", test_find_helps_by_prefix);
+    REGISTER("Note: Text Read On Demand", test_note_text_read_on_demand);
+
+#undef REGISTER
+}
@@ -5,17 +5,37 @@
 // Test generic language extensions to the Lox interpreter for Mud98.
 
 #include "lox_tests.h"
+#include "mock.h"
 
+#include <command.h>
+#include <config.h>
 #include <db.h>
 
 #include <lox/array.h>
+#include <lox/bytecode.h>
+#include <lox/compiler.h>
+#include <lox/function.h>
+#include <lox/list.h>
+#include <lox/lox.h>
+#include <lox/memory.h>
 #include <lox/object.h>
 #include <lox/scanner.h>
 #include <lox/value.h>
 #include <lox/vm.h>
 
+#include <entities/entity.h>
+#include <entities/room.h>
+
+#include <sys/stat.h>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#endif
+
 TestGroup lox_ext_tests;
 
+extern Table global_const_table;
+
 static int test_array_access()
 {
     const char* src =
@@ -362,7 +382,7 @@ static int test_const_2()
     ASSERT_LOX_OUTPUT_EQ("3\n"
         "== <script> ==\n"
         "0000    3 OP_CONSTANT         0 2\n"
-        "0002    | OP_CONSTANT         1 1\n"
+        "0002    | OP_ADD_CONSTANT     1 1\n"   // Fused with the OP_ADD below.
         "0004    | OP_ADD\n"
         "0005    4 OP_GET_LOCAL        1\n"
         "0007    | OP_PRINT\n"
@@ -518,6 +538,490 @@ static int test_array_class_member()
     return 0;
 }
 
+static int test_inline_cache_sites()
+{
+    // Each of call() and count() is a single call site that sees several
+    // receiver kinds; the cached lookups must keep resolving correctly.
+    const char* src =
+        "class A { f() { return 1; } }\n"
+        "class B { f() { return 2; } }\n"
+        "fun call(o) { return o.f(); }\n"
+        "fun count(o) { return o.count; }\n"
+        "var a = A();\n"
+        "var b = B();\n"
+        "print call(a) + call(b) * 10 + call(a) * 100 + call(b) * 1000;\n"
+        "fun three() { return 3; }\n"
+        "var c = A();\n"
+        "c.f = three;\n"
+        "print call(c);\n"
+        "print call(a);\n"
+        "print count([1, 2]) + count([1, 2, 3]);\n";
+
+    InterpretResult result = interpret_code(src);
+    ASSERT(result == INTERPRET_OK);
+    ASSERT_LOX_OUTPUT_EQ("2121\n3\n1\n5\n");
+    test_output_buffer = NIL_VAL;
+
+    // Defining methods invalidates every cache.
+    uint32_t epoch = vm.ic_epoch;
+    result = interpret_code(
+        "class A { f() { return 4; } }\n"
+        "print call(A());\n"
+        "print call(a);\n");
+    ASSERT(result == INTERPRET_OK);
+    ASSERT(vm.ic_epoch != epoch);
+    ASSERT_LOX_OUTPUT_EQ("4\n1\n");
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_superinstructions()
+{
+    // Exercises every fused pair and global call form, including a jump
+    // ('and' short-circuiting) that lands on the second half of a fused pair.
+    const char* src =
+        "class P { init(x) { this.x = x; } }\n"
+        "fun zero() { return 0; }\n"
+        "fun add(a, b) { return a + b; }\n"
+        "{\n"
+        "    var t = zero();\n"
+        "    for (var i = 0; i < 5; i = i + 1) t = t + 2;\n"
+        "    var j = 5;\n"
+        "    while (j > 0) j = j - 1;\n"
+        "    if (t == 10) print \"ten\"; else print \"not ten\";\n"
+        "    var p = P(add(t, 1));\n"
+        "    print p.x;\n"
+        "    print \"s\" + 1;\n"
+        "    print floor(2.5 + 1);\n"
+        "    if (false and 1 < 2) print \"wrong\"; else print \"short\";\n"
+        "    print j;\n"
+        "}\n";
+
+    InterpretResult result = interpret_code(src);
+    ASSERT(result == INTERPRET_OK);
+    ASSERT_LOX_OUTPUT_EQ("ten\n11\ns1\n3\nshort\n0\n");
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+// Compiles 'src' into a bytecode image, recording its const dependencies.
+static bool compile_image(const char* src, BytecodeBuffer* image)
+{
+    BytecodeKey key = { bytecode_build_id(), bytecode_source_hash(src, 0) };
+    CompileDeps deps;
+
+    init_compile_deps(&deps);
+    record_compile_deps(&deps);
+    ObjFunction* function = compile(src);
+    record_compile_deps(NULL);
+
+    bool ok = function != NULL
+        && write_bytecode_image(image, &key, function, &deps);
+    free_compile_deps(&deps);
+    return ok;
+}
+
+static int test_bytecode_round_trip()
+{
+    // Nested functions, closures, classes, and every kind of constant.
+    const char* src =
+        "class Counter {\n"
+        "    init(step) { this.n = 0; this.step = step; }\n"
+        "    bump() { this.n = this.n + this.step; return this.n; }\n"
+        "}\n"
+        "fun make(prefix) {\n"
+        "    fun label(n) { return \"${prefix}:${n}\"; }\n"
+        "    return label;\n"
+        "}\n"
+        "{\n"
+        "    var c = Counter(2);\n"
+        "    c.bump();\n"
+        "    var f = make(\"bc\");\n"
+        "    print f(c.bump());\n"
+        "    print 1.5 * 2;\n"
+        "    print nil == false;\n"
+        "}\n";
+
+    BytecodeBuffer image = { 0 };
+    ASSERT(compile_image(src, &image));
+
+    BytecodeKey key;
+    ASSERT(read_bytecode_key(image.data, image.len, &key));
+    ASSERT(key.build_id == bytecode_build_id());
+    ASSERT(key.source_hash == bytecode_source_hash(src, 0));
+    ASSERT(key.source_hash != bytecode_source_hash(src, BYTECODE_REPL));
+
+    bool stale = true;
+    ObjFunction* function = load_bytecode_image(image.data, image.len, &stale);
+    ASSERT(function != NULL);
+    ASSERT(!stale);
+
+    InterpretResult result = interpret_function(function);
+    ASSERT_LOX_OUTPUT_EQ("bc:4\n3\nfalse\n");
+    test_output_buffer = NIL_VAL;
+
+    // A damaged image is rejected rather than run.
+    image.data[image.len / 2] ^= 0x5a;
+    ASSERT(load_bytecode_image(image.data, image.len, &stale) == NULL);
+    ASSERT(!stale);
+
+    free_bytecode_buffer(&image);
+    return 0;
+}
+
+static int test_bytecode_const_deps()
+{
+    ObjString* limit = lox_string("BcLimit");
+    ObjString* kind = lox_string("BcKind");
+    Value value;
+
+    ASSERT(interpret_code("const BcLimit = 5\n") == INTERPRET_OK);
+
+    // Reads BcLimit (folded into the code) and defines BcKind.
+    const char* src =
+        "enum BcKind { BcSmall, BcLarge = 10 }\n"
+        "print BcLimit + BcKind.BcLarge;\n";
+
+    BytecodeBuffer image = { 0 };
+    ASSERT(compile_image(src, &image));
+    table_delete(&global_const_table, kind);
+
+    // Loading defines BcKind again, as compiling would have.
+    bool stale = true;
+    ObjFunction* function = load_bytecode_image(image.data, image.len, &stale);
+    ASSERT(function != NULL);
+    ASSERT(table_get(&global_const_table, kind, &value) && IS_ENUM(value));
+    InterpretResult result = interpret_function(function);
+    ASSERT_LOX_OUTPUT_EQ("15\n");
+    test_output_buffer = NIL_VAL;
+
+    // Once a const it read changes, the image is stale.
+    table_delete(&global_const_table, kind);
+    table_set(&global_const_table, limit, INT_VAL(6));
+    ASSERT(load_bytecode_image(image.data, image.len, &stale) == NULL);
+    ASSERT(stale);
+    ASSERT(!table_get(&global_const_table, kind, &value));
+
+    table_delete(&global_const_table, limit);
+    table_delete(&global_const_table, lox_string("BcSmall"));
+    table_delete(&global_const_table, lox_string("BcLarge"));
+    free_bytecode_buffer(&image);
+    return 0;
+}
+
+static bool on_object_list(Obj* target)
+{
+    for (Obj* object = vm.objects; object != NULL; object = object->next)
+        if (object == target)
+            return true;
+    return false;
+}
+
+static bool is_black(Obj* object)
+{
+    if (object->mark_id != vm.current_gc_mark)
+        return false;
+    for (int i = 0; i < vm.gray_count; i++)
+        if (vm.gray_stack[i] == object)
+            return false;
+    return true;
+}
+
+static int test_incremental_gc_barrier()
+{
+    // 'kept' sits at the end of a long chain of arrays, so the collector
+    // reaches it late. Once 'b' has been traced, 'kept' is moved there and
+    // its only other reference dropped; only the write barrier keeps it alive.
+    ValueArray* holder = new_obj_array();
+    gc_protect(OBJ_VAL(holder));
+
+    ValueArray* chain = new_obj_array();
+    write_value_array(holder, OBJ_VAL(chain));
+    List* b = new_list();
+    write_value_array(holder, OBJ_VAL(b));
+    for (int i = 0; i < 2000; i++) {
+        ValueArray* link = new_obj_array();
+        write_value_array(chain, OBJ_VAL(link));
+        chain = link;
+    }
+    List* a = new_list();
+    write_value_array(chain, OBJ_VAL(a));
+
+    ValueArray* kept = new_obj_array();
+    list_push(a, OBJ_VAL(kept));
+    ValueArray* dropped = new_obj_array();
+
+    int old_slice = cfg_get_gc_slice_usec();
+    cfg_set_gc_slice_usec(1);
+
+    uint64_t cycles = gc_stats.cycles;
+    collect_garbage();
+    while (gc_stats.cycles == cycles
+        && !(is_black((Obj*)b) && a->obj.mark_id != vm.current_gc_mark))
+        collect_garbage_step();
+    bool moved_mid_cycle = gc_stats.cycles == cycles;
+
+    list_push(b, list_pop(a));
+    for (int i = 0; i < 100000 && gc_stats.cycles == cycles; i++)
+        collect_garbage_step();
+
+    cfg_set_gc_slice_usec(old_slice);
+
+    ASSERT(moved_mid_cycle);
+    ASSERT(gc_stats.cycles > cycles);
+    ASSERT(on_object_list((Obj*)kept));
+    ASSERT(!on_object_list((Obj*)dropped));
+    ASSERT(gc_stats.last_freed_objects > 0);
+
+    gc_protect_clear();
+    return 0;
+}
+
+static int test_incremental_gc_entity_store()
+{
+    // As above, but the new reference is stored from C into an entity that
+    // has already been traced, the way OLC assigns a freshly compiled class.
+    Room* room = mock_room(50000, NULL, NULL);
+
+    // Globals are marked before the mocks, so the chain is traced last.
+    ValueArray* chain = new_obj_array();
+    add_global("gc_entity_chain", OBJ_VAL(chain));
+    for (int i = 0; i < 2000; i++) {
+        ValueArray* link = new_obj_array();
+        write_value_array(chain, OBJ_VAL(link));
+        chain = link;
+    }
+    List* a = new_list();
+    write_value_array(chain, OBJ_VAL(a));
+
+    ObjClass* klass = new_class(copy_string("BarrierClass", 12));
+    list_push(a, OBJ_VAL(klass));
+
+    int old_slice = cfg_get_gc_slice_usec();
+    cfg_set_gc_slice_usec(1);
+
+    uint64_t cycles = gc_stats.cycles;
+    collect_garbage();
+    while (gc_stats.cycles == cycles
+        && !(is_black((Obj*)room) && a->obj.mark_id != vm.current_gc_mark))
+        collect_garbage_step();
+    bool moved_mid_cycle = gc_stats.cycles == cycles;
+
+    set_entity_class(&room->header, AS_CLASS(list_pop(a)));
+    for (int i = 0; i < 100000 && gc_stats.cycles == cycles; i++)
+        collect_garbage_step();
+
+    cfg_set_gc_slice_usec(old_slice);
+
+    ASSERT(moved_mid_cycle);
+    ASSERT(gc_stats.cycles > cycles);
+    ASSERT(on_object_list((Obj*)klass));
+    ASSERT(room->header.klass == klass);
+
+    room->header.klass = NULL;
+    add_global("gc_entity_chain", NIL_VAL);
+    return 0;
+}
+
+static int test_script_budget()
+{
+    int budget = cfg_get_lox_budget();
+    cfg_set_lox_budget(10000);
+
+    InterpretResult result = interpret_code("while (true) {}");
+    ASSERT(result == INTERPRET_RUNTIME_ERROR);
+    ASSERT_OUTPUT_CONTAINS("budget");
+    test_output_buffer = NIL_VAL;
+
+    // Recursion that never loops is caught at the calls.
+    result = interpret_code(
+        "fun budget_fib(n) {\n"
+        "    if (n < 2) return n;\n"
+        "    return budget_fib(n - 1) + budget_fib(n - 2);\n"
+        "}\n"
+        "budget_fib(30);\n");
+    ASSERT(result == INTERPRET_RUNTIME_ERROR);
+    test_output_buffer = NIL_VAL;
+
+    Value fib;
+    ASSERT(table_get(&vm.globals, lox_string("budget_fib"), &fib));
+    ASSERT(IS_CLOSURE(fib));
+    ASSERT(AS_CLOSURE(fib)->function->profile.aborts == 1);
+
+    // Each run gets a fresh budget.
+    result = interpret_code("budget_fib(5);");
+    ASSERT(result == INTERPRET_OK);
+
+    cfg_set_lox_budget(budget);
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_class_budget_reload()
+{
+    char old_data_dir[MIL];
+    snprintf(old_data_dir, sizeof(old_data_dir), "%s", cfg_get_data_dir());
+    cfg_set_data_dir(cfg_get_temp_dir());
+#ifndef _MSC_VER
+    mkdir(cfg_get_data_dir(), 0775);
+#else
+    _mkdir(cfg_get_data_dir());
+#endif
+
+    Room* room = mock_room(50200, NULL, NULL);
+    ObjClass* klass = create_entity_class(&room->header, "budget_reload_room",
+        "spin() { var i = 0; while (i < 1000) i = i + 1; }");
+    ASSERT_OR_GOTO(klass != NULL, cleanup);
+    set_entity_class(&room->header, klass);
+
+    Value spin;
+    ASSERT_OR_GOTO(table_get(&klass->methods, lox_string("spin"), &spin), cleanup);
+    ObjFunction* function = AS_CLOSURE(spin)->function;
+
+    set_class_budget(klass->name, 500);
+    save_class_budgets();
+
+    // A reboot starts without any class budgets and reads them back in.
+    set_class_budget(klass->name, -1);
+    invoke_method_closure(OBJ_VAL(room), AS_CLOSURE(spin), 0);
+    ASSERT(function->profile.aborts == 0);
+
+    load_class_budgets();
+    ASSERT(get_class_budget(klass->name) == 500);
+    invoke_method_closure(OBJ_VAL(room), AS_CLOSURE(spin), 0);
+    ASSERT(function->profile.aborts == 1);
+
+cleanup:
+    set_class_budget(lox_string("budget_reload_room"), -1);
+    char path[MIL * 2];
+    snprintf(path, sizeof(path), "%s%s", cfg_get_data_dir(), cfg_get_lox_budget_file());
+    remove(path);
+    cfg_set_data_dir(old_data_dir);
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_script_profile()
+{
+    InterpretResult result = interpret_code(
+        "fun profiled_fn(n) { var l = [n, n]; return l[0] + l[1]; }\n"
+        "for (var i = 0; i < 3; i++) profiled_fn(i);\n");
+    ASSERT(result == INTERPRET_OK);
+
+    Value fn;
+    ASSERT(table_get(&vm.globals, lox_string("profiled_fn"), &fn));
+    ASSERT(IS_CLOSURE(fn));
+
+    const ScriptProfile* profile = &AS_CLOSURE(fn)->function->profile;
+    ASSERT(profile->calls == 3);
+    ASSERT(profile->instructions >= 3 * 5);
+    ASSERT(profile->allocations >= 3);
+    ASSERT(profile->aborts == 0);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static void find_object(Obj* object, void* data)
+{
+    Obj** target = data;
+    if (object == *target)
+        *target = NULL;
+}
+
+// Halfway through a sweep, live functions are on the collector's lists rather
+// than vm.objects. The profile must still see them, and 'reset' clear them.
+static int test_script_profile_mid_sweep()
+{
+    InterpretResult result = interpret_code(
+        "fun swept_fn() { return 1; }\n"
+        "swept_fn();\n");
+    ASSERT(result == INTERPRET_OK);
+
+    Value fn;
+    ASSERT(table_get(&vm.globals, lox_string("swept_fn"), &fn));
+    ObjFunction* function = AS_CLOSURE(fn)->function;
+    ASSERT(function->profile.calls == 1);
+
+    Mobile* ch = mock_player("Profiler");
+
+    int old_slice = cfg_get_gc_slice_usec();
+    cfg_set_gc_slice_usec(1);
+
+    uint64_t cycles = gc_stats.cycles;
+    collect_garbage();
+    while (gc_stats.cycles == cycles && on_object_list((Obj*)function))
+        collect_garbage_step();
+    bool mid_sweep = gc_stats.cycles == cycles;
+
+    Obj* target = (Obj*)function;
+    for_each_object(find_object, &target);
+    bool found = target == NULL;
+
+    do_lox(ch, "profile reset");
+    uint64_t calls = function->profile.calls;
+
+    for (int i = 0; i < 100000 && gc_stats.cycles == cycles; i++)
+        collect_garbage_step();
+    cfg_set_gc_slice_usec(old_slice);
+
+    ASSERT(mid_sweep);
+    ASSERT(found);
+    ASSERT(calls == 0);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
+static int test_coroutines()
+{
+    // Locals, shared upvalues, and the values passed each way all survive
+    // being suspended.
+    InterpretResult result = interpret_code(
+        "fun counter(start) {\n"
+        "    var n = start;\n"
+        "    var peek = () -> { return n; };\n"
+        "    while (true) {\n"
+        "        var step = yield n;\n"
+        "        n = n + step;\n"
+        "        print peek();\n"
+        "    }\n"
+        "}\n"
+        "var co = coroutine(counter);\n"
+        "print co(10);\n"
+        "print co(5);\n"
+        "print co(2);\n"
+        "fun twice() { yield 1; yield 2; return 3; }\n"
+        "var gen = coroutine(twice);\n"
+        "var outer = coroutine(() -> {\n"
+        "    while (!gen.done) yield gen() * 10;\n"
+        "});\n"
+        "print outer();\n"
+        "print outer();\n"
+        "print outer();\n"
+        "print gen.done;\n");
+    ASSERT_LOX_OUTPUT_EQ("10\n15\n15\n17\n17\n10\n20\n30\ntrue\n");
+    test_output_buffer = NIL_VAL;
+
+    result = interpret_code("gen();");
+    ASSERT(result == INTERPRET_RUNTIME_ERROR);
+    ASSERT_OUTPUT_CONTAINS("finished coroutine");
+    test_output_buffer = NIL_VAL;
+
+    result = interpret_code("fun no_co() { yield 1; } no_co();");
+    ASSERT(result == INTERPRET_RUNTIME_ERROR);
+    ASSERT_OUTPUT_CONTAINS("outside a coroutine");
+    test_output_buffer = NIL_VAL;
+
+    result = interpret_code("yield 1;");
+    ASSERT(result == INTERPRET_COMPILE_ERROR);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
 void register_lox_ext_tests()
 {
 #define REGISTER(n, f)  register_test(&lox_ext_tests, (n), (f))
@@ -543,6 +1047,17 @@ void register_lox_ext_tests()
     REGISTER("Constant Values #1", test_const_1);
     REGISTER("Constant Values #2", test_const_2);
     REGISTER("Constant Folding", test_const_folding);
+    REGISTER("Incremental GC: Write Barrier", test_incremental_gc_barrier);
+    REGISTER("Incremental GC: Entity Store", test_incremental_gc_entity_store);
+    REGISTER("Inline Caches: Call Sites", test_inline_cache_sites);
+    REGISTER("Superinstructions", test_superinstructions);
+    REGISTER("Bytecode Image: Round Trip", test_bytecode_round_trip);
+    REGISTER("Bytecode Image: Const Dependencies", test_bytecode_const_deps);
+    REGISTER("Script Budget", test_script_budget);
+    REGISTER("Script Budget: Saved Class Budgets", test_class_budget_reload);
+    REGISTER("Coroutines", test_coroutines);
+    REGISTER("Script Profile", test_script_profile);
+    REGISTER("Script Profile: Mid-Sweep", test_script_profile_mid_sweep);
     REGISTER("Enum: Auto-Increment", test_enum_auto);
     REGISTER("Enum: Assign", test_enum_assign);
     REGISTER("Enum: Boot Vals", test_enum_bootval);
@@ -1,5 +1,5 @@
 ////////////////////////////////////////////////////////////////////////////////
-// magic_tests.c - Tests for magic item usage (3 tests)
+// magic_tests.c - Tests for magic item usage (4 tests)
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "tests.h"
@@ -14,6 +14,7 @@
 #include <merc.h>
 #include <skill_ops.h>
 
+#include <entities/affect.h>
 #include <entities/mobile.h>
 #include <entities/object.h>
 #include <entities/room.h>
@@ -180,6 +181,70 @@ static int test_zap_wand()
     return 0;
 }
 
+// is_affected() answers from the skill bits; they must follow the list.
+static int test_affect_skill_index()
+{
+    Room* room = mock_room(60001, NULL, NULL);
+    Mobile* ch = mock_player("sleeper");
+    transfer_mob(ch, room);
+
+    Affect af = { 0 };
+    af.where = TO_AFFECTS;
+    af.type = gsn_sleep;
+    af.level = 10;
+    af.duration = 5;
+    af.location = APPLY_NONE;
+    af.bitvector = AFF_SLEEP;
+
+    ASSERT(!is_affected(ch, gsn_sleep));
+    affect_to_mob(ch, &af);
+    affect_to_mob(ch, &af);
+    ASSERT(is_affected(ch, gsn_sleep));
+    ASSERT(!is_affected(ch, gsn_blindness));
+
+    // One of two gone still leaves the other.
+    affect_remove(ch, ch->affected);
+    ASSERT(is_affected(ch, gsn_sleep));
+    affect_remove(ch, ch->affected);
+    ASSERT(!is_affected(ch, gsn_sleep));
+    ASSERT(!IS_AFFECTED(ch, AFF_SLEEP));
+
+    // Joining onto nothing just adds it.
+    af.duration = 3;
+    affect_join(ch, &af);
+    affect_join(ch, &af);
+    ASSERT(is_affected(ch, gsn_sleep));
+    ASSERT(ch->affected->duration == 6);
+    ASSERT(ch->affected->next == NULL);
+
+    affect_strip(ch, gsn_blindness);
+    ASSERT(is_affected(ch, gsn_sleep));
+    affect_strip(ch, gsn_sleep);
+    ASSERT(!is_affected(ch, gsn_sleep));
+    ASSERT(ch->affected == NULL);
+
+    // Types past the bits are looked up in the list.
+    af.type = AFFECT_SKILL_BITS + 1;
+    af.bitvector = 0;
+    affect_to_mob(ch, &af);
+    ASSERT(is_affected(ch, AFFECT_SKILL_BITS + 1));
+    affect_strip(ch, AFFECT_SKILL_BITS + 1);
+    ASSERT(!is_affected(ch, AFFECT_SKILL_BITS + 1));
+
+    // Loaders link affects in directly, then rebuild.
+    Affect* loaded = new_affect();
+    loaded->type = gsn_blindness;
+    loaded->location = APPLY_NONE;
+    loaded->next = ch->affected;
+    ch->affected = loaded;
+    rebuild_affect_index(ch);
+    ASSERT(is_affected(ch, gsn_blindness));
+    affect_remove(ch, loaded);
+    ASSERT(!is_affected(ch, gsn_blindness));
+
+    return 0;
+}
+
 void register_magic_tests()
 {
     TestGroup* group = calloc(1, sizeof(TestGroup));
@@ -190,6 +255,7 @@ void register_magic_tests()
     REGISTER("Recite: Scroll", test_recite_scroll);
     REGISTER("Brandish: Staff", test_brandish_staff);
     REGISTER("Zap: Wand", test_zap_wand);
+    REGISTER("Affects: Skill index", test_affect_skill_index);
 
 #undef REGISTER
 
@@ -0,0 +1,357 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/mob_prog_tests.c
+//
+// Compiled MOBprogs are checked against program_flow(): each program is run
+// both ways from the same RNG state, and must say the same things and leave
+// the same target behind.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+#include "mock.h"
+
+#include <db.h>
+#include <handler.h>
+#include <mob_prog.h>
+#include <rng.h>
+
+#include <entities/mobile.h>
+#include <entities/room.h>
+
+#include <string.h>
+
+TestGroup mob_prog_tests;
+
+static char* run_captured(bool compiled, char* source, Mobile* mob,
+    Mobile* ch, const void* arg1, const void* arg2)
+{
+    reset_mock_rng();
+    mob->mprog_target = NULL;
+
+    test_output_buffer = NIL_VAL;
+    test_socket_output_enabled = true;
+    if (compiled) {
+        MobProgram* program = compile_mob_prog(65100, source);
+        execute_mob_program(program, mob, ch, arg1, arg2);
+        free_mob_program(program);
+    }
+    else
+        program_flow(65100, source, mob, ch, arg1, arg2);
+    test_socket_output_enabled = false;
+
+    char* out = strdup(IS_STRING(test_output_buffer)
+        ? AS_CSTRING(test_output_buffer) : "");
+    test_output_buffer = NIL_VAL;
+    return out;
+}
+
+// Runs 'source' through both interpreters; returns what they said (if they
+// agreed), for the caller to free.
+static char* run_both(char* source, Mobile* mob, Mobile* ch,
+    const void* arg1, const void* arg2)
+{
+    RngOps* saved_rng = rng;
+    rng = &mock_rng;
+
+    char* text = run_captured(false, source, mob, ch, arg1, arg2);
+    Mobile* text_target = mob->mprog_target;
+    char* compiled = run_captured(true, source, mob, ch, arg1, arg2);
+    Mobile* compiled_target = mob->mprog_target;
+
+    rng = saved_rng;
+
+    ASSERT_STR_EQ(text, compiled);
+    ASSERT(text_target == compiled_target);
+
+    free(compiled);
+    return text;
+}
+
+static Mobile* setup_guard(Room* room)
+{
+    Mobile* guard = mock_mob("guard", 65101, NULL);
+    guard->position = POS_STANDING;
+    transfer_mob(guard, room);
+    return guard;
+}
+
+static Mobile* setup_player(Room* room, int level)
+{
+    Mobile* ch = mock_player("Bob");
+    ch->level = (LEVEL)level;
+    ch->position = POS_STANDING;
+    transfer_mob(ch, room);
+    return ch;
+}
+
+static int test_commands()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+    Mobile* ch = setup_player(room, 5);
+
+    char* out = run_both(
+        "* A comment\n"
+        "say Hello, $n.\n\r"
+        "   say Indented line\n"
+        "mob echo The guard looks at $N.\n"
+        "emote nods.\n",
+        guard, ch, NULL, NULL);
+
+    ASSERT(strstr(out, "Hello, Bob.") != NULL);
+    ASSERT(strstr(out, "Indented line") != NULL);
+    ASSERT(strstr(out, "The guard looks at Bob.") != NULL);
+    free(out);
+
+    return 0;
+}
+
+static int test_nested_blocks()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+
+    char* source =
+        "if ispc $n\n"
+        "  say player\n"
+        "  if level $n >= 10\n"
+        "    say high\n"
+        "    if level $n > 20\n"
+        "      say very high\n"
+        "    endif\n"
+        "  else\n"
+        "    say low\n"
+        "  endif\n"
+        "else\n"
+        "  say npc\n"
+        "endif\n"
+        "say done\n";
+
+    Mobile* novice = setup_player(room, 5);
+    char* out = run_both(source, guard, novice, NULL, NULL);
+    ASSERT(strstr(out, "low") != NULL);
+    ASSERT(strstr(out, "high") == NULL);
+    ASSERT(strstr(out, "done") != NULL);
+    free(out);
+
+    Mobile* veteran = setup_player(room, 30);
+    out = run_both(source, guard, veteran, NULL, NULL);
+    ASSERT(strstr(out, "very high") != NULL);
+    free(out);
+
+    Mobile* rat = mock_mob("rat", 65102, NULL);
+    transfer_mob(rat, room);
+    out = run_both(source, guard, rat, NULL, NULL);
+    ASSERT(strstr(out, "npc") != NULL);
+    ASSERT(strstr(out, "player") == NULL);
+    free(out);
+
+    return 0;
+}
+
+static int test_logic_and_rand()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+    Mobile* ch = setup_player(room, 5);
+
+    char* out = run_both(
+        "if isnpc not $n\n"
+        "and people > 0\n"
+        "or hour == 99\n"
+        "  say one\n"
+        "endif\n"
+        "if isnpc $n\n"
+        "or ispc not not $n\n"
+        "  say two\n"
+        "endif\n"
+        "if ispc $n\n"
+        "and people > 5\n"
+        "  say three\n"
+        "endif\n"
+        "if rand 60\n"
+        "  say lucky\n"
+        "else\n"
+        "  say unlucky\n"
+        "endif\n"
+        "if rand 60\n"
+        "  say lucky again\n"
+        "endif\n"
+        "say chosen $r\n",
+        guard, ch, NULL, NULL);
+
+    ASSERT(strstr(out, "one") != NULL);
+    ASSERT(strstr(out, "two") != NULL);
+    ASSERT(strstr(out, "three") == NULL);
+    free(out);
+
+    return 0;
+}
+
+static int test_checks()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+    Mobile* ch = setup_player(room, 12);
+
+    ObjPrototype* proto = mock_obj_proto(65110);
+    Object* sword = mock_obj("sword", 65110, proto);
+    obj_to_char(sword, ch);
+
+    char* out = run_both(
+        "if carries $n sword\n  say carries name\nendif\n"
+        "if carries $n 65110\n  say carries vnum\nendif\n"
+        "if carries $n 65111\n  say wrong vnum\nendif\n"
+        "if name $n bob\n  say named\nendif\n"
+        "if name $o sword\n  say object named\nendif\n"
+        "if pos $n standing\n  say standing\nendif\n"
+        "if vnum $i == 65101\n  say my vnum\nendif\n"
+        "if vnum $o == 65110\n  say its vnum\nendif\n"
+        "if objhere sword\n  say nothing here\nendif\n"
+        "if mobhere 65101\n  say me here\nendif\n"
+        "if players == 1\n  say one player\nendif\n"
+        "if affected $n blind\n  say blind\nendif\n"
+        "if hastarget $i\n  say targeting\nendif\n"
+        "if istarget $n\n  say is target\nendif\n",
+        guard, ch, sword, NULL);
+
+    ASSERT(strstr(out, "carries name") != NULL);
+    ASSERT(strstr(out, "wrong vnum") == NULL);
+    ASSERT(strstr(out, "named") != NULL);
+    ASSERT(strstr(out, "object named") != NULL);
+    ASSERT(strstr(out, "standing") != NULL);
+    ASSERT(strstr(out, "my vnum") != NULL);
+    ASSERT(strstr(out, "its vnum") != NULL);
+    ASSERT(strstr(out, "nothing here") == NULL);
+    ASSERT(strstr(out, "me here") != NULL);
+    ASSERT(strstr(out, "one player") != NULL);
+    ASSERT(strstr(out, "blind") == NULL);
+    ASSERT(strstr(out, "is target") != NULL);
+    ASSERT(guard->mprog_target == ch);
+    free(out);
+
+    return 0;
+}
+
+static int test_break()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+    Mobile* ch = setup_player(room, 5);
+
+    char* out = run_both(
+        "if isnpc $n\n"
+        "  break\n"
+        "endif\n"
+        "say before\n"
+        "if ispc $n\n"
+        "  end\n"
+        "endif\n"
+        "say after\n",
+        guard, ch, NULL, NULL);
+
+    ASSERT(strstr(out, "before") != NULL);
+    ASSERT(strstr(out, "after") == NULL);
+    free(out);
+
+    return 0;
+}
+
+static int test_errors()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+    Mobile* ch = setup_player(room, 5);
+
+    char* sources[] = {
+        // Bad checks are false, but the program carries on.
+        "if level $n ~ 3\n  say bad oper\nendif\n"
+        "if people\n  say empty\nendif\n"
+        "if isnpc foo\n  say bad actor\nendif\n"
+        "if isnpc $z\n  say bad code\nendif\n"
+        "if isnpc not\n  say negated nothing\nendif\n"
+        "say still running\n",
+        // These stop it.
+        "say first\nif bogus $n\n  say never\nendif\nsay never\n",
+        "say first\nendif\nsay never\n",
+        "say first\nelse\nsay never\n",
+        "say first\nor ispc $n\nsay never\n",
+        "say first\n"
+        "if ispc $n\nif ispc $n\nif ispc $n\nif ispc $n\nif ispc $n\n"
+        "if ispc $n\nif ispc $n\nif ispc $n\nif ispc $n\nif ispc $n\n"
+        "if ispc $n\nif ispc $n\nsay never\n",
+    };
+
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        char* out = run_both(sources[i], guard, ch, NULL, NULL);
+        ASSERT(strstr(out, "never") == NULL);
+        if (i == 0) {
+            ASSERT(strstr(out, "negated nothing") != NULL);
+            ASSERT(strstr(out, "still running") != NULL);
+        }
+        else
+            ASSERT(strstr(out, "first") != NULL);
+        free(out);
+    }
+
+    // An aborted program has to leave room for the next one.
+    for (int i = 0; i < 10; i++) {
+        char* out = run_both("say first\nendif\n", guard, ch, NULL, NULL);
+        free(out);
+    }
+    char* out = run_both("say still here\n", guard, ch, NULL, NULL);
+    ASSERT(strstr(out, "still here") != NULL);
+    free(out);
+
+    return 0;
+}
+
+static int test_recompile()
+{
+    Room* room = mock_room(65100, NULL, NULL);
+    Mobile* guard = setup_guard(room);
+    Mobile* ch = setup_player(room, 5);
+
+    MobProg* prg = new_mob_prog();
+    prg->vnum = 65100;
+    prg->code = str_dup("say old code\n");
+
+    test_socket_output_enabled = true;
+    run_mob_prog(prg, guard, ch, NULL, NULL);
+    test_socket_output_enabled = false;
+    ASSERT_OUTPUT_CONTAINS("old code");
+    test_output_buffer = NIL_VAL;
+    ASSERT(prg->program != NULL);
+
+    free_string(prg->code);
+    prg->code = str_dup("say new code\n");
+    recompile_mob_prog(prg);
+
+    test_socket_output_enabled = true;
+    run_mob_prog(prg, guard, ch, NULL, NULL);
+    test_socket_output_enabled = false;
+    ASSERT_OUTPUT_CONTAINS("new code");
+    test_output_buffer = NIL_VAL;
+
+    free_mob_prog(prg);
+
+    return 0;
+}
+
+void register_mob_prog_tests()
+{
+#define REGISTER(n, f)  register_test(&mob_prog_tests, (n), (f))
+
+    init_test_group(&mob_prog_tests, "MOBPROG TESTS");
+    register_test_group(&mob_prog_tests);
+
+    REGISTER("Compiled: Commands", test_commands);
+    REGISTER("Compiled: Nested Blocks", test_nested_blocks);
+    REGISTER("Compiled: Logic and Rand", test_logic_and_rand);
+    REGISTER("Compiled: Checks", test_checks);
+    REGISTER("Compiled: Break", test_break);
+    REGISTER("Compiled: Errors", test_errors);
+    REGISTER("Compiled: Recompile", test_recompile);
+
+#undef REGISTER
+}
@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/olc_asave_tests.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+#include "mock.h"
+
+#include <olc/area_save_queue.h>
+
+#include <config.h>
+#include <db.h>
+
+#include <stdio.h>
+#include <string.h>
+
+TestGroup olc_asave_tests;
+
+static int test_queued_save_written_after_flush()
+{
+    char original_area_dir[MIL];
+    snprintf(original_area_dir, sizeof(original_area_dir), "%s", cfg_get_area_dir());
+    const char* temp_dir = cfg_get_temp_dir();
+    char area_path[MIL];
+    snprintf(area_path, sizeof(area_path), "%s%s", temp_dir, "asave_queue.are");
+    remove(area_path);
+
+    AreaData* area = mock_area_data();
+    free_string(area->file_name);
+    area->file_name = str_dup("asave_queue.are");
+    SET_NAME(area, lox_string("Queued Save"));
+    area->min_vnum = 9950;
+    area->max_vnum = 9959;
+
+    cfg_set_area_dir(temp_dir);
+
+    AreaSaveBatch* batch = begin_area_save_batch(NULL);
+    ASSERT_OR_GOTO(batch != NULL, cleanup);
+    bool queued = queue_area_save(batch, area);
+    end_area_save_batch(batch);
+    ASSERT_OR_GOTO(queued, cleanup);
+
+    // The snapshot is already taken; later edits must not reach the file.
+    SET_NAME(area, lox_string("Edited After Snapshot"));
+
+    flush_area_saves();
+    ASSERT_OR_GOTO(pending_area_saves() == 0, cleanup);
+
+    FILE* fp = fopen(area_path, "r");
+    ASSERT_OR_GOTO(fp != NULL, cleanup);
+    char contents[4096];
+    size_t len = fread(contents, 1, sizeof(contents) - 1, fp);
+    contents[len] = '\0';
+    fclose(fp);
+
+    ASSERT_OR_GOTO(strstr(contents, "Queued Save") != NULL, cleanup);
+    ASSERT_OR_GOTO(strstr(contents, "Edited After Snapshot") == NULL, cleanup);
+
+cleanup:
+    remove(area_path);
+    cfg_set_area_dir(original_area_dir);
+    return 0;
+}
+
+void register_olc_asave_tests()
+{
+#define REGISTER(name, func) register_test(&olc_asave_tests, name, func)
+
+    init_test_group(&olc_asave_tests, "OLC ASAVE TESTS");
+    register_test_group(&olc_asave_tests);
+
+    REGISTER("ASave: Queued Save Written After Flush", test_queued_save_written_after_flush);
+
+#undef REGISTER
+}
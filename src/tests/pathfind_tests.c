@@ -0,0 +1,551 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/pathfind_tests.c
+//
+// Searches on random grids are checked against a brute-force BFS and
+// Dijkstra over the same edges; the rest covers doors, sectors, graph changes
+// and the commands built on find_path().
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+#include "mock.h"
+#include "mock_skill_ops.h"
+
+#include <act_move.h>
+#include <db.h>
+#include <handler.h>
+#include <lookup.h>
+#include <mob_cmds.h>
+#include <pathfind.h>
+#include <rng.h>
+#include <skill_ops.h>
+
+#include <entities/mobile.h>
+#include <entities/object.h>
+#include <entities/room.h>
+#include <entities/room_exit.h>
+
+#include <data/direction.h>
+
+#include <lox/vm.h>
+
+#include <limits.h>
+
+TestGroup pathfind_tests;
+
+#define GRID_SIDE   6
+#define GRID_ROOMS  (GRID_SIDE * GRID_SIDE)
+#define UNREACHED   INT_MAX
+
+typedef struct {
+    Room* rooms[GRID_ROOMS];
+    int edge[GRID_ROOMS][DIR_MAX];      // Index of the room it leads to, or -1
+} Grid;
+
+static Room* grid_room(Area* area, VNUM vnum, Sector sector)
+{
+    Room* room = mock_room(vnum, NULL, area);
+    room->data->sector_type = sector;
+    return room;
+}
+
+// Every room is linked to its neighbors; with 'one_way' set, each direction of
+// each link is kept (or dropped) on its own.
+static void make_grid(Grid* grid, RngContext* ctx, bool one_way, bool sectors)
+{
+    Area* area = mock_area(mock_area_data());
+
+    for (int i = 0; i < GRID_ROOMS; i++) {
+        Sector sector = sectors ? (Sector)rng_range_r(ctx, SECT_INSIDE,
+            SECT_MOUNTAIN) : SECT_CITY;
+        grid->rooms[i] = grid_room(area, 65200 + i, sector);
+        for (int dir = 0; dir < DIR_MAX; dir++)
+            grid->edge[i][dir] = -1;
+    }
+
+    for (int y = 0; y < GRID_SIDE; y++) {
+        for (int x = 0; x < GRID_SIDE; x++) {
+            int i = y * GRID_SIDE + x;
+            struct { int to; Direction dir; } links[] = {
+                { x + 1 < GRID_SIDE ? i + 1 : -1, DIR_EAST },
+                { y + 1 < GRID_SIDE ? i + GRID_SIDE : -1, DIR_SOUTH },
+            };
+            for (int l = 0; l < 2; l++) {
+                int j = links[l].to;
+                if (j < 0)
+                    continue;
+                Direction dir = links[l].dir;
+                Direction rev = dir_list[dir].rev_dir;
+                if (!one_way || rng_percent_r(ctx) <= 75) {
+                    mock_room_connection(grid->rooms[i], grid->rooms[j], dir,
+                        false);
+                    grid->edge[i][dir] = j;
+                }
+                if (!one_way || rng_percent_r(ctx) <= 75) {
+                    mock_room_connection(grid->rooms[j], grid->rooms[i], rev,
+                        false);
+                    grid->edge[j][rev] = i;
+                }
+            }
+        }
+    }
+}
+
+static int edge_cost(Grid* grid, int from, int to, bool costs)
+{
+    if (!costs)
+        return 1;
+    int move = (movement_loss[grid->rooms[from]->data->sector_type]
+        + movement_loss[grid->rooms[to]->data->sector_type]) / 2;
+    return move < 1 ? 1 : move;
+}
+
+// Distance from every room to 'target', the slow way.
+static void reference_distances(Grid* grid, int target, bool costs,
+    int* dist)
+{
+    bool done[GRID_ROOMS] = { 0 };
+
+    for (int i = 0; i < GRID_ROOMS; i++)
+        dist[i] = UNREACHED;
+    dist[target] = 0;
+
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < GRID_ROOMS; i++)
+            if (!done[i] && dist[i] != UNREACHED
+                && (best < 0 || dist[i] < dist[best]))
+                best = i;
+        if (best < 0)
+            break;
+        done[best] = true;
+
+        for (int i = 0; i < GRID_ROOMS; i++) {
+            for (int dir = 0; dir < DIR_MAX; dir++) {
+                if (grid->edge[i][dir] != best)
+                    continue;
+                int d = dist[best] + edge_cost(grid, i, best, costs);
+                if (d < dist[i])
+                    dist[i] = d;
+            }
+        }
+    }
+}
+
+static int check_grid(Grid* grid, bool costs)
+{
+    FLAGS flags = costs ? PATH_COSTS : 0;
+    int dist[GRID_ROOMS];
+
+    for (int to = 0; to < GRID_ROOMS; to++) {
+        reference_distances(grid, to, costs, dist);
+
+        for (int from = 0; from < GRID_ROOMS; from++) {
+            PathResult path;
+            bool found = find_path(grid->rooms[from], grid->rooms[to], 0,
+                flags, &path);
+
+            ASSERT(found == (dist[from] != UNREACHED));
+            if (!found)
+                continue;
+
+            ASSERT(path.cost == dist[from]);
+            if (from == to) {
+                ASSERT(path.first_dir == -1);
+                continue;
+            }
+
+            // Any first step will do, so long as it's on a shortest path.
+            ASSERT(path.first_dir >= 0 && path.first_dir < DIR_MAX);
+            int next = grid->edge[from][path.first_dir];
+            ASSERT(next >= 0);
+            ASSERT(dist[next] != UNREACHED);
+            ASSERT(edge_cost(grid, from, next, costs) + dist[next]
+                == dist[from]);
+        }
+    }
+
+    return 0;
+}
+
+static int test_random_grids()
+{
+    RngContext ctx;
+    rng_context_seed(&ctx, 45, 1);
+
+    for (int round = 0; round < 4; round++) {
+        Grid grid;
+        make_grid(&grid, &ctx, round > 0, round > 1);
+        ASSERT(check_grid(&grid, false) == 0);
+        ASSERT(check_grid(&grid, true) == 0);
+    }
+
+    return 0;
+}
+
+static int test_limits()
+{
+    RngContext ctx;
+    rng_context_seed(&ctx, 45, 2);
+
+    Grid grid;
+    make_grid(&grid, &ctx, false, false);
+
+    Room* corner = grid.rooms[0];
+    Room* far = grid.rooms[GRID_ROOMS - 1];
+    int steps = 2 * (GRID_SIDE - 1);
+    PathResult path;
+
+    ASSERT(find_path(corner, far, steps, 0, &path));
+    ASSERT(path.steps == steps);
+    ASSERT(path.first_dir == DIR_EAST || path.first_dir == DIR_SOUTH);
+    ASSERT(!find_path(corner, far, steps - 1, 0, &path));
+
+    // City streets cost 2 a step.
+    ASSERT(find_path(corner, far, steps * 2, PATH_COSTS, &path));
+    ASSERT(path.cost == steps * 2);
+    ASSERT(path.steps == steps);
+    ASSERT(!find_path(corner, far, steps * 2 - 1, PATH_COSTS, &path));
+
+    ASSERT(find_path(far, far, 1, 0, &path));
+    ASSERT(path.steps == 0);
+
+    return 0;
+}
+
+// A straight hall, west to east, with a door halfway along; and a long way
+// around to the north.
+static Room* make_hall(Room** rooms, Room** detour, RoomExit** door)
+{
+    Area* area = mock_area(mock_area_data());
+
+    for (int i = 0; i < 3; i++)
+        rooms[i] = grid_room(area, 65250 + i, SECT_INSIDE);
+    for (int i = 0; i < 3; i++)
+        detour[i] = grid_room(area, 65260 + i, SECT_INSIDE);
+
+    mock_room_connection(rooms[0], rooms[1], DIR_EAST, true);
+    mock_room_connection(rooms[1], rooms[2], DIR_EAST, true);
+    mock_room_connection(rooms[0], detour[0], DIR_NORTH, true);
+    mock_room_connection(detour[0], detour[1], DIR_EAST, true);
+    mock_room_connection(detour[1], detour[2], DIR_EAST, true);
+    mock_room_connection(detour[2], rooms[2], DIR_SOUTH, true);
+
+    *door = rooms[0]->exit[DIR_EAST];
+    (*door)->data->keyword = str_dup("door");
+    SET_BIT((*door)->exit_flags, EX_ISDOOR | EX_CLOSED);
+    SET_BIT(rooms[1]->exit[DIR_WEST]->exit_flags, EX_ISDOOR | EX_CLOSED);
+
+    return rooms[2];
+}
+
+static int test_doors()
+{
+    Room* hall[3];
+    Room* detour[3];
+    RoomExit* door;
+    Room* end = make_hall(hall, detour, &door);
+    PathResult path;
+
+    ASSERT(find_path(hall[0], end, 0, 0, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+    ASSERT(path.steps == 4);
+
+    ASSERT(find_path(hall[0], end, 0, PATH_OPEN_DOORS, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+    ASSERT(path.steps == 2);
+
+    // Opening the door costs a little, but not as much as walking around.
+    ASSERT(find_path(hall[0], end, 0, PATH_OPEN_DOORS | PATH_COSTS, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+    ASSERT(path.cost == 3);
+
+    SET_BIT(door->exit_flags, EX_LOCKED);
+    ASSERT(find_path(hall[0], end, 0, PATH_OPEN_DOORS, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+    ASSERT(find_path(hall[0], end, 0, PATH_OPEN_DOORS | PATH_UNLOCK, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+    ASSERT(find_path(hall[0], end, 0, PATH_PASS_DOOR, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+
+    SET_BIT(door->exit_flags, EX_NOPASS);
+    ASSERT(find_path(hall[0], end, 0, PATH_PASS_DOOR, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+
+    // Doors are read as they are, not as they were.
+    REMOVE_BIT(door->exit_flags, EX_CLOSED | EX_LOCKED | EX_NOPASS);
+    ASSERT(find_path(hall[0], end, 0, 0, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+
+    return 0;
+}
+
+static int test_rooms_on_the_way()
+{
+    Room* hall[3];
+    Room* detour[3];
+    RoomExit* door;
+    Room* end = make_hall(hall, detour, &door);
+    PathResult path;
+
+    REMOVE_BIT(door->exit_flags, EX_CLOSED);
+
+    hall[1]->data->sector_type = SECT_AIR;
+    ASSERT(find_path(hall[0], end, 0, 0, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+    ASSERT(find_path(hall[0], end, 0, PATH_FLY, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+
+    hall[1]->data->sector_type = SECT_WATER_NOSWIM;
+    ASSERT(find_path(hall[0], end, 0, 0, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+    ASSERT(find_path(hall[0], end, 0, PATH_SWIM, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+    ASSERT(find_path(hall[0], end, 0, PATH_FLY, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+
+    hall[1]->data->sector_type = SECT_INSIDE;
+    SET_BIT(hall[1]->data->room_flags, ROOM_NO_MOB);
+    ASSERT(find_path(hall[0], end, 0, PATH_AVOID_NO_MOB, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+    // ...unless it's where it's going.
+    ASSERT(find_path(hall[0], hall[1], 0, PATH_AVOID_NO_MOB, &path));
+    ASSERT(path.steps == 1);
+
+    // Player flags follow move_char().
+    Mobile* ch = mock_player("Walker");
+    ch->level = 10;
+    FLAGS flags = path_flags_for(ch);
+    ASSERT(IS_SET(flags, PATH_OPEN_DOORS));
+    ASSERT(!IS_SET(flags, PATH_FLY | PATH_SWIM | PATH_PASS_DOOR));
+
+    ObjPrototype* proto = mock_obj_proto(65270);
+    proto->item_type = ITEM_BOAT;
+    Object* boat = mock_obj("boat", 65270, proto);
+    boat->item_type = ITEM_BOAT;
+    obj_to_char(boat, ch);
+    ASSERT(IS_SET(path_flags_for(ch), PATH_SWIM));
+
+    Mobile* mob = mock_mob("rat", 65271, NULL);
+    ASSERT(IS_SET(path_flags_for(mob), PATH_AVOID_NO_MOB | PATH_FLY));
+
+    return 0;
+}
+
+static int test_graph_changes()
+{
+    Area* area = mock_area(mock_area_data());
+    Room* a = grid_room(area, 65280, SECT_INSIDE);
+    Room* b = grid_room(area, 65281, SECT_INSIDE);
+    Room* c = grid_room(area, 65282, SECT_INSIDE);
+    PathResult path;
+
+    mock_room_connection(a, b, DIR_EAST, true);
+
+    // Ruled out without a search.
+    uint64_t pruned = path_stats()->pruned;
+    ASSERT(!find_path(a, c, 0, PATH_COSTS, &path));
+    ASSERT(!find_path(a, c, 0, 0, &path));
+    ASSERT(path_stats()->pruned > pruned);
+
+    mock_room_connection(b, c, DIR_NORTH, false);
+    ASSERT(find_path(a, c, 0, 0, &path));
+    ASSERT(path.steps == 2);
+    ASSERT(find_path(a, c, 0, PATH_COSTS, &path));
+    ASSERT(path.steps == 2);
+    ASSERT(!find_path(c, a, 0, 0, &path));
+
+    mock_room_connection(a, c, DIR_NORTH, false);
+    ASSERT(find_path(a, c, 0, PATH_COSTS, &path));
+    ASSERT(path.first_dir == DIR_NORTH);
+    ASSERT(path.steps == 1);
+
+    free_room_exit(a->exit[DIR_NORTH]);
+    a->exit[DIR_NORTH] = NULL;
+    free_room_exit(b->exit[DIR_NORTH]);
+    b->exit[DIR_NORTH] = NULL;
+    ASSERT(!find_path(a, c, 0, 0, &path));
+    ASSERT(!find_path(a, c, 0, PATH_COSTS, &path));
+
+    return 0;
+}
+
+// redit's "<dir> room <vnum>" gives the room a new exit, but the old one is
+// still on its old target's inbound list; searches must not walk it.
+static int test_repointed_exit()
+{
+    Area* area = mock_area(mock_area_data());
+    Room* a = grid_room(area, 65290, SECT_INSIDE);
+    Room* b = grid_room(area, 65291, SECT_INSIDE);
+    Room* c = grid_room(area, 65292, SECT_INSIDE);
+    Room* d = grid_room(area, 65293, SECT_INSIDE);
+    Room* e = grid_room(area, 65294, SECT_INSIDE);
+    PathResult path;
+
+    mock_room_connection(a, b, DIR_EAST, false);
+    mock_room_connection(a, d, DIR_NORTH, false);
+    mock_room_connection(a, e, DIR_SOUTH, false);
+    mock_room_connection(d, b, DIR_EAST, false);
+    ASSERT(find_path(a, b, 0, 0, &path));
+    ASSERT(path.steps == 1);
+
+    RoomExitData* exit_data = a->data->exit_data[DIR_EAST];
+    exit_data->to_room = c->data;
+    exit_data->to_vnum = VNUM_FIELD(c->data);
+    a->exit[DIR_EAST] = new_room_exit(exit_data, a);
+
+    for (int i = 0; i < 2; i++) {
+        ASSERT(find_path(a, b, 0, i == 0 ? 0 : PATH_COSTS, &path));
+        ASSERT(path.first_dir == DIR_NORTH);
+        ASSERT(path.steps == 2);
+    }
+    ASSERT(find_path(a, c, 0, 0, &path));
+    ASSERT(path.first_dir == DIR_EAST);
+
+    Mobile* mob = mock_mob("walker", 65290, NULL);
+    transfer_mob(mob, a);
+    ASSERT(move_toward(mob, b, 0));
+    ASSERT(mob->in_room == d);
+
+    return 0;
+}
+
+static int test_track()
+{
+    Area* area = mock_area(mock_area_data());
+    Room* camp = grid_room(area, 65290, SECT_CITY);
+    Room* trail = grid_room(area, 65291, SECT_FOREST);
+    Room* den = grid_room(area, 65292, SECT_FOREST);
+    Room* elsewhere = mock_room(65293, NULL, NULL);
+    mock_room_connection(camp, trail, DIR_NORTH, true);
+    mock_room_connection(trail, den, DIR_EAST, true);
+    mock_room_connection(den, elsewhere, DIR_UP, true);
+
+    Mobile* ch = mock_player("Ranger");
+    ch->ch_class = class_lookup("thief");
+    ch->level = 20;
+    ch->position = POS_STANDING;
+    transfer_mob(ch, camp);
+    mock_skill(ch, gsn_track, 100);
+
+    Mobile* wolf = mock_mob("wargling", 65294, NULL);
+    transfer_mob(wolf, den);
+
+    SkillOps* saved_skill_ops = skill_ops;
+    skill_ops = &mock_skill_ops;
+    set_skill_check_result(gsn_track, true);
+
+    test_socket_output_enabled = true;
+    do_track(ch, "wargling");
+    test_socket_output_enabled = false;
+    ASSERT_OUTPUT_CONTAINS("Wargling is north from here.");
+    test_output_buffer = NIL_VAL;
+
+    // Mortals lose the trail at the edge of the area.
+    transfer_mob(wolf, elsewhere);
+    ch->wait = 0;
+    test_socket_output_enabled = true;
+    do_track(ch, "wargling");
+    test_socket_output_enabled = false;
+    ASSERT_OUTPUT_CONTAINS("wargling from here.");
+    ASSERT_OUTPUT_CONTAINS("You can't find a trail of");
+    test_output_buffer = NIL_VAL;
+
+    transfer_mob(wolf, den);
+    set_skill_check_result(gsn_track, false);
+    ch->wait = 0;
+    test_socket_output_enabled = true;
+    do_track(ch, "wargling");
+    test_socket_output_enabled = false;
+    ASSERT_OUTPUT_CONTAINS("You can't make out the trail.");
+    test_output_buffer = NIL_VAL;
+
+    skill_ops = saved_skill_ops;
+    clear_skill_check_results();
+
+    return 0;
+}
+
+static int test_mob_hunt()
+{
+    Room* hall[3];
+    Room* detour[3];
+    RoomExit* door;
+    Room* end = make_hall(hall, detour, &door);
+
+    Mobile* hunter = mock_mob("hunter", 65295, NULL);
+    hunter->position = POS_STANDING;
+    transfer_mob(hunter, hall[0]);
+
+    Mobile* ch = mock_player("Quarry");
+    transfer_mob(ch, end);
+
+    // The door is on the shortest way, so it gets opened.
+    mob_interpret(hunter, "hunt Quarry");
+    ASSERT(!IS_SET(door->exit_flags, EX_CLOSED));
+    ASSERT(hunter->in_room == hall[1]);
+
+    mob_interpret(hunter, "hunt Quarry");
+    ASSERT(hunter->in_room == end);
+
+    // Already there.
+    mob_interpret(hunter, "hunt Quarry");
+    ASSERT(hunter->in_room == end);
+
+    return 0;
+}
+
+static int test_lox_natives()
+{
+    Room* hall[3];
+    Room* detour[3];
+    RoomExit* door;
+    Room* end = make_hall(hall, detour, &door);
+
+    Mobile* ch = mock_player("Scout");
+    ch->level = 10;
+    transfer_mob(ch, hall[0]);
+
+    ObjString* from_name = copy_string("path_test_from", 14);
+    ObjString* to_name = copy_string("path_test_to", 12);
+    ObjString* mob_name = copy_string("path_test_mob", 13);
+    table_set(&vm.globals, from_name, OBJ_VAL(hall[0]));
+    table_set(&vm.globals, to_name, OBJ_VAL(end));
+    table_set(&vm.globals, mob_name, OBJ_VAL(ch));
+
+    InterpretResult result = interpret_code(
+        "print path_step(path_test_from, path_test_to);"
+        "print path_distance(path_test_from, path_test_to);"
+        "print path_distance(path_test_mob, path_test_to, 1);"
+        "print path_step(path_test_to, path_test_to);"
+        "print path_distance(path_test_to, path_test_mob);");
+    ASSERT(result == INTERPRET_OK);
+    ASSERT_LOX_OUTPUT_EQ("east\n2\nnil\nnil\n2\n");
+    test_output_buffer = NIL_VAL;
+
+    table_delete(&vm.globals, from_name);
+    table_delete(&vm.globals, to_name);
+    table_delete(&vm.globals, mob_name);
+
+    return 0;
+}
+
+void register_pathfind_tests()
+{
+#define REGISTER(n, f)  register_test(&pathfind_tests, (n), (f))
+
+    init_test_group(&pathfind_tests, "PATHFIND TESTS");
+    register_test_group(&pathfind_tests);
+
+    REGISTER("Path: Random Grids", test_random_grids);
+    REGISTER("Path: Limits", test_limits);
+    REGISTER("Path: Doors", test_doors);
+    REGISTER("Path: Rooms on the Way", test_rooms_on_the_way);
+    REGISTER("Path: Graph Changes", test_graph_changes);
+    REGISTER("Path: Repointed Exit", test_repointed_exit);
+    REGISTER("Path: Track", test_track);
+    REGISTER("Path: Mob Hunt", test_mob_hunt);
+    REGISTER("Path: Lox Natives", test_lox_natives);
+
+#undef REGISTER
+}
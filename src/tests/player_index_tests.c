@@ -0,0 +1,223 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/player_index_tests.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+#include "mock.h"
+
+#include <config.h>
+#include <db.h>
+#include <player_index.h>
+#include <save.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static TestGroup player_index_tests;
+
+static int test_index_tracks_saves_and_deletes()
+{
+    const char* temp_dir = "temp/player_index_tests/";
+    const char* temp_dir_no_slash = "temp/player_index_tests";
+    char old_player_dir[MIL];
+    snprintf(old_player_dir, sizeof(old_player_dir), "%s", cfg_get_player_dir());
+#ifndef _MSC_VER
+    mkdir("temp", 0775);
+    mkdir(temp_dir, 0775);
+#else
+    _mkdir("temp");
+    _mkdir(temp_dir);
+#endif
+
+    cfg_set_player_dir(temp_dir);
+    char index_file[MIL];
+    snprintf(index_file, sizeof(index_file), "%s%s", temp_dir, cfg_get_player_index_file());
+
+    ASSERT_OR_GOTO(rebuild_player_index() == 0, cleanup);
+    ASSERT_OR_GOTO(player_index_ready(), cleanup);
+    ASSERT_OR_GOTO(!player_file_exists("IndexUser"), cleanup);
+
+    Mobile* player = mock_player("IndexUser");
+    player->level = 12;
+    bool prev_output = test_output_enabled;
+    test_output_enabled = false;
+    save_char_obj(player);
+    test_output_enabled = prev_output;
+
+    const PlayerIndexEntry* entry = player_index_lookup("indexuser");
+    ASSERT_OR_GOTO(entry != NULL && entry->level == 12, cleanup);
+    ASSERT_OR_GOTO(player_file_exists("IndexUser"), cleanup);
+
+    // Reading the journal back gives the same answer...
+    load_player_index();
+    entry = player_index_lookup("IndexUser");
+    ASSERT_OR_GOTO(entry != NULL && entry->level == 12, cleanup);
+
+    // ...and so does rebuilding it from the player files.
+    remove(index_file);
+    ASSERT_OR_GOTO(rebuild_player_index() == 1, cleanup);
+    entry = player_index_lookup("IndexUser");
+    ASSERT_OR_GOTO(entry != NULL && entry->level == 12, cleanup);
+
+    delete_player_file("IndexUser");
+    ASSERT_OR_GOTO(player_index_lookup("IndexUser") == NULL, cleanup);
+    load_player_index();
+    ASSERT_OR_GOTO(!player_file_exists("IndexUser"), cleanup);
+    ASSERT_OR_GOTO(player_index_count() == 0, cleanup);
+
+cleanup:
+    delete_player_file("IndexUser");
+    remove(index_file);
+#ifndef _MSC_VER
+    rmdir(temp_dir_no_slash);
+#else
+    _rmdir(temp_dir_no_slash);
+#endif
+    cfg_set_player_dir(old_player_dir);
+    ASSERT(!player_index_ready());
+
+    return 0;
+}
+
+// A player file the index never heard about (lost journal append, crash after
+// the save) must still count as an existing player, and gets indexed again.
+static int test_index_finds_unrecorded_files()
+{
+    const char* temp_dir = "temp/player_index_tests/";
+    const char* temp_dir_no_slash = "temp/player_index_tests";
+    char old_player_dir[MIL];
+    snprintf(old_player_dir, sizeof(old_player_dir), "%s", cfg_get_player_dir());
+#ifndef _MSC_VER
+    mkdir("temp", 0775);
+    mkdir(temp_dir, 0775);
+#else
+    _mkdir("temp");
+    _mkdir(temp_dir);
+#endif
+
+    cfg_set_player_dir(temp_dir);
+    char index_file[MIL];
+    snprintf(index_file, sizeof(index_file), "%s%s", temp_dir, cfg_get_player_index_file());
+
+    ASSERT_OR_GOTO(rebuild_player_index() == 0, cleanup);
+
+    Mobile* player = mock_player("LostUser");
+    player->level = 7;
+    bool prev_output = test_output_enabled;
+    test_output_enabled = false;
+    save_char_obj(player);
+    test_output_enabled = prev_output;
+
+    // Lose the record, but keep the player file.
+    FILE* fp = fopen(index_file, "w");
+    ASSERT_OR_GOTO(fp != NULL, cleanup);
+    fclose(fp);
+    load_player_index();
+    ASSERT_OR_GOTO(player_index_ready(), cleanup);
+    ASSERT_OR_GOTO(player_index_count() == 0, cleanup);
+
+    ASSERT_OR_GOTO(player_file_exists("LostUser"), cleanup);
+    const PlayerIndexEntry* entry = player_index_lookup("lostuser");
+    ASSERT_OR_GOTO(entry != NULL && entry->level == 7, cleanup);
+    ASSERT_OR_GOTO(player_index_count() == 1, cleanup);
+
+    // The recovered record was written back to the journal.
+    load_player_index();
+    ASSERT_OR_GOTO(player_index_count() == 1, cleanup);
+
+    // A name with no file anywhere is still missing.
+    ASSERT_OR_GOTO(!player_file_exists("NoSuchUser"), cleanup);
+    ASSERT_OR_GOTO(player_index_count() == 1, cleanup);
+
+cleanup:
+    delete_player_file("LostUser");
+    remove(index_file);
+#ifndef _MSC_VER
+    rmdir(temp_dir_no_slash);
+#else
+    _rmdir(temp_dir_no_slash);
+#endif
+    cfg_set_player_dir(old_player_dir);
+
+    return 0;
+}
+
+// Offline queries load the player's pet along with them; letting it go again
+// must leave the pet prototype's count where it was.
+static int test_offline_pet_count()
+{
+    const char* temp_dir = "temp/player_index_tests/";
+    const char* temp_dir_no_slash = "temp/player_index_tests";
+    char old_player_dir[MIL];
+    snprintf(old_player_dir, sizeof(old_player_dir), "%s", cfg_get_player_dir());
+#ifndef _MSC_VER
+    mkdir("temp", 0775);
+    mkdir(temp_dir, 0775);
+#else
+    _mkdir("temp");
+    _mkdir(temp_dir);
+#endif
+
+    cfg_set_player_dir(temp_dir);
+    char index_file[MIL];
+    snprintf(index_file, sizeof(index_file), "%s%s", temp_dir, cfg_get_player_index_file());
+    rebuild_player_index();
+
+    Room* room = mock_room(60320, NULL, NULL);
+    MobPrototype* proto = mock_mob_proto(60321);
+    Mobile* player = mock_player("PetOwner");
+    Mobile* pet = mock_mob("loyal hound", 60321, proto);
+    transfer_mob(player, room);
+    transfer_mob(pet, room);
+    player->pet = pet;
+
+    bool prev_output = test_output_enabled;
+    test_output_enabled = false;
+    save_char_obj(player);
+    test_output_enabled = prev_output;
+
+    const PlayerIndexEntry* entry = player_index_lookup("PetOwner");
+    ASSERT_OR_GOTO(entry != NULL, cleanup);
+
+    int count = proto->count;
+    Mobile* offline = load_offline_player("PetOwner", entry->format);
+    ASSERT_OR_GOTO(offline != NULL && offline->pet != NULL, cleanup);
+    ASSERT_OR_GOTO(proto->count == count + 1, cleanup);
+    free_offline_player(offline);
+    ASSERT_OR_GOTO(proto->count == count, cleanup);
+
+cleanup:
+    player->pet = NULL;
+    delete_player_file("PetOwner");
+    remove(index_file);
+#ifndef _MSC_VER
+    rmdir(temp_dir_no_slash);
+#else
+    _rmdir(temp_dir_no_slash);
+#endif
+    cfg_set_player_dir(old_player_dir);
+
+    return 0;
+}
+
+void register_player_index_tests()
+{
+#define REGISTER(name, func) register_test(&player_index_tests, name, func)
+
+    init_test_group(&player_index_tests, "PLAYER INDEX TESTS");
+    register_test_group(&player_index_tests);
+
+    REGISTER("Player Index: Tracks Saves And Deletes", test_index_tracks_saves_and_deletes);
+    REGISTER("Player Index: Finds Unrecorded Player Files", test_index_finds_unrecorded_files);
+    REGISTER("Player Index: Offline Pets Keep Prototype Counts", test_offline_pet_count);
+
+#undef REGISTER
+}
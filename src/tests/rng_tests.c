@@ -0,0 +1,232 @@
+////////////////////////////////////////////////////////////////////////////////
+// tests/rng_tests.c
+//
+// RNG contexts: seeded and split streams must be reproducible, and the
+// production ops must draw exactly what the explicit-context calls do.
+////////////////////////////////////////////////////////////////////////////////
+
+#include "tests.h"
+#include "test_registry.h"
+
+#include <rng.h>
+
+#include <string.h>
+
+#ifndef _MSC_VER
+#include <pthread.h>
+#endif
+
+TestGroup rng_tests;
+
+#define DRAWS 64
+
+static int test_seeded_stream()
+{
+    RngContext a, b;
+    pcg32_random_t reference;
+
+    rng_context_seed(&a, 42, 7);
+    rng_context_seed(&b, 42, 7);
+    pcg32_srandom_r(&reference, 42, 7);
+
+    for (int i = 0; i < DRAWS; i++) {
+        uint32_t draw = rng_next_r(&a);
+        ASSERT(draw == rng_next_r(&b));
+        ASSERT(draw == pcg32_random_r(&reference));
+    }
+
+    return 0;
+}
+
+static int test_bound_context()
+{
+    RngOps* saved_rng = rng;
+    rng = &rng_production;
+
+    RngContext bound, copy;
+    rng_context_seed(&bound, 1234, 1);
+    copy = bound;
+
+    RngContext* prev = rng_bind_context(&bound);
+    ASSERT(rng_bound_context() == &bound);
+
+    for (int i = 0; i < DRAWS; i++) {
+        ASSERT(number_range(-5, 17) == rng_range_r(&copy, -5, 17));
+        ASSERT(number_percent() == rng_percent_r(&copy));
+        ASSERT(dice(3, 6) == rng_dice_r(&copy, 3, 6));
+        ASSERT((uint32_t)number_mm() == rng_next_r(&copy));
+    }
+
+    rng_bind_context(prev);
+    rng = saved_rng;
+
+    return 0;
+}
+
+static int test_dice()
+{
+    int sizes[] = { -3, 0, 1, 2, 6, 7, 8, 100 };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        RngContext a, b;
+        rng_context_seed(&a, 99, 3);
+        rng_context_seed(&b, 99, 3);
+
+        for (int number = 0; number < 5; number++) {
+            int size = sizes[i];
+            int expected = 0;
+            if (size == 0)
+                expected = 0;
+            else if (size == 1)
+                expected = number;
+            else {
+                for (int d = 0; d < number; d++)
+                    expected += rng_range_r(&b, 1, size);
+            }
+            ASSERT(rng_dice_r(&a, number, size) == expected);
+        }
+
+        ASSERT(rng_next_r(&a) == rng_next_r(&b));
+    }
+
+    return 0;
+}
+
+static void draw_children(RngContext* c1, RngContext* c2, uint32_t* out1,
+    uint32_t* out2)
+{
+    for (int i = 0; i < DRAWS; i++)
+        out2[i] = rng_next_r(c2);
+    for (int i = 0; i < DRAWS; i++)
+        out1[i] = rng_next_r(c1);
+}
+
+static int test_split()
+{
+    uint32_t first1[DRAWS], first2[DRAWS];
+    uint32_t second1[DRAWS], second2[DRAWS];
+
+    RngContext parent, c1, c2;
+    rng_context_seed(&parent, 2024, 11);
+    rng_context_split(&parent, 1, &c1);
+    rng_context_split(&parent, 2, &c2);
+    uint32_t parent_next = rng_next_r(&parent);
+    draw_children(&c1, &c2, first1, first2);
+
+    // Same parent, same splits: same children. Drawing from one doesn't move
+    // the parent or its sibling.
+    rng_context_seed(&parent, 2024, 11);
+    rng_context_split(&parent, 1, &c1);
+    rng_context_split(&parent, 2, &c2);
+    for (int i = 0; i < 1000; i++)
+        rng_next_r(&c1);
+    ASSERT(rng_next_r(&parent) == parent_next);
+    draw_children(&c1, &c2, second1, second2);
+
+    ASSERT(memcmp(first2, second2, sizeof(first2)) == 0);
+    ASSERT(memcmp(first1, second1, sizeof(first1)) != 0);
+
+    rng_context_seed(&parent, 2024, 11);
+    rng_context_split(&parent, 1, &c1);
+    rng_context_split(&parent, 2, &c2);
+    draw_children(&c1, &c2, second1, second2);
+    ASSERT(memcmp(first1, second1, sizeof(first1)) == 0);
+
+    // Siblings don't share a sequence.
+    ASSERT(memcmp(first1, first2, sizeof(first1)) != 0);
+
+    return 0;
+}
+
+static int test_batched()
+{
+    RngContext a, b;
+    uint32_t raw[DRAWS];
+    int percents[DRAWS];
+
+    rng_context_seed(&a, 5, 5);
+    rng_context_seed(&b, 5, 5);
+
+    rng_fill_r(&a, raw, DRAWS);
+    for (int i = 0; i < DRAWS; i++)
+        ASSERT(raw[i] == rng_next_r(&b));
+
+    rng_percents_r(&a, percents, DRAWS);
+    for (int i = 0; i < DRAWS; i++) {
+        ASSERT(percents[i] >= 1 && percents[i] <= 100);
+        ASSERT(percents[i] == rng_percent_r(&b));
+    }
+
+    return 0;
+}
+
+#ifndef _MSC_VER
+typedef struct thread_draws_t {
+    RngContext ctx;
+    bool production;
+    int rolls[DRAWS];
+} ThreadDraws;
+
+static void* draw_on_thread(void* arg)
+{
+    ThreadDraws* draws = arg;
+
+    // A new thread starts on the production ops and the shared stream.
+    draws->production = rng == &rng_production && rng_bound_context() == NULL;
+
+    rng_bind_context(&draws->ctx);
+    for (int i = 0; i < DRAWS; i++)
+        draws->rolls[i] = number_percent();
+
+    return NULL;
+}
+
+static int test_threads()
+{
+    RngContext parent;
+    ThreadDraws draws[2];
+
+    rng_context_seed(&parent, 77, 1);
+    rng_context_split(&parent, 1, &draws[0].ctx);
+    rng_context_split(&parent, 2, &draws[1].ctx);
+    RngContext expected[2] = { draws[0].ctx, draws[1].ctx };
+
+    RngContext* prev = rng_bound_context();
+
+    pthread_t threads[2];
+    for (int i = 0; i < 2; i++)
+        ASSERT(pthread_create(&threads[i], NULL, draw_on_thread, &draws[i]) == 0);
+    for (int i = 0; i < 2; i++)
+        pthread_join(threads[i], NULL);
+
+    // Binding on the workers left this thread alone.
+    ASSERT(rng_bound_context() == prev);
+
+    for (int i = 0; i < 2; i++) {
+        ASSERT(draws[i].production);
+        for (int j = 0; j < DRAWS; j++)
+            ASSERT(draws[i].rolls[j] == rng_percent_r(&expected[i]));
+    }
+
+    return 0;
+}
+#endif
+
+void register_rng_tests()
+{
+#define REGISTER(n, f)  register_test(&rng_tests, (n), (f))
+
+    init_test_group(&rng_tests, "RNG TESTS");
+    register_test_group(&rng_tests);
+
+    REGISTER("Context: Seeded Stream", test_seeded_stream);
+    REGISTER("Context: Bound to Production Ops", test_bound_context);
+    REGISTER("Context: Dice", test_dice);
+    REGISTER("Context: Split Streams", test_split);
+    REGISTER("Context: Batched Draws", test_batched);
+#ifndef _MSC_VER
+    REGISTER("Context: Per-Thread", test_threads);
+#endif
+
+#undef REGISTER
+}
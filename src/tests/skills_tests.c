@@ -1,5 +1,5 @@
 ////////////////////////////////////////////////////////////////////////////////
-// skills_tests.c - Skill learning and practice command tests (12 tests)
+// skills_tests.c - Skill learning and practice command tests (15 tests)
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "tests.h"
@@ -7,15 +7,19 @@
 #include "test_registry.h"
 
 #include <skills.h>
+#include <gsn.h>
 #include <handler.h>
 #include <db.h>
+#include <lookup.h>
 #include <merc.h>
 
 #include <entities/mobile.h>
 #include <entities/room.h>
 
+#include <data/class.h>
 #include <data/mobile_data.h>
 #include <data/player.h>
+#include <data/race.h>
 
 extern bool test_socket_output_enabled;
 extern Value test_output_buffer;
@@ -264,6 +268,128 @@ static int test_groups_npc()
     return 0;
 }
 
+// Stat caps are cached on the mobile; they must follow its level and race, and
+// the race table once it has been invalidated.
+static int test_derived_stat_caps()
+{
+    Mobile* ch = mock_player("capped");
+    int16_t human = race_lookup("human");
+    ch->race = human;
+    ch->ch_class = class_lookup("warrior");
+    ch->level = 10;
+
+    Stat stat = class_table[ch->ch_class].prime_stat == STAT_INT
+        ? STAT_WIS : STAT_INT;
+    int16_t saved = race_table[human].max_stats[stat];
+    ch->perm_stat[stat] = STAT_MAX;
+    ch->mod_stat[stat] = 0;
+
+    race_table[human].max_stats[stat] = 15;
+    invalidate_derived_stats();
+    ASSERT(get_curr_stat(ch, stat) == 20);
+
+    race_table[human].max_stats[stat] = 16;
+    invalidate_derived_stats();
+    ASSERT(get_curr_stat(ch, stat) == 21);
+
+    ch->level = LEVEL_IMMORTAL + 1;
+    ASSERT(get_curr_stat(ch, stat) == STAT_MAX);
+    ch->level = 10;
+    ASSERT(get_curr_stat(ch, stat) == 21);
+
+    ch->mod_stat[stat] = -30;
+    ASSERT(get_curr_stat(ch, stat) == 3);
+
+    race_table[human].max_stats[stat] = saved;
+    invalidate_derived_stats();
+
+    return 0;
+}
+
+// NPC skills come from per-sn rules, gated by the mobile's own flags.
+static int test_npc_skill_rules()
+{
+    Mobile* mob = mock_mob("skilled", 60003, NULL);
+    mob->level = 20;
+    mob->daze = 0;
+    REMOVE_BIT(mob->atk_flags, ATK_DODGE);
+    REMOVE_BIT(mob->act_flags, ACT_WARRIOR | ACT_THIEF);
+
+    ASSERT(get_skill(mob, gsn_dodge) == 0);
+    SET_BIT(mob->atk_flags, ATK_DODGE);
+    ASSERT(get_skill(mob, gsn_dodge) == 40);
+
+    ASSERT(get_skill(mob, gsn_second_attack) == 0);
+    ASSERT(get_skill(mob, gsn_third_attack) == 0);
+    SET_BIT(mob->act_flags, ACT_WARRIOR);
+    ASSERT(get_skill(mob, gsn_second_attack) == 70);
+    ASSERT(get_skill(mob, gsn_third_attack) == 40);
+    ASSERT(get_skill(mob, gsn_disarm) == 80);
+
+    ASSERT(get_skill(mob, gsn_sword) == 90);
+    ASSERT(get_skill(mob, gsn_recall) == 60);
+    ASSERT(get_skill(mob, gsn_kick) == 70);
+
+    invalidate_derived_stats();
+    mob->daze = 1;
+    ASSERT(get_skill(mob, gsn_kick) == 46);
+
+    return 0;
+}
+
+// AC, hitroll and skill aren't cached; they must follow affects, stat changes
+// and daze as soon as they happen.
+static int test_derived_live_values()
+{
+    Mobile* ch = mock_player("armored");
+    ch->race = race_lookup("human");
+    ch->ch_class = class_lookup("warrior");
+    ch->level = 10;
+    ch->position = POS_STANDING;
+    ch->daze = 0;
+    ch->pcdata->learned[gsn_kick] = 60;
+    ch->pcdata->condition[COND_DRUNK] = 0;
+    ch->perm_stat[STAT_STR] = 15;
+    ch->mod_stat[STAT_STR] = 0;
+
+    int ac = GET_AC(ch, AC_PIERCE);
+    int hitroll = GET_HITROLL(ch);
+
+    Affect af = { 0 };
+    af.where = TO_AFFECTS;
+    af.type = gsn_kick;
+    af.level = 10;
+    af.duration = 5;
+    af.location = APPLY_AC;
+    af.modifier = -20;
+    affect_to_mob(ch, &af);
+    af.location = APPLY_HITROLL;
+    af.modifier = 4;
+    affect_to_mob(ch, &af);
+    ASSERT(GET_AC(ch, AC_PIERCE) == ac - 20);
+    ASSERT(GET_HITROLL(ch) == hitroll + 4);
+
+    af.location = APPLY_STR;
+    af.modifier = 3;
+    affect_to_mob(ch, &af);
+    ASSERT(GET_HITROLL(ch) == ch->hitroll + str_mod[18].tohit);
+
+    affect_strip(ch, gsn_kick);
+    ASSERT(GET_AC(ch, AC_PIERCE) == ac);
+    ASSERT(GET_HITROLL(ch) == hitroll);
+
+    ASSERT(get_skill(ch, gsn_kick) == 60);
+    ch->daze = 1;
+    ASSERT(get_skill(ch, gsn_kick) == 40);
+    ch->daze = 0;
+    ch->pcdata->condition[COND_DRUNK] = 20;
+    ASSERT(get_skill(ch, gsn_kick) == 54);
+    ch->pcdata->condition[COND_DRUNK] = 0;
+    ASSERT(get_skill(ch, gsn_kick) == 60);
+
+    return 0;
+}
+
 void register_skills_tests()
 {
     TestGroup* group = calloc(1, sizeof(TestGroup));
@@ -291,6 +417,11 @@ void register_skills_tests()
     REGISTER("Groups: Specific group", test_groups_specific);
     REGISTER("Groups: NPC check", test_groups_npc);
 
+    // Derived stats
+    REGISTER("Derived: Stat caps", test_derived_stat_caps);
+    REGISTER("Derived: NPC skill rules", test_npc_skill_rules);
+    REGISTER("Derived: Live AC, hitroll and skill", test_derived_live_values);
+
 #undef REGISTER
 
     register_test_group(group);
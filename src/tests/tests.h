@@ -63,6 +63,7 @@ void register_money_tests();
 void register_quest_tests();
 void register_login_tests();
 void register_persist_tests();
+void register_area_cache_tests();
 void register_player_persist_tests();
 void register_fight_tests();
 void register_damage_tests();
@@ -77,8 +78,14 @@ void register_multihit_tests();
 void register_loot_tests();
 void register_thief_tests();
 void register_magic_tests();
+void register_mob_prog_tests();
+void register_rng_tests();
+void register_pathfind_tests();
 void register_craft_tests();
 void register_olc_aedit_tests();
+void register_olc_asave_tests();
+void register_help_note_tests();
+void register_player_index_tests();
 void register_gather_spawn_tests();
 
 void run_unit_tests();
@@ -4,14 +4,21 @@
 
 #include "tests.h"
 #include "test_registry.h"
+#include "mock.h"
 
 #include <olc/string_edit.h>
 
 #include <color.h>
+#include <command.h>
 #include <db.h>
 #include <format.h>
+#include <interp.h>
 #include <match.h>
 
+#include <entities/mobile.h>
+
+#include <lox/lox.h>
+
 TestGroup util_tests;
 
 static int test_match_none()
@@ -94,6 +101,62 @@ static int test_match_kleene_closure()
     return 0;
 }
 
+extern int nSharedString;
+extern int nSharedRefs;
+
+static int test_str_dup_shares_text()
+{
+    char first[] = "a shared string for the str_dup tests";
+    char second[] = "a shared string for the str_dup tests";
+    int strings = nSharedString;
+    int refs = nSharedRefs;
+
+    char* a = str_dup(first);
+    char* b = str_dup(second);
+
+    ASSERT(a == b);
+    ASSERT(a != first);
+    ASSERT(nSharedString == strings + 1);
+    ASSERT(nSharedRefs == refs + 2);
+
+    free_string(a);
+    ASSERT_STR_EQ(second, b);
+    ASSERT(nSharedString == strings + 1);
+
+    free_string(b);
+    ASSERT(nSharedString == strings);
+    ASSERT(nSharedRefs == refs);
+
+    return 0;
+}
+
+// Commands write into their argument (do_title() cuts it at 45), so callers
+// must not hand them str_dup() text, which other owners may share.
+static int test_commands_leave_shared_text()
+{
+    Room* room = mock_room(50000, NULL, NULL);
+    Mobile* ch = mock_player("Titled");
+    transfer_mob(ch, room);
+
+    const char* title = "the very long title that goes on well past the cut";
+    char* shared = str_dup(title);
+    do_function(ch, &do_title, shared);
+    ASSERT_STR_EQ(title, shared);
+    free_string(shared);
+
+    const char* cmd = "title the very long title that Lox sets for the mob";
+    shared = str_dup(cmd);
+    Mobile* saved_me = exec_context.me;
+    exec_context.me = ch;
+    interpret_code("do(\"title the very long title that Lox sets for the mob\")");
+    exec_context.me = saved_me;
+    ASSERT_STR_EQ(cmd, shared);
+    free_string(shared);
+
+    test_output_buffer = NIL_VAL;
+    return 0;
+}
+
 void register_util_tests()
 {
 #define REGISTER(n, f)  register_test(&util_tests, (n), (f))
@@ -106,6 +169,8 @@ void register_util_tests()
     REGISTER("Pattern Matching: Substitutions", test_match_subs);
     REGISTER("Pattern Matching: Positive Closure", test_match_positive_closure);
     REGISTER("Pattern Matching: Kleene Closure", test_match_kleene_closure);
+    REGISTER("Strings: str_dup Shares Text", test_str_dup_shares_text);
+    REGISTER("Strings: Commands Leave Shared Text", test_commands_leave_shared_text);
 
 #undef REGISTER
 }
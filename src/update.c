@@ -57,6 +57,8 @@
 
 #include <lox/memory.h>
 
+#include <olc/area_save_queue.h>
+
 #include <stdio.h>
 #include <string.h>
 #include <sys/types.h>
@@ -885,25 +887,63 @@ void obj_update(void)
  *   who leads the party into the room.
  *
  * -- Furey
+ *
+ * Rooms count the NPCs that could ever aggress (see update_room_aggressor()),
+ * so a player standing among peaceful mobs costs one compare. A player's
+ * standing with each faction in the room is looked up once, not per mob.
  */
+
+#define AGGR_STANDINGS  8
+
+typedef struct aggr_standing_t {
+    Faction* faction;
+    int standing;
+} AggrStanding;
+
+static int aggr_standing(Mobile* wch, Faction* faction, AggrStanding* cache,
+    int* count)
+{
+    for (int i = 0; i < *count; i++) {
+        if (cache[i].faction == faction)
+            return cache[i].standing;
+    }
+
+    int standing = faction_get_standing(wch, faction, true);
+    if (*count < AGGR_STANDINGS) {
+        cache[*count].faction = faction;
+        cache[*count].standing = standing;
+        (*count)++;
+    }
+    return standing;
+}
+
 void aggr_update(void)
 {
     for (PlayerData* wpc = player_data_list; wpc != NULL; NEXT_LINK(wpc)) {
         Mobile* wch = wpc->ch;
 
-        if (wch->level >= LEVEL_IMMORTAL || wch->in_room == NULL)
+        if (wch->level >= LEVEL_IMMORTAL || wch->in_room == NULL
+            || wch->in_room->aggressors == 0)
             continue;
 
+        AggrStanding standings[AGGR_STANDINGS];
+        int standing_count = 0;
+
         Mobile* ch = NULL;
         FOR_EACH_ROOM_MOB(ch, wch->in_room) {
             int count;
+
+            if (!ch->room_aggressor)
+                continue;
+
             // TODO: If the player is exalted with an NPC's faction, that NPC
             // should agress the player's enemies.
             Faction* faction = get_mob_faction(ch);
             bool forced_hostile = false;
 
             if (faction != NULL && !IS_NPC(wch)) {
-                int standing = faction_get_standing(wch, faction, true);
+                int standing = aggr_standing(wch, faction, standings,
+                    &standing_count);
                 if (faction_is_friendly_value(standing))
                     continue;
                 forced_hostile = faction_is_hostile_value(standing);
@@ -943,6 +983,9 @@ void aggr_update(void)
                 continue;
 
             multi_hit(ch, victim, TYPE_UNDEFINED);
+
+            // A kill can move the player's standings.
+            standing_count = 0;
         }
     }
 
@@ -995,8 +1038,10 @@ void update_handler()
 
     event_timer_tick();
     aggr_update();
+    poll_area_saves();
 
     gc_protect_clear();
+    collect_garbage_step();
 
     return;
 }
@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////
+// batch.c
+////////////////////////////////////////////////////////////////////////////////
+
+#include "batch.h"
+
+#include <pcg_basic.h>
+
+#include <stdio.h>
+
+#ifndef _MSC_VER
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+void sim_seed_rng(uint64_t seed)
+{
+    uint64_t seq = 54u;
+    pcg32_srandom(seed, seq);
+}
+
+static bool run_range(SimContext* ctx, const SimConfig* cfg, uint64_t seed_base,
+                      int first, int count, SimRunMetrics* results)
+{
+    for (int run = first; run < first + count; run++) {
+        if (cfg->use_seed) {
+            sim_seed_rng(seed_base + (uint64_t)run);
+        }
+
+        if (!sim_run(ctx, cfg, &results[run])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#ifndef _MSC_VER
+static bool write_all(int fd, const void* buf, size_t len)
+{
+    const char* p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void* buf, size_t len)
+{
+    char* p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+#endif
+
+bool sim_run_batch(SimContext* ctx, const SimConfig* cfg, uint64_t seed_base,
+                   int jobs, SimRunMetrics* results)
+{
+    if (!ctx || !cfg || !results) {
+        return false;
+    }
+
+    if (jobs > cfg->runs) {
+        jobs = cfg->runs;
+    }
+    if (jobs > SIM_MAX_JOBS) {
+        jobs = SIM_MAX_JOBS;
+    }
+
+    if (jobs <= 1) {
+        return run_range(ctx, cfg, seed_base, 0, cfg->runs, results);
+    }
+
+#ifdef _MSC_VER
+    return run_range(ctx, cfg, seed_base, 0, cfg->runs, results);
+#else
+    pid_t pids[SIM_MAX_JOBS];
+    int fds[SIM_MAX_JOBS];
+    int started = 0;
+    bool ok = true;
+
+    // Anything still buffered would otherwise be written once per child.
+    fflush(NULL);
+
+    for (int job = 0; job < jobs; job++) {
+        int first = (int)((long long)cfg->runs * job / jobs);
+        int count = (int)((long long)cfg->runs * (job + 1) / jobs) - first;
+
+        int pipe_fds[2];
+        if (pipe(pipe_fds) != 0) {
+            perror("pipe");
+            ok = false;
+            break;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            close(pipe_fds[0]);
+            close(pipe_fds[1]);
+            ok = false;
+            break;
+        }
+
+        if (pid == 0) {
+            close(pipe_fds[0]);
+            bool child_ok = run_range(ctx, cfg, seed_base, first, count, results)
+                && write_all(pipe_fds[1], &results[first],
+                    sizeof(SimRunMetrics) * (size_t)count);
+            close(pipe_fds[1]);
+            // Skip atexit handlers and stdio flushing; they belong to the parent.
+            _exit(child_ok ? 0 : 1);
+        }
+
+        close(pipe_fds[1]);
+        pids[started] = pid;
+        fds[started] = pipe_fds[0];
+        started++;
+    }
+
+    for (int job = 0; job < started; job++) {
+        int first = (int)((long long)cfg->runs * job / jobs);
+        int count = (int)((long long)cfg->runs * (job + 1) / jobs) - first;
+
+        if (!read_all(fds[job], &results[first], sizeof(SimRunMetrics) * (size_t)count)) {
+            ok = false;
+        }
+        close(fds[job]);
+
+        int status = 0;
+        while (waitpid(pids[job], &status, 0) < 0 && errno == EINTR)
+            ;
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            ok = false;
+        }
+    }
+
+    return ok;
+#endif
+}
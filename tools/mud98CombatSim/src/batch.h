@@ -0,0 +1,31 @@
+////////////////////////////////////////////////////////////////////////////////
+// batch.h
+////////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#ifndef MUD98_COMBAT_SIM_BATCH_H
+#define MUD98_COMBAT_SIM_BATCH_H
+
+#include "metrics.h"
+#include "sim.h"
+#include "sim_config.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Reseeds the RNG for one run.
+void sim_seed_rng(uint64_t seed);
+
+// Runs cfg->runs fights into 'results' (one per run, in order). When the
+// config has a seed, run i starts from the stream seeded with seed_base + i,
+// so each run's outcome depends only on its own index.
+//
+// With jobs > 1 the runs are split into contiguous chunks, and each chunk is
+// simulated by a forked copy of the booted world, which sends its results
+// back over a pipe. Because every run is reseeded, the merged results are the
+// same as a sequential run with the same seed. Where fork() is unavailable,
+// the runs are done sequentially.
+bool sim_run_batch(SimContext* ctx, const SimConfig* cfg, uint64_t seed_base,
+                   int jobs, SimRunMetrics* results);
+
+#endif // MUD98_COMBAT_SIM_BATCH_H
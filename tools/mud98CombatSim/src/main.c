@@ -2,6 +2,7 @@
 // mud98CombatSim: A combat simulator for MUD98.
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "batch.h"
 #include "metrics.h"
 #include "sim.h"
 #include "sim_config.h"
@@ -9,7 +10,6 @@
 #include <config.h>
 #include <db.h>
 #include <fileutils.h>
-#include <pcg_basic.h>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -39,16 +39,10 @@ int gettimeofday(struct timeval* tp, struct timezone* unused);
 static void print_usage(const char* argv0)
 {
     fprintf(stderr,
-        "Usage: %s [--dir=<rundir>] [--area-dir=<areadir>] <config.json>\n",
+        "Usage: %s [--dir=<rundir>] [--area-dir=<areadir>] [--jobs=<n>] <config.json>\n",
         argv0);
 }
 
-static void seed_rng(uint64_t seed)
-{
-    uint64_t seq = 54u;
-    pcg32_srandom(seed, seq);
-}
-
 static const char* sweep_target_name(SimSweepTarget target)
 {
     switch (target) {
@@ -83,6 +77,45 @@ static const char* sweep_stat_name(SimSweepStat stat)
     }
 }
 
+typedef enum sweep_field_t {
+    SWEEP_FIELD_TARGET,
+    SWEEP_FIELD_STAT,
+    SWEEP_FIELD_VALUE,
+} SweepField;
+
+// One field of every sweep axis, joined with ';'.
+static void format_sweep_field(char* out, size_t out_len, const SimSweepConfig* sweep,
+                               const int* values, SweepField field)
+{
+    size_t used = 0;
+    out[0] = '\0';
+
+    for (int i = 0; i < sweep->axis_count && used < out_len; i++) {
+        const SimSweepAxis* axis = &sweep->axes[i];
+        const char* sep = i > 0 ? ";" : "";
+        int written = 0;
+
+        switch (field) {
+        case SWEEP_FIELD_TARGET:
+            written = snprintf(out + used, out_len - used, "%s%s", sep,
+                sweep_target_name(axis->target));
+            break;
+        case SWEEP_FIELD_STAT:
+            written = snprintf(out + used, out_len - used, "%s%s", sep,
+                sweep_stat_name(axis->stat));
+            break;
+        case SWEEP_FIELD_VALUE:
+            written = snprintf(out + used, out_len - used, "%s%d", sep, values[i]);
+            break;
+        }
+
+        if (written < 0) {
+            break;
+        }
+        used += (size_t)written;
+    }
+}
+
 static void compute_rates(long long rolls, long long hits, long long misses,
                           long long parries, long long dodges, long long blocks,
                           double* hit_rate, double* miss_rate, double* parry_rate,
@@ -104,7 +137,7 @@ static void compute_rates(long long rolls, long long hits, long long misses,
     *block_rate = (double)blocks / (double)rolls;
 }
 
-static void write_run_csv(FILE* csv, int run_index, int sweep_value, bool include_sweep,
+static void write_run_csv(FILE* csv, int run_index, const char* sweep_value,
                           const SimRunMetrics* run)
 {
     double seconds = (double)run->ticks / (double)PULSE_PER_SECOND;
@@ -122,8 +155,8 @@ static void write_run_csv(FILE* csv, int run_index, int sweep_value, bool includ
                   run->parry_count, run->dodge_count, run->block_count,
                   &hit_rate, &miss_rate, &parry_rate, &dodge_rate, &block_rate);
 
-    if (include_sweep) {
-        fprintf(csv, "%d,", sweep_value);
+    if (sweep_value) {
+        fprintf(csv, "%s,", sweep_value);
     }
     fprintf(csv,
         "%d,%d,%.4f,%d,%.4f,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f\n",
@@ -170,18 +203,19 @@ static void write_csv_summary_header(FILE* csv)
         "hit_rate,miss_rate,parry_rate,dodge_rate,block_rate\n");
 }
 
-static bool apply_sweep_value(SimConfig* cfg, int value, char* err, size_t err_len)
+static bool apply_sweep_value(SimConfig* cfg, const SimSweepAxis* axis, int value,
+                              char* err, size_t err_len)
 {
-    if (!cfg) {
+    if (!cfg || !axis) {
         snprintf(err, err_len, "invalid sweep config");
         return false;
     }
 
     SimCombatantConfig* target = NULL;
-    if (cfg->sweep.target == SWEEP_TARGET_ATTACKER) {
+    if (axis->target == SWEEP_TARGET_ATTACKER) {
         target = &cfg->attacker;
     }
-    else if (cfg->sweep.target == SWEEP_TARGET_DEFENDER) {
+    else if (axis->target == SWEEP_TARGET_DEFENDER) {
         target = &cfg->defender;
     }
 
@@ -190,7 +224,7 @@ static bool apply_sweep_value(SimConfig* cfg, int value, char* err, size_t err_l
         return false;
     }
 
-    switch (cfg->sweep.stat) {
+    switch (axis->stat) {
     case SWEEP_STAT_LEVEL:
         if (value <= 0) {
             snprintf(err, err_len, "sweep level must be > 0");
@@ -247,6 +281,7 @@ int main(int argc, char** argv)
     char run_dir[256] = { 0 };
     char area_dir[256] = { 0 };
     const char* config_path = NULL;
+    int jobs = 0;
 
     if (argc > 1) {
         for (int i = 1; i < argc; i++) {
@@ -269,6 +304,14 @@ int main(int argc, char** argv)
                     snprintf(area_dir, sizeof(area_dir), "%s", argv[i]);
                 }
             }
+            else if (!strncmp(argv[i], "--jobs=", 7)) {
+                jobs = atoi(argv[i] + 7);
+            }
+            else if (!strcmp(argv[i], "-j")) {
+                if (++i < argc) {
+                    jobs = atoi(argv[i]);
+                }
+            }
             else if (!strncmp(argv[i], "--config=", 9)) {
                 config_path = argv[i] + 9;
             }
@@ -293,6 +336,11 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (jobs < 0 || jobs > SIM_MAX_JOBS) {
+        fprintf(stderr, "--jobs must be between 1 and %d.\n", SIM_MAX_JOBS);
+        return 1;
+    }
+
     if (area_dir[0]) {
         cfg_set_area_dir(area_dir);
     }
@@ -318,6 +366,17 @@ int main(int argc, char** argv)
         return 1;
     }
 
+    if (jobs > 0) {
+        cfg.jobs = jobs;
+    }
+
+    // Workers can't share one RNG stream, so a parallel run always has a seed.
+    if (cfg.jobs > 1 && !cfg.use_seed) {
+        cfg.use_seed = true;
+        cfg.seed = (uint64_t)now_time.tv_sec * 1000000u + (uint64_t)now_time.tv_usec;
+        printf("Seed: %llu\n", (unsigned long long)cfg.seed);
+    }
+
     SimContext ctx;
     if (!sim_init(&ctx, &cfg, err, sizeof(err))) {
         fprintf(stderr, "Sim init error: %s\n", err);
@@ -358,48 +417,64 @@ int main(int argc, char** argv)
         }
     }
 
+    SimRunMetrics* results = calloc((size_t)cfg.runs, sizeof(SimRunMetrics));
+    if (!results) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
     if (sweep_enabled) {
-        int sweep_index = 0;
-        for (int value = cfg.sweep.start; ; value += cfg.sweep.step, sweep_index++) {
-            if (cfg.sweep.step > 0 && value > cfg.sweep.end) {
-                break;
-            }
-            if (cfg.sweep.step < 0 && value < cfg.sweep.end) {
-                break;
+        char targets[128];
+        char stats[128];
+        format_sweep_field(targets, sizeof(targets), &cfg.sweep, NULL, SWEEP_FIELD_TARGET);
+        format_sweep_field(stats, sizeof(stats), &cfg.sweep, NULL, SWEEP_FIELD_STAT);
+
+        int combo_count = 1;
+        for (int i = 0; i < cfg.sweep.axis_count; i++) {
+            combo_count *= sim_sweep_axis_count(&cfg.sweep.axes[i]);
+        }
+
+        for (int combo = 0; combo < combo_count; combo++) {
+            int values[SIM_MAX_SWEEP_AXES] = { 0 };
+            int rest = combo;
+            for (int i = cfg.sweep.axis_count - 1; i >= 0; i--) {
+                const SimSweepAxis* axis = &cfg.sweep.axes[i];
+                int count = sim_sweep_axis_count(axis);
+                values[i] = sim_sweep_axis_value(axis, rest % count);
+                rest /= count;
             }
 
             SimConfig step_cfg = cfg;
-            if (!apply_sweep_value(&step_cfg, value, err, sizeof(err))) {
-                fprintf(stderr, "Sweep error: %s\n", err);
+            for (int i = 0; i < cfg.sweep.axis_count; i++) {
+                if (!apply_sweep_value(&step_cfg, &cfg.sweep.axes[i], values[i],
+                        err, sizeof(err))) {
+                    fprintf(stderr, "Sweep error: %s\n", err);
+                    return 1;
+                }
+            }
+
+            uint64_t seed_base = cfg.seed + (uint64_t)combo * (uint64_t)cfg.runs;
+            if (!sim_run_batch(&ctx, &step_cfg, seed_base, cfg.jobs, results)) {
+                fprintf(stderr, "Sim run failed.\n");
                 return 1;
             }
 
+            char value_text[128];
+            format_sweep_field(value_text, sizeof(value_text), &cfg.sweep, values,
+                SWEEP_FIELD_VALUE);
+
             SimAggregateMetrics step_metrics;
             sim_metrics_init(&step_metrics);
 
             for (int run = 0; run < cfg.runs; run++) {
-                if (cfg.use_seed) {
-                    uint64_t offset = (uint64_t)(sweep_index * cfg.runs + run);
-                    seed_rng(cfg.seed + offset);
-                }
-
-                SimRunMetrics run_metrics = { 0 };
-                if (!sim_run(&ctx, &step_cfg, &run_metrics)) {
-                    fprintf(stderr, "Sim run failed.\n");
-                    return 1;
-                }
-
                 if (csv_runs) {
-                    write_run_csv(csv_runs, run + 1, value, true, &run_metrics);
+                    write_run_csv(csv_runs, run + 1, value_text, &results[run]);
                 }
 
-                sim_metrics_add_run(&step_metrics, &run_metrics);
+                sim_metrics_add_run(&step_metrics, &results[run]);
             }
 
-            printf("Sweep target=%s stat=%s value=%d\n",
-                sweep_target_name(cfg.sweep.target),
-                sweep_stat_name(cfg.sweep.stat),
-                value);
+            printf("Sweep target=%s stat=%s value=%s\n", targets, stats, value_text);
             sim_metrics_print_summary(&step_metrics, stdout);
 
             if (csv_summary) {
@@ -443,10 +518,10 @@ int main(int argc, char** argv)
                     &hit_rate, &miss_rate, &parry_rate, &dodge_rate, &block_rate);
 
                 fprintf(csv_summary,
-                    "%s,%s,%d,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
-                    sweep_target_name(cfg.sweep.target),
-                    sweep_stat_name(cfg.sweep.stat),
-                    value,
+                    "%s,%s,%s,%d,%d,%d,%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                    targets,
+                    stats,
+                    value_text,
                     step_metrics.runs,
                     step_metrics.completed,
                     step_metrics.timeouts,
@@ -464,37 +539,29 @@ int main(int argc, char** argv)
                     dodge_rate,
                     block_rate);
             }
-
-            if (value == cfg.sweep.end) {
-                break;
-            }
         }
     }
     else {
         SimAggregateMetrics metrics;
         sim_metrics_init(&metrics);
 
-        for (int run = 0; run < cfg.runs; run++) {
-            if (cfg.use_seed) {
-                seed_rng(cfg.seed + (uint64_t)run);
-            }
-
-            SimRunMetrics run_metrics = { 0 };
-            if (!sim_run(&ctx, &cfg, &run_metrics)) {
-                fprintf(stderr, "Sim run failed.\n");
-                return 1;
-            }
+        if (!sim_run_batch(&ctx, &cfg, cfg.seed, cfg.jobs, results)) {
+            fprintf(stderr, "Sim run failed.\n");
+            return 1;
+        }
 
+        for (int run = 0; run < cfg.runs; run++) {
             if (csv_runs) {
-                write_run_csv(csv_runs, run + 1, 0, false, &run_metrics);
+                write_run_csv(csv_runs, run + 1, NULL, &results[run]);
             }
 
-            sim_metrics_add_run(&metrics, &run_metrics);
+            sim_metrics_add_run(&metrics, &results[run]);
         }
 
         sim_metrics_print_summary(&metrics, stdout);
     }
 
+    free(results);
     sim_shutdown(&ctx);
     free_vm();
 
@@ -211,7 +211,7 @@ static bool sim_ai_try_cast_spell(Mobile* ch, Mobile* opponent,
         return false;
     }
     if (ch->fighting == NULL) {
-        ch->fighting = opponent;
+        set_fighting(ch, opponent);
     }
 
     for (int i = 0; i < cfg->ai.spell_count; i++) {
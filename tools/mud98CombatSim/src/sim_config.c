@@ -294,27 +294,22 @@ static SimSweepStat parse_sweep_stat(const char* value)
     return SWEEP_STAT_NONE;
 }
 
-static bool parse_sweep(json_t* root, SimSweepConfig* out, char* err, size_t err_len)
+static bool parse_sweep_axis(json_t* node, const char* name, SimSweepAxis* out,
+                             char* err, size_t err_len)
 {
-    json_t* node = json_object_get(root, "sweep");
-    if (!node) {
-        out->enabled = false;
-        return true;
-    }
-
     if (!json_is_object(node)) {
-        snprintf(err, err_len, "sweep must be an object");
+        snprintf(err, err_len, "%s must be an object", name);
         return false;
     }
 
     char target_name[64] = { 0 };
     char stat_name[64] = { 0 };
     if (!json_get_string(node, "target", target_name, sizeof(target_name))) {
-        snprintf(err, err_len, "sweep.target is required");
+        snprintf(err, err_len, "%s.target is required", name);
         return false;
     }
     if (!json_get_string(node, "stat", stat_name, sizeof(stat_name))) {
-        snprintf(err, err_len, "sweep.stat is required");
+        snprintf(err, err_len, "%s.stat is required", name);
         return false;
     }
 
@@ -322,40 +317,39 @@ static bool parse_sweep(json_t* root, SimSweepConfig* out, char* err, size_t err
     int end = 0;
     int step = 0;
     if (!json_get_int(node, "start", &start)) {
-        snprintf(err, err_len, "sweep.start is required");
+        snprintf(err, err_len, "%s.start is required", name);
         return false;
     }
     if (!json_get_int(node, "end", &end)) {
-        snprintf(err, err_len, "sweep.end is required");
+        snprintf(err, err_len, "%s.end is required", name);
         return false;
     }
     if (!json_get_int(node, "step", &step) || step == 0) {
-        snprintf(err, err_len, "sweep.step must be a non-zero integer");
+        snprintf(err, err_len, "%s.step must be a non-zero integer", name);
         return false;
     }
 
     SimSweepTarget target = parse_sweep_target(target_name);
     if (target == SWEEP_TARGET_NONE) {
-        snprintf(err, err_len, "sweep.target must be attacker or defender");
+        snprintf(err, err_len, "%s.target must be attacker or defender", name);
         return false;
     }
 
     SimSweepStat stat = parse_sweep_stat(stat_name);
     if (stat == SWEEP_STAT_NONE) {
-        snprintf(err, err_len, "sweep.stat is not supported");
+        snprintf(err, err_len, "%s.stat is not supported", name);
         return false;
     }
 
     if (start < end && step < 0) {
-        snprintf(err, err_len, "sweep.step must be positive for increasing ranges");
+        snprintf(err, err_len, "%s.step must be positive for increasing ranges", name);
         return false;
     }
     if (start > end && step > 0) {
-        snprintf(err, err_len, "sweep.step must be negative for decreasing ranges");
+        snprintf(err, err_len, "%s.step must be negative for decreasing ranges", name);
         return false;
     }
 
-    out->enabled = true;
     out->target = target;
     out->stat = stat;
     out->start = start;
@@ -364,6 +358,52 @@ static bool parse_sweep(json_t* root, SimSweepConfig* out, char* err, size_t err
     return true;
 }
 
+static bool parse_sweep(json_t* root, SimSweepConfig* out, char* err, size_t err_len)
+{
+    json_t* node = json_object_get(root, "sweep");
+    if (!node) {
+        out->enabled = false;
+        return true;
+    }
+
+    // A single object sweeps one stat; an array sweeps every combination.
+    if (json_is_array(node)) {
+        size_t count = json_array_size(node);
+        if (count == 0 || count > SIM_MAX_SWEEP_AXES) {
+            snprintf(err, err_len, "sweep must list 1 to %d axes", SIM_MAX_SWEEP_AXES);
+            return false;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            char name[32];
+            snprintf(name, sizeof(name), "sweep[%zu]", i);
+            if (!parse_sweep_axis(json_array_get(node, i), name, &out->axes[i], err, err_len)) {
+                return false;
+            }
+        }
+        out->axis_count = (int)count;
+    }
+    else {
+        if (!parse_sweep_axis(node, "sweep", &out->axes[0], err, err_len)) {
+            return false;
+        }
+        out->axis_count = 1;
+    }
+
+    out->enabled = true;
+    return true;
+}
+
+int sim_sweep_axis_count(const SimSweepAxis* axis)
+{
+    return (axis->end - axis->start) / axis->step + 1;
+}
+
+int sim_sweep_axis_value(const SimSweepAxis* axis, int index)
+{
+    return axis->start + index * axis->step;
+}
+
 static bool parse_damage(json_t* node, SimDamageConfig* out, char* err, size_t err_len)
 {
     if (!json_is_object(node)) {
@@ -526,6 +566,7 @@ void sim_config_init(SimConfig* cfg)
 
     cfg->runs = 1;
     cfg->max_ticks = 200;
+    cfg->jobs = 1;
     cfg->use_seed = false;
     cfg->seed = 0;
     cfg->csv_path[0] = '\0';
@@ -590,11 +631,7 @@ void sim_config_init(SimConfig* cfg)
     cfg->defender.set_spec = false;
 
     cfg->sweep.enabled = false;
-    cfg->sweep.target = SWEEP_TARGET_NONE;
-    cfg->sweep.stat = SWEEP_STAT_NONE;
-    cfg->sweep.start = 0;
-    cfg->sweep.end = 0;
-    cfg->sweep.step = 0;
+    cfg->sweep.axis_count = 0;
 }
 
 bool sim_config_load(const char* path, SimConfig* out, char* err, size_t err_len)
@@ -637,6 +674,13 @@ bool sim_config_load(const char* path, SimConfig* out, char* err, size_t err_len
         return false;
     }
 
+    if (json_get_int(root, "jobs", &out->jobs)
+        && (out->jobs <= 0 || out->jobs > SIM_MAX_JOBS)) {
+        snprintf(err, err_len, "jobs must be between 1 and %d", SIM_MAX_JOBS);
+        json_decref(root);
+        return false;
+    }
+
     (void)json_get_string(root, "csv_path", out->csv_path, sizeof(out->csv_path));
     (void)json_get_string(root, "csv_runs_path", out->csv_runs_path, sizeof(out->csv_runs_path));
 
@@ -16,6 +16,8 @@
 #define SIM_MAX_SPELLS 16
 #define SIM_NAME_LEN 64
 #define SIM_TOKEN_LEN 32
+#define SIM_MAX_SWEEP_AXES 4
+#define SIM_MAX_JOBS 64
 
 typedef struct sim_damage_config_t {
     int dice;
@@ -93,18 +95,26 @@ typedef enum sim_sweep_stat_t {
     SWEEP_STAT_DAMAGE_BONUS = 7,
 } SimSweepStat;
 
-typedef struct sim_sweep_config_t {
-    bool enabled;
+typedef struct sim_sweep_axis_t {
     SimSweepTarget target;
     SimSweepStat stat;
     int start;
     int end;
     int step;
+} SimSweepAxis;
+
+// Every combination of the axes' values is simulated; the last axis varies
+// fastest.
+typedef struct sim_sweep_config_t {
+    bool enabled;
+    int axis_count;
+    SimSweepAxis axes[SIM_MAX_SWEEP_AXES];
 } SimSweepConfig;
 
 typedef struct sim_config_t {
     int runs;
     int max_ticks;
+    int jobs;
     bool use_seed;
     uint64_t seed;
     char csv_path[256];
@@ -117,4 +127,8 @@ typedef struct sim_config_t {
 void sim_config_init(SimConfig* cfg);
 bool sim_config_load(const char* path, SimConfig* out, char* err, size_t err_len);
 
+// How many values a sweep axis takes, and the index'th of them.
+int sim_sweep_axis_count(const SimSweepAxis* axis);
+int sim_sweep_axis_value(const SimSweepAxis* axis, int index);
+
 #endif // MUD98_COMBAT_SIM_CONFIG_H